@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_CHUNKER_CHUNKERINTERFACE_H_
+#define PEERACLE_CHUNKER_CHUNKERINTERFACE_H_
+
+#include <stdint.h>
+#include <cstdlib>
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Chunker module interface.
+ * \addtogroup Chunker
+ */
+class ChunkerInterface {
+ public:
+  /**
+   * Get the chunk size to record in the metadata stream.
+   * \return The fixed chunk size in bytes, or 0 if the chunk boundaries
+   * depend on the content and every chunk length is recorded.
+   */
+  virtual uint32_t getChunkSize() const = 0;
+
+  /**
+   * Find the end of the chunk starting at \p buffer. Chunks never span two
+   * media segments, so \p buffer always points inside a single segment.
+   * @param buffer a pointer to the remaining bytes of the media segment.
+   * @param length the number of bytes remaining in the media segment.
+   * \return The length of the chunk, between 1 and \p length bytes.
+   */
+  virtual size_t next(const uint8_t *buffer, size_t length) = 0;
+
+  virtual ~ChunkerInterface() {}
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_CHUNKER_CHUNKERINTERFACE_H_
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/Chunker/ContentDefinedChunker.h"
+#include "peeracle/Chunker/FixedSizeChunker.h"
+
+namespace peeracle {
+
+class ChunkerTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    uint32_t state = 0x5052434C;
+
+    _data.resize(4 * 1024 * 1024);
+    for (size_t i = 0; i < _data.size(); ++i) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      _data[i] = static_cast<uint8_t>(state);
+    }
+  }
+
+  void split(ChunkerInterface *chunker, const std::vector<uint8_t> &data,
+             std::vector<std::string> *chunks) {
+    size_t offset = 0;
+
+    while (offset < data.size()) {
+      size_t length = chunker->next(&data[offset], data.size() - offset);
+
+      ASSERT_GT(length, 0);
+      ASSERT_LE(offset + length, data.size());
+      chunks->push_back(std::string(
+        reinterpret_cast<const char *>(&data[offset]), length));
+      offset += length;
+    }
+  }
+
+  std::vector<uint8_t> _data;
+};
+
+TEST_F(ChunkerTest, FixedSize) {
+  FixedSizeChunker chunker(65536);
+  std::vector<std::string> chunks;
+
+  EXPECT_EQ(65536, chunker.getChunkSize());
+
+  _data.resize(65536 * 3 + 10);
+  split(&chunker, _data, &chunks);
+
+  ASSERT_EQ(4, chunks.size());
+  EXPECT_EQ(65536, chunks[0].size());
+  EXPECT_EQ(65536, chunks[2].size());
+  EXPECT_EQ(10, chunks[3].size());
+}
+
+TEST_F(ChunkerTest, FixedSizeWholeSegment) {
+  FixedSizeChunker chunker(0);
+  std::vector<std::string> chunks;
+
+  EXPECT_EQ(0, chunker.getChunkSize());
+  _data.resize(65536 * 3 + 10);
+  split(&chunker, _data, &chunks);
+
+  ASSERT_EQ(1, chunks.size());
+  EXPECT_EQ(_data.size(), chunks[0].size());
+}
+
+TEST_F(ChunkerTest, ContentDefinedBounds) {
+  ContentDefinedChunker chunker(65536);
+  std::vector<std::string> chunks;
+
+  EXPECT_EQ(0, chunker.getChunkSize());
+  EXPECT_EQ(16384, chunker.getMinimumSize());
+  EXPECT_EQ(65536, chunker.getAverageSize());
+  EXPECT_EQ(262144, chunker.getMaximumSize());
+
+  split(&chunker, _data, &chunks);
+
+  ASSERT_GT(chunks.size(), 1);
+  for (size_t i = 0; i < chunks.size() - 1; ++i) {
+    EXPECT_GE(chunks[i].size(), chunker.getMinimumSize());
+    EXPECT_LE(chunks[i].size(), chunker.getMaximumSize());
+  }
+
+  EXPECT_GT(chunks.size(), _data.size() / chunker.getMaximumSize());
+  EXPECT_LT(chunks.size(), _data.size() / chunker.getMinimumSize());
+}
+
+TEST_F(ChunkerTest, ContentDefinedShift) {
+  ContentDefinedChunker chunker(65536);
+  std::vector<uint8_t> shifted(_data);
+  std::vector<std::string> chunks;
+  std::vector<std::string> shiftedChunks;
+  std::map<std::string, int> known;
+  size_t shared = 0;
+
+  shifted.insert(shifted.begin() + 100000, 7, 0x42);
+  split(&chunker, _data, &chunks);
+  split(&chunker, shifted, &shiftedChunks);
+
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    known[chunks[i]] = 1;
+  }
+
+  for (size_t i = 0; i < shiftedChunks.size(); ++i) {
+    shared += known.count(shiftedChunks[i]);
+  }
+
+  // Only the chunks around the inserted bytes should differ.
+  EXPECT_GE(shared + 3, chunks.size());
+}
+
+TEST_F(ChunkerTest, ContentDefinedShortSegment) {
+  ContentDefinedChunker chunker(65536);
+
+  EXPECT_EQ(100, chunker.next(&_data[0], 100));
+  EXPECT_EQ(16384, chunker.next(&_data[0], 16384));
+}
+
+}  // namespace peeracle
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "peeracle/Chunker/ContentDefinedChunker.h"
+
+namespace peeracle {
+
+static const uint64_t kGearSeed = 0x5052434C;
+
+static uint64_t splitMix64(uint64_t *state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static uint64_t highBitsMask(uint32_t bits) {
+  return ~0ULL << (64 - bits);
+}
+
+ContentDefinedChunker::ContentDefinedChunker(uint32_t averageSize) {
+  uint32_t bits = 0;
+  uint64_t state = kGearSeed;
+
+  if (averageSize < 256) {
+    averageSize = 256;
+  }
+
+  while ((2U << bits) <= averageSize) {
+    ++bits;
+  }
+
+  _avgSize = 1U << bits;
+  _minSize = _avgSize / 4;
+  _maxSize = _avgSize * 4;
+
+  // Normalized chunking: a stricter mask before the average size and a
+  // looser one after it narrows the chunk length distribution. The gear
+  // hash is shifted left, so only its high bits depend on a full window.
+  _maskS = highBitsMask(bits + 2);
+  _maskL = highBitsMask(bits - 2);
+
+  // The table must never change, peers would not find the same boundaries.
+  for (int i = 0; i < 256; ++i) {
+    _gear[i] = splitMix64(&state);
+  }
+}
+
+uint32_t ContentDefinedChunker::getChunkSize() const {
+  return 0;
+}
+
+uint32_t ContentDefinedChunker::getMinimumSize() const {
+  return _minSize;
+}
+
+uint32_t ContentDefinedChunker::getAverageSize() const {
+  return _avgSize;
+}
+
+uint32_t ContentDefinedChunker::getMaximumSize() const {
+  return _maxSize;
+}
+
+size_t ContentDefinedChunker::next(const uint8_t *buffer, size_t length) {
+  size_t i;
+  size_t normal;
+  size_t end;
+  uint64_t hash = 0;
+
+  if (length <= _minSize) {
+    return length;
+  }
+
+  end = length > _maxSize ? _maxSize : length;
+  normal = end > _avgSize ? _avgSize : end;
+
+  // No cut point can be shorter than the minimum size, skip hashing it.
+  for (i = _minSize; i < normal; ++i) {
+    hash = (hash << 1) + _gear[buffer[i]];
+    if (!(hash & _maskS)) {
+      return i + 1;
+    }
+  }
+
+  for (; i < end; ++i) {
+    hash = (hash << 1) + _gear[buffer[i]];
+    if (!(hash & _maskL)) {
+      return i + 1;
+    }
+  }
+
+  return end;
+}
+
+}  // namespace peeracle
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_CHUNKER_CONTENTDEFINEDCHUNKER_H_
+#define PEERACLE_CHUNKER_CONTENTDEFINEDCHUNKER_H_
+
+#include "peeracle/Chunker/ChunkerInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Split media segments where a gear rolling hash of the last bytes matches a
+ * mask (FastCDC), so that identical byte runs produce identical chunks even
+ * when the bytes around them differ.
+ * Chunks are between a quarter and four times the average size, normalized
+ * around the average size.
+ * \addtogroup Chunker
+ */
+class ContentDefinedChunker
+  : public ChunkerInterface {
+ public:
+  explicit ContentDefinedChunker(uint32_t averageSize = 65536);
+
+  uint32_t getChunkSize() const;
+  size_t next(const uint8_t *buffer, size_t length);
+
+  uint32_t getMinimumSize() const;
+  uint32_t getAverageSize() const;
+  uint32_t getMaximumSize() const;
+
+ private:
+  uint32_t _minSize;
+  uint32_t _avgSize;
+  uint32_t _maxSize;
+  uint64_t _maskS;
+  uint64_t _maskL;
+  uint64_t _gear[256];
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_CHUNKER_CONTENTDEFINEDCHUNKER_H_
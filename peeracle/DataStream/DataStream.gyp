@@ -39,11 +39,17 @@
       #   }]
       # ],
       'sources': [
+        'DataStreamCopy.cc',
+        'DataStreamCopy.h',
         'DataStreamInterface.h',
         'FileDataStream.cc',
         'FileDataStream.h',
+        'MappedDataStream.cc',
+        'MappedDataStream.h',
         'MemoryDataStream.cc',
         'MemoryDataStream.h',
+        'ViewDataStream.cc',
+        'ViewDataStream.h',
       ]
     },
   ],
@@ -59,7 +65,11 @@
             '<(DEPTH)/test/test.gyp:peeracle_tests_utils',
           ],
           'sources': [
+            'DataStreamCopy_unittest.cc',
             'DataStream_unittest.cc',
+            'FileDataStream_unittest.cc',
+            'MappedDataStream_unittest.cc',
+            'ViewDataStream_unittest.cc',
           ],
         },
       ],
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "peeracle/DataStream/DataStreamCopy.h"
+
+namespace peeracle {
+
+const std::streamsize DataStreamCopy::kBufferSize;
+
+bool DataStreamCopy::copyRange(DataStreamInterface *in,
+                               std::streamsize offset,
+                               std::streamsize length,
+                               DataStreamInterface *out) {
+  std::vector<char> buffer;
+
+  if (length <= 0) {
+    return length == 0;
+  }
+
+  if (in->seek(offset) != offset) {
+    return false;
+  }
+
+  buffer.resize(static_cast<size_t>(std::min(length, kBufferSize)));
+  while (length > 0) {
+    std::streamsize size = std::min(length, kBufferSize);
+
+    if (in->read(&buffer[0], size) != size ||
+        out->write(&buffer[0], size) != size) {
+      return false;
+    }
+    length -= size;
+  }
+
+  return true;
+}
+
+}  // namespace peeracle
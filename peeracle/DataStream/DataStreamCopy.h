@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_DATASTREAM_DATASTREAMCOPY_H_
+#define PEERACLE_DATASTREAM_DATASTREAMCOPY_H_
+
+#include <ios>
+#include "peeracle/DataStream/DataStreamInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Copy bytes between data streams through a bounded buffer, so that a
+ * range of any size is copied in constant memory.
+ * \addtogroup DataStream
+ */
+class DataStreamCopy {
+ public:
+  /**
+   * The size of the buffer the bytes go through.
+   */
+  static const std::streamsize kBufferSize = 65536;
+
+  /**
+   * Write the \p length bytes at \p offset of \p in to \p out, at the
+   * cursor of \p out.
+   * \return false if \p in could not be read or \p out could not be
+   * written, some of the bytes having possibly been written.
+   */
+  static bool copyRange(DataStreamInterface *in, std::streamsize offset,
+                        std::streamsize length, DataStreamInterface *out);
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_DATASTREAM_DATASTREAMCOPY_H_
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/DataStreamCopy.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+
+namespace peeracle {
+
+TEST(DataStreamCopyTest, CopyRange) {
+  DataStreamInit dsInit;
+  MemoryDataStream in(dsInit);
+  MemoryDataStream out(dsInit);
+  std::vector<char> bytes(3 * DataStreamCopy::kBufferSize);
+
+  // A range over several buffers, starting and ending within one.
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<char>(i * 7);
+  }
+  in.write(&bytes[0], static_cast<std::streamsize>(bytes.size()));
+
+  out.write("abc", 3);
+  ASSERT_TRUE(DataStreamCopy::copyRange(&in, 5,
+                                        2 * DataStreamCopy::kBufferSize + 11,
+                                        &out));
+  ASSERT_EQ(3 + 2 * DataStreamCopy::kBufferSize + 11, out.length());
+  EXPECT_EQ(0, memcmp(out.getBuffer(), "abc", 3));
+  EXPECT_EQ(0, memcmp(out.getBuffer() + 3, &bytes[5],
+                      2 * DataStreamCopy::kBufferSize + 11));
+
+  EXPECT_TRUE(DataStreamCopy::copyRange(&in, 0, 0, &out));
+  EXPECT_FALSE(DataStreamCopy::copyRange(&in, in.length() + 1, 1, &out));
+  EXPECT_FALSE(DataStreamCopy::copyRange(&in, in.length() - 4, 5, &out));
+}
+
+}  // namespace peeracle
@@ -40,18 +40,26 @@ struct DataStreamInit {
     : bigEndian(true),
       path(""),
       buffer(NULL),
-      bufferLength(0) {
+      bufferLength(0),
+      create(false) {
   }
 
   bool bigEndian;
   std::string path;
   uint8_t *buffer;
   std::streamsize bufferLength;
+
+  // Open a file stream for writing as well as reading, and create the file
+  // at path when it does not exist. A file stream is read-only otherwise.
+  bool create;
 };
 
 /**
  * \addtogroup DataStream
  * DataStream module interface.
+ * Reads and peeks are all or nothing: when the value or the bytes asked
+ * for go past the end of the DataStream, or a string is not terminated
+ * before it, nothing is read, the cursor does not move and -1 is returned.
  */
 class DataStreamInterface {
  public:
@@ -72,6 +80,15 @@ class DataStreamInterface {
    */
   virtual std::streamsize length() const = 0;
 
+  /**
+   * Get the stream's content when it is held in memory, so that it can be
+   * parsed in place.
+   * \return The first byte of the stream, or NULL if it is not in memory.
+   */
+  virtual const uint8_t *getBuffer() const {
+    return NULL;
+  }
+
   /**
    * Get the stream's cursor's current position.
    * \return The stream's cursor's current position in bytes.
@@ -79,20 +96,22 @@ class DataStreamInterface {
   virtual std::streamsize tell() const = 0;
 
   /**
-   * Move the cursor to an absolution \p position.
-   * It will set the cursor at the same value as the length of the DataStream
-   * if the \p position value is higher than it's length.
+   * Move the cursor to an absolute \p position, between 0 and the length of
+   * the DataStream. The cursor does not move if \p position is out of these
+   * bounds.
    * @param position the position to move the cursor to.
-   * \return The new cursor's position.
+   * \return The new cursor's position, or -1 if \p position is out of
+   * bounds.
    */
   virtual std::streamsize seek(std::streamsize position) = 0;
 
   /**
-   * Read up to \p length bytes of data at the cursor and store these into
-   * the \p buffer. The cursor will be increased to \p length bytes.
+   * Read \p length bytes of data at the cursor and store these into the
+   * \p buffer. The cursor will be increased to \p length bytes.
    * @param buffer a pointer to the buffer which will receive the data.
    * @param length the number of bytes to read.
-   * \return The number of bytes read.
+   * \return The number of bytes read, or -1 if fewer than \p length bytes
+   * are left.
    */
   virtual std::streamsize read(char *buffer,
                                std::streamsize length) = 0;
@@ -170,11 +189,12 @@ class DataStreamInterface {
   virtual std::streamsize read(std::string *buffer) = 0;
 
   /**
-   * Read up to \p length bytes of data at the cursor and store these into
-   * the \p buffer. The cursor won't move.
+   * Read \p length bytes of data at the cursor and store these into the
+   * \p buffer. The cursor won't move.
    * @param buffer a pointer to the buffer which will receive the data.
    * @param length the number of bytes to read.
-   * \return The number of bytes read.
+   * \return The number of bytes read, or -1 if fewer than \p length bytes
+   * are left.
    */
   virtual std::streamsize peek(uint8_t *buffer,
                                std::streamsize length) = 0;
@@ -21,25 +21,56 @@
  */
 
 #include <string.h>
+#include <string>
 #include "peeracle/DataStream/FileDataStream.h"
 
 namespace peeracle {
 
+template<typename T>
+static void swapBytes(T *value) {
+  uint8_t *data = reinterpret_cast<uint8_t *>(value);
+
+  for (size_t i = 0; i < sizeof(T) / 2; ++i) {
+    uint8_t tmp = data[i];
+
+    data[i] = data[sizeof(T) - i - 1];
+    data[sizeof(T) - i - 1] = tmp;
+  }
+}
+
 FileDataStream::FileDataStream(const DataStreamInit &dsInit)
-  : filename_(dsInit.path), readOnly_(true) { }
+  : filename_(dsInit.path), fileSize_(0), cursor_(0),
+    bigEndian_(dsInit.bigEndian), readOnly_(!dsInit.create),
+    writing_(false) {
+}
+
+FileDataStream::~FileDataStream() {
+  this->close();
+}
 
 bool FileDataStream::open() {
-  this->file_.open(this->filename_.c_str(), std::ifstream::binary);
+  std::ios::openmode mode = std::ios::in | std::ios::binary;
+
+  if (!this->readOnly_) {
+    mode |= std::ios::out;
+  }
+
+  this->close();
+  this->file_.open(this->filename_.c_str(), mode);
+  if (!this->file_.is_open() && !this->readOnly_) {
+    this->file_.clear();
+    this->file_.open(this->filename_.c_str(), mode | std::ios::trunc);
+  }
 
   if (!this->file_.is_open()) {
     return false;
   }
 
-  std::streamsize tmp = this->file_.tellg();
   this->file_.seekg(0, std::ios::end);
-  this->fileSize_ = static_cast<std::streamsize>
-    (this->file_.tellg()) - tmp;
+  this->fileSize_ = static_cast<std::streamsize>(this->file_.tellg());
   this->file_.seekg(0, std::ios::beg);
+  this->cursor_ = 0;
+  this->writing_ = false;
   return true;
 }
 
@@ -49,20 +80,23 @@ void FileDataStream::close() {
   }
 
   this->file_.close();
+  this->fileSize_ = 0;
+  this->cursor_ = 0;
 }
 
 std::streamsize FileDataStream::seek(std::streamsize offset) {
-  if (!this->file_.is_open()) {
-    return 0;
+  if (!this->file_.is_open() || offset < 0 || offset > this->fileSize_) {
+    return -1;
   }
 
-  if (offset > this->fileSize_) {
-    this->file_.seekg(this->fileSize_);
-    return this->file_.tellg();
+  this->file_.clear();
+  if (this->writing_) {
+    this->file_.seekp(offset);
+  } else {
+    this->file_.seekg(offset);
   }
-
-  this->file_.seekg(offset);
-  return this->file_.tellg();
+  this->cursor_ = offset;
+  return this->cursor_;
 }
 
 std::streamsize FileDataStream::length() const {
@@ -70,25 +104,57 @@ std::streamsize FileDataStream::length() const {
 }
 
 std::streamsize FileDataStream::tell() const {
-  //  std::streamsize cursor = this->file_.tellg();
-  return 0;
+  return this->cursor_;
 }
 
-std::streamsize FileDataStream::read(char *buffer,
-                                     std::streamsize length) {
-  if (!this->file_.is_open() || length < 1) {
+bool FileDataStream::_prepare(bool write) {
+  if (!this->file_.is_open() || (write && this->readOnly_)) {
+    return false;
+  }
+
+  // A file stream must be repositioned when switching between reading and
+  // writing.
+  if (write != this->writing_) {
+    this->file_.clear();
+    if (write) {
+      this->file_.seekp(this->cursor_);
+    } else {
+      this->file_.seekg(this->cursor_);
+    }
+    this->writing_ = write;
+  }
+  return true;
+}
+
+std::streamsize FileDataStream::_get(char *buffer, std::streamsize length,
+                                     bool advance) {
+  if (length < 0 || this->cursor_ + length > this->fileSize_ ||
+      !this->_prepare(false)) {
+    return -1;
+  }
+
+  if (!length) {
     return 0;
   }
 
-  std::streamsize cursor = this->file_.tellg();
-  if (cursor + length > this->fileSize_) {
-    length = this->fileSize_ - cursor;
+  this->file_.read(buffer, length);
+  if (this->file_.gcount() != length) {
+    this->file_.clear();
+    this->file_.seekg(this->cursor_);
+    return -1;
   }
 
-  this->file_.read(reinterpret_cast<char*>(buffer), length);
-  std::streamsize s = this->file_.gcount();
-  this->file_.seekg(cursor + s);
-  return s;
+  if (advance) {
+    this->cursor_ += length;
+  } else {
+    this->file_.seekg(this->cursor_);
+  }
+  return length;
+}
+
+std::streamsize FileDataStream::read(char *buffer,
+                                     std::streamsize length) {
+  return this->_get(buffer, length, true);
 }
 
 std::streamsize FileDataStream::read(int8_t *buffer) {
@@ -124,37 +190,44 @@ std::streamsize FileDataStream::read(double *buffer) {
 }
 
 std::streamsize FileDataStream::read(std::string *buffer) {
-  return 0;
-}
+  std::string value;
 
-template<typename T>
-std::streamsize FileDataStream::_read(T *buffer) {
-  if (!this->file_.is_open()) {
-    return 0;
+  if (this->cursor_ >= this->fileSize_ || !this->_prepare(false)) {
+    return -1;
   }
 
-  std::streamsize length = static_cast<std::streamsize>(sizeof(T));
-  std::streamsize cursor = this->file_.tellg();
-  if (cursor + length > this->fileSize_) {
-    length =  this->fileSize_ - cursor;
+  std::getline(this->file_, value, '\0');
+  if (this->file_.eof()) {
+    // The string is not terminated before the end of the file.
+    this->file_.clear();
+    this->file_.seekg(this->cursor_);
+    return -1;
   }
-  this->file_.read(reinterpret_cast<char*>(buffer), length);
-  this->file_.seekg(cursor+length);
-  return length;
+
+  this->cursor_ += static_cast<std::streamsize>(value.size()) + 1;
+  *buffer = value;
+  return static_cast<std::streamsize>(value.size());
 }
 
-std::streamsize FileDataStream::peek(uint8_t *buffer, std::streamsize length) {
-    if (!this->file_.is_open() || length < 1) {
-    return 0;
+template<typename T>
+std::streamsize FileDataStream::_read(T *buffer) {
+  T value;
+  std::streamsize result = this->_get(reinterpret_cast<char *>(&value),
+                                      sizeof(T), true);
+
+  if (result < 0) {
+    return result;
   }
 
-  std::streamsize cursor = this->file_.tellg();
-  if (cursor + length > this->fileSize_) {
-    length = this->fileSize_ - cursor;
+  if (this->bigEndian_) {
+    swapBytes(&value);
   }
+  *buffer = value;
+  return result;
+}
 
-  this->file_.read(reinterpret_cast<char*>(buffer), length);
-  return length;
+std::streamsize FileDataStream::peek(uint8_t *buffer, std::streamsize length) {
+  return this->_get(reinterpret_cast<char *>(buffer), length, false);
 }
 
 std::streamsize FileDataStream::peek(int8_t *buffer) {
@@ -190,33 +263,48 @@ std::streamsize FileDataStream::peek(double *buffer) {
 }
 
 std::streamsize FileDataStream::peek(std::string *buffer) {
-  return 0;
+  std::streamsize cursor = this->cursor_;
+  std::streamsize result = this->read(buffer);
+
+  if (result >= 0) {
+    this->cursor_ = cursor;
+    this->file_.seekg(cursor);
+  }
+  return result;
 }
 
 template<typename T>
 std::streamsize FileDataStream::_peek(T *buffer) {
-  if (!this->file_.is_open()) {
-    return 0;
+  T value;
+  std::streamsize result = this->_get(reinterpret_cast<char *>(&value),
+                                      sizeof(T), false);
+
+  if (result < 0) {
+    return result;
   }
 
-  std::streamsize length = static_cast<std::streamsize>(sizeof(T));
-  std::streamsize cursor = this->file_.tellg();
-  if (cursor + length > this->fileSize_) {
-    length =  this->fileSize_ - cursor;
+  if (this->bigEndian_) {
+    swapBytes(&value);
   }
-  this->file_.read(reinterpret_cast<char*>(buffer), length);
-  return length;
+  *buffer = value;
+  return result;
 }
 
 std::streamsize FileDataStream::write(const char *buffer,
                                       std::streamsize length) {
-  if  (!this->file_.is_open()) {
-  return 0;
+  if (length < 0 || !this->_prepare(true)) {
+    return -1;
   }
 
-  std::streamsize cursor = this->file_.tellg();
-  this->file_.seekp(cursor);
   this->file_.write(buffer, length);
+  if (!this->file_.good()) {
+    return -1;
+  }
+
+  this->cursor_ += length;
+  if (this->cursor_ > this->fileSize_) {
+    this->fileSize_ = this->cursor_;
+  }
   return length;
 }
 
@@ -237,7 +325,7 @@ std::streamsize FileDataStream::write(uint16_t value) {
 }
 
 std::streamsize FileDataStream::write(int32_t value) {
-  return  this->_write(value);
+  return this->_write(value);
 }
 
 std::streamsize FileDataStream::write(uint32_t value) {
@@ -258,14 +346,10 @@ std::streamsize FileDataStream::write(const std::string &value) {
 
 template<typename T>
 std::streamsize FileDataStream::_write(T buffer) {
-  if (!this->file_.is_open()) {
-    return 0;
+  if (this->bigEndian_) {
+    swapBytes(&buffer);
   }
-
-  std::streamsize cursor = this->file_.tellg();
-  this->file_.seekp(cursor);
-  this->file_.write(reinterpret_cast<const char*>(&buffer), sizeof(T));
-  return sizeof(T);
+  return this->write(reinterpret_cast<const char *>(&buffer), sizeof(T));
 }
 
 }  // namespace peeracle
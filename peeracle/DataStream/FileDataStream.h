@@ -42,8 +42,13 @@ namespace peeracle {
 class FileDataStream : public DataStreamInterface {
  public:
   explicit FileDataStream(const DataStreamInit &dsInit);
-  virtual ~FileDataStream() {}
+  virtual ~FileDataStream();
 
+  /**
+   * Open the file for reading only, unless DataStreamInit::create is set:
+   * the file is then opened for writing as well, and created when it is
+   * missing. A missing file makes open() fail otherwise.
+   */
   bool open();
   void close();
   std::streamsize length() const;
@@ -87,9 +92,15 @@ class FileDataStream : public DataStreamInterface {
   const std::string filename_;
   std::fstream file_;
   std::streamsize fileSize_;
+  std::streamsize cursor_;
+  bool bigEndian_;
   bool readOnly_;
+  bool writing_;
 
  private:
+  bool _prepare(bool write);
+  std::streamsize _get(char *buffer, std::streamsize length, bool advance);
+
   template<typename T>
   std::streamsize _read(T *buffer);
 
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/FileDataStream.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+
+namespace peeracle {
+
+class FileDataStreamTest : public testing::Test {
+ protected:
+  FileDataStreamTest() : _path("FileDataStream_unittest.tmp") {
+  }
+
+  virtual void SetUp() {
+    remove(_path.c_str());
+    _dsInit.path = _path;
+    _dsInit.create = true;
+  }
+
+  virtual void TearDown() {
+    remove(_path.c_str());
+  }
+
+  std::string _path;
+  DataStreamInit _dsInit;
+};
+
+TEST_F(FileDataStreamTest, MissingFile) {
+  DataStreamInit dsInit;
+  FILE *file;
+
+  dsInit.path = _path;
+  FileDataStream ds(dsInit);
+  EXPECT_FALSE(ds.open());
+
+  file = fopen(_path.c_str(), "rb");
+  EXPECT_TRUE(file == NULL);
+  if (file) {
+    fclose(file);
+  }
+}
+
+TEST_F(FileDataStreamTest, WriteAndRead) {
+  uint32_t u32;
+  int16_t i16;
+  double d;
+  std::string str;
+  char bytes[3];
+
+  {
+    FileDataStream ds(_dsInit);
+
+    ASSERT_TRUE(ds.open());
+    EXPECT_EQ(0, ds.length());
+    EXPECT_EQ(4, ds.write(static_cast<uint32_t>(0x5052434C)));
+    EXPECT_EQ(2, ds.write(static_cast<int16_t>(-2)));
+    EXPECT_EQ(9, ds.write(std::string("peeracle")));
+    EXPECT_EQ(8, ds.write(3.5));
+    EXPECT_EQ(3, ds.write("abc", 3));
+    EXPECT_EQ(26, ds.tell());
+    EXPECT_EQ(26, ds.length());
+  }
+
+  FileDataStream ds(_dsInit);
+  ASSERT_TRUE(ds.open());
+  ASSERT_EQ(26, ds.length());
+
+  EXPECT_EQ(4, ds.peek(&u32));
+  EXPECT_EQ(0, ds.tell());
+  EXPECT_EQ(4, ds.read(&u32));
+  EXPECT_EQ(0x5052434C, u32);
+  EXPECT_EQ(2, ds.read(&i16));
+  EXPECT_EQ(-2, i16);
+  EXPECT_EQ(8, ds.peek(&str));
+  EXPECT_EQ(6, ds.tell());
+  EXPECT_EQ(8, ds.read(&str));
+  EXPECT_EQ("peeracle", str);
+  EXPECT_EQ(15, ds.tell());
+  EXPECT_EQ(8, ds.read(&d));
+  EXPECT_EQ(3.5, d);
+  EXPECT_EQ(3, ds.read(bytes, 3));
+  EXPECT_EQ(0, memcmp("abc", bytes, 3));
+
+  EXPECT_EQ(-1, ds.read(&u32));
+  EXPECT_EQ(ds.length(), ds.tell());
+}
+
+TEST_F(FileDataStreamTest, ReadOnly) {
+  DataStreamInit dsInit;
+  uint16_t u16;
+
+  {
+    FileDataStream ds(_dsInit);
+
+    ASSERT_TRUE(ds.open());
+    ds.write(static_cast<uint16_t>(0x1234));
+  }
+
+  // Without DataStreamInit::create, the file is only opened for reading.
+  dsInit.path = _path;
+  FileDataStream ds(dsInit);
+  ASSERT_TRUE(ds.open());
+  EXPECT_EQ(-1, ds.write(static_cast<uint16_t>(0xABCD)));
+  EXPECT_EQ(0, ds.tell());
+  EXPECT_EQ(2, ds.read(&u16));
+  EXPECT_EQ(0x1234, u16);
+}
+
+TEST_F(FileDataStreamTest, SameBytesAsMemory) {
+  MemoryDataStream memory(_dsInit);
+  FileDataStream file(_dsInit);
+  std::vector<char> bytes;
+
+  ASSERT_TRUE(file.open());
+  memory.write(static_cast<uint16_t>(0x1234));
+  memory.write(-1.25f);
+  memory.write(std::string("webm"));
+  file.write(static_cast<uint16_t>(0x1234));
+  file.write(-1.25f);
+  file.write(std::string("webm"));
+
+  ASSERT_EQ(memory.length(), file.length());
+  bytes.resize(static_cast<size_t>(file.length()));
+  ASSERT_EQ(0, file.seek(0));
+  ASSERT_EQ(file.length(), file.read(&bytes[0], file.length()));
+  EXPECT_EQ(0, memcmp(memory.getBuffer(), &bytes[0], bytes.size()));
+}
+
+TEST_F(FileDataStreamTest, Bounds) {
+  FileDataStream ds(_dsInit);
+  uint32_t value = 7;
+  uint16_t u16;
+  std::string str;
+
+  ASSERT_TRUE(ds.open());
+  ds.write(static_cast<uint16_t>(1));
+  ds.write("abc", 3);
+
+  EXPECT_EQ(-1, ds.seek(-1));
+  EXPECT_EQ(-1, ds.seek(6));
+  EXPECT_EQ(5, ds.tell());
+  EXPECT_EQ(5, ds.seek(5));
+  EXPECT_EQ(0, ds.seek(0));
+
+  ds.seek(2);
+  EXPECT_EQ(-1, ds.read(&value));
+  EXPECT_EQ(7, value);
+  EXPECT_EQ(2, ds.tell());
+
+  // The string is not terminated before the end of the file.
+  EXPECT_EQ(-1, ds.read(&str));
+  EXPECT_EQ(2, ds.tell());
+
+  // Overwrite in place, then keep reading.
+  ds.seek(0);
+  EXPECT_EQ(2, ds.write(static_cast<uint16_t>(0xABCD)));
+  EXPECT_EQ(5, ds.length());
+  ds.seek(0);
+  EXPECT_EQ(2, ds.read(&u16));
+  EXPECT_EQ(0xABCD, u16);
+}
+
+}  // namespace peeracle
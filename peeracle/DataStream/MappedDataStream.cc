@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include <cstring>
+#include <string>
+#include "peeracle/DataStream/MappedDataStream.h"
+
+namespace peeracle {
+
+MappedDataStream::MappedDataStream(const DataStreamInit &dsInit) :
+  _bigEndian(dsInit.bigEndian), _path(dsInit.path), _buffer(NULL),
+  _length(0), _cursor(0) {
+#if defined(_WIN32)
+  _file = INVALID_HANDLE_VALUE;
+  _mapping = NULL;
+#endif
+}
+
+MappedDataStream::~MappedDataStream() {
+  this->close();
+}
+
+bool MappedDataStream::open() {
+  this->close();
+
+#if defined(_WIN32)
+  LARGE_INTEGER size;
+
+  _file = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(_file, &size)) {
+    this->close();
+    return false;
+  }
+
+  _length = static_cast<std::streamsize>(size.QuadPart);
+  if (!_length) {
+    return true;
+  }
+
+  _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!_mapping) {
+    this->close();
+    return false;
+  }
+
+  _buffer = static_cast<const uint8_t *>(
+    MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!_buffer) {
+    this->close();
+    return false;
+  }
+#else
+  struct stat st;
+  int fd = ::open(_path.c_str(), O_RDONLY);
+
+  if (fd == -1) {
+    return false;
+  }
+
+  if (fstat(fd, &st) == -1) {
+    ::close(fd);
+    return false;
+  }
+
+  _length = static_cast<std::streamsize>(st.st_size);
+  if (_length) {
+    void *address = mmap(NULL, static_cast<size_t>(_length), PROT_READ,
+                         MAP_SHARED, fd, 0);
+
+    if (address == MAP_FAILED) {
+      ::close(fd);
+      _length = 0;
+      return false;
+    }
+    _buffer = static_cast<const uint8_t *>(address);
+  }
+
+  ::close(fd);
+#endif
+  return true;
+}
+
+void MappedDataStream::close() {
+#if defined(_WIN32)
+  if (_buffer) {
+    UnmapViewOfFile(_buffer);
+  }
+  if (_mapping) {
+    CloseHandle(_mapping);
+  }
+  if (_file != INVALID_HANDLE_VALUE) {
+    CloseHandle(_file);
+  }
+  _file = INVALID_HANDLE_VALUE;
+  _mapping = NULL;
+#else
+  if (_buffer) {
+    munmap(const_cast<uint8_t *>(_buffer), static_cast<size_t>(_length));
+  }
+#endif
+  _buffer = NULL;
+  _length = 0;
+  _cursor = 0;
+}
+
+std::streamsize MappedDataStream::length() const {
+  return _length;
+}
+
+std::streamsize MappedDataStream::seek(std::streamsize position) {
+  if (position < 0 || position > _length) {
+    return -1;
+  }
+  _cursor = position;
+  return _cursor;
+}
+
+std::streamsize MappedDataStream::tell() const {
+  return _cursor;
+}
+
+const uint8_t *MappedDataStream::getBuffer() const {
+  return _buffer;
+}
+
+std::streamsize MappedDataStream::read(char *buffer,
+                                       std::streamsize length) {
+  std::streamsize result = this->peek(reinterpret_cast<uint8_t *>(buffer),
+                                      length);
+
+  if (result > 0) {
+    _cursor += result;
+  }
+  return result;
+}
+
+std::streamsize MappedDataStream::read(int8_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize MappedDataStream::read(uint8_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize MappedDataStream::read(int16_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize MappedDataStream::read(uint16_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize MappedDataStream::read(int32_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize MappedDataStream::read(uint32_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize MappedDataStream::read(float *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize MappedDataStream::read(double *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize MappedDataStream::read(std::string *buffer) {
+  std::streamsize result = this->peek(buffer);
+
+  if (result >= 0) {
+    _cursor += result + 1;
+  }
+  return result;
+}
+
+template <typename T>
+std::streamsize MappedDataStream::_read(T *buffer) {
+  std::streamsize result = this->_peek(buffer);
+
+  if (result > 0) {
+    _cursor += result;
+  }
+  return result;
+}
+
+std::streamsize MappedDataStream::peek(uint8_t *buffer,
+                                       std::streamsize length) {
+  if (length < 0 || _cursor + length > _length) {
+    return -1;
+  }
+
+  if (length > 0) {
+    memcpy(buffer, _buffer + _cursor, static_cast<size_t>(length));
+  }
+  return length;
+}
+
+std::streamsize MappedDataStream::peek(int8_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize MappedDataStream::peek(uint8_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize MappedDataStream::peek(int16_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize MappedDataStream::peek(uint16_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize MappedDataStream::peek(int32_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize MappedDataStream::peek(uint32_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize MappedDataStream::peek(float *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize MappedDataStream::peek(double *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize MappedDataStream::peek(std::string *buffer) {
+  const void *end;
+
+  if (_cursor >= _length) {
+    return -1;
+  }
+
+  end = memchr(_buffer + _cursor, '\0', static_cast<size_t>(_length - _cursor));
+  if (!end) {
+    return -1;
+  }
+
+  buffer->assign(reinterpret_cast<const char *>(_buffer + _cursor),
+                 static_cast<const uint8_t *>(end) - (_buffer + _cursor));
+  return static_cast<std::streamsize>(buffer->size());
+}
+
+template <typename T>
+std::streamsize MappedDataStream::_peek(T *buffer) {
+  uint8_t *data = reinterpret_cast<uint8_t *>(buffer);
+  std::streamsize size = static_cast<std::streamsize>(sizeof(T));
+
+  if (_cursor + size > _length) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    data[i] = _buffer[_cursor + (_bigEndian ? sizeof(T) - i - 1 : i)];
+  }
+  return size;
+}
+
+std::streamsize MappedDataStream::write(const char *buffer,
+                                        std::streamsize length) {
+  return -1;
+}
+
+std::streamsize MappedDataStream::write(int8_t value) {
+  return -1;
+}
+
+std::streamsize MappedDataStream::write(uint8_t value) {
+  return -1;
+}
+
+std::streamsize MappedDataStream::write(int16_t value) {
+  return -1;
+}
+
+std::streamsize MappedDataStream::write(uint16_t value) {
+  return -1;
+}
+
+std::streamsize MappedDataStream::write(int32_t value) {
+  return -1;
+}
+
+std::streamsize MappedDataStream::write(uint32_t value) {
+  return -1;
+}
+
+std::streamsize MappedDataStream::write(float value) {
+  return -1;
+}
+
+std::streamsize MappedDataStream::write(double value) {
+  return -1;
+}
+
+std::streamsize MappedDataStream::write(const std::string &value) {
+  return -1;
+}
+
+}  // namespace peeracle
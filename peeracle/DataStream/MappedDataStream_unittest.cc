@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/MappedDataStream.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+
+namespace peeracle {
+
+class MappedDataStreamTest : public testing::Test {
+ protected:
+  MappedDataStreamTest() : _path("MappedDataStream_unittest.tmp") {
+  }
+
+  void writeFile(const std::vector<uint8_t> &data) {
+    std::ofstream file(_path.c_str(), std::ios::binary | std::ios::trunc);
+
+    if (!data.empty()) {
+      file.write(reinterpret_cast<const char *>(&data[0]), data.size());
+    }
+  }
+
+  virtual void TearDown() {
+    remove(_path.c_str());
+  }
+
+  std::string _path;
+};
+
+TEST_F(MappedDataStreamTest, Read) {
+  DataStreamInit dsInit;
+  MemoryDataStream source(dsInit);
+  std::vector<uint8_t> data;
+  uint32_t u32;
+  int16_t i16;
+  double d;
+  std::string str;
+  char bytes[3];
+
+  source.write(static_cast<uint32_t>(0x5052434C));
+  source.write(static_cast<int16_t>(-2));
+  source.write(std::string("peeracle"));
+  source.write(3.5);
+  source.write("abc", 3);
+  data.resize(static_cast<size_t>(source.length()));
+  source.seek(0);
+  source.read(reinterpret_cast<char *>(&data[0]), source.length());
+  writeFile(data);
+
+  dsInit.path = _path;
+  MappedDataStream ds(dsInit);
+  ASSERT_TRUE(ds.open());
+  ASSERT_EQ(source.length(), ds.length());
+  EXPECT_EQ(0, memcmp(&data[0], ds.getBuffer(), data.size()));
+
+  EXPECT_EQ(4, ds.peek(&u32));
+  EXPECT_EQ(0, ds.tell());
+  EXPECT_EQ(4, ds.read(&u32));
+  EXPECT_EQ(0x5052434C, u32);
+  EXPECT_EQ(2, ds.read(&i16));
+  EXPECT_EQ(-2, i16);
+  EXPECT_EQ(8, ds.read(&str));
+  EXPECT_EQ("peeracle", str);
+  EXPECT_EQ(8, ds.read(&d));
+  EXPECT_EQ(3.5, d);
+  EXPECT_EQ(3, ds.read(bytes, 3));
+  EXPECT_EQ(0, memcmp("abc", bytes, 3));
+  EXPECT_EQ(ds.length(), ds.tell());
+
+  EXPECT_EQ(-1, ds.read(&u32));
+  EXPECT_EQ(-1, ds.seek(ds.length() + 1));
+  EXPECT_EQ(-1, ds.write(u32));
+  EXPECT_EQ(4, ds.seek(4));
+  EXPECT_EQ(-1, ds.read(bytes, ds.length()));
+
+  ds.close();
+  EXPECT_EQ(0, ds.length());
+  EXPECT_TRUE(ds.getBuffer() == NULL);
+}
+
+TEST_F(MappedDataStreamTest, EmptyAndMissingFile) {
+  DataStreamInit dsInit;
+  uint8_t value;
+
+  writeFile(std::vector<uint8_t>());
+  dsInit.path = _path;
+  MappedDataStream empty(dsInit);
+  ASSERT_TRUE(empty.open());
+  EXPECT_EQ(0, empty.length());
+  EXPECT_EQ(-1, empty.read(&value));
+
+  dsInit.path = _path + ".missing";
+  MappedDataStream missing(dsInit);
+  EXPECT_FALSE(missing.open());
+}
+
+}  // namespace peeracle
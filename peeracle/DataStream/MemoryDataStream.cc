@@ -21,13 +21,12 @@
  */
 
 #include <cstring>
-#include <sstream>
 #include "peeracle/DataStream/MemoryDataStream.h"
 
 namespace peeracle {
 
 MemoryDataStream::MemoryDataStream(const DataStreamInit &dsInit) :
-  _bigEndian(dsInit.bigEndian) {
+  _bigEndian(dsInit.bigEndian), _cursor(0) {
 }
 
 MemoryDataStream::~MemoryDataStream() {
@@ -45,10 +44,17 @@ std::streamsize MemoryDataStream::length() const {
   return this->_buffer.size();
 }
 
+void MemoryDataStream::reserve(std::streamsize length) {
+  this->_buffer.reserve(static_cast<size_t>(length));
+}
+
+const uint8_t *MemoryDataStream::getBuffer() const {
+  return this->_buffer.empty() ? NULL : &this->_buffer[0];
+}
+
 std::streamsize MemoryDataStream::seek(std::streamsize position) {
   if (position < 0 ||
-      static_cast<std::streamsize>(this->_cursor) +
-      position > this->_buffer.size()) {
+      position > static_cast<std::streamsize>(this->_buffer.size())) {
     return -1;
   }
   this->_cursor = position;
@@ -61,12 +67,12 @@ std::streamsize MemoryDataStream::tell() const {
 
 std::streamsize MemoryDataStream::read(char *buffer,
                                        std::streamsize length) {
-  std::streamsize result = 0;
+  std::streamsize result = this->peek(reinterpret_cast<uint8_t *>(buffer),
+                                      length);
 
-  for (int i = 0; i < length; i++) {
-    result += this->_read(buffer++);
+  if (result > 0) {
+    this->_cursor += result;
   }
-
   return result;
 }
 
@@ -107,12 +113,12 @@ std::streamsize MemoryDataStream::read(std::string *buffer) {
   std::string result;
 
   i = this->peek(&result);
-  if (i < 1) {
+  if (i < 0) {
     return i;
   }
 
   *buffer = result;
-  this->_cursor += i;
+  this->_cursor += i + 1;
   return i;
 }
 
@@ -128,12 +134,18 @@ std::streamsize MemoryDataStream::_read(T *buffer) {
 
 std::streamsize MemoryDataStream::peek(uint8_t *buffer,
                                        std::streamsize length) {
-  std::streamsize result = 0;
+  std::streamsize cursor = static_cast<std::streamsize>(this->_cursor);
 
-  for (int i = 0; i < length; i++) {
-    result += this->_peek(buffer++);
+  if (length < 0 ||
+      cursor + length > static_cast<std::streamsize>(this->_buffer.size())) {
+    return -1;
   }
-  return result;
+
+  if (length > 0) {
+    memcpy(buffer, &this->_buffer[static_cast<size_t>(cursor)],
+           static_cast<size_t>(length));
+  }
+  return length;
 }
 
 std::streamsize MemoryDataStream::peek(int8_t *buffer) {
@@ -169,24 +181,23 @@ std::streamsize MemoryDataStream::peek(double *buffer) {
 }
 
 std::streamsize MemoryDataStream::peek(std::string *value) {
-  int8_t c;
-  std::streamsize i;
-  int size;
-  std::stringstream strm;
-
-  for (i = 0; i < 32768; ++i) {
-    if (this->_peek(&c) < 1 || c == '\0') {
-      break;
-    } else {
-      this->_cursor += 1;
-    }
-    size = i;
-    strm << c;
+  size_t cursor = static_cast<size_t>(this->_cursor);
+  size_t remaining;
+  const void *end;
+
+  if (cursor >= this->_buffer.size()) {
+    return -1;
   }
 
-  *value = strm.str();
-  this->_cursor -= size;
-  return i;
+  remaining = this->_buffer.size() - cursor;
+  end = memchr(&this->_buffer[cursor], '\0', remaining);
+  if (!end) {
+    return -1;
+  }
+
+  value->assign(reinterpret_cast<const char *>(&this->_buffer[cursor]),
+                static_cast<const uint8_t *>(end) - &this->_buffer[cursor]);
+  return static_cast<std::streamsize>(value->size());
 }
 
 template <typename T>
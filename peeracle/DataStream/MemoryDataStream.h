@@ -83,6 +83,17 @@ class MemoryDataStream : public DataStreamInterface {
   std::streamsize write(double value);
   std::streamsize write(const std::string &value);
 
+  /**
+   * Allocate room for \p length bytes, so that writing up to that many bytes
+   * does not reallocate the buffer.
+   */
+  void reserve(std::streamsize length);
+
+  /**
+   * Get the written bytes, valid until the next write.
+   */
+  const uint8_t *getBuffer() const;
+
  private:
   template<typename T>
   std::streamsize _read(T *buffer);
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include "peeracle/DataStream/ViewDataStream.h"
+
+namespace peeracle {
+
+static const std::streamsize kStringBlockSize = 64;
+
+ViewDataStream::ViewDataStream(const DataStreamInit &dsInit,
+                               DataStreamInterface *source,
+                               std::streamsize offset,
+                               std::streamsize length) :
+  _bigEndian(dsInit.bigEndian), _source(source), _buffer(NULL),
+  _offset(offset), _length(length), _cursor(0) {
+}
+
+ViewDataStream::ViewDataStream(const DataStreamInit &dsInit,
+                               const uint8_t *buffer,
+                               std::streamsize length) :
+  _bigEndian(dsInit.bigEndian), _source(NULL), _buffer(buffer), _offset(0),
+  _length(length), _cursor(0) {
+}
+
+ViewDataStream::~ViewDataStream() {
+}
+
+bool ViewDataStream::open() {
+  return _buffer || (_source && _offset >= 0 && _length >= 0 &&
+                     _offset + _length <= _source->length());
+}
+
+void ViewDataStream::close() {
+}
+
+std::streamsize ViewDataStream::length() const {
+  return _length;
+}
+
+std::streamsize ViewDataStream::seek(std::streamsize position) {
+  if (position < 0 || position > _length) {
+    return -1;
+  }
+  _cursor = position;
+  return _cursor;
+}
+
+std::streamsize ViewDataStream::tell() const {
+  return _cursor;
+}
+
+const uint8_t *ViewDataStream::getBuffer() const {
+  return _buffer;
+}
+
+std::streamsize ViewDataStream::read(char *buffer, std::streamsize length) {
+  std::streamsize result = this->peek(reinterpret_cast<uint8_t *>(buffer),
+                                      length);
+
+  if (result > 0) {
+    _cursor += result;
+  }
+  return result;
+}
+
+std::streamsize ViewDataStream::read(int8_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize ViewDataStream::read(uint8_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize ViewDataStream::read(int16_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize ViewDataStream::read(uint16_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize ViewDataStream::read(int32_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize ViewDataStream::read(uint32_t *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize ViewDataStream::read(float *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize ViewDataStream::read(double *buffer) {
+  return this->_read(buffer);
+}
+
+std::streamsize ViewDataStream::read(std::string *buffer) {
+  std::streamsize result = this->peek(buffer);
+
+  if (result >= 0) {
+    _cursor += result + 1;
+  }
+  return result;
+}
+
+template <typename T>
+std::streamsize ViewDataStream::_read(T *buffer) {
+  std::streamsize result = this->_peek(buffer);
+
+  if (result > 0) {
+    _cursor += result;
+  }
+  return result;
+}
+
+std::streamsize ViewDataStream::peek(uint8_t *buffer,
+                                     std::streamsize length) {
+  if (length < 0 || _cursor + length > _length) {
+    return -1;
+  }
+
+  if (!length) {
+    return 0;
+  }
+
+  if (_buffer) {
+    memcpy(buffer, _buffer + _cursor, static_cast<size_t>(length));
+    return length;
+  }
+
+  if (_source->seek(_offset + _cursor) != _offset + _cursor ||
+      _source->read(reinterpret_cast<char *>(buffer), length) != length) {
+    return -1;
+  }
+  return length;
+}
+
+std::streamsize ViewDataStream::peek(int8_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize ViewDataStream::peek(uint8_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize ViewDataStream::peek(int16_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize ViewDataStream::peek(uint16_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize ViewDataStream::peek(int32_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize ViewDataStream::peek(uint32_t *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize ViewDataStream::peek(float *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize ViewDataStream::peek(double *buffer) {
+  return this->_peek(buffer);
+}
+
+std::streamsize ViewDataStream::peek(std::string *buffer) {
+  std::streamsize cursor = _cursor;
+  std::string value;
+
+  // Look for the terminating NUL a block at a time, so that a view over a
+  // data stream does not read it byte per byte.
+  while (cursor < _length) {
+    uint8_t block[kStringBlockSize];
+    std::streamsize size = _length - cursor < kStringBlockSize ?
+      _length - cursor : kStringBlockSize;
+    std::streamsize saved = _cursor;
+    const void *end;
+
+    _cursor = cursor;
+    if (this->peek(block, size) != size) {
+      _cursor = saved;
+      return -1;
+    }
+    _cursor = saved;
+
+    end = memchr(block, '\0', static_cast<size_t>(size));
+    if (end) {
+      value.append(reinterpret_cast<const char *>(block),
+                   static_cast<const uint8_t *>(end) - block);
+      *buffer = value;
+      return static_cast<std::streamsize>(value.size());
+    }
+
+    value.append(reinterpret_cast<const char *>(block),
+                 static_cast<size_t>(size));
+    cursor += size;
+  }
+
+  return -1;
+}
+
+template <typename T>
+std::streamsize ViewDataStream::_peek(T *buffer) {
+  uint8_t bytes[sizeof(T)];
+  uint8_t *data = reinterpret_cast<uint8_t *>(buffer);
+  std::streamsize size = static_cast<std::streamsize>(sizeof(T));
+
+  if (this->peek(bytes, size) != size) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    data[i] = bytes[_bigEndian ? sizeof(T) - i - 1 : i];
+  }
+  return size;
+}
+
+std::streamsize ViewDataStream::write(const char *buffer,
+                                      std::streamsize length) {
+  return -1;
+}
+
+std::streamsize ViewDataStream::write(int8_t value) {
+  return -1;
+}
+
+std::streamsize ViewDataStream::write(uint8_t value) {
+  return -1;
+}
+
+std::streamsize ViewDataStream::write(int16_t value) {
+  return -1;
+}
+
+std::streamsize ViewDataStream::write(uint16_t value) {
+  return -1;
+}
+
+std::streamsize ViewDataStream::write(int32_t value) {
+  return -1;
+}
+
+std::streamsize ViewDataStream::write(uint32_t value) {
+  return -1;
+}
+
+std::streamsize ViewDataStream::write(float value) {
+  return -1;
+}
+
+std::streamsize ViewDataStream::write(double value) {
+  return -1;
+}
+
+std::streamsize ViewDataStream::write(const std::string &value) {
+  return -1;
+}
+
+}  // namespace peeracle
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/DataStream/ViewDataStream.h"
+
+namespace peeracle {
+
+class ViewDataStreamTest : public testing::Test {
+ protected:
+  ViewDataStreamTest() : _source(_dsInit), _long(100, 'p') {
+  }
+
+  virtual void SetUp() {
+    _source.write("junk", 4);
+    _source.write(static_cast<uint32_t>(0x5052434C));
+    _source.write(static_cast<int16_t>(-2));
+    _source.write(_long);
+    _source.write(3.5);
+    _source.write("tail", 4);
+  }
+
+  // The view covers the values written between "junk" and "tail".
+  void expectValues(ViewDataStream *view) {
+    uint32_t u32;
+    int16_t i16;
+    double d;
+    std::string str;
+    uint8_t byte;
+
+    ASSERT_EQ(4 + 2 + 101 + 8, view->length());
+    EXPECT_EQ(4, view->peek(&u32));
+    EXPECT_EQ(0, view->tell());
+    EXPECT_EQ(4, view->read(&u32));
+    EXPECT_EQ(0x5052434C, u32);
+    EXPECT_EQ(2, view->read(&i16));
+    EXPECT_EQ(-2, i16);
+    EXPECT_EQ(100, view->read(&str));
+    EXPECT_EQ(_long, str);
+    EXPECT_EQ(8, view->read(&d));
+    EXPECT_EQ(3.5, d);
+
+    // The bytes after the range cannot be read.
+    EXPECT_EQ(view->length(), view->tell());
+    EXPECT_EQ(-1, view->read(&byte));
+    EXPECT_EQ(-1, view->seek(view->length() + 1));
+    EXPECT_EQ(-1, view->write(static_cast<uint8_t>(1)));
+
+    // A string is not terminated before the end of the range.
+    EXPECT_EQ(6, view->seek(6));
+    EXPECT_EQ(-1, view->peek(static_cast<uint8_t *>(NULL), 200));
+    EXPECT_EQ(100, view->peek(&str));
+    EXPECT_EQ(6, view->tell());
+  }
+
+  DataStreamInit _dsInit;
+  MemoryDataStream _source;
+  std::string _long;
+};
+
+TEST_F(ViewDataStreamTest, OverDataStream) {
+  ViewDataStream view(_dsInit, &_source, 4, _source.length() - 8);
+  ViewDataStream outside(_dsInit, &_source, 4, _source.length());
+  std::string str;
+
+  EXPECT_TRUE(view.open());
+  EXPECT_TRUE(view.getBuffer() == NULL);
+  expectValues(&view);
+  EXPECT_FALSE(outside.open());
+
+  ViewDataStream truncated(_dsInit, &_source, 4, 50);
+  truncated.seek(6);
+  EXPECT_EQ(-1, truncated.read(&str));
+}
+
+TEST_F(ViewDataStreamTest, OverBuffer) {
+  ViewDataStream view(_dsInit, _source.getBuffer() + 4,
+                      _source.length() - 8);
+
+  EXPECT_TRUE(view.open());
+  EXPECT_EQ(_source.getBuffer() + 4, view.getBuffer());
+  expectValues(&view);
+}
+
+}  // namespace peeracle
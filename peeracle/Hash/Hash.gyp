@@ -34,6 +34,8 @@
       ],
       'sources': [
         'HashInterface.h',
+        'Hex.cc',
+        'Hex.h',
         'Murmur3Hash.cc',
         'Murmur3Hash.h',
       ]
@@ -50,10 +52,27 @@
             '<(DEPTH)/test/test.gyp:peeracle_tests_utils',
           ],
           'sources': [
+            'Hex_unittest.cc',
             'Murmur3Hash_unittest.cc',
           ],
         },
       ],
     }],
+    ['build_benchmarks == 1', {
+      'targets': [
+        {
+          'target_name': 'peeracle_hash_benchmark',
+          'type': 'executable',
+          'dependencies': [
+            'peeracle_hash',
+            '../Utils/Utils.gyp:peeracle_workerpool',
+            '<(DEPTH)/test/test.gyp:peeracle_benchmark_utils',
+          ],
+          'sources': [
+            'Hash_benchmark.cc',
+          ],
+        },
+      ],
+    }],
   ],
 }
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Hash/Murmur3Hash.h"
+#include "peeracle/Utils/WorkerPool.h"
+#include "test/benchmark.h"
+#include "third_party/murmur3/MurmurHash3.h"
+
+namespace peeracle {
+
+static const int64_t kMinNanos = 200000000;
+static const size_t kIncrementalStep = 4096;
+static const size_t kThreadedWorkingSet = 16 * 1024 * 1024;
+
+class HashBenchmarkCase : public Benchmark::Case {
+ public:
+  HashBenchmarkCase(const std::vector<uint8_t> &data, size_t size)
+    : _data(&data[0]), _size(size) {
+  }
+
+ protected:
+  const uint8_t *_data;
+  size_t _size;
+};
+
+class RawMurmur3Case : public HashBenchmarkCase {
+ public:
+  RawMurmur3Case(const std::vector<uint8_t> &data, size_t size)
+    : HashBenchmarkCase(data, size) {
+  }
+
+  void run() {
+    uint8_t result[16];
+
+    MurmurHash3_x86_128(_data, static_cast<int>(_size), 0x5052434C, result);
+  }
+};
+
+class BufferedCase : public HashBenchmarkCase {
+ public:
+  BufferedCase(const std::vector<uint8_t> &data, size_t size)
+    : HashBenchmarkCase(data, size) {
+  }
+
+  void run() {
+    Murmur3Hash hash;
+    uint8_t result[16];
+
+    hash.update(_data, _size);
+    hash.final(result);
+  }
+};
+
+class IncrementalCase : public HashBenchmarkCase {
+ public:
+  IncrementalCase(const std::vector<uint8_t> &data, size_t size)
+    : HashBenchmarkCase(data, size) {
+  }
+
+  void run() {
+    Murmur3Hash hash;
+    uint8_t result[16];
+
+    for (size_t offset = 0; offset < _size; offset += kIncrementalStep) {
+      size_t length = _size - offset;
+
+      hash.update(_data + offset,
+                  length > kIncrementalStep ? kIncrementalStep : length);
+    }
+    hash.final(result);
+  }
+};
+
+class DataStreamCase : public HashBenchmarkCase {
+ public:
+  DataStreamCase(const std::vector<uint8_t> &data, size_t size)
+    : HashBenchmarkCase(data, size) {
+    DataStreamInit init;
+
+    _dataStream = new MemoryDataStream(init);
+    _dataStream->write(reinterpret_cast<const char *>(_data), _size);
+  }
+
+  ~DataStreamCase() {
+    delete _dataStream;
+  }
+
+  void run() {
+    Murmur3Hash hash;
+    uint8_t result[16];
+
+    _dataStream->seek(0);
+    hash.checksum(_dataStream, result);
+  }
+
+ private:
+  MemoryDataStream *_dataStream;
+};
+
+class ChunkRangeTask : public WorkerPoolInterface::Task {
+ public:
+  ChunkRangeTask() : _data(NULL), _chunkSize(0), _count(0) {
+  }
+
+  void set(const uint8_t *data, size_t chunkSize, size_t count) {
+    _data = data;
+    _chunkSize = chunkSize;
+    _count = count;
+  }
+
+  void run() {
+    for (size_t i = 0; i < _count; ++i) {
+      Murmur3Hash hash;
+      uint8_t result[16];
+
+      hash.update(_data + i * _chunkSize, _chunkSize);
+      hash.final(result);
+    }
+  }
+
+ private:
+  const uint8_t *_data;
+  size_t _chunkSize;
+  size_t _count;
+};
+
+// Hash a working set split in chunks of the given size, the way metadata
+// chunk hashes are computed, spreading the chunks over the pool threads.
+class ThreadedCase : public HashBenchmarkCase {
+ public:
+  ThreadedCase(const std::vector<uint8_t> &data, size_t size,
+               WorkerPoolInterface *pool)
+    : HashBenchmarkCase(data, size), _pool(pool) {
+    size_t chunks = getTotalSize() / _size;
+    size_t threads = pool->getThreadCount();
+    size_t perTask = (chunks + threads - 1) / threads;
+
+    _tasks.resize(threads);
+    for (size_t t = 0; t < threads; ++t) {
+      size_t first = t * perTask;
+      size_t count = first < chunks ? chunks - first : 0;
+
+      _tasks[t].set(_data + first * _size, _size,
+                    count < perTask ? count : perTask);
+    }
+  }
+
+  size_t getTotalSize() const {
+    return _size > kThreadedWorkingSet ? _size : kThreadedWorkingSet;
+  }
+
+  void run() {
+    for (size_t t = 0; t < _tasks.size(); ++t) {
+      _pool->post(&_tasks[t]);
+    }
+    _pool->wait();
+  }
+
+ private:
+  WorkerPoolInterface *_pool;
+  std::vector<ChunkRangeTask> _tasks;
+};
+
+static std::string rate(Benchmark::Case *benchmarkCase, size_t bytes) {
+  double nanos = Benchmark::measure(benchmarkCase, kMinNanos);
+
+  return Benchmark::formatRate(static_cast<double>(bytes) * 1e9 / nanos);
+}
+
+static int run(size_t maxSize) {
+  std::vector<uint8_t> data;
+  WorkerPool singlePool;
+  WorkerPool pool;
+  size_t threads = WorkerPool::getProcessorCount();
+  uint32_t state = 0x5052434C;
+  BenchmarkTable table("murmur3_x86_128 throughput (" +
+                       Benchmark::formatCount(static_cast<double>(threads)) +
+                       " processors)");
+
+  data.resize(maxSize > kThreadedWorkingSet ? maxSize : kThreadedWorkingSet);
+  for (size_t i = 0; i < data.size(); ++i) {
+    state = state * 1664525 + 1013904223;
+    data[i] = static_cast<uint8_t>(state >> 24);
+  }
+
+  if (!singlePool.start(1) || !pool.start(threads)) {
+    std::cerr << "unable to start the worker threads" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  table.addColumn("input size");
+  table.addColumn("scalar kernel");
+  table.addColumn("buffered");
+  table.addColumn("incremental 4 KB");
+  table.addColumn("DataStream");
+  table.addColumn("1 thread");
+  table.addColumn(Benchmark::formatCount(static_cast<double>(threads)) +
+                  " threads");
+
+  for (size_t size = 64; size <= maxSize; size *= 4) {
+    RawMurmur3Case raw(data, size);
+    BufferedCase buffered(data, size);
+    IncrementalCase incremental(data, size);
+    DataStreamCase dataStream(data, size);
+    ThreadedCase single(data, size, &singlePool);
+    ThreadedCase threaded(data, size, &pool);
+
+    table.addRow();
+    table.addCell(Benchmark::formatSize(static_cast<double>(size)));
+    table.addCell(rate(&raw, size));
+    table.addCell(rate(&buffered, size));
+    table.addCell(rate(&incremental, size));
+    table.addCell(rate(&dataStream, size));
+    table.addCell(rate(&single, single.getTotalSize()));
+    table.addCell(rate(&threaded, threaded.getTotalSize()));
+  }
+
+  table.print(&std::cout);
+  return EXIT_SUCCESS;
+}
+
+}  // namespace peeracle
+
+int main(int argc, char **argv) {
+  size_t maxSize = 256 * 1024 * 1024;
+
+  if (argc > 1) {
+    maxSize = static_cast<size_t>(strtoul(argv[1], NULL, 10));
+  }
+
+  if (maxSize < 64) {
+    std::cerr << "usage: " << argv[0] << " [max input size in bytes]"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return peeracle::run(maxSize);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string>
+#include "peeracle/Hash/Hex.h"
+
+namespace peeracle {
+
+static const char kDigits[] = "0123456789abcdef";
+
+void Hex::encode(const uint8_t *buffer, size_t length, char *out) {
+  for (size_t i = 0; i < length; ++i) {
+    out[i * 2] = kDigits[buffer[i] >> 4];
+    out[i * 2 + 1] = kDigits[buffer[i] & 0x0F];
+  }
+}
+
+std::string Hex::encode(const uint8_t *buffer, size_t length) {
+  std::string result(length * 2, '\0');
+
+  if (length) {
+    encode(buffer, length, &result[0]);
+  }
+  return result;
+}
+
+static int digit(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool Hex::decode(const std::string &hex, uint8_t *out, size_t length) {
+  if (hex.size() != length * 2) {
+    return false;
+  }
+
+  for (size_t i = 0; i < length; ++i) {
+    int high = digit(hex[i * 2]);
+    int low = digit(hex[i * 2 + 1]);
+
+    if (high < 0 || low < 0) {
+      return false;
+    }
+    out[i] = static_cast<uint8_t>(high << 4 | low);
+  }
+  return true;
+}
+
+}  // namespace peeracle
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_HASH_HEX_H_
+#define PEERACLE_HASH_HEX_H_
+
+#include <stdint.h>
+#include <cstdlib>
+#include <string>
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Lowercase hexadecimal encoding of digests, through a lookup table rather
+ * than a formatted stream.
+ * \addtogroup Hash
+ */
+class Hex {
+ public:
+  /**
+   * Write the 2 * \p length characters encoding \p buffer to \p out. No
+   * terminating NUL is written.
+   */
+  static void encode(const uint8_t *buffer, size_t length, char *out);
+
+  /**
+   * Get the encoding of \p length bytes at \p buffer.
+   */
+  static std::string encode(const uint8_t *buffer, size_t length);
+
+  /**
+   * Write the \p length bytes encoded by \p hex to \p out.
+   * \return false if \p hex is not 2 * \p length hexadecimal characters,
+   * in either case.
+   */
+  static bool decode(const std::string &hex, uint8_t *out, size_t length);
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_HASH_HEX_H_
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/Hash/Hex.h"
+
+namespace peeracle {
+
+TEST(HexTest, Encode) {
+  const uint8_t bytes[] = { 0x00, 0x0f, 0x10, 0x9a, 0xc3, 0xff };
+  char out[5] = { 'x', 'x', 'x', 'x', 'x' };
+
+  EXPECT_EQ("000f109ac3ff", Hex::encode(bytes, sizeof(bytes)));
+  EXPECT_EQ("", Hex::encode(bytes, 0));
+
+  Hex::encode(bytes + 3, 2, out);
+  EXPECT_EQ("9ac3x", std::string(out, sizeof(out)));
+}
+
+TEST(HexTest, Decode) {
+  const uint8_t bytes[] = { 0x00, 0x0f, 0x10, 0x9a, 0xc3, 0xff };
+  uint8_t out[6];
+
+  ASSERT_TRUE(Hex::decode("000f109aC3FF", out, sizeof(out)));
+  EXPECT_EQ(0, memcmp(bytes, out, sizeof(out)));
+  EXPECT_TRUE(Hex::decode(Hex::encode(bytes, 3), out, 3));
+  EXPECT_FALSE(Hex::decode("000f109ac3f", out, sizeof(out)));
+  EXPECT_FALSE(Hex::decode("000f109ac3fg", out, sizeof(out)));
+  EXPECT_FALSE(Hex::decode("", out, 1));
+}
+
+}  // namespace peeracle
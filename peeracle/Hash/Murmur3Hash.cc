@@ -20,46 +20,171 @@
  * SOFTWARE.
  */
 
+#include <cstring>
 #include <iostream>
 #include "peeracle/Hash/Murmur3Hash.h"
 #include "third_party/murmur3/MurmurHash3.h"
 
 namespace peeracle {
 
-Murmur3Hash::Murmur3Hash() {
-  DataStreamInit init;
+static const uint32_t kSeed = 0x5052434C;
+
+// The constants of MurmurHash3_x86_128, for each of its four lanes: the
+// multipliers, key and state rotations and state additions.
+static const uint32_t kMultipliers[5] = {
+  0x239b961b, 0xab0e9789, 0x38b34ae5, 0xa1e38b93, 0x239b961b
+};
+static const int kKeyRotations[4] = { 15, 16, 17, 18 };
+static const int kStateRotations[4] = { 19, 17, 15, 13 };
+static const uint32_t kStateAdditions[4] = {
+  0x561ccd1b, 0x0bcaa747, 0x96cd1c35, 0x32ac3b17
+};
+
+static uint32_t rotl32(uint32_t x, int r) {
+  return (x << r) | (x >> (32 - r));
+}
+
+static uint32_t fmix32(uint32_t h) {
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  return h;
+}
+
+static uint32_t mixKey(uint32_t k, int lane) {
+  k *= kMultipliers[lane];
+  k = rotl32(k, kKeyRotations[lane]);
+  return k * kMultipliers[lane + 1];
+}
+
+static void addLanes(uint32_t *h) {
+  h[0] += h[1] + h[2] + h[3];
+  for (int i = 1; i < 4; ++i) {
+    h[i] += h[0];
+  }
+}
 
-  this->_dataStream = new MemoryDataStream(init);
+Murmur3Hash::Murmur3Hash() {
+  this->init();
 }
 
 Murmur3Hash::~Murmur3Hash() {
-  delete this->_dataStream;
 }
 
 void Murmur3Hash::init() {
+  for (int i = 0; i < 4; ++i) {
+    this->_h[i] = kSeed;
+  }
+  this->_tailLength = 0;
+  this->_length = 0;
 }
 
 void Murmur3Hash::update(DataStreamInterface *dataStream) {
-  char *buffer = new char[dataStream->length()];
+  uint8_t buffer[65536];
+  std::streamsize remaining = dataStream->length();
+
+  while (remaining > 0) {
+    std::streamsize length = dataStream->read(
+      reinterpret_cast<char *>(buffer), remaining <
+      static_cast<std::streamsize>(sizeof(buffer)) ? remaining :
+      static_cast<std::streamsize>(sizeof(buffer)));
+
+    if (length <= 0) {
+      break;
+    }
+    this->update(buffer, static_cast<size_t>(length));
+    remaining -= length;
+  }
+}
 
-  dataStream->read(buffer, dataStream->length());
-  this->_dataStream->write(buffer, dataStream->length());
-  delete buffer;
+// The block loop of MurmurHash3_x86_128, run as the bytes are passed to
+// update() instead of over a whole buffer.
+void Murmur3Hash::_mixBlock(const uint8_t *block) {
+  uint32_t k[4];
+
+  memcpy(k, block, sizeof(k));
+  for (int i = 0; i < 4; ++i) {
+    this->_h[i] ^= mixKey(k[i], i);
+    this->_h[i] = rotl32(this->_h[i], kStateRotations[i]);
+    this->_h[i] += this->_h[(i + 1) % 4];
+    this->_h[i] = this->_h[i] * 5 + kStateAdditions[i];
+  }
 }
 
 void Murmur3Hash::update(const uint8_t *buffer, size_t length) {
-  this->_dataStream->write(reinterpret_cast<const char *>(buffer), length);
+  if (!length) {
+    return;
+  }
+
+  this->_length += length;
+
+  if (this->_tailLength) {
+    size_t count = sizeof(this->_tail) - this->_tailLength;
+
+    if (count > length) {
+      count = length;
+    }
+    memcpy(this->_tail + this->_tailLength, buffer, count);
+    this->_tailLength += count;
+    buffer += count;
+    length -= count;
+    if (this->_tailLength < sizeof(this->_tail)) {
+      return;
+    }
+    this->_mixBlock(this->_tail);
+    this->_tailLength = 0;
+  }
+
+  for (; length >= sizeof(this->_tail); length -= sizeof(this->_tail)) {
+    this->_mixBlock(buffer);
+    buffer += sizeof(this->_tail);
+  }
+
+  memcpy(this->_tail, buffer, length);
+  this->_tailLength = length;
 }
 
 void Murmur3Hash::final(uint8_t *result) {
-  const std::streamsize length = this->_dataStream->length();
-  char *buffer = new char[length];
-  uint8_t output[16];
+  uint32_t h[4];
+  uint32_t k[4] = { 0, 0, 0, 0 };
+  uint32_t length = static_cast<uint32_t>(this->_length);
+
+  // The state is left as is, so that more bytes can still be passed.
+  memcpy(h, this->_h, sizeof(h));
+  for (size_t i = 0; i < this->_tailLength; ++i) {
+    k[i / 4] ^= static_cast<uint32_t>(this->_tail[i]) << ((i % 4) * 8);
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    if (this->_tailLength > static_cast<size_t>(i) * 4) {
+      h[i] ^= mixKey(k[i], i);
+    }
+  }
 
-  this->_dataStream->seek(0);
-  this->_dataStream->read(buffer, length);
+  for (size_t i = 0; i < 4; ++i) {
+    h[i] ^= length;
+  }
+  addLanes(h);
+  for (size_t i = 0; i < 4; ++i) {
+    h[i] = fmix32(h[i]);
+  }
+  addLanes(h);
+
+  for (size_t i = 0; i < 4; ++i) {
+    result[i * 4 + 0] = static_cast<uint8_t>(h[i] >> 24);
+    result[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+    result[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+    result[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+  }
+}
+
+void Murmur3Hash::digest(const uint8_t *buffer, size_t length,
+                         uint8_t *result) {
+  uint8_t output[16];
 
-  MurmurHash3_x86_128(buffer, static_cast<int>(length), 0x5052434C, output);
+  MurmurHash3_x86_128(buffer, static_cast<int>(length), kSeed, output);
 
   for (int i = 0; i < 16; i += 4) {
     result[i + 0] = output[i + 3];
@@ -67,8 +192,6 @@ void Murmur3Hash::final(uint8_t *result) {
     result[i + 2] = output[i + 1];
     result[i + 3] = output[i + 0];
   }
-
-  delete buffer;
 }
 
 void Murmur3Hash::checksum(DataStreamInterface *dataStream, uint8_t *result) {
@@ -45,7 +45,9 @@ class Murmur3Hash
   virtual ~Murmur3Hash();
 
   /**
-   * Initialize the Murmur3 hash algorithm module.
+   * Initialize the Murmur3 hash algorithm module, discarding any data
+   * previously passed to update(). The data is hashed as it is passed, so
+   * only the last partial block of 16 bytes is kept between calls.
    */
   void init();
   void update(DataStreamInterface *dataStream);
@@ -53,11 +55,23 @@ class Murmur3Hash
   void final(uint8_t *result);
   void checksum(DataStreamInterface *dataStream, uint8_t *result);
 
+  /**
+   * Hash \p length bytes at \p buffer in place, giving the same result as
+   * update() followed by final() without copying the bytes. Safe to call
+   * from several threads at once.
+   */
+  static void digest(const uint8_t *buffer, size_t length, uint8_t *result);
+
   static void serialize(uint8_t *in, DataStreamInterface *out);
   static void unserialize(DataStreamInterface *in, uint8_t *out);
 
  private:
-  MemoryDataStream *_dataStream;
+  void _mixBlock(const uint8_t *block);
+
+  uint32_t _h[4];
+  uint8_t _tail[16];
+  size_t _tailLength;
+  uint64_t _length;
 };
 
 /**
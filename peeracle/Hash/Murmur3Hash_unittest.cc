@@ -20,6 +20,7 @@
  * SOFTWARE.
  */
 
+#include <cstring>
 #include "third_party/googletest/gtest/include/gtest/gtest.h"
 #include "peeracle/Hash/Murmur3Hash.h"
 
@@ -54,4 +55,37 @@ TEST_F(Murmur3HashTest, SimpleHash) {
   std::cout << std::endl;
 }
 
+TEST_F(Murmur3HashTest, UpdateInPieces) {
+  uint8_t buffer[1000];
+  uint8_t expected[16];
+  uint8_t result[16];
+
+  for (size_t i = 0; i < sizeof(buffer); ++i) {
+    buffer[i] = static_cast<uint8_t>(i * 131 + 7);
+  }
+
+  // Every length, hashed in pieces that cross the 16 bytes blocks, gives
+  // the digest of the whole buffer.
+  for (size_t length = 0; length <= 100; ++length) {
+    Murmur3Hash::digest(buffer, length, expected);
+    for (size_t piece = 1; piece <= 33; piece += 4) {
+      hash_->init();
+      for (size_t offset = 0; offset < length; offset += piece) {
+        hash_->update(buffer + offset,
+                      piece < length - offset ? piece : length - offset);
+      }
+      hash_->final(result);
+      ASSERT_EQ(0, memcmp(expected, result, sizeof(result)));
+    }
+  }
+
+  hash_->init();
+  hash_->update(buffer, 7);
+  hash_->final(result);
+  hash_->update(buffer + 7, sizeof(buffer) - 7);
+  hash_->final(result);
+  Murmur3Hash::digest(buffer, sizeof(buffer), expected);
+  EXPECT_EQ(0, memcmp(expected, result, sizeof(result)));
+}
+
 }  // namespace peeracle
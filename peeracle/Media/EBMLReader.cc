@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "peeracle/Media/EBMLReader.h"
+
+namespace peeracle {
+
+const uint64_t EBMLReader::kUnknownSize = 0xFFFFFFFFFFFFFFFFULL;
+
+// The length of a variable length integer is one more than the number of
+// leading zeros of its first byte, which must not be 0.
+static int vintLength(uint8_t first) {
+#if defined(__GNUC__)
+  return __builtin_clz(first) - 23;
+#else
+  static const int kLength[16] = {
+    0, 4, 3, 3, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1
+  };
+
+  return first >> 4 ? kLength[first >> 4] : 4 + kLength[first];
+#endif
+}
+
+// Load 8 bytes as a big-endian integer, in a single unaligned load where
+// the compiler can byte swap.
+static uint64_t loadBigEndian(const uint8_t *data) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  uint64_t value;
+
+  memcpy(&value, data, sizeof(value));
+  return __builtin_bswap64(value);
+#else
+  uint64_t value = 0;
+
+  for (int i = 0; i < 8; ++i) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+#endif
+}
+
+EBMLReader::EBMLReader(DataStreamInterface *dataStream)
+  : _dataStream(dataStream) {
+}
+
+int EBMLReader::decodeVint(const uint8_t *data, size_t length, int maxLength,
+                           bool keepMarker, uint64_t *value, bool *allOnes) {
+  int vint;
+  uint64_t result;
+  uint64_t mask;
+
+  if (!length || !data[0]) {
+    return 0;
+  }
+
+  vint = vintLength(data[0]);
+  if (vint > maxLength || static_cast<size_t>(vint) > length) {
+    return 0;
+  }
+
+  if (length >= 8) {
+    result = loadBigEndian(data) >> (64 - 8 * vint);
+  } else {
+    result = 0;
+    for (int i = 0; i < vint; ++i) {
+      result = (result << 8) | data[i];
+    }
+  }
+
+  mask = (1ULL << (7 * vint)) - 1;
+  *allOnes = (result & mask) == mask;
+  *value = keepMarker ? result : result & mask;
+  return vint;
+}
+
+int EBMLReader::decodeHeader(const uint8_t *data, size_t length,
+                             std::streamsize offset, EBMLElement *element) {
+  uint64_t id;
+  uint64_t size;
+  bool allOnes;
+  int idLength = decodeVint(data, length, 4, true, &id, &allOnes);
+  int sizeLength = idLength ? decodeVint(data + idLength, length - idLength,
+                                         8, false, &size, &allOnes) : 0;
+
+  if (!sizeLength) {
+    return 0;
+  }
+
+  element->id = static_cast<uint32_t>(id);
+  element->size = allOnes ? kUnknownSize : size;
+  element->offset = offset;
+  element->dataOffset = offset + idLength + sizeLength;
+  return idLength + sizeLength;
+}
+
+size_t EBMLReader::scanElements(const uint8_t *data, size_t length,
+                                std::streamsize offset,
+                                std::vector<EBMLElement> *elements) {
+  EBMLElement element;
+  size_t position = 0;
+
+  while (position < length) {
+    int header = decodeHeader(data + position, length - position,
+                              offset + static_cast<std::streamsize>(position),
+                              &element);
+
+    if (!header || element.size > length - position - header) {
+      break;
+    }
+
+    elements->push_back(element);
+    position += header + static_cast<size_t>(element.size);
+  }
+  return position;
+}
+
+bool EBMLReader::decodeUnsigned(const uint8_t *data, uint64_t length,
+                                uint64_t *value) {
+  uint64_t result = 0;
+
+  if (length > 8) {
+    return false;
+  }
+
+  for (uint64_t i = 0; i < length; ++i) {
+    result = (result << 8) | data[i];
+  }
+
+  *value = result;
+  return true;
+}
+
+bool EBMLReader::readElement(EBMLElement *element) {
+  uint8_t header[kMaxHeaderLength];
+  std::streamsize offset = _dataStream->tell();
+  std::streamsize length = std::min<std::streamsize>(
+    kMaxHeaderLength, _dataStream->length() - offset);
+  int headerLength;
+
+  // A single peek and seek per element, instead of a read per byte.
+  if (length <= 0 || _dataStream->peek(header, length) != length) {
+    return false;
+  }
+
+  headerLength = decodeHeader(header, static_cast<size_t>(length), offset,
+                              element);
+  return headerLength && seek(offset + headerLength);
+}
+
+bool EBMLReader::readUnsigned(const EBMLElement &element, uint64_t *value) {
+  uint8_t bytes[8];
+  std::streamsize size = static_cast<std::streamsize>(element.size);
+
+  if (element.size > sizeof(bytes) ||
+      (size && _dataStream->read(reinterpret_cast<char *>(bytes), size) !=
+       size)) {
+    return false;
+  }
+
+  return decodeUnsigned(bytes, element.size, value);
+}
+
+bool EBMLReader::skip(const EBMLElement &element) {
+  std::streamsize end = getEnd(element);
+
+  return end != -1 && seek(end);
+}
+
+bool EBMLReader::seek(std::streamsize offset) {
+  return _dataStream->seek(offset) == offset;
+}
+
+std::streamsize EBMLReader::tell() {
+  return _dataStream->tell();
+}
+
+std::streamsize EBMLReader::getEnd(const EBMLElement &element) {
+  if (element.size == kUnknownSize) {
+    return -1;
+  }
+  return element.dataOffset + static_cast<std::streamsize>(element.size);
+}
+
+}  // namespace peeracle
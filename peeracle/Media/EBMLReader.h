@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_MEDIA_EBMLREADER_H_
+#define PEERACLE_MEDIA_EBMLREADER_H_
+
+#include <stdint.h>
+#include <vector>
+#include "peeracle/DataStream/DataStreamInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Header of an EBML element.
+ */
+struct EBMLElement {
+  EBMLElement()
+    : id(0),
+      size(0),
+      offset(0),
+      dataOffset(0) {
+  }
+
+  /**
+   * The element id, with its length marker, as written in the
+   * specifications (0x1A45DFA3 for the EBML header).
+   */
+  uint32_t id;
+
+  /**
+   * The payload size, or EBMLReader::kUnknownSize.
+   */
+  uint64_t size;
+
+  /**
+   * Offsets of the element header and of its payload in the data stream.
+   */
+  std::streamsize offset;
+  std::streamsize dataOffset;
+};
+
+/**
+ * Read EBML element headers from a data stream. Only the headers and the
+ * small values asked for are read, payloads are skipped by seeking past
+ * them.
+ * \addtogroup Media
+ */
+class EBMLReader {
+ public:
+  static const uint64_t kUnknownSize;
+
+  /**
+   * The longest element header: a 4 bytes id and an 8 bytes size.
+   */
+  static const int kMaxHeaderLength = 12;
+
+  explicit EBMLReader(DataStreamInterface *dataStream);
+
+  /**
+   * Read the element header at the current position, leaving the stream at
+   * the start of its payload.
+   */
+  bool readElement(EBMLElement *element);
+
+  /**
+   * Read the payload of \p element as a big-endian unsigned integer of up
+   * to 8 bytes.
+   */
+  bool readUnsigned(const EBMLElement &element, uint64_t *value);
+
+  /**
+   * Move to the end of \p element.
+   * \return false if the element size is unknown.
+   */
+  bool skip(const EBMLElement &element);
+
+  bool seek(std::streamsize offset);
+  std::streamsize tell();
+
+  /**
+   * Get the offset of the end of \p element, or -1 if its size is unknown.
+   */
+  static std::streamsize getEnd(const EBMLElement &element);
+
+  /**
+   * Decode the variable length integer at the start of \p data, of at most
+   * \p maxLength bytes. \p allOnes is set when every value bit is set,
+   * which marks an unknown size.
+   * \return the length of the integer, or 0 if it is invalid or truncated.
+   */
+  static int decodeVint(const uint8_t *data, size_t length, int maxLength,
+                        bool keepMarker, uint64_t *value, bool *allOnes);
+
+  /**
+   * Decode the element header at the start of \p data, found at \p offset
+   * in the data stream.
+   * \return the length of the header, or 0 if it is invalid or truncated.
+   */
+  static int decodeHeader(const uint8_t *data, size_t length,
+                          std::streamsize offset, EBMLElement *element);
+
+  /**
+   * Decode the headers of the consecutive elements held in \p data, found
+   * at \p offset in the data stream, skipping their payloads. The scan
+   * stops before an element that is invalid, of unknown size, or not
+   * entirely in \p data.
+   * \return the number of bytes scanned.
+   */
+  static size_t scanElements(const uint8_t *data, size_t length,
+                             std::streamsize offset,
+                             std::vector<EBMLElement> *elements);
+
+  /**
+   * Decode the payload of an element of \p length bytes as a big-endian
+   * unsigned integer of up to 8 bytes.
+   */
+  static bool decodeUnsigned(const uint8_t *data, uint64_t length,
+                             uint64_t *value);
+
+ private:
+  DataStreamInterface *_dataStream;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_MEDIA_EBMLREADER_H_
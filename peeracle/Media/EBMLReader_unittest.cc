@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Media/EBMLReader.h"
+
+namespace peeracle {
+
+// Decode one byte at a time, as the specifications describe it.
+static int referenceVint(const uint8_t *data, size_t length, int maxLength,
+                         bool keepMarker, uint64_t *value, bool *allOnes) {
+  uint8_t mask = 0x80;
+  int vint = 1;
+  uint64_t result;
+
+  if (!length || !data[0]) {
+    return 0;
+  }
+
+  while (!(data[0] & mask)) {
+    mask >>= 1;
+    ++vint;
+  }
+
+  if (vint > maxLength || static_cast<size_t>(vint) > length) {
+    return 0;
+  }
+
+  result = keepMarker ? data[0] : data[0] & (mask - 1);
+  *allOnes = (data[0] & (mask - 1)) == mask - 1;
+  for (int i = 1; i < vint; ++i) {
+    result = (result << 8) | data[i];
+    *allOnes = *allOnes && data[i] == 0xFF;
+  }
+
+  *value = result;
+  return vint;
+}
+
+TEST(EBMLReaderTest, DecodeVint) {
+  const uint8_t size[] = { 0x81 };
+  const uint8_t id[] = { 0x1A, 0x45, 0xDF, 0xA3, 0x9F };
+  const uint8_t unknown[] = { 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+  const uint8_t twoBytes[] = { 0x40, 0x02 };
+  uint64_t value;
+  bool allOnes;
+
+  EXPECT_EQ(1, EBMLReader::decodeVint(size, sizeof(size), 8, false, &value,
+                                      &allOnes));
+  EXPECT_EQ(1, value);
+  EXPECT_FALSE(allOnes);
+
+  EXPECT_EQ(4, EBMLReader::decodeVint(id, sizeof(id), 4, true, &value,
+                                      &allOnes));
+  EXPECT_EQ(0x1A45DFA3, value);
+
+  EXPECT_EQ(8, EBMLReader::decodeVint(unknown, sizeof(unknown), 8, false,
+                                      &value, &allOnes));
+  EXPECT_TRUE(allOnes);
+
+  EXPECT_EQ(2, EBMLReader::decodeVint(twoBytes, sizeof(twoBytes), 8, false,
+                                      &value, &allOnes));
+  EXPECT_EQ(2, value);
+
+  // Too long, truncated, or without a length marker.
+  EXPECT_EQ(0, EBMLReader::decodeVint(unknown, sizeof(unknown), 4, false,
+                                      &value, &allOnes));
+  EXPECT_EQ(0, EBMLReader::decodeVint(id, 3, 4, true, &value, &allOnes));
+  EXPECT_EQ(0, EBMLReader::decodeVint(id, 0, 4, true, &value, &allOnes));
+  EXPECT_EQ(0, EBMLReader::decodeVint(unknown + 1, 0, 8, false, &value,
+                                      &allOnes));
+}
+
+TEST(EBMLReaderTest, DecodeVintMatchesReference) {
+  uint8_t data[9];
+  uint32_t state = 0x45424D4C;
+
+  for (int first = 0; first < 256; ++first) {
+    for (int round = 0; round < 64; ++round) {
+      data[0] = static_cast<uint8_t>(first);
+      for (size_t i = 1; i < sizeof(data); ++i) {
+        state = state * 1664525 + 1013904223;
+        // Favour the all ones pattern of unknown sizes.
+        data[i] = round % 2 ? 0xFF : static_cast<uint8_t>(state >> 24);
+      }
+
+      // Every available length, so that both the 8 bytes load and the
+      // byte loop near the end of a buffer are covered.
+      for (size_t length = 0; length <= sizeof(data); ++length) {
+        uint64_t expected = 0;
+        uint64_t value = 0;
+        bool expectedAllOnes = false;
+        bool allOnes = false;
+        int result = referenceVint(data, length, 8, false, &expected,
+                                   &expectedAllOnes);
+
+        ASSERT_EQ(result, EBMLReader::decodeVint(data, length, 8, false,
+                                                 &value, &allOnes));
+        if (result) {
+          ASSERT_EQ(expected, value);
+          ASSERT_EQ(expectedAllOnes, allOnes);
+        }
+
+        result = referenceVint(data, length, 4, true, &expected,
+                               &expectedAllOnes);
+        ASSERT_EQ(result, EBMLReader::decodeVint(data, length, 4, true,
+                                                 &value, &allOnes));
+        if (result) {
+          ASSERT_EQ(expected, value);
+        }
+      }
+    }
+  }
+}
+
+TEST(EBMLReaderTest, ScanElements) {
+  // Two elements, then one whose payload is cut, then one of unknown size.
+  const uint8_t data[] = {
+    0xE7, 0x81, 0x2A,
+    0xA3, 0x82, 0x01, 0x02,
+    0xA3, 0x85, 0x01
+  };
+  const uint8_t unknown[] = {
+    0xE7, 0x81, 0x2A,
+    0x1F, 0x43, 0xB6, 0x75, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+  };
+  std::vector<EBMLElement> elements;
+  uint64_t value;
+
+  EXPECT_EQ(7, EBMLReader::scanElements(data, sizeof(data), 100, &elements));
+  ASSERT_EQ(2, elements.size());
+  EXPECT_EQ(0xE7, elements[0].id);
+  EXPECT_EQ(1, elements[0].size);
+  EXPECT_EQ(100, elements[0].offset);
+  EXPECT_EQ(102, elements[0].dataOffset);
+  EXPECT_EQ(0xA3, elements[1].id);
+  EXPECT_EQ(2, elements[1].size);
+  EXPECT_EQ(103, elements[1].offset);
+  EXPECT_EQ(105, elements[1].dataOffset);
+
+  ASSERT_TRUE(EBMLReader::decodeUnsigned(data + 5, elements[1].size,
+                                         &value));
+  EXPECT_EQ(0x0102, value);
+  EXPECT_FALSE(EBMLReader::decodeUnsigned(data, 9, &value));
+
+  elements.clear();
+  EXPECT_EQ(3, EBMLReader::scanElements(unknown, sizeof(unknown), 0,
+                                        &elements));
+  EXPECT_EQ(1, elements.size());
+}
+
+TEST(EBMLReaderTest, ReadElementAtEndOfStream) {
+  DataStreamInit dsInit;
+  MemoryDataStream ds(dsInit);
+  EBMLReader reader(&ds);
+  EBMLElement element;
+  uint64_t value;
+
+  // Headers shorter than the longest one, up to the end of the stream.
+  ds.write("\xE7\x81\x2A\xEC\x80", 5);
+  ds.seek(0);
+
+  ASSERT_TRUE(reader.readElement(&element));
+  EXPECT_EQ(0xE7, element.id);
+  EXPECT_EQ(2, reader.tell());
+  ASSERT_TRUE(reader.readUnsigned(element, &value));
+  EXPECT_EQ(0x2A, value);
+
+  ASSERT_TRUE(reader.readElement(&element));
+  EXPECT_EQ(0xEC, element.id);
+  EXPECT_EQ(0, element.size);
+  EXPECT_EQ(5, reader.tell());
+  EXPECT_FALSE(reader.readElement(&element));
+
+  ds.seek(3);
+  ds.write("\x1A\x45", 2);
+  ds.seek(3);
+  EXPECT_FALSE(reader.readElement(&element));
+  EXPECT_EQ(3, reader.tell());
+}
+
+}  // namespace peeracle
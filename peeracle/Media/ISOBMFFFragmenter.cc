@@ -0,0 +1,682 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "peeracle/DataStream/DataStreamCopy.h"
+#include "peeracle/Media/ISOBMFFFragmenter.h"
+
+namespace peeracle {
+
+static const uint32_t kFtyp = 0x66747970;
+static const uint32_t kMoov = 0x6D6F6F76;
+static const uint32_t kMvex = 0x6D766578;
+static const uint32_t kTrex = 0x74726578;
+static const uint32_t kTrak = 0x7472616B;
+static const uint32_t kTkhd = 0x746B6864;
+static const uint32_t kMdia = 0x6D646961;
+static const uint32_t kMdhd = 0x6D646864;
+static const uint32_t kHdlr = 0x68646C72;
+static const uint32_t kVide = 0x76696465;
+static const uint32_t kMinf = 0x6D696E66;
+static const uint32_t kStbl = 0x7374626C;
+static const uint32_t kStts = 0x73747473;
+static const uint32_t kCtts = 0x63747473;
+static const uint32_t kStsc = 0x73747363;
+static const uint32_t kStsz = 0x7374737A;
+static const uint32_t kStz2 = 0x73747A32;
+static const uint32_t kStco = 0x7374636F;
+static const uint32_t kCo64 = 0x636F3634;
+static const uint32_t kStss = 0x73747373;
+static const uint32_t kSdtp = 0x73647470;
+static const uint32_t kMoof = 0x6D6F6F66;
+static const uint32_t kMfhd = 0x6D666864;
+static const uint32_t kTraf = 0x74726166;
+static const uint32_t kTfhd = 0x74666864;
+static const uint32_t kTfdt = 0x74666474;
+static const uint32_t kTrun = 0x7472756E;
+static const uint32_t kMdat = 0x6D646174;
+
+// tfhd flags: the data offsets of the trun boxes are relative to the moof.
+static const uint32_t kDefaultBaseIsMoof = 0x020000;
+
+// trun flags: a data offset, then a duration, size, flags and composition
+// time offset for every sample.
+static const uint32_t kTrunFlags = 0x000F01;
+
+// Sample flags of a sync sample, and of a sample that depends on others.
+static const uint32_t kSyncSample = 0x02000000;
+static const uint32_t kNonSyncSample = 0x01010000;
+
+static uint32_t getU32(const uint8_t *data) {
+  return (static_cast<uint32_t>(data[0]) << 24) |
+    (static_cast<uint32_t>(data[1]) << 16) |
+    (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+
+static uint64_t getU64(const uint8_t *data) {
+  return (static_cast<uint64_t>(getU32(data)) << 32) | getU32(data + 4);
+}
+
+static void putU32(uint32_t value, std::vector<uint8_t> *out) {
+  out->push_back(static_cast<uint8_t>(value >> 24));
+  out->push_back(static_cast<uint8_t>(value >> 16));
+  out->push_back(static_cast<uint8_t>(value >> 8));
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+static void putU64(uint64_t value, std::vector<uint8_t> *out) {
+  putU32(static_cast<uint32_t>(value >> 32), out);
+  putU32(static_cast<uint32_t>(value), out);
+}
+
+static void setU32(size_t position, uint32_t value,
+                   std::vector<uint8_t> *out) {
+  (*out)[position] = static_cast<uint8_t>(value >> 24);
+  (*out)[position + 1] = static_cast<uint8_t>(value >> 16);
+  (*out)[position + 2] = static_cast<uint8_t>(value >> 8);
+  (*out)[position + 3] = static_cast<uint8_t>(value);
+}
+
+// Start a box whose size is set by endBox().
+static size_t beginBox(uint32_t type, std::vector<uint8_t> *out) {
+  size_t position = out->size();
+
+  putU32(0, out);
+  putU32(type, out);
+  return position;
+}
+
+static void endBox(size_t position, std::vector<uint8_t> *out) {
+  setU32(position, static_cast<uint32_t>(out->size() - position), out);
+}
+
+// Check that a full box of \p payload bytes holds \p count entries of
+// \p entrySize bytes after its \p headerSize bytes of fields.
+static bool hasEntries(const std::vector<uint8_t> &payload,
+                       size_t headerSize, uint64_t count, size_t entrySize) {
+  return payload.size() >= headerSize &&
+    count <= (payload.size() - headerSize) / entrySize;
+}
+
+ISOBMFFFragmenter::ISOBMFFFragmenter(uint32_t segmentDuration)
+  : _segmentDuration(segmentDuration), _dataStream(NULL) {
+}
+
+ISOBMFFFragmenter::~ISOBMFFFragmenter() {
+}
+
+bool ISOBMFFFragmenter::Load(DataStreamInterface *dataStream) {
+  ISOBMFFReader reader(dataStream);
+  ISOBMFFBox box;
+  ISOBMFFBox ftyp;
+  ISOBMFFBox moov;
+  std::streamsize length;
+  bool hasSamples = false;
+
+  _dataStream = dataStream;
+  _initSegment.clear();
+  _tracks.clear();
+  _timecodes.clear();
+  _firstSamples.clear();
+  if (!dataStream) {
+    return false;
+  }
+
+  // The moov box can follow the mdat box, every top level box is visited.
+  length = dataStream->length();
+  while (reader.tell() < length && reader.readBox(&box) &&
+         ISOBMFFReader::getEnd(box) <= length) {
+    if (box.type == kMoof) {
+      return false;
+    }
+
+    if (box.type == kFtyp && !ftyp.size) {
+      ftyp = box;
+    } else if (box.type == kMoov && !moov.size) {
+      moov = box;
+    }
+
+    if (!reader.skip(box)) {
+      break;
+    }
+  }
+
+  if (!moov.size || !reader.seek(moov.dataOffset)) {
+    return false;
+  }
+
+  while (reader.tell() < ISOBMFFReader::getEnd(moov) &&
+         reader.readBox(&box)) {
+    if (box.type == kTrak) {
+      Track track;
+
+      if (!_readTrack(&reader, box, &track)) {
+        return false;
+      }
+      if (track.id && track.timescale) {
+        hasSamples = hasSamples || !track.samples.empty();
+        _tracks.push_back(track);
+      }
+    }
+
+    if (!reader.skip(box)) {
+      return false;
+    }
+  }
+
+  if (!hasSamples) {
+    _tracks.clear();
+    return false;
+  }
+
+  _cutSegments();
+
+  return (!ftyp.size || _writeInitBox(&reader, ftyp)) &&
+    reader.seek(moov.dataOffset) && _writeInitBox(&reader, moov);
+}
+
+bool ISOBMFFFragmenter::_readTrack(ISOBMFFReader *reader,
+                                   const ISOBMFFBox &parent, Track *track) {
+  ISOBMFFBox box;
+
+  // The trak box, then its mdia and minf children.
+  while (reader->tell() < ISOBMFFReader::getEnd(parent) &&
+         reader->readBox(&box)) {
+    uint8_t version;
+    uint32_t flags;
+    uint64_t value;
+
+    if (box.type == kTkhd) {
+      if (!reader->readFullBoxHeader(&version, &flags) ||
+          !reader->readUnsigned(version ? 8 : 4, &value) ||
+          !reader->readUnsigned(version ? 8 : 4, &value) ||
+          !reader->readUnsigned(4, &value)) {
+        return false;
+      }
+      track->id = static_cast<uint32_t>(value);
+    } else if (box.type == kMdhd) {
+      if (!reader->readFullBoxHeader(&version, &flags) ||
+          !reader->readUnsigned(version ? 8 : 4, &value) ||
+          !reader->readUnsigned(version ? 8 : 4, &value) ||
+          !reader->readUnsigned(4, &value)) {
+        return false;
+      }
+      track->timescale = static_cast<uint32_t>(value);
+    } else if (box.type == kHdlr) {
+      if (!reader->readFullBoxHeader(&version, &flags) ||
+          !reader->readUnsigned(4, &value) ||
+          !reader->readUnsigned(4, &value)) {
+        return false;
+      }
+      track->video = value == kVide;
+    } else if (box.type == kMdia || box.type == kMinf) {
+      if (!_readTrack(reader, box, track)) {
+        return false;
+      }
+    } else if (box.type == kStbl) {
+      if (!_readSampleTable(reader, box, track)) {
+        return false;
+      }
+    }
+
+    if (!reader->skip(box)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ISOBMFFFragmenter::_readSampleTable(ISOBMFFReader *reader,
+                                         const ISOBMFFBox &stbl,
+                                         Track *track) {
+  std::vector<uint8_t> stts;
+  std::vector<uint8_t> ctts;
+  std::vector<uint8_t> stsz;
+  std::vector<uint8_t> stsc;
+  std::vector<uint8_t> stco;
+  std::vector<uint8_t> stss;
+  std::vector<Sample> &samples = track->samples;
+  size_t chunkOffsetSize = 4;
+  bool hasSyncTable = false;
+  ISOBMFFBox box;
+
+  // The tables are small next to the samples they describe, they are read
+  // whole and decoded from memory.
+  while (reader->tell() < ISOBMFFReader::getEnd(stbl) &&
+         reader->readBox(&box)) {
+    std::vector<uint8_t> *table = NULL;
+
+    if (box.type == kStts) {
+      table = &stts;
+    } else if (box.type == kCtts) {
+      table = &ctts;
+    } else if (box.type == kStsz) {
+      table = &stsz;
+    } else if (box.type == kStsc) {
+      table = &stsc;
+    } else if (box.type == kStco || box.type == kCo64) {
+      table = &stco;
+      chunkOffsetSize = box.type == kCo64 ? 8 : 4;
+    } else if (box.type == kStss) {
+      table = &stss;
+      hasSyncTable = true;
+    }
+
+    if ((table && !_readPayload(box, table)) || !reader->seek(
+        ISOBMFFReader::getEnd(box))) {
+      return false;
+    }
+  }
+
+  if (stsz.size() < 12 || !getU32(&stsz[8])) {
+    return true;
+  }
+
+  uint32_t sampleSize = getU32(&stsz[4]);
+  uint32_t sampleCount = getU32(&stsz[8]);
+  uint32_t timeCount = stts.size() >= 8 ? getU32(&stts[4]) : 0;
+  uint32_t chunkRuns = stsc.size() >= 8 ? getU32(&stsc[4]) : 0;
+  uint32_t chunkCount = stco.size() >= 8 ? getU32(&stco[4]) : 0;
+
+  if ((!sampleSize && !hasEntries(stsz, 12, sampleCount, 4)) ||
+      !hasEntries(stts, 8, timeCount, 8) ||
+      !hasEntries(stsc, 8, chunkRuns, 12) ||
+      !hasEntries(stco, 8, chunkCount, chunkOffsetSize)) {
+    return false;
+  }
+
+  samples.resize(sampleCount);
+  for (uint32_t i = 0; i < sampleCount; ++i) {
+    samples[i].size = sampleSize ? sampleSize : getU32(&stsz[12 + 4 * i]);
+    samples[i].compositionOffset = 0;
+    samples[i].sync = !hasSyncTable;
+  }
+
+  // Decode times, from runs of samples of the same duration.
+  size_t sample = 0;
+  uint64_t time = 0;
+  for (uint32_t i = 0; i < timeCount && sample < sampleCount; ++i) {
+    uint32_t count = getU32(&stts[8 + 8 * i]);
+    uint32_t duration = getU32(&stts[12 + 8 * i]);
+
+    for (uint32_t j = 0; j < count && sample < sampleCount; ++j) {
+      samples[sample].time = time;
+      samples[sample].duration = duration;
+      time += duration;
+      ++sample;
+    }
+  }
+  if (sample != sampleCount) {
+    return false;
+  }
+
+  // Composition time offsets, signed in a version 1 box.
+  if (ctts.size() >= 8) {
+    uint32_t count = getU32(&ctts[4]);
+
+    if (!hasEntries(ctts, 8, count, 8)) {
+      return false;
+    }
+
+    track->compositionVersion = ctts[0];
+    sample = 0;
+    for (uint32_t i = 0; i < count && sample < sampleCount; ++i) {
+      uint32_t run = getU32(&ctts[8 + 8 * i]);
+      int32_t offset = static_cast<int32_t>(getU32(&ctts[12 + 8 * i]));
+
+      for (uint32_t j = 0; j < run && sample < sampleCount; ++j) {
+        samples[sample++].compositionOffset = offset;
+      }
+    }
+  }
+
+  if (hasSyncTable) {
+    uint32_t count = stss.size() >= 8 ? getU32(&stss[4]) : 0;
+
+    if (!hasEntries(stss, 8, count, 4)) {
+      return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+      uint32_t number = getU32(&stss[8 + 4 * i]);
+
+      if (number && number <= sampleCount) {
+        samples[number - 1].sync = true;
+      }
+    }
+  }
+
+  // Sample offsets, from the chunk offsets and the runs of chunks of the
+  // same number of samples.
+  sample = 0;
+  for (uint32_t i = 0; i < chunkRuns; ++i) {
+    uint32_t firstChunk = getU32(&stsc[8 + 12 * i]);
+    uint32_t perChunk = getU32(&stsc[12 + 12 * i]);
+    uint32_t lastChunk = i + 1 < chunkRuns ?
+      getU32(&stsc[20 + 12 * i]) - 1 : chunkCount;
+
+    if (!firstChunk || lastChunk > chunkCount) {
+      return false;
+    }
+
+    for (uint32_t chunk = firstChunk - 1; chunk < lastChunk; ++chunk) {
+      const uint8_t *entry = &stco[8 + chunkOffsetSize * chunk];
+      uint64_t offset = chunkOffsetSize == 8 ? getU64(entry) :
+        getU32(entry);
+
+      for (uint32_t j = 0; j < perChunk && sample < sampleCount; ++j) {
+        samples[sample].offset = offset;
+        offset += samples[sample].size;
+        ++sample;
+      }
+    }
+  }
+  if (sample != sampleCount) {
+    return false;
+  }
+
+  // A truncated file ends with the last complete sample.
+  for (size_t i = 0; i < samples.size(); ++i) {
+    if (samples[i].offset + samples[i].size >
+        static_cast<uint64_t>(_dataStream->length())) {
+      samples.resize(i);
+      break;
+    }
+  }
+
+  return true;
+}
+
+bool ISOBMFFFragmenter::_readPayload(const ISOBMFFBox &box,
+                                     std::vector<uint8_t> *payload) {
+  std::streamsize length = ISOBMFFReader::getEnd(box) - box.dataOffset;
+
+  if (ISOBMFFReader::getEnd(box) > _dataStream->length() ||
+      _dataStream->seek(box.dataOffset) != box.dataOffset) {
+    return false;
+  }
+
+  payload->resize(static_cast<size_t>(length));
+  return !length ||
+    _dataStream->read(reinterpret_cast<char *>(&(*payload)[0]), length) ==
+    length;
+}
+
+bool ISOBMFFFragmenter::_writeInitBox(ISOBMFFReader *reader,
+                                      const ISOBMFFBox &box) {
+  std::vector<uint8_t> &out = _initSegment;
+
+  if (box.type == kMoov || box.type == kTrak || box.type == kMdia ||
+      box.type == kMinf || box.type == kStbl) {
+    size_t position = beginBox(box.type, &out);
+    ISOBMFFBox child;
+
+    while (reader->tell() < ISOBMFFReader::getEnd(box) &&
+           reader->readBox(&child)) {
+      if (!_writeInitBox(reader, child) || !reader->skip(child)) {
+        return false;
+      }
+    }
+
+    // Every track is fragmented, with no default for its samples.
+    if (box.type == kMoov) {
+      size_t mvex = beginBox(kMvex, &out);
+
+      for (size_t i = 0; i < _tracks.size(); ++i) {
+        size_t trex = beginBox(kTrex, &out);
+
+        putU32(0, &out);
+        putU32(_tracks[i].id, &out);
+        putU32(1, &out);
+        putU32(0, &out);
+        putU32(0, &out);
+        putU32(0, &out);
+        endBox(trex, &out);
+      }
+      endBox(mvex, &out);
+    }
+
+    endBox(position, &out);
+    return true;
+  }
+
+  // The samples are described by the moof boxes, the sample tables are
+  // left empty.
+  if (box.type == kStts || box.type == kStsc || box.type == kStco ||
+      box.type == kCo64) {
+    size_t position = beginBox(box.type == kCo64 ? kStco : box.type, &out);
+
+    putU32(0, &out);
+    putU32(0, &out);
+    endBox(position, &out);
+    return true;
+  }
+
+  if (box.type == kStsz || box.type == kStz2) {
+    size_t position = beginBox(kStsz, &out);
+
+    putU32(0, &out);
+    putU32(0, &out);
+    putU32(0, &out);
+    endBox(position, &out);
+    return true;
+  }
+
+  if (box.type == kCtts || box.type == kStss || box.type == kSdtp ||
+      box.type == kMvex) {
+    return true;
+  }
+
+  std::vector<uint8_t> payload;
+  ISOBMFFBox whole = box;
+
+  // Any other box is copied as it is, header included.
+  whole.dataOffset = box.offset;
+  if (!_readPayload(whole, &payload)) {
+    return false;
+  }
+  out.insert(out.end(), payload.begin(), payload.end());
+  return true;
+}
+
+void ISOBMFFFragmenter::_cutSegments() {
+  size_t reference = _tracks.size();
+  std::vector<size_t> starts;
+
+  // Cut at the sync samples of the first video track, or of the first
+  // track with samples when there is no video.
+  for (size_t t = 0; t < _tracks.size(); ++t) {
+    if (!_tracks[t].samples.empty() &&
+        (reference == _tracks.size() ||
+         (_tracks[t].video && !_tracks[reference].video))) {
+      reference = t;
+    }
+  }
+
+  const Track &track = _tracks[reference];
+  uint64_t target = static_cast<uint64_t>(_segmentDuration) *
+    track.timescale / 1000;
+
+  starts.push_back(0);
+  for (size_t i = 1; i < track.samples.size(); ++i) {
+    if (track.samples[i].sync &&
+        track.samples[i].time - track.samples[starts.back()].time >=
+        target) {
+      starts.push_back(i);
+    }
+  }
+
+  std::vector<size_t> next(_tracks.size(), 0);
+  for (size_t s = 0; s < starts.size(); ++s) {
+    uint64_t start = track.samples[starts[s]].time;
+
+    // The other tracks are cut at the same time, whatever their sync
+    // samples.
+    for (size_t t = 0; t < _tracks.size(); ++t) {
+      const std::vector<Sample> &samples = _tracks[t].samples;
+
+      while (s && next[t] < samples.size() &&
+             samples[next[t]].time * track.timescale <
+             start * _tracks[t].timescale) {
+        ++next[t];
+      }
+    }
+
+    _firstSamples.push_back(next);
+    _timecodes.push_back(static_cast<uint32_t>(start * 1000 /
+                                               track.timescale));
+  }
+
+  for (size_t t = 0; t < _tracks.size(); ++t) {
+    next[t] = _tracks[t].samples.size();
+  }
+  _firstSamples.push_back(next);
+}
+
+void ISOBMFFFragmenter::getInitSegment(DataStreamInterface *out) {
+  if (!_initSegment.empty()) {
+    out->write(reinterpret_cast<const char *>(&_initSegment[0]),
+               static_cast<std::streamsize>(_initSegment.size()));
+  }
+}
+
+void ISOBMFFFragmenter::getMediaSegment(std::streampos timecode,
+                                        DataStreamInterface *out) {
+  std::vector<uint8_t> header;
+  std::vector<Range> ranges;
+
+  if (!getMediaSegmentParts(timecode, &header, &ranges)) {
+    return;
+  }
+
+  out->write(reinterpret_cast<const char *>(&header[0]),
+             static_cast<std::streamsize>(header.size()));
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    DataStreamCopy::copyRange(_dataStream, ranges[i].first, ranges[i].second,
+                              out);
+  }
+}
+
+bool ISOBMFFFragmenter::getMediaSegmentParts(std::streampos timecode,
+                                             std::vector<uint8_t> *header,
+                                             std::vector<Range> *ranges) {
+  std::vector<uint32_t>::const_iterator it =
+    std::lower_bound(_timecodes.begin(), _timecodes.end(),
+                     static_cast<uint32_t>(timecode));
+  size_t segment = it - _timecodes.begin();
+  std::vector<size_t> dataOffsets;
+  std::vector<uint64_t> payloads;
+  uint64_t mdatSize = 8;
+  size_t moof;
+
+  if (it == _timecodes.end() || *it != static_cast<uint32_t>(timecode)) {
+    return false;
+  }
+
+  const std::vector<size_t> &first = _firstSamples[segment];
+  const std::vector<size_t> &last = _firstSamples[segment + 1];
+
+  header->clear();
+  ranges->clear();
+  moof = beginBox(kMoof, header);
+  putU32(16, header);
+  putU32(kMfhd, header);
+  putU32(0, header);
+  putU32(static_cast<uint32_t>(segment + 1), header);
+
+  for (size_t t = 0; t < _tracks.size(); ++t) {
+    const Track &track = _tracks[t];
+    size_t traf;
+    size_t trun;
+    uint64_t payload = 0;
+
+    if (first[t] == last[t]) {
+      continue;
+    }
+
+    traf = beginBox(kTraf, header);
+    putU32(16, header);
+    putU32(kTfhd, header);
+    putU32(kDefaultBaseIsMoof, header);
+    putU32(track.id, header);
+
+    putU32(20, header);
+    putU32(kTfdt, header);
+    putU32(0x01000000, header);
+    putU64(track.samples[first[t]].time, header);
+
+    trun = beginBox(kTrun, header);
+    putU32(static_cast<uint32_t>(track.compositionVersion) << 24 |
+           kTrunFlags, header);
+    putU32(static_cast<uint32_t>(last[t] - first[t]), header);
+    dataOffsets.push_back(header->size());
+    putU32(0, header);
+
+    for (size_t i = first[t]; i < last[t]; ++i) {
+      const Sample &sample = track.samples[i];
+      std::streamsize offset = static_cast<std::streamsize>(sample.offset);
+
+      putU32(sample.duration, header);
+      putU32(sample.size, header);
+      putU32(sample.sync ? kSyncSample : kNonSyncSample, header);
+      putU32(static_cast<uint32_t>(sample.compositionOffset), header);
+
+      // Samples stored one after the other are read as a single range.
+      if (!ranges->empty() &&
+          ranges->back().first + ranges->back().second == offset) {
+        ranges->back().second += sample.size;
+      } else {
+        ranges->push_back(Range(offset, sample.size));
+      }
+      payload += sample.size;
+    }
+
+    endBox(trun, header);
+    endBox(traf, header);
+    payloads.push_back(payload);
+    mdatSize += payload;
+  }
+
+  endBox(moof, header);
+  if (mdatSize > 0xFFFFFFFF) {
+    return false;
+  }
+
+  // The samples of each track follow the mdat header, in track order.
+  uint64_t dataOffset = header->size() + 8;
+  for (size_t i = 0; i < dataOffsets.size(); ++i) {
+    setU32(dataOffsets[i], static_cast<uint32_t>(dataOffset), header);
+    dataOffset += payloads[i];
+  }
+
+  putU32(static_cast<uint32_t>(mdatSize), header);
+  putU32(kMdat, header);
+  return true;
+}
+
+const std::vector<uint32_t> &ISOBMFFFragmenter::getTimecodes() const {
+  return _timecodes;
+}
+
+}  // namespace peeracle
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_MEDIA_ISOBMFFFRAGMENTER_H_
+#define PEERACLE_MEDIA_ISOBMFFFRAGMENTER_H_
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "peeracle/Media/ISOBMFFReader.h"
+
+namespace peeracle {
+
+/**
+ * Fragment a progressive MP4 file, whose samples are described by the
+ * sample tables of its moov box, without rewriting it.
+ *
+ * The tracks are cut into media segments at the sync samples of the first
+ * video track, every \p segmentDuration milliseconds or more. Each media
+ * segment is a moof box built from the sample tables, then an mdat box
+ * holding the samples of every track of the segment, taken from the
+ * original file. The init segment is the ftyp box and a copy of the moov
+ * box whose sample tables are emptied and that declares the tracks as
+ * fragmented.
+ *
+ * Only the generated headers are kept in memory, the sample data is read
+ * from the data stream given to Load(), which must outlive this object.
+ * \addtogroup Media
+ */
+class ISOBMFFFragmenter {
+ public:
+  /**
+   * A range of the data stream, as an offset and a length.
+   */
+  typedef std::pair<std::streamsize, std::streamsize> Range;
+
+  explicit ISOBMFFFragmenter(uint32_t segmentDuration);
+  ~ISOBMFFFragmenter();
+
+  /**
+   * Read the sample tables of the file at the current position of
+   * \p dataStream.
+   * \return false if the file is already fragmented or has no sample.
+   */
+  bool Load(DataStreamInterface *dataStream);
+
+  void getInitSegment(DataStreamInterface *out);
+  void getMediaSegment(std::streampos timecode, DataStreamInterface *out);
+
+  /**
+   * Get the media segment of \p timecode as its generated moof and mdat
+   * headers, followed by the \p ranges of the data stream that make the
+   * mdat payload, so that the samples can be served without a copy.
+   */
+  bool getMediaSegmentParts(std::streampos timecode,
+                            std::vector<uint8_t> *header,
+                            std::vector<Range> *ranges);
+
+  /**
+   * Get the decode time of every media segment, in milliseconds.
+   */
+  const std::vector<uint32_t> &getTimecodes() const;
+
+ private:
+  struct Sample {
+    uint64_t offset;
+    uint64_t time;
+    uint32_t size;
+    uint32_t duration;
+    int32_t compositionOffset;
+    bool sync;
+  };
+
+  struct Track {
+    Track()
+      : id(0),
+        timescale(0),
+        video(false),
+        compositionVersion(0) {
+    }
+
+    uint32_t id;
+    uint32_t timescale;
+    bool video;
+    uint8_t compositionVersion;
+    std::vector<Sample> samples;
+  };
+
+  bool _readTrack(ISOBMFFReader *reader, const ISOBMFFBox &parent,
+                  Track *track);
+  bool _readSampleTable(ISOBMFFReader *reader, const ISOBMFFBox &stbl,
+                        Track *track);
+  bool _readPayload(const ISOBMFFBox &box, std::vector<uint8_t> *payload);
+  bool _writeInitBox(ISOBMFFReader *reader, const ISOBMFFBox &box);
+  void _cutSegments();
+
+  uint32_t _segmentDuration;
+  DataStreamInterface *_dataStream;
+  std::vector<uint8_t> _initSegment;
+  std::vector<Track> _tracks;
+  std::vector<uint32_t> _timecodes;
+
+  // The first sample of every track in every segment, and the sample
+  // count of every track after the last one.
+  std::vector<std::vector<size_t> > _firstSamples;
+};
+
+}  // namespace peeracle
+
+#endif  // PEERACLE_MEDIA_ISOBMFFFRAGMENTER_H_
@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Media/ISOBMFFFragmenter.h"
+#include "peeracle/Media/ISOBMFFMedia.h"
+
+namespace peeracle {
+
+static const uint32_t kVideoSamples = 150;
+static const uint32_t kVideoDuration = 3000;
+static const uint32_t kVideoTimescale = 90000;
+static const uint32_t kKeyFrameInterval = 24;
+static const uint32_t kVideoChunk = 6;
+static const uint32_t kAudioSamples = 235;
+static const uint32_t kAudioDuration = 1024;
+static const uint32_t kAudioTimescale = 48000;
+static const uint32_t kAudioSize = 200;
+static const uint32_t kAudioChunk = 10;
+
+static void put32(uint32_t value, std::vector<uint8_t> *out) {
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    out->push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+static void put64(uint64_t value, std::vector<uint8_t> *out) {
+  put32(static_cast<uint32_t>(value >> 32), out);
+  put32(static_cast<uint32_t>(value), out);
+}
+
+static uint32_t get32(const uint8_t *data) {
+  return (static_cast<uint32_t>(data[0]) << 24) | (data[1] << 16) |
+    (data[2] << 8) | data[3];
+}
+
+static std::vector<uint8_t> box(const char *type,
+                                const std::vector<uint8_t> &payload) {
+  std::vector<uint8_t> result;
+
+  put32(static_cast<uint32_t>(payload.size() + 8), &result);
+  result.insert(result.end(), type, type + 4);
+  result.insert(result.end(), payload.begin(), payload.end());
+  return result;
+}
+
+static std::vector<uint8_t> fullBox(const char *type, uint8_t version,
+                                    const std::vector<uint8_t> &payload) {
+  std::vector<uint8_t> header;
+
+  put32(static_cast<uint32_t>(version) << 24, &header);
+  header.insert(header.end(), payload.begin(), payload.end());
+  return box(type, header);
+}
+
+static void append(std::vector<uint8_t> *out,
+                   const std::vector<uint8_t> &bytes) {
+  out->insert(out->end(), bytes.begin(), bytes.end());
+}
+
+static uint32_t videoSize(uint32_t sample) {
+  return sample % kKeyFrameInterval ? 100 + sample * 7 % 50 : 1000;
+}
+
+class ISOBMFFFragmenterTest : public testing::Test {
+ protected:
+  ISOBMFFFragmenterTest() : _ds(_dsInit) {
+  }
+
+  // A video track with a key frame every 24 frames and composition
+  // offsets, and an audio track, interleaved in chunks of 6 and 10
+  // samples. The audio chunk offsets are 64-bit.
+  void build(bool moovFirst) {
+    std::vector<uint8_t> ftyp;
+    std::vector<uint8_t> mdat;
+    std::vector<uint8_t> moov;
+    std::vector<uint64_t> videoChunks;
+    std::vector<uint64_t> audioChunks;
+    uint32_t video = 0;
+    uint32_t audio = 0;
+
+    ftyp.insert(ftyp.end(), "isom", "isom" + 4);
+    put32(0x200, &ftyp);
+    ftyp = box("ftyp", ftyp);
+
+    _video.clear();
+    _audio.clear();
+    while (video < kVideoSamples || audio < kAudioSamples) {
+      videoChunks.push_back(mdat.size());
+      for (uint32_t i = 0; i < kVideoChunk && video < kVideoSamples; ++i) {
+        _video.push_back(std::vector<uint8_t>(videoSize(video),
+                                              static_cast<uint8_t>(video)));
+        append(&mdat, _video.back());
+        ++video;
+      }
+
+      audioChunks.push_back(mdat.size());
+      for (uint32_t i = 0; i < kAudioChunk && audio < kAudioSamples; ++i) {
+        _audio.push_back(std::vector<uint8_t>(kAudioSize,
+                                              static_cast<uint8_t>(~audio)));
+        append(&mdat, _audio.back());
+        ++audio;
+      }
+    }
+    videoChunks.resize((kVideoSamples + kVideoChunk - 1) / kVideoChunk);
+    audioChunks.resize((kAudioSamples + kAudioChunk - 1) / kAudioChunk);
+    mdat = box("mdat", mdat);
+
+    // The chunk offsets depend on the moov size, which does not depend on
+    // them.
+    moov = buildMoov(videoChunks, audioChunks, 0);
+    _bytes = ftyp;
+    if (moovFirst) {
+      append(&_bytes, buildMoov(videoChunks, audioChunks,
+                                ftyp.size() + moov.size() + 8));
+      append(&_bytes, mdat);
+    } else {
+      append(&_bytes, mdat);
+      append(&_bytes, buildMoov(videoChunks, audioChunks, ftyp.size() + 8));
+    }
+
+    _ds.write(reinterpret_cast<const char *>(&_bytes[0]),
+              static_cast<std::streamsize>(_bytes.size()));
+    _ds.seek(0);
+  }
+
+  std::vector<uint8_t> buildMoov(const std::vector<uint64_t> &videoChunks,
+                                 const std::vector<uint64_t> &audioChunks,
+                                 uint64_t base) {
+    std::vector<uint8_t> moov;
+    std::vector<uint8_t> table;
+
+    // Video: one run of durations, composition offsets on the frames that
+    // are not key frames, and a size per sample.
+    std::vector<uint8_t> stbl;
+    put32(1, &table);
+    put32(kVideoSamples, &table);
+    put32(kVideoDuration, &table);
+    append(&stbl, fullBox("stts", 0, table));
+    table.clear();
+    put32(kVideoSamples, &table);
+    for (uint32_t i = 0; i < kVideoSamples; ++i) {
+      put32(1, &table);
+      put32(i % kKeyFrameInterval ? kVideoDuration : 0, &table);
+    }
+    append(&stbl, fullBox("ctts", 0, table));
+    table.clear();
+    put32((kVideoSamples + kKeyFrameInterval - 1) / kKeyFrameInterval,
+          &table);
+    for (uint32_t i = 0; i < kVideoSamples; i += kKeyFrameInterval) {
+      put32(i + 1, &table);
+    }
+    append(&stbl, fullBox("stss", 0, table));
+    table.clear();
+    put32(1, &table);
+    put32(1, &table);
+    put32(kVideoChunk, &table);
+    put32(1, &table);
+    append(&stbl, fullBox("stsc", 0, table));
+    table.clear();
+    put32(0, &table);
+    put32(kVideoSamples, &table);
+    for (uint32_t i = 0; i < kVideoSamples; ++i) {
+      put32(videoSize(i), &table);
+    }
+    append(&stbl, fullBox("stsz", 0, table));
+    table.clear();
+    put32(static_cast<uint32_t>(videoChunks.size()), &table);
+    for (size_t i = 0; i < videoChunks.size(); ++i) {
+      put32(static_cast<uint32_t>(base + videoChunks[i]), &table);
+    }
+    append(&stbl, fullBox("stco", 0, table));
+    append(&moov, buildTrack(1, kVideoTimescale, "vide", stbl));
+
+    // Audio: a constant sample size, every sample a sync sample, and a
+    // shorter last chunk.
+    stbl.clear();
+    table.clear();
+    put32(1, &table);
+    put32(kAudioSamples, &table);
+    put32(kAudioDuration, &table);
+    append(&stbl, fullBox("stts", 0, table));
+    table.clear();
+    put32(2, &table);
+    put32(1, &table);
+    put32(kAudioChunk, &table);
+    put32(1, &table);
+    put32(static_cast<uint32_t>(audioChunks.size()), &table);
+    put32(kAudioSamples % kAudioChunk, &table);
+    put32(1, &table);
+    append(&stbl, fullBox("stsc", 0, table));
+    table.clear();
+    put32(kAudioSize, &table);
+    put32(kAudioSamples, &table);
+    append(&stbl, fullBox("stsz", 0, table));
+    table.clear();
+    put32(static_cast<uint32_t>(audioChunks.size()), &table);
+    for (size_t i = 0; i < audioChunks.size(); ++i) {
+      put64(base + audioChunks[i], &table);
+    }
+    append(&stbl, fullBox("co64", 0, table));
+    append(&moov, buildTrack(2, kAudioTimescale, "soun", stbl));
+    return box("moov", moov);
+  }
+
+  std::vector<uint8_t> buildTrack(uint32_t trackId, uint32_t timescale,
+                                  const char *handler,
+                                  const std::vector<uint8_t> &stbl) {
+    std::vector<uint8_t> tkhd;
+    std::vector<uint8_t> mdhd;
+    std::vector<uint8_t> hdlr;
+    std::vector<uint8_t> mdia;
+    std::vector<uint8_t> stsd;
+    std::vector<uint8_t> table;
+    std::vector<uint8_t> trak;
+
+    put32(0, &tkhd);
+    put32(0, &tkhd);
+    put32(trackId, &tkhd);
+    tkhd.resize(80);
+    put32(0, &mdhd);
+    put32(0, &mdhd);
+    put32(timescale, &mdhd);
+    put32(0, &mdhd);
+    put32(0, &mdhd);
+    put32(0, &hdlr);
+    hdlr.insert(hdlr.end(), handler, handler + 4);
+    hdlr.resize(21);
+    put32(0, &stsd);
+
+    table = fullBox("stsd", 0, stsd);
+    append(&table, stbl);
+    append(&mdia, fullBox("mdhd", 0, mdhd));
+    append(&mdia, fullBox("hdlr", 0, hdlr));
+    append(&mdia, box("minf", box("stbl", table)));
+    trak = fullBox("tkhd", 0, tkhd);
+    append(&trak, box("mdia", mdia));
+    return box("trak", trak);
+  }
+
+  // The samples of the segment that starts at the video sample \p first
+  // and ends before \p last, video then audio.
+  std::vector<uint8_t> expectedPayload(uint32_t first, uint32_t last) {
+    std::vector<uint8_t> payload;
+
+    for (uint32_t i = first; i < last; ++i) {
+      append(&payload, _video[i]);
+    }
+
+    for (uint32_t i = 0; i < kAudioSamples; ++i) {
+      uint64_t time = static_cast<uint64_t>(i) * kAudioDuration *
+        kVideoTimescale;
+
+      if (time >= static_cast<uint64_t>(first) * kVideoDuration *
+          kAudioTimescale &&
+          (last == kVideoSamples ||
+           time < static_cast<uint64_t>(last) * kVideoDuration *
+           kAudioTimescale)) {
+        append(&payload, _audio[i]);
+      }
+    }
+    return payload;
+  }
+
+  void expectSegments(ISOBMFFFragmenter *fragmenter) {
+    // Cut at the first key frame 2 seconds or more after the last cut.
+    const uint32_t kStarts[] = { 0, 72, 144, kVideoSamples };
+
+    ASSERT_EQ(3, fragmenter->getTimecodes().size());
+    for (size_t s = 0; s < 3; ++s) {
+      std::vector<uint8_t> header;
+      std::vector<ISOBMFFFragmenter::Range> ranges;
+      std::vector<uint8_t> payload;
+      std::vector<uint8_t> expected = expectedPayload(kStarts[s],
+                                                      kStarts[s + 1]);
+      DataStreamInit dsInit;
+      MemoryDataStream segment(dsInit);
+      uint32_t timecode = fragmenter->getTimecodes()[s];
+
+      EXPECT_EQ(kStarts[s] * kVideoDuration * 1000 / kVideoTimescale,
+                timecode);
+      ASSERT_TRUE(fragmenter->getMediaSegmentParts(timecode, &header,
+                                                   &ranges));
+      ASSERT_GE(header.size(), 8);
+      EXPECT_EQ(0, memcmp("mdat", &header[header.size() - 4], 4));
+      EXPECT_EQ(expected.size() + 8, get32(&header[header.size() - 8]));
+
+      // The payload is made of views over the original sample data.
+      for (size_t i = 0; i < ranges.size(); ++i) {
+        ASSERT_LE(ranges[i].first + ranges[i].second,
+                  static_cast<std::streamsize>(_bytes.size()));
+        payload.insert(payload.end(), _bytes.begin() + ranges[i].first,
+                       _bytes.begin() + ranges[i].first + ranges[i].second);
+      }
+      EXPECT_TRUE(expected == payload);
+
+      fragmenter->getMediaSegment(timecode, &segment);
+      ASSERT_EQ(header.size() + payload.size(), segment.length());
+      EXPECT_EQ(0, memcmp(&header[0], segment.getBuffer(), header.size()));
+      EXPECT_EQ(0, memcmp(&payload[0], segment.getBuffer() + header.size(),
+                          payload.size()));
+    }
+
+    EXPECT_FALSE(fragmenter->getMediaSegmentParts(1, NULL, NULL));
+  }
+
+  // Concatenate the init and media segments into a fragmented file.
+  void fragment(MediaInterface *media, DataStreamInterface *out) {
+    const std::vector<uint32_t> &timecodes = media->getTimecodes();
+
+    media->getInitSegment(out);
+    for (size_t i = 0; i < timecodes.size(); ++i) {
+      media->getMediaSegment(timecodes[i], out);
+    }
+    out->seek(0);
+  }
+
+  DataStreamInit _dsInit;
+  MemoryDataStream _ds;
+  std::vector<uint8_t> _bytes;
+  std::vector<std::vector<uint8_t> > _video;
+  std::vector<std::vector<uint8_t> > _audio;
+};
+
+TEST_F(ISOBMFFFragmenterTest, MoovFirst) {
+  ISOBMFFFragmenter fragmenter(2000);
+
+  build(true);
+  ASSERT_TRUE(fragmenter.Load(&_ds));
+  expectSegments(&fragmenter);
+}
+
+TEST_F(ISOBMFFFragmenterTest, MoovLast) {
+  ISOBMFFFragmenter fragmenter(2000);
+
+  build(false);
+  ASSERT_TRUE(fragmenter.Load(&_ds));
+  expectSegments(&fragmenter);
+}
+
+TEST_F(ISOBMFFFragmenterTest, FragmentedOutput) {
+  ISOBMFFMedia progressive;
+  ISOBMFFMedia fragmented;
+  ISOBMFFFragmenter fragmenter(2000);
+  DataStreamInit dsInit;
+  MemoryDataStream out(dsInit);
+  std::streamsize offset;
+  std::streamsize length;
+  uint32_t video = 0;
+  uint32_t audio = 0;
+
+  build(true);
+  ASSERT_TRUE(progressive.Load(&_ds));
+  EXPECT_FALSE(progressive.getInitSegmentRange(&offset, &length));
+  EXPECT_FALSE(progressive.getMediaSegmentRange(0, &offset, &length));
+  fragment(&progressive, &out);
+
+  // The output is a fragmented file whose moov box has no sample left.
+  ASSERT_TRUE(fragmented.Load(&out));
+  EXPECT_TRUE(fragmented.getTimecodes() == progressive.getTimecodes());
+  ASSERT_TRUE(fragmented.getInitSegmentRange(&offset, &length));
+  EXPECT_EQ(0, offset);
+  out.seek(0);
+  EXPECT_FALSE(fragmenter.Load(&out));
+
+  for (size_t i = 0; i < fragmented.getTimecodes().size(); ++i) {
+    uint32_t timecode = fragmented.getTimecodes()[i];
+    MemoryDataStream expected(dsInit);
+    MemoryDataStream actual(dsInit);
+    std::vector<MediaFrame> generatedFrames;
+    std::vector<MediaFrame> frames;
+
+    progressive.getMediaSegment(timecode, &expected);
+    fragmented.getMediaSegment(timecode, &actual);
+    ASSERT_EQ(expected.length(), actual.length());
+    EXPECT_EQ(0, memcmp(expected.getBuffer(), actual.getBuffer(),
+                        static_cast<size_t>(actual.length())));
+
+    // The frames are the original samples, whether the fragment is
+    // generated or read.
+    ASSERT_TRUE(progressive.getMediaSegmentFrames(timecode,
+                                                  &generatedFrames));
+    ASSERT_TRUE(fragmented.getMediaSegmentFrames(timecode, &frames));
+    ASSERT_EQ(generatedFrames.size(), frames.size());
+    for (size_t f = 0; f < frames.size(); ++f) {
+      const MediaFrame &frame = frames[f];
+
+      ASSERT_TRUE(frame.track == 1 ? video < kVideoSamples :
+                  audio < kAudioSamples);
+      const std::vector<uint8_t> &sample = frame.track == 1 ?
+        _video[video] : _audio[audio];
+
+      EXPECT_EQ(generatedFrames[f].offset, frame.offset);
+      EXPECT_EQ(generatedFrames[f].timecode, frame.timecode);
+      ASSERT_EQ(static_cast<std::streamsize>(sample.size()), frame.length);
+      EXPECT_EQ(0, memcmp(&sample[0], actual.getBuffer() + frame.offset,
+                          sample.size()));
+      if (frame.track == 1) {
+        EXPECT_EQ(video * kVideoDuration * 1000 / kVideoTimescale,
+                  frame.timecode);
+        EXPECT_EQ(video % kKeyFrameInterval == 0, frame.keyframe);
+        ++video;
+      } else {
+        EXPECT_EQ(static_cast<uint64_t>(audio) * kAudioDuration * 1000 /
+                  kAudioTimescale, frame.timecode);
+        EXPECT_TRUE(frame.keyframe);
+        ++audio;
+      }
+    }
+  }
+  EXPECT_EQ(kVideoSamples, video);
+  EXPECT_EQ(kAudioSamples, audio);
+}
+
+TEST_F(ISOBMFFFragmenterTest, Truncated) {
+  ISOBMFFFragmenter fragmenter(2000);
+  DataStreamInit dsInit;
+  MemoryDataStream truncated(dsInit);
+  std::vector<uint8_t> header;
+  std::vector<ISOBMFFFragmenter::Range> ranges;
+  std::streamsize length = 0;
+
+  build(true);
+  truncated.write(reinterpret_cast<const char *>(&_bytes[0]),
+                  static_cast<std::streamsize>(_bytes.size() - 100));
+  truncated.seek(0);
+
+  // The file ends with the last video sample, which is dropped.
+  ASSERT_TRUE(fragmenter.Load(&truncated));
+  ASSERT_EQ(3, fragmenter.getTimecodes().size());
+  ASSERT_TRUE(fragmenter.getMediaSegmentParts(
+    fragmenter.getTimecodes()[2], &header, &ranges));
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    length += ranges[i].second;
+  }
+  EXPECT_EQ(expectedPayload(144, kVideoSamples).size() -
+            videoSize(kVideoSamples - 1), length);
+  EXPECT_LE(ranges.back().first + ranges.back().second, truncated.length());
+}
+
+TEST_F(ISOBMFFFragmenterTest, Corrupted) {
+  ISOBMFFFragmenter fragmenter(2000);
+  DataStreamInit dsInit;
+  MemoryDataStream empty(dsInit);
+  size_t stts;
+
+  EXPECT_FALSE(fragmenter.Load(NULL));
+  EXPECT_FALSE(fragmenter.Load(&empty));
+
+  // Fewer durations in the stts box than samples.
+  build(true);
+  for (stts = 0; memcmp(&_bytes[stts], "stts", 4); ++stts) {
+  }
+  _bytes[stts + 15] -= 1;
+  _ds.seek(0);
+  _ds.write(reinterpret_cast<const char *>(&_bytes[0]),
+            static_cast<std::streamsize>(_bytes.size()));
+  _ds.seek(0);
+  EXPECT_FALSE(fragmenter.Load(&_ds));
+}
+
+}  // namespace peeracle
@@ -20,25 +20,524 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "peeracle/DataStream/DataStreamCopy.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
 #include "peeracle/Media/ISOBMFFMedia.h"
 
 namespace peeracle {
 
-ISOBMFFMedia::ISOBMFFMedia() {
+static const uint32_t kMoov = 0x6D6F6F76;
+static const uint32_t kTrak = 0x7472616B;
+static const uint32_t kTkhd = 0x746B6864;
+static const uint32_t kMdia = 0x6D646961;
+static const uint32_t kMdhd = 0x6D646864;
+static const uint32_t kSidx = 0x73696478;
+static const uint32_t kStyp = 0x73747970;
+static const uint32_t kMoof = 0x6D6F6F66;
+static const uint32_t kTraf = 0x74726166;
+static const uint32_t kTfhd = 0x74666864;
+static const uint32_t kTfdt = 0x74666474;
+static const uint32_t kTrun = 0x7472756E;
+static const uint32_t kMdat = 0x6D646174;
+
+static const uint32_t kSegmentDuration = 2000;
+
+static bool compareFrameOffsets(const MediaFrame &a, const MediaFrame &b) {
+  return a.offset < b.offset;
+}
+
+ISOBMFFMedia::ISOBMFFMedia() : _dataStream(NULL), _initOffset(0),
+  _initLength(0), _fragmenter(kSegmentDuration), _fragmenting(false) {
 }
 
 ISOBMFFMedia::~ISOBMFFMedia() {
 }
 
 bool ISOBMFFMedia::Load(DataStreamInterface *dataStream) {
+  ISOBMFFReader reader(dataStream);
+  ISOBMFFBox box;
+  ISOBMFFBox sidx;
+  std::streamsize length;
+  std::streamsize moovEnd = -1;
+  std::streamsize fragments = -1;
+
+  _dataStream = dataStream;
+  _initLength = 0;
+  _timescales.clear();
+  _timecodes.clear();
+  _offsets.clear();
+  _lengths.clear();
+  _fragmenting = false;
+  if (!dataStream) {
+    return false;
+  }
+
+  _initOffset = dataStream->tell();
+  length = dataStream->length();
+  while (reader.tell() < length && reader.readBox(&box)) {
+    // The moov box of a progressive file can follow its mdat box.
+    if (box.type == kMoof || box.type == kStyp ||
+        (box.type == kMdat && moovEnd != -1)) {
+      fragments = box.offset;
+      break;
+    }
+
+    if (box.type == kMoov) {
+      if (!_readMoov(&reader, box)) {
+        return false;
+      }
+      moovEnd = ISOBMFFReader::getEnd(box);
+    } else if (box.type == kSidx && moovEnd != -1 && !sidx.size) {
+      sidx = box;
+    }
+
+    if (!reader.skip(box)) {
+      return false;
+    }
+  }
+
+  if (moovEnd == -1) {
+    return false;
+  }
+
+  _initLength = moovEnd - _initOffset;
+  if (sidx.size && _readSidx(&reader, sidx) && !_timecodes.empty()) {
+    return true;
+  }
+
+  _timecodes.clear();
+  _offsets.clear();
+  _lengths.clear();
+  if (fragments != -1 && !_scanFragments(&reader, fragments)) {
+    return false;
+  }
+
+  // Without fragments, the samples may be described by the moov box.
+  if (_timecodes.empty() && reader.seek(_initOffset) &&
+      _fragmenter.Load(dataStream)) {
+    _fragmenting = true;
+    _timecodes = _fragmenter.getTimecodes();
+  }
+  return true;
+}
+
+bool ISOBMFFMedia::_readMoov(ISOBMFFReader *reader, const ISOBMFFBox &moov) {
+  ISOBMFFBox trak;
+
+  // Keep the timescale of every track, tfdt boxes give decode times in it.
+  while (reader->tell() < ISOBMFFReader::getEnd(moov) &&
+         reader->readBox(&trak)) {
+    ISOBMFFBox child;
+    uint64_t trackId = 0;
+    uint64_t timescale = 0;
+
+    while (trak.type == kTrak &&
+           reader->tell() < ISOBMFFReader::getEnd(trak) &&
+           reader->readBox(&child)) {
+      ISOBMFFBox mdhd;
+      uint8_t version;
+      uint32_t flags;
+      uint64_t ignored;
+
+      if (child.type == kTkhd) {
+        if (!reader->readFullBoxHeader(&version, &flags) ||
+            !reader->readUnsigned(version ? 8 : 4, &ignored) ||
+            !reader->readUnsigned(version ? 8 : 4, &ignored) ||
+            !reader->readUnsigned(4, &trackId)) {
+          return false;
+        }
+      }
+
+      while (child.type == kMdia &&
+             reader->tell() < ISOBMFFReader::getEnd(child) &&
+             reader->readBox(&mdhd)) {
+        if (mdhd.type == kMdhd &&
+            (!reader->readFullBoxHeader(&version, &flags) ||
+             !reader->readUnsigned(version ? 8 : 4, &ignored) ||
+             !reader->readUnsigned(version ? 8 : 4, &ignored) ||
+             !reader->readUnsigned(4, &timescale))) {
+          return false;
+        }
+        if (!reader->skip(mdhd)) {
+          return false;
+        }
+      }
+
+      if (!reader->skip(child)) {
+        return false;
+      }
+    }
+
+    if (trackId && timescale) {
+      _timescales[static_cast<uint32_t>(trackId)] =
+        static_cast<uint32_t>(timescale);
+    }
+
+    if (!reader->skip(trak)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ISOBMFFMedia::_readSidx(ISOBMFFReader *reader, const ISOBMFFBox &sidx) {
+  uint8_t version;
+  uint32_t flags;
+  uint64_t referenceId;
+  uint64_t timescale;
+  uint64_t time;
+  uint64_t firstOffset;
+  uint64_t count;
+  std::streamsize offset;
+
+  if (!reader->seek(sidx.dataOffset) ||
+      !reader->readFullBoxHeader(&version, &flags) ||
+      !reader->readUnsigned(4, &referenceId) ||
+      !reader->readUnsigned(4, &timescale) ||
+      !reader->readUnsigned(version ? 8 : 4, &time) ||
+      !reader->readUnsigned(version ? 8 : 4, &firstOffset) ||
+      !reader->readUnsigned(4, &count) || !timescale) {
+    return false;
+  }
+
+  offset = ISOBMFFReader::getEnd(sidx) +
+    static_cast<std::streamsize>(firstOffset);
+  for (uint64_t i = 0; i < (count & 0xFFFF); ++i) {
+    uint64_t reference;
+    uint64_t duration;
+    uint64_t sap;
+    std::streamsize size;
+
+    if (!reader->readUnsigned(4, &reference) ||
+        !reader->readUnsigned(4, &duration) ||
+        !reader->readUnsigned(4, &sap)) {
+      return false;
+    }
+
+    // A reference to another sidx would need that index too, the fragments
+    // are scanned instead.
+    size = static_cast<std::streamsize>(reference & 0x7FFFFFFF);
+    if ((reference & 0x80000000) || offset + size > _dataStream->length()) {
+      return false;
+    }
+
+    _addFragment(offset, size, time, timescale);
+    offset += size;
+    time += duration;
+  }
+
+  return true;
+}
+
+bool ISOBMFFMedia::_scanFragments(ISOBMFFReader *reader,
+                                  std::streamsize offset) {
+  std::streamsize length = _dataStream->length();
+  std::streamsize start = -1;
+  ISOBMFFBox box;
+
+  if (!reader->seek(offset)) {
+    return false;
+  }
+
+  while (reader->tell() < length && reader->readBox(&box)) {
+    std::streamsize end = ISOBMFFReader::getEnd(box);
+
+    // A truncated file ends with the last complete fragment.
+    if (end > length) {
+      break;
+    }
+
+    // A fragment starts with its styp or moof box and takes every box up
+    // to the next fragment.
+    if (box.type == kStyp) {
+      start = box.offset;
+    } else if (box.type == kMoof) {
+      uint64_t time;
+      uint64_t timescale;
+
+      if (!_readMoof(reader, box, &time, &timescale)) {
+        return false;
+      }
+      _addFragment(start == -1 ? box.offset : start, 0, time, timescale);
+      start = -1;
+    }
+
+    if (start == -1 && !_offsets.empty()) {
+      _lengths.back() = end - _offsets.back();
+    }
+
+    if (!reader->skip(box)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ISOBMFFMedia::_readMoof(ISOBMFFReader *reader, const ISOBMFFBox &moof,
+                             uint64_t *time, uint64_t *timescale) {
+  std::map<uint32_t, uint32_t>::const_iterator it;
+  ISOBMFFBox traf;
+  uint64_t trackId = 0;
+  bool hasTime = false;
+
+  // The decode time of a fragment is the one of its first track fragment.
+  while (!hasTime && reader->tell() < ISOBMFFReader::getEnd(moof) &&
+         reader->readBox(&traf)) {
+    ISOBMFFBox child;
+
+    while (traf.type == kTraf &&
+           reader->tell() < ISOBMFFReader::getEnd(traf) &&
+           reader->readBox(&child)) {
+      uint8_t version;
+      uint32_t flags;
+
+      if (child.type == kTfhd) {
+        if (!reader->readFullBoxHeader(&version, &flags) ||
+            !reader->readUnsigned(4, &trackId)) {
+          return false;
+        }
+      } else if (child.type == kTfdt) {
+        if (!reader->readFullBoxHeader(&version, &flags) ||
+            !reader->readUnsigned(version ? 8 : 4, time)) {
+          return false;
+        }
+        hasTime = true;
+      }
+
+      if (!reader->skip(child)) {
+        return false;
+      }
+    }
+
+    if (!reader->skip(traf)) {
+      return false;
+    }
+  }
+
+  it = _timescales.find(static_cast<uint32_t>(trackId));
+  if (!hasTime || it == _timescales.end()) {
+    return false;
+  }
+
+  *timescale = it->second;
   return true;
 }
 
+void ISOBMFFMedia::_addFragment(std::streamsize offset,
+                                std::streamsize length, uint64_t time,
+                                uint64_t timescale) {
+  _offsets.push_back(offset);
+  _lengths.push_back(length);
+  _timecodes.push_back(static_cast<uint32_t>(time * 1000 / timescale));
+}
+
 void ISOBMFFMedia::getInitSegment(DataStreamInterface *out) {
+  std::streamsize offset;
+  std::streamsize length;
+
+  if (_fragmenting) {
+    _fragmenter.getInitSegment(out);
+  } else if (getInitSegmentRange(&offset, &length)) {
+    DataStreamCopy::copyRange(_dataStream, offset, length, out);
+  }
 }
 
 void ISOBMFFMedia::getMediaSegment(std::streampos timecode,
-                                DataStreamInterface *out) {
+                                   DataStreamInterface *out) {
+  std::streamsize offset;
+  std::streamsize length;
+
+  if (_fragmenting) {
+    _fragmenter.getMediaSegment(timecode, out);
+  } else if (getMediaSegmentRange(timecode, &offset, &length)) {
+    DataStreamCopy::copyRange(_dataStream, offset, length, out);
+  }
+}
+
+bool ISOBMFFMedia::getInitSegmentRange(std::streamsize *offset,
+                                       std::streamsize *length) {
+  if (!_dataStream || !_initLength || _fragmenting) {
+    return false;
+  }
+
+  *offset = _initOffset;
+  *length = _initLength;
+  return true;
+}
+
+bool ISOBMFFMedia::getMediaSegmentRange(std::streampos timecode,
+                                        std::streamsize *offset,
+                                        std::streamsize *length) {
+  std::vector<uint32_t>::const_iterator it =
+    std::lower_bound(_timecodes.begin(), _timecodes.end(),
+                     static_cast<uint32_t>(timecode));
+  size_t index = it - _timecodes.begin();
+
+  if (_fragmenting || it == _timecodes.end() ||
+      *it != static_cast<uint32_t>(timecode)) {
+    return false;
+  }
+
+  *offset = _offsets[index];
+  *length = _lengths[index];
+  return true;
+}
+
+bool ISOBMFFMedia::getMediaSegmentFrames(std::streampos timecode,
+                                         std::vector<MediaFrame> *frames) {
+  DataStreamInit dsInit;
+  MemoryDataStream generated(dsInit);
+  DataStreamInterface *in = _dataStream;
+  std::streamsize offset;
+  std::streamsize length;
+  ISOBMFFBox box;
+
+  frames->clear();
+  if (_fragmenting) {
+    // Parse the generated fragment, its trun data offsets are relative to
+    // the generated moof box.
+    _fragmenter.getMediaSegment(timecode, &generated);
+    in = &generated;
+    offset = 0;
+    length = generated.length();
+  } else if (!getMediaSegmentRange(timecode, &offset, &length)) {
+    return false;
+  }
+
+  ISOBMFFReader reader(in);
+  if (!length || !reader.seek(offset)) {
+    return false;
+  }
+
+  while (reader.tell() < offset + length && reader.readBox(&box)) {
+    if (box.type == kMoof &&
+        !_readFrames(&reader, box, offset, offset + length, frames)) {
+      return false;
+    }
+    if (!reader.skip(box)) {
+      return false;
+    }
+  }
+
+  std::sort(frames->begin(), frames->end(), compareFrameOffsets);
+  return true;
+}
+
+bool ISOBMFFMedia::_readFrames(ISOBMFFReader *reader, const ISOBMFFBox &moof,
+                               std::streamsize segmentOffset,
+                               std::streamsize segmentEnd,
+                               std::vector<MediaFrame> *frames) {
+  std::streamsize dataEnd = moof.offset;
+  ISOBMFFBox traf;
+
+  while (reader->tell() < ISOBMFFReader::getEnd(moof) &&
+         reader->readBox(&traf)) {
+    std::map<uint32_t, uint32_t>::const_iterator it = _timescales.end();
+    ISOBMFFBox child;
+    uint64_t trackId = 0;
+    uint64_t defaultDuration = 0;
+    uint64_t defaultSize = 0;
+    uint64_t defaultFlags = 0;
+    uint64_t time = 0;
+    std::streamsize base = dataEnd;
+
+    while (traf.type == kTraf &&
+           reader->tell() < ISOBMFFReader::getEnd(traf) &&
+           reader->readBox(&child)) {
+      uint8_t version;
+      uint32_t flags;
+      uint64_t value;
+      uint64_t count;
+      uint64_t firstFlags = 0;
+
+      if ((child.type == kTfhd || child.type == kTfdt ||
+           child.type == kTrun) &&
+          !reader->readFullBoxHeader(&version, &flags)) {
+        return false;
+      }
+
+      if (child.type == kTfhd) {
+        if (!reader->readUnsigned(4, &trackId) ||
+            ((flags & 0x1) && !reader->readUnsigned(8, &value)) ||
+            ((flags & 0x2) && !reader->readUnsigned(4, &count)) ||
+            ((flags & 0x8) && !reader->readUnsigned(4, &defaultDuration)) ||
+            ((flags & 0x10) && !reader->readUnsigned(4, &defaultSize)) ||
+            ((flags & 0x20) && !reader->readUnsigned(4, &defaultFlags))) {
+          return false;
+        }
+
+        // Without an explicit base, a track fragment follows the data of
+        // the previous one, or starts at the moof box.
+        if (flags & 0x1) {
+          base = static_cast<std::streamsize>(value);
+        } else if (flags & 0x20000) {
+          base = moof.offset;
+        }
+        dataEnd = base;
+        it = _timescales.find(static_cast<uint32_t>(trackId));
+        if (it == _timescales.end()) {
+          return false;
+        }
+      } else if (child.type == kTfdt) {
+        if (!reader->readUnsigned(version ? 8 : 4, &time)) {
+          return false;
+        }
+      } else if (child.type == kTrun) {
+        if (it == _timescales.end() || !reader->readUnsigned(4, &count) ||
+            ((flags & 0x1) && !reader->readUnsigned(4, &value)) ||
+            ((flags & 0x4) && !reader->readUnsigned(4, &firstFlags))) {
+          return false;
+        }
+
+        // A run without a data offset continues the previous run.
+        if (flags & 0x1) {
+          dataEnd = base + static_cast<int32_t>(value);
+        }
+
+        for (uint64_t i = 0; i < count; ++i) {
+          MediaFrame frame;
+          uint64_t duration = defaultDuration;
+          uint64_t size = defaultSize;
+          uint64_t sampleFlags = i == 0 && (flags & 0x4) ?
+            firstFlags : defaultFlags;
+
+          if (((flags & 0x100) && !reader->readUnsigned(4, &duration)) ||
+              ((flags & 0x200) && !reader->readUnsigned(4, &size)) ||
+              ((flags & 0x400) && !reader->readUnsigned(4, &sampleFlags)) ||
+              ((flags & 0x800) && !reader->readUnsigned(4, &value)) ||
+              dataEnd < segmentOffset || dataEnd > segmentEnd ||
+              static_cast<uint64_t>(segmentEnd - dataEnd) < size) {
+            return false;
+          }
+
+          // Frames other than sync samples set sample_is_non_sync_sample.
+          frame.offset = dataEnd - segmentOffset;
+          frame.length = static_cast<std::streamsize>(size);
+          frame.track = static_cast<uint32_t>(trackId);
+          frame.timecode = static_cast<uint32_t>(time * 1000 / it->second);
+          frame.keyframe = !(sampleFlags & 0x10000);
+          frames->push_back(frame);
+          dataEnd += frame.length;
+          time += duration;
+        }
+      }
+
+      if (!reader->skip(child)) {
+        return false;
+      }
+    }
+
+    if (!reader->skip(traf)) {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 const std::vector<uint32_t> &ISOBMFFMedia::getTimecodes() const {
@@ -24,12 +24,32 @@
 #define PEERACLE_MEDIA_ISOBMFFMEDIA_H_
 
 #include <stdint.h>
+#include <map>
 #include <vector>
 
+#include "peeracle/Media/ISOBMFFFragmenter.h"
+#include "peeracle/Media/ISOBMFFReader.h"
 #include "peeracle/Media/MediaInterface.h"
 
 namespace peeracle {
 
+/**
+ * Fragmented MP4 media, indexed by reading box headers only.
+ *
+ * The init segment runs from the start of the file to the end of the moov
+ * box, ftyp included. Each fragment, a moof box and the boxes up to the
+ * next one, is a media segment keyed by its decode time in milliseconds.
+ * The fragment ranges and times come from the first sidx box when there
+ * is one, otherwise from a scan of the moof boxes that skips the mdat
+ * payloads.
+ *
+ * A progressive file, whose moov box describes every sample, is
+ * fragmented on the fly by an ISOBMFFFragmenter. Its init and media
+ * segments are then generated, and have no range in the data stream.
+ *
+ * The data stream given to Load() is read again by getInitSegment() and
+ * getMediaSegment(), it must outlive this object.
+ */
 class ISOBMFFMedia
   : public MediaInterface {
  public:
@@ -39,10 +59,34 @@ class ISOBMFFMedia
   bool Load(DataStreamInterface *dataStream);
   void getInitSegment(DataStreamInterface *out);
   void getMediaSegment(std::streampos timecode, DataStreamInterface *out);
+  bool getInitSegmentRange(std::streamsize *offset, std::streamsize *length);
+  bool getMediaSegmentRange(std::streampos timecode, std::streamsize *offset,
+                            std::streamsize *length);
+  bool getMediaSegmentFrames(std::streampos timecode,
+                             std::vector<MediaFrame> *frames);
   const std::vector<uint32_t> &getTimecodes() const;
 
  private:
+  bool _readMoov(ISOBMFFReader *reader, const ISOBMFFBox &moov);
+  bool _readSidx(ISOBMFFReader *reader, const ISOBMFFBox &sidx);
+  bool _scanFragments(ISOBMFFReader *reader, std::streamsize offset);
+  bool _readMoof(ISOBMFFReader *reader, const ISOBMFFBox &moof,
+                 uint64_t *time, uint64_t *timescale);
+  bool _readFrames(ISOBMFFReader *reader, const ISOBMFFBox &moof,
+                   std::streamsize segmentOffset, std::streamsize segmentEnd,
+                   std::vector<MediaFrame> *frames);
+  void _addFragment(std::streamsize offset, std::streamsize length,
+                    uint64_t time, uint64_t timescale);
+
+  DataStreamInterface *_dataStream;
+  std::streamsize _initOffset;
+  std::streamsize _initLength;
+  std::map<uint32_t, uint32_t> _timescales;
   std::vector<uint32_t> _timecodes;
+  std::vector<std::streamsize> _offsets;
+  std::vector<std::streamsize> _lengths;
+  ISOBMFFFragmenter _fragmenter;
+  bool _fragmenting;
 };
 
 }  // namespace peeracle
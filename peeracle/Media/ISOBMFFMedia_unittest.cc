@@ -20,6 +20,8 @@
  * SOFTWARE.
  */
 
+#include <cstring>
+#include <vector>
 #include "third_party/googletest/gtest/include/gtest/gtest.h"
 #include "peeracle/DataStream/FileDataStream.h"
 #include "peeracle/DataStream/MemoryDataStream.h"
@@ -113,18 +115,106 @@ unsigned char _expectedInitBytes[] = {
 
 unsigned int _expectedInitLength = 943;
 
+static void put32(uint32_t value, std::vector<uint8_t> *out) {
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    out->push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+static void put64(uint64_t value, std::vector<uint8_t> *out) {
+  put32(static_cast<uint32_t>(value >> 32), out);
+  put32(static_cast<uint32_t>(value), out);
+}
+
+static std::vector<uint8_t> box(const char *type,
+                                const std::vector<uint8_t> &payload,
+                                bool largeSize = false) {
+  std::vector<uint8_t> result;
+
+  put32(largeSize ? 1 : static_cast<uint32_t>(payload.size() + 8), &result);
+  result.insert(result.end(), type, type + 4);
+  if (largeSize) {
+    put64(payload.size() + 16, &result);
+  }
+  result.insert(result.end(), payload.begin(), payload.end());
+  return result;
+}
+
+static std::vector<uint8_t> fullBox(const char *type, uint8_t version,
+                                    const std::vector<uint8_t> &payload) {
+  std::vector<uint8_t> header;
+
+  put32(static_cast<uint32_t>(version) << 24, &header);
+  header.insert(header.end(), payload.begin(), payload.end());
+  return box(type, header);
+}
+
+static void append(std::vector<uint8_t> *out,
+                   const std::vector<uint8_t> &bytes) {
+  out->insert(out->end(), bytes.begin(), bytes.end());
+}
+
+static std::vector<uint8_t> track(uint32_t trackId, uint32_t timescale) {
+  std::vector<uint8_t> tkhd;
+  std::vector<uint8_t> mdhd;
+  std::vector<uint8_t> trak;
+
+  put32(0, &tkhd);
+  put32(0, &tkhd);
+  put32(trackId, &tkhd);
+  tkhd.resize(80);
+  put64(0, &mdhd);
+  put64(0, &mdhd);
+  put32(timescale, &mdhd);
+  put64(0, &mdhd);
+  put32(0, &mdhd);
+
+  append(&trak, fullBox("tkhd", 0, tkhd));
+  append(&trak, box("mdia", fullBox("mdhd", 1, mdhd)));
+  return box("trak", trak);
+}
+
 class ISOBMFFMediaTest : public testing::Test {
  protected:
   ISOBMFFMediaTest() : _media(NULL), _ISOBMFFToTest(NULL) {
   }
 
+  // Follow the sample init segment with fragments of 2 seconds of its
+  // video track, track 1 with a timescale of 12288.
   virtual void SetUp() {
+    DataStreamInit dsInit;
+    std::vector<uint8_t> bytes(_expectedInitBytes,
+                               _expectedInitBytes + _expectedInitLength);
+
+    for (uint32_t i = 0; i < 30; ++i) {
+      std::vector<uint8_t> tfhd;
+      std::vector<uint8_t> time;
+      std::vector<uint8_t> traf;
+      std::vector<uint8_t> moof;
+
+      put32(1, &tfhd);
+      put64(i * 24576ULL, &time);
+      append(&traf, fullBox("tfhd", 0, tfhd));
+      append(&traf, fullBox("tfdt", 1, time));
+      append(&moof, fullBox("mfhd", 0, std::vector<uint8_t>(4, i)));
+      append(&moof, box("traf", traf));
+      append(&bytes, box("moof", moof));
+      append(&bytes, box("mdat", std::vector<uint8_t>(64, 0x5a)));
+      _expectedTimecodes.push_back(i * 2000);
+    }
+
+    _ISOBMFFToTest = new MemoryDataStream(dsInit);
+    _ISOBMFFToTest->write(reinterpret_cast<const char *>(&bytes[0]),
+                          bytes.size());
+    _ISOBMFFToTest->seek(0);
+
     _media = new ISOBMFFMedia();
-    _media->Load(NULL);
+    ASSERT_TRUE(_media->Load(_ISOBMFFToTest));
   }
 
   virtual void TearDown() {
     delete _media;
+    delete _ISOBMFFToTest;
   }
 
   std::vector<uint32_t> _expectedTimecodes;
@@ -140,6 +230,7 @@ TEST_F(ISOBMFFMediaTest, getInitSegment) {
   uint8_t *actualBytes;
 
   _media->getInitSegment(actualDS);
+  actualDS->seek(0);
 
   ASSERT_EQ(_expectedInitLength, actualDS->length());
 
@@ -150,7 +241,7 @@ TEST_F(ISOBMFFMediaTest, getInitSegment) {
     EXPECT_EQ(_expectedInitBytes[i], actualBytes[i]);
   }
 
-  delete actualBytes;
+  delete[] actualBytes;
   delete actualDS;
 }
 
@@ -164,6 +255,194 @@ TEST_F(ISOBMFFMediaTest, getMediaSegment) {
   }
 }
 
+class ISOBMFFMediaParseTest : public testing::Test {
+ protected:
+  ISOBMFFMediaParseTest() : _ds(NULL), _initLength(0) {
+  }
+
+  virtual void SetUp() {
+    DataStreamInit dsInit;
+
+    _ds = new MemoryDataStream(dsInit);
+  }
+
+  virtual void TearDown() {
+    delete _ds;
+  }
+
+  // Write a fragmented MP4 file of 4 fragments of 2 seconds of the video
+  // track, the last mdat with a 64 bits size. \p sidx adds an index,
+  // \p hierarchical makes it reference other indexes, and fragments start
+  // with a styp box when \p styp is set. Fragments have a decode time only
+  // when \p tfdt is set.
+  void write(bool sidx, bool hierarchical, bool styp, bool tfdt) {
+    std::vector<uint8_t> moov;
+    std::vector<uint8_t> fragments;
+    std::vector<uint8_t> index;
+
+    _bytes = box("ftyp", std::vector<uint8_t>(16, 'i'));
+    append(&moov, track(2, 48000));
+    append(&moov, track(1, 90000));
+    append(&_bytes, box("moov", moov));
+    _initLength = _bytes.size();
+
+    put32(1, &index);
+    put32(90000, &index);
+    put32(0, &index);
+    put32(0, &index);
+    put32(4, &index);
+
+    _fragments.clear();
+    _timecodes.clear();
+    for (uint32_t i = 0; i < 4; ++i) {
+      std::vector<uint8_t> fragment;
+      std::vector<uint8_t> tfhd;
+      std::vector<uint8_t> traf;
+      std::vector<uint8_t> time;
+      std::vector<uint8_t> moof;
+
+      put32(1, &tfhd);
+      append(&traf, fullBox("tfhd", 0, tfhd));
+      if (tfdt) {
+        put64(i * 180000ULL, &time);
+        append(&traf, fullBox("tfdt", 1, time));
+      }
+      append(&moof, fullBox("mfhd", 0, std::vector<uint8_t>(4, i)));
+      append(&moof, box("traf", traf));
+
+      if (styp) {
+        append(&fragment, box("styp", std::vector<uint8_t>(8, 's')));
+      }
+      append(&fragment, box("moof", moof));
+      append(&fragment, box("mdat", std::vector<uint8_t>(200 + i * 31, i),
+                            i == 3));
+      _fragments.push_back(fragment);
+      _timecodes.push_back(i * 2000);
+      append(&fragments, fragment);
+
+      put32(static_cast<uint32_t>(fragment.size()) |
+            (hierarchical ? 0x80000000 : 0), &index);
+      put32(180000, &index);
+      put32(0x90000000, &index);
+    }
+
+    if (sidx) {
+      append(&_bytes, fullBox("sidx", 0, index));
+    }
+    append(&_bytes, fragments);
+
+    _ds->write(reinterpret_cast<const char *>(&_bytes[0]), _bytes.size());
+    _ds->seek(0);
+  }
+
+  void expectSegments(ISOBMFFMedia *media) {
+    DataStreamInit dsInit;
+    MemoryDataStream init(dsInit);
+    std::streamsize offset;
+    std::streamsize length;
+
+    media->getInitSegment(&init);
+    ASSERT_EQ(_initLength, init.length());
+    EXPECT_EQ(0, memcmp(&_bytes[0], init.getBuffer(), _initLength));
+    ASSERT_TRUE(media->getInitSegmentRange(&offset, &length));
+    EXPECT_EQ(0, offset);
+    EXPECT_EQ(_initLength, length);
+
+    ASSERT_EQ(_timecodes, media->getTimecodes());
+    for (size_t i = 0; i < _timecodes.size(); ++i) {
+      MemoryDataStream segment(dsInit);
+
+      media->getMediaSegment(_timecodes[i], &segment);
+      ASSERT_EQ(_fragments[i].size(), segment.length());
+      EXPECT_EQ(0, memcmp(&_fragments[i][0], segment.getBuffer(),
+                          _fragments[i].size()));
+
+      ASSERT_TRUE(media->getMediaSegmentRange(_timecodes[i], &offset,
+                                              &length));
+      ASSERT_EQ(_fragments[i].size(), length);
+      EXPECT_EQ(0, memcmp(&_fragments[i][0], &_bytes[offset],
+                          _fragments[i].size()));
+    }
+    EXPECT_FALSE(media->getMediaSegmentRange(1, &offset, &length));
+  }
+
+  MemoryDataStream *_ds;
+  std::vector<uint8_t> _bytes;
+  size_t _initLength;
+  std::vector<std::vector<uint8_t> > _fragments;
+  std::vector<uint32_t> _timecodes;
+};
+
+TEST_F(ISOBMFFMediaParseTest, Sidx) {
+  ISOBMFFMedia media;
+
+  // Without tfdt boxes, only the sidx gives the fragment times.
+  write(true, false, false, false);
+  ASSERT_TRUE(media.Load(_ds));
+  expectSegments(&media);
+}
+
+TEST_F(ISOBMFFMediaParseTest, FragmentScan) {
+  ISOBMFFMedia media;
+
+  write(false, false, false, true);
+  ASSERT_TRUE(media.Load(_ds));
+  expectSegments(&media);
+}
+
+TEST_F(ISOBMFFMediaParseTest, SegmentTypes) {
+  ISOBMFFMedia media;
+
+  write(false, false, true, true);
+  ASSERT_TRUE(media.Load(_ds));
+  expectSegments(&media);
+}
+
+TEST_F(ISOBMFFMediaParseTest, HierarchicalSidx) {
+  ISOBMFFMedia media;
+
+  write(true, true, false, true);
+  ASSERT_TRUE(media.Load(_ds));
+  expectSegments(&media);
+}
+
+TEST_F(ISOBMFFMediaParseTest, InitSegmentOnly) {
+  ISOBMFFMedia media;
+  DataStreamInit dsInit;
+  MemoryDataStream init(dsInit);
+
+  _ds->write(reinterpret_cast<const char *>(_expectedInitBytes),
+             _expectedInitLength);
+  _ds->seek(0);
+  ASSERT_TRUE(media.Load(_ds));
+  EXPECT_TRUE(media.getTimecodes().empty());
+
+  media.getInitSegment(&init);
+  ASSERT_EQ(_expectedInitLength, init.length());
+  EXPECT_EQ(0, memcmp(_expectedInitBytes, init.getBuffer(),
+                      _expectedInitLength));
+}
+
+TEST_F(ISOBMFFMediaParseTest, Corrupted) {
+  ISOBMFFMedia media;
+  DataStreamInit dsInit;
+  MemoryDataStream noMoov(dsInit);
+
+  EXPECT_FALSE(media.Load(NULL));
+
+  write(false, false, false, true);
+  noMoov.write(reinterpret_cast<const char *>(&_bytes[0]), 24);
+  noMoov.seek(0);
+  EXPECT_FALSE(media.Load(&noMoov));
+}
+
+TEST_F(ISOBMFFMediaParseTest, NoDecodeTime) {
+  ISOBMFFMedia media;
+
+  write(false, false, false, false);
+  EXPECT_FALSE(media.Load(_ds));
+}
+
 }  // namespace Media
 
 }  // namespace peeracle
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "peeracle/Media/ISOBMFFReader.h"
+
+namespace peeracle {
+
+ISOBMFFReader::ISOBMFFReader(DataStreamInterface *dataStream)
+  : _dataStream(dataStream) {
+}
+
+bool ISOBMFFReader::readBox(ISOBMFFBox *box) {
+  uint64_t size;
+  uint64_t type;
+
+  box->offset = _dataStream->tell();
+  if (!readUnsigned(4, &size) || !readUnsigned(4, &type) ||
+      (size == 1 && !readUnsigned(8, &size))) {
+    return false;
+  }
+
+  box->type = static_cast<uint32_t>(type);
+  box->dataOffset = _dataStream->tell();
+  if (!size) {
+    size = static_cast<uint64_t>(_dataStream->length() - box->offset);
+  }
+
+  box->size = size;
+  return size >= static_cast<uint64_t>(box->dataOffset - box->offset);
+}
+
+bool ISOBMFFReader::readUnsigned(int length, uint64_t *value) {
+  uint8_t bytes[8];
+  uint64_t result = 0;
+
+  if (length < 1 || length > 8 ||
+      _dataStream->read(reinterpret_cast<char *>(bytes), length) != length) {
+    return false;
+  }
+
+  for (int i = 0; i < length; ++i) {
+    result = (result << 8) | bytes[i];
+  }
+
+  *value = result;
+  return true;
+}
+
+bool ISOBMFFReader::readFullBoxHeader(uint8_t *version, uint32_t *flags) {
+  uint64_t value;
+
+  if (!readUnsigned(4, &value)) {
+    return false;
+  }
+
+  *version = static_cast<uint8_t>(value >> 24);
+  *flags = static_cast<uint32_t>(value & 0xFFFFFF);
+  return true;
+}
+
+bool ISOBMFFReader::skip(const ISOBMFFBox &box) {
+  return seek(getEnd(box));
+}
+
+bool ISOBMFFReader::seek(std::streamsize offset) {
+  return _dataStream->seek(offset) == offset;
+}
+
+std::streamsize ISOBMFFReader::tell() {
+  return _dataStream->tell();
+}
+
+std::streamsize ISOBMFFReader::getEnd(const ISOBMFFBox &box) {
+  return box.offset + static_cast<std::streamsize>(box.size);
+}
+
+}  // namespace peeracle
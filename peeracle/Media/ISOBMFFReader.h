@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_MEDIA_ISOBMFFREADER_H_
+#define PEERACLE_MEDIA_ISOBMFFREADER_H_
+
+#include <stdint.h>
+#include "peeracle/DataStream/DataStreamInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Header of an ISOBMFF box.
+ */
+struct ISOBMFFBox {
+  ISOBMFFBox()
+    : type(0),
+      size(0),
+      offset(0),
+      dataOffset(0) {
+  }
+
+  /**
+   * The box type, its four characters read as a big-endian integer
+   * (0x6D6F6F76 for "moov").
+   */
+  uint32_t type;
+
+  /**
+   * The size of the whole box, header included. A box whose header gives
+   * a size of 0 extends to the end of the data stream.
+   */
+  uint64_t size;
+
+  /**
+   * Offsets of the box header and of its payload in the data stream.
+   */
+  std::streamsize offset;
+  std::streamsize dataOffset;
+};
+
+/**
+ * Read ISOBMFF box headers and big-endian fields from a data stream,
+ * whatever the data stream byte order. Payloads are skipped by seeking
+ * past them.
+ * \addtogroup Media
+ */
+class ISOBMFFReader {
+ public:
+  explicit ISOBMFFReader(DataStreamInterface *dataStream);
+
+  /**
+   * Read the box header at the current position, leaving the stream at
+   * the start of its payload.
+   */
+  bool readBox(ISOBMFFBox *box);
+
+  /**
+   * Read a big-endian unsigned integer of \p length bytes, up to 8.
+   */
+  bool readUnsigned(int length, uint64_t *value);
+
+  /**
+   * Read the version and flags of a full box.
+   */
+  bool readFullBoxHeader(uint8_t *version, uint32_t *flags);
+
+  /**
+   * Move to the end of \p box.
+   */
+  bool skip(const ISOBMFFBox &box);
+
+  bool seek(std::streamsize offset);
+  std::streamsize tell();
+
+  static std::streamsize getEnd(const ISOBMFFBox &box);
+
+ private:
+  DataStreamInterface *_dataStream;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_MEDIA_ISOBMFFREADER_H_
@@ -32,9 +32,19 @@
         '../DataStream/DataStream.gyp:peeracle_datastream',
       ],
       'sources': [
+        'EBMLReader.cc',
+        'EBMLReader.h',
+        'MediaFactory.cc',
+        'MediaFactory.h',
         'MediaInterface.h',
+        'ISOBMFFFragmenter.cc',
+        'ISOBMFFFragmenter.h',
         'ISOBMFFMedia.cc',
         'ISOBMFFMedia.h',
+        'ISOBMFFReader.cc',
+        'ISOBMFFReader.h',
+        'SegmentListMedia.cc',
+        'SegmentListMedia.h',
         'WebMMedia.cc',
         'WebMMedia.h',
       ]
@@ -48,14 +58,45 @@
           'type': 'executable',
           'dependencies': [
             'peeracle_media',
+            '<(DEPTH)/test/test.gyp:peeracle_benchmark_utils',
             '<(DEPTH)/test/test.gyp:peeracle_tests_utils',
           ],
           'sources': [
+            'EBMLReader_unittest.cc',
+            'ISOBMFFFragmenter_unittest.cc',
             'ISOBMFFMedia_unittest.cc',
+            'MediaFactory_unittest.cc',
+            'SegmentListMedia_unittest.cc',
             'WebMMedia_unittest.cc',
           ],
         },
       ],
     }],
+    ['build_benchmarks == 1', {
+      'targets': [
+        {
+          'target_name': 'peeracle_media_webm_benchmark',
+          'type': 'executable',
+          'dependencies': [
+            'peeracle_media',
+            '<(DEPTH)/test/test.gyp:peeracle_benchmark_utils',
+          ],
+          'sources': [
+            'WebMMedia_benchmark.cc',
+          ],
+        },
+        {
+          'target_name': 'peeracle_media_load_benchmark',
+          'type': 'executable',
+          'dependencies': [
+            'peeracle_media',
+            '<(DEPTH)/test/test.gyp:peeracle_benchmark_utils',
+          ],
+          'sources': [
+            'MediaLoad_benchmark.cc',
+          ],
+        },
+      ],
+    }],
   ],
 }
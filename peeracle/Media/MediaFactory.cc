@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "peeracle/Media/ISOBMFFMedia.h"
+#include "peeracle/Media/MediaFactory.h"
+#include "peeracle/Media/WebMMedia.h"
+
+namespace peeracle {
+
+// The EBML header id, and the box size and type of an ISO BMFF file.
+static const std::streamsize kSniffLength = 8;
+
+MediaFactory::Format MediaFactory::detect(DataStreamInterface *dataStream) {
+  uint8_t bytes[kSniffLength];
+  uint32_t size;
+
+  if (!dataStream ||
+      dataStream->peek(bytes, kSniffLength) != kSniffLength) {
+    return kUnknown;
+  }
+
+  if (bytes[0] == 0x1A && bytes[1] == 0x45 && bytes[2] == 0xDF &&
+      bytes[3] == 0xA3) {
+    return kWebM;
+  }
+
+  // A size of 1 is followed by a 64-bit size, anything else below the
+  // header length is invalid.
+  size = (static_cast<uint32_t>(bytes[0]) << 24) | (bytes[1] << 16) |
+    (bytes[2] << 8) | bytes[3];
+  if ((size == 1 || size >= kSniffLength) &&
+      ((bytes[4] == 'f' && bytes[5] == 't' && bytes[6] == 'y' &&
+        bytes[7] == 'p') ||
+       (bytes[4] == 's' && bytes[5] == 't' && bytes[6] == 'y' &&
+        bytes[7] == 'p'))) {
+    return kISOBMFF;
+  }
+
+  return kUnknown;
+}
+
+MediaInterface *MediaFactory::create(Format format) {
+  switch (format) {
+    case kWebM:
+      return new WebMMedia();
+    case kISOBMFF:
+      return new ISOBMFFMedia();
+    default:
+      return NULL;
+  }
+}
+
+MediaInterface *MediaFactory::load(DataStreamInterface *dataStream) {
+  MediaInterface *media = create(detect(dataStream));
+
+  if (media && !media->Load(dataStream)) {
+    delete media;
+    return NULL;
+  }
+  return media;
+}
+
+}  // namespace peeracle
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_MEDIA_MEDIAFACTORY_H_
+#define PEERACLE_MEDIA_MEDIAFACTORY_H_
+
+#include "peeracle/DataStream/DataStreamInterface.h"
+#include "peeracle/Media/MediaInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Pick the MediaInterface implementation of a file from its first bytes,
+ * so that a library of WebM and MP4 files can be processed without
+ * knowing the format of each file in advance.
+ * \addtogroup Media
+ */
+class MediaFactory {
+ public:
+  enum Format {
+    kUnknown,
+    kWebM,
+    kISOBMFF
+  };
+
+  /**
+   * Detect the format of the media at the current position of
+   * \p dataStream, from the EBML magic number or from a leading ftyp or
+   * styp box. The position is left unchanged.
+   */
+  static Format detect(DataStreamInterface *dataStream);
+
+  /**
+   * Create the media of \p format, or NULL for kUnknown.
+   */
+  static MediaInterface *create(Format format);
+
+  /**
+   * Detect the format of \p dataStream and load it.
+   * \return the loaded media, to be deleted by the caller, or NULL if the
+   * format is unknown or the media can not be loaded.
+   */
+  static MediaInterface *load(DataStreamInterface *dataStream);
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_MEDIA_MEDIAFACTORY_H_
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Media/MediaFactory.h"
+
+namespace peeracle {
+
+// An EBML header, then a Segment with an Info element and no Cluster.
+static const uint8_t kWebM[] = {
+  0x1A, 0x45, 0xDF, 0xA3, 0x84, 0x42, 0x82, 0x81, 0x77,
+  0x18, 0x53, 0x80, 0x67, 0x88,
+  0x15, 0x49, 0xA9, 0x66, 0x83, 0xE7, 0x81, 0x00
+};
+
+// An ftyp box, then an empty moov box.
+static const uint8_t kMP4[] = {
+  0x00, 0x00, 0x00, 0x10, 'f', 't', 'y', 'p',
+  'i', 's', 'o', '6', 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x08, 'm', 'o', 'o', 'v'
+};
+
+class MediaFactoryTest : public testing::Test {
+ protected:
+  MediaFactoryTest() : _ds(_dsInit) {
+  }
+
+  void write(const uint8_t *bytes, size_t length) {
+    _ds.write(reinterpret_cast<const char *>(bytes),
+              static_cast<std::streamsize>(length));
+    _ds.seek(0);
+  }
+
+  DataStreamInit _dsInit;
+  MemoryDataStream _ds;
+};
+
+TEST_F(MediaFactoryTest, WebM) {
+  MediaInterface *media;
+
+  write(kWebM, sizeof(kWebM));
+  EXPECT_EQ(MediaFactory::kWebM, MediaFactory::detect(&_ds));
+  EXPECT_EQ(0, _ds.tell());
+
+  media = MediaFactory::load(&_ds);
+  ASSERT_TRUE(media != NULL);
+  EXPECT_TRUE(media->getTimecodes().empty());
+  delete media;
+}
+
+TEST_F(MediaFactoryTest, ISOBMFF) {
+  const uint8_t styp[] = {
+    0x00, 0x00, 0x00, 0x01, 's', 't', 'y', 'p'
+  };
+  std::streamsize offset;
+  std::streamsize length;
+  MediaInterface *media;
+
+  write(kMP4, sizeof(kMP4));
+  EXPECT_EQ(MediaFactory::kISOBMFF, MediaFactory::detect(&_ds));
+  EXPECT_EQ(0, _ds.tell());
+
+  media = MediaFactory::load(&_ds);
+  ASSERT_TRUE(media != NULL);
+  ASSERT_TRUE(media->getInitSegmentRange(&offset, &length));
+  EXPECT_EQ(sizeof(kMP4), length);
+  delete media;
+
+  // A media segment starts with a styp box, here with a 64-bit size.
+  _ds.seek(0);
+  write(styp, sizeof(styp));
+  EXPECT_EQ(MediaFactory::kISOBMFF, MediaFactory::detect(&_ds));
+}
+
+TEST_F(MediaFactoryTest, DetectFromCurrentPosition) {
+  _ds.write("junk", 4);
+  _ds.write(reinterpret_cast<const char *>(kWebM), sizeof(kWebM));
+  _ds.seek(0);
+  EXPECT_EQ(MediaFactory::kUnknown, MediaFactory::detect(&_ds));
+  _ds.seek(4);
+  EXPECT_EQ(MediaFactory::kWebM, MediaFactory::detect(&_ds));
+  EXPECT_EQ(4, _ds.tell());
+}
+
+TEST_F(MediaFactoryTest, Unknown) {
+  const uint8_t badSize[] = {
+    0x00, 0x00, 0x00, 0x04, 'f', 't', 'y', 'p'
+  };
+
+  EXPECT_EQ(MediaFactory::kUnknown, MediaFactory::detect(NULL));
+  EXPECT_EQ(MediaFactory::kUnknown, MediaFactory::detect(&_ds));
+  EXPECT_TRUE(MediaFactory::load(NULL) == NULL);
+  EXPECT_TRUE(MediaFactory::create(MediaFactory::kUnknown) == NULL);
+
+  // Shorter than the bytes needed to tell.
+  write(kWebM, 4);
+  EXPECT_EQ(MediaFactory::kUnknown, MediaFactory::detect(&_ds));
+
+  write(badSize, sizeof(badSize));
+  EXPECT_EQ(MediaFactory::kUnknown, MediaFactory::detect(&_ds));
+}
+
+TEST_F(MediaFactoryTest, LoadFailure) {
+  // Detected as an MP4 file, but without a moov box.
+  write(kMP4, 16);
+  EXPECT_EQ(MediaFactory::kISOBMFF, MediaFactory::detect(&_ds));
+  EXPECT_TRUE(MediaFactory::load(&_ds) == NULL);
+}
+
+}  // namespace peeracle
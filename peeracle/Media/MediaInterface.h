@@ -36,6 +36,36 @@
  */
 namespace peeracle {
 
+/**
+ * A frame of a media segment: a SimpleBlock or BlockGroup of a WebM
+ * Cluster, or a sample of an MP4 track fragment run.
+ */
+struct MediaFrame {
+  MediaFrame()
+    : offset(0),
+      length(0),
+      track(0),
+      timecode(0),
+      keyframe(false) {
+  }
+
+  /**
+   * The range of the frame in the media segment, from the start of the
+   * bytes getMediaSegment() writes. A WebM frame range covers its element
+   * header, an MP4 frame range only covers the sample data.
+   */
+  std::streamsize offset;
+  std::streamsize length;
+
+  uint32_t track;
+
+  /**
+   * The decode time of the frame in milliseconds.
+   */
+  uint32_t timecode;
+  bool keyframe;
+};
+
 /**
  * Media module interface.
  * \addtogroup Media
@@ -58,12 +88,41 @@ class MediaInterface {
   virtual void getMediaSegment(std::streampos timecode,
                                DataStreamInterface *out) = 0;
 
+  /**
+   * Get the range of the initialization segment in the data stream given
+   * to Load(), so that it can be served through a ViewDataStream, or
+   * straight from a file mapping, instead of being copied.
+   * \return false if the media is not loaded, or if its initialization
+   * segment is generated rather than stored in the data stream.
+   */
+  virtual bool getInitSegmentRange(std::streamsize *offset,
+                                   std::streamsize *length) = 0;
+
+  /**
+   * Get the range of the media segment of \p timecode in the data stream
+   * given to Load(), as getInitSegmentRange() does.
+   * \return false if there is no media segment at \p timecode, or if it
+   * is generated.
+   */
+  virtual bool getMediaSegmentRange(std::streampos timecode,
+                                    std::streamsize *offset,
+                                    std::streamsize *length) = 0;
+
+  /**
+   * List the frames of the media segment of \p timecode, ordered by
+   * offset, so that a player can demux the start of a segment before the
+   * rest of it is received.
+   * \return false if there is no media segment at \p timecode, if it can
+   * not be parsed, or if the media does not know its frames.
+   */
+  virtual bool getMediaSegmentFrames(std::streampos timecode,
+                                     std::vector<MediaFrame> *frames) = 0;
+
   /**
    * Get a list of timecodes.
    */
   virtual const std::vector<uint32_t> &getTimecodes() const = 0;
 
- protected:
   virtual ~MediaInterface() {}
 };
 
@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/FileDataStream.h"
+#include "peeracle/DataStream/MappedDataStream.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Media/ISOBMFFMedia.h"
+#include "peeracle/Media/WebMMedia.h"
+#include "test/benchmark.h"
+
+// Every allocation is prefixed with its size, so that the benchmark can
+// track the heap kept by a loaded media: its segment index.
+static const size_t kHeaderSize = 16;
+static uint64_t gHeapBytes = 0;
+
+static void *countedAlloc(size_t size) {
+  uint8_t *block = static_cast<uint8_t *>(malloc(size + kHeaderSize));
+
+  if (!block) {
+    throw std::bad_alloc();
+  }
+
+  *reinterpret_cast<size_t *>(block) = size;
+  gHeapBytes += size;
+  return block + kHeaderSize;
+}
+
+static void countedFree(void *pointer) {
+  uint8_t *block;
+
+  if (!pointer) {
+    return;
+  }
+
+  block = static_cast<uint8_t *>(pointer) - kHeaderSize;
+  gHeapBytes -= *reinterpret_cast<size_t *>(block);
+  free(block);
+}
+
+void *operator new(size_t size) {
+  return countedAlloc(size);
+}
+
+void *operator new[](size_t size) {
+  return countedAlloc(size);
+}
+
+void operator delete(void *pointer) throw() {
+  countedFree(pointer);
+}
+
+void operator delete[](void *pointer) throw() {
+  countedFree(pointer);
+}
+
+namespace peeracle {
+
+static const int64_t kMinNanos = 500000000;
+static const char *kFilePath = "MediaLoad_benchmark.tmp";
+static const uint32_t kSegmentDuration = 2000;
+static const uint32_t kFramesPerSegment = 60;
+
+// Forward every call to a data stream, counting the bytes read or peeked
+// and the seeks that move the read position.
+class CountingDataStream : public DataStreamInterface {
+ public:
+  explicit CountingDataStream(DataStreamInterface *dataStream)
+    : _dataStream(dataStream), _bytesRead(0), _seeks(0) {
+  }
+
+  bool open() {
+    return _dataStream->open();
+  }
+
+  void close() {
+    _dataStream->close();
+  }
+
+  std::streamsize length() const {
+    return _dataStream->length();
+  }
+
+  std::streamsize tell() const {
+    return _dataStream->tell();
+  }
+
+  std::streamsize seek(std::streamsize position) {
+    if (position != _dataStream->tell()) {
+      ++_seeks;
+    }
+    return _dataStream->seek(position);
+  }
+
+  std::streamsize read(char *buffer, std::streamsize length) {
+    return _count(_dataStream->read(buffer, length));
+  }
+
+  std::streamsize read(int8_t *buffer) {
+    return _count(_dataStream->read(buffer));
+  }
+
+  std::streamsize read(uint8_t *buffer) {
+    return _count(_dataStream->read(buffer));
+  }
+
+  std::streamsize read(int16_t *buffer) {
+    return _count(_dataStream->read(buffer));
+  }
+
+  std::streamsize read(uint16_t *buffer) {
+    return _count(_dataStream->read(buffer));
+  }
+
+  std::streamsize read(int32_t *buffer) {
+    return _count(_dataStream->read(buffer));
+  }
+
+  std::streamsize read(uint32_t *buffer) {
+    return _count(_dataStream->read(buffer));
+  }
+
+  std::streamsize read(float *buffer) {
+    return _count(_dataStream->read(buffer));
+  }
+
+  std::streamsize read(double *buffer) {
+    return _count(_dataStream->read(buffer));
+  }
+
+  std::streamsize read(std::string *buffer) {
+    return _count(_dataStream->read(buffer));
+  }
+
+  std::streamsize peek(uint8_t *buffer, std::streamsize length) {
+    return _count(_dataStream->peek(buffer, length));
+  }
+
+  std::streamsize peek(int8_t *buffer) {
+    return _count(_dataStream->peek(buffer));
+  }
+
+  std::streamsize peek(uint8_t *buffer) {
+    return _count(_dataStream->peek(buffer));
+  }
+
+  std::streamsize peek(int16_t *buffer) {
+    return _count(_dataStream->peek(buffer));
+  }
+
+  std::streamsize peek(uint16_t *buffer) {
+    return _count(_dataStream->peek(buffer));
+  }
+
+  std::streamsize peek(int32_t *buffer) {
+    return _count(_dataStream->peek(buffer));
+  }
+
+  std::streamsize peek(uint32_t *buffer) {
+    return _count(_dataStream->peek(buffer));
+  }
+
+  std::streamsize peek(float *buffer) {
+    return _count(_dataStream->peek(buffer));
+  }
+
+  std::streamsize peek(double *buffer) {
+    return _count(_dataStream->peek(buffer));
+  }
+
+  std::streamsize peek(std::string *buffer) {
+    return _count(_dataStream->peek(buffer));
+  }
+
+  std::streamsize write(const char *buffer, std::streamsize length) {
+    return _dataStream->write(buffer, length);
+  }
+
+  std::streamsize write(int8_t value) {
+    return _dataStream->write(value);
+  }
+
+  std::streamsize write(uint8_t value) {
+    return _dataStream->write(value);
+  }
+
+  std::streamsize write(int16_t value) {
+    return _dataStream->write(value);
+  }
+
+  std::streamsize write(uint16_t value) {
+    return _dataStream->write(value);
+  }
+
+  std::streamsize write(int32_t value) {
+    return _dataStream->write(value);
+  }
+
+  std::streamsize write(uint32_t value) {
+    return _dataStream->write(value);
+  }
+
+  std::streamsize write(float value) {
+    return _dataStream->write(value);
+  }
+
+  std::streamsize write(double value) {
+    return _dataStream->write(value);
+  }
+
+  std::streamsize write(const std::string &value) {
+    return _dataStream->write(value);
+  }
+
+  uint64_t getBytesRead() const {
+    return _bytesRead;
+  }
+
+  uint64_t getSeeks() const {
+    return _seeks;
+  }
+
+ private:
+  std::streamsize _count(std::streamsize result) {
+    if (result > 0) {
+      _bytesRead += static_cast<uint64_t>(result);
+    }
+    return result;
+  }
+
+  DataStreamInterface *_dataStream;
+  uint64_t _bytesRead;
+  uint64_t _seeks;
+};
+
+class LoadCase : public Benchmark::Case {
+ public:
+  LoadCase(DataStreamInterface *in, bool webm)
+    : _in(in), _webm(webm), _segmentCount(0), _indexBytes(0) {
+  }
+
+  void run() {
+    if (_webm) {
+      WebMMedia media;
+
+      _load(&media);
+    } else {
+      ISOBMFFMedia media;
+
+      _load(&media);
+    }
+  }
+
+  size_t getSegmentCount() const {
+    return _segmentCount;
+  }
+
+  uint64_t getIndexBytes() const {
+    return _indexBytes;
+  }
+
+ private:
+  void _load(MediaInterface *media) {
+    uint64_t heapBytes = gHeapBytes;
+
+    _in->seek(0);
+    _segmentCount = media->Load(_in) ? media->getTimecodes().size() : 0;
+    _indexBytes = gHeapBytes - heapBytes;
+  }
+
+  DataStreamInterface *_in;
+  bool _webm;
+  size_t _segmentCount;
+  uint64_t _indexBytes;
+};
+
+static bool addRow(BenchmarkTable *table, const std::string &name,
+                   DataStreamInterface *in, bool webm,
+                   uint32_t segmentCount) {
+  CountingDataStream counting(in);
+  LoadCase load(in, webm);
+  LoadCase counted(&counting, webm);
+  double nanos;
+
+  // A first load warms up the stream buffers and the page cache, a counted
+  // load gives the figures, then the plain load is timed.
+  load.run();
+  counted.run();
+  if (load.getSegmentCount() != segmentCount ||
+      counted.getSegmentCount() != segmentCount) {
+    std::cerr << "unable to load the media from " << name << std::endl;
+    return false;
+  }
+
+  nanos = Benchmark::measure(&load, kMinNanos);
+  table->addRow();
+  table->addCell(name);
+  table->addCell(Benchmark::formatTime(nanos));
+  table->addCell(Benchmark::formatSize(static_cast<double>(
+    counting.getBytesRead())));
+  table->addCell(Benchmark::formatCount(static_cast<double>(
+    counting.getSeeks())));
+  table->addCell(Benchmark::formatSize(static_cast<double>(
+    counted.getIndexBytes())));
+  return true;
+}
+
+static bool run(const std::string &name, const std::vector<uint8_t> &bytes,
+                bool webm, uint32_t segmentCount) {
+  DataStreamInit dsInit;
+  MemoryDataStream memory(dsInit);
+  FileDataStream *writer;
+  FileDataStream *file;
+  MappedDataStream *mapped;
+  std::streamsize length = static_cast<std::streamsize>(bytes.size());
+  bool result;
+
+  memory.write(reinterpret_cast<const char *>(&bytes[0]), length);
+
+  dsInit.path = kFilePath;
+  dsInit.create = true;
+  remove(kFilePath);
+  writer = new FileDataStream(dsInit);
+  result = writer->open() &&
+    writer->write(reinterpret_cast<const char *>(&bytes[0]), length) ==
+    length;
+  delete writer;
+  if (!result) {
+    std::cerr << "unable to write " << kFilePath << std::endl;
+    remove(kFilePath);
+    return false;
+  }
+
+  BenchmarkTable table(name + ": " +
+                       Benchmark::formatCount(segmentCount) +
+                       " segments, " +
+                       Benchmark::formatSize(static_cast<double>(length)));
+
+  table.addColumn("source");
+  table.addColumn("load time");
+  table.addColumn("bytes read");
+  table.addColumn("seeks");
+  table.addColumn("index memory");
+
+  dsInit.create = false;
+  file = new FileDataStream(dsInit);
+  mapped = new MappedDataStream(dsInit);
+  result = file->open() && mapped->open() &&
+    addRow(&table, "memory", &memory, webm, segmentCount) &&
+    addRow(&table, "file", file, webm, segmentCount) &&
+    addRow(&table, "mmap", mapped, webm, segmentCount);
+  if (result) {
+    table.print(&std::cout);
+  }
+
+  delete mapped;
+  delete file;
+  remove(kFilePath);
+  return result;
+}
+
+static bool run(uint32_t hours) {
+  uint32_t segmentCount = hours * 3600000 / kSegmentDuration;
+  std::string duration = Benchmark::formatCount(hours) +
+    (hours > 1 ? " hours" : " hour");
+  std::vector<uint8_t> bytes;
+  SyntheticMedia media(segmentCount, kSegmentDuration, kFramesPerSegment);
+
+  media.writeWebM(true, true, &bytes);
+  if (!run("WebM with Cues, " + duration, bytes, true, segmentCount)) {
+    return false;
+  }
+
+  media.writeWebM(false, false, &bytes);
+  if (!run("WebM without Cues, " + duration, bytes, true, segmentCount)) {
+    return false;
+  }
+
+  media.writeMP4(true, &bytes);
+  if (!run("fragmented MP4 with sidx, " + duration, bytes, false,
+           segmentCount)) {
+    return false;
+  }
+
+  media.writeMP4(false, &bytes);
+  return run("fragmented MP4 without sidx, " + duration, bytes, false,
+             segmentCount);
+}
+
+}  // namespace peeracle
+
+int main(int argc, char **argv) {
+  uint32_t hours = 2;
+
+  if (argc > 1) {
+    hours = static_cast<uint32_t>(strtoul(argv[1], NULL, 10));
+  }
+
+  if (!hours) {
+    std::cerr << "usage: " << argv[0] << " [hours]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return peeracle::run(hours) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/MappedDataStream.h"
+#include "peeracle/Media/SegmentListMedia.h"
+
+namespace peeracle {
+
+SegmentListMedia::SegmentListMedia() {
+  _initSegment.offset = 0;
+  _initSegment.length = 0;
+}
+
+SegmentListMedia::~SegmentListMedia() {
+}
+
+void SegmentListMedia::setInitSegment(const std::string &path,
+                                      std::streamsize offset,
+                                      std::streamsize length) {
+  _initSegment.path = path;
+  _initSegment.offset = offset;
+  _initSegment.length = length;
+}
+
+bool SegmentListMedia::addMediaSegment(uint32_t timecode,
+                                       const std::string &path,
+                                       std::streamsize offset,
+                                       std::streamsize length) {
+  Segment segment;
+
+  if (!_timecodes.empty() && timecode <= _timecodes.back()) {
+    return false;
+  }
+
+  segment.path = path;
+  segment.offset = offset;
+  segment.length = length;
+  _segments.push_back(segment);
+  _timecodes.push_back(timecode);
+  return true;
+}
+
+bool SegmentListMedia::Load(DataStreamInterface *dataStream) {
+  if (!_initSegment.path.empty() && !_check(_initSegment)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < _segments.size(); ++i) {
+    if (!_check(_segments[i])) {
+      return false;
+    }
+  }
+
+  return !_segments.empty();
+}
+
+bool SegmentListMedia::_check(const Segment &segment) {
+  DataStreamInit dsInit;
+
+  dsInit.path = segment.path;
+  MappedDataStream file(dsInit);
+
+  return file.open() && segment.offset >= 0 &&
+    segment.offset <= file.length() && (segment.length == -1 ||
+    (segment.length >= 0 &&
+     segment.length <= file.length() - segment.offset));
+}
+
+void SegmentListMedia::_copy(const Segment &segment,
+                             DataStreamInterface *out) {
+  DataStreamInit dsInit;
+  std::streamsize length = segment.length;
+
+  dsInit.path = segment.path;
+  MappedDataStream file(dsInit);
+
+  if (!file.open() || segment.offset < 0 ||
+      segment.offset > file.length()) {
+    return;
+  }
+
+  if (length == -1 || length > file.length() - segment.offset) {
+    length = file.length() - segment.offset;
+  }
+
+  if (length > 0) {
+    out->write(reinterpret_cast<const char *>(file.getBuffer()) +
+               segment.offset, length);
+  }
+}
+
+void SegmentListMedia::getInitSegment(DataStreamInterface *out) {
+  if (!_initSegment.path.empty()) {
+    _copy(_initSegment, out);
+  }
+}
+
+void SegmentListMedia::getMediaSegment(std::streampos timecode,
+                                       DataStreamInterface *out) {
+  uint32_t value = static_cast<uint32_t>(timecode);
+  std::vector<uint32_t>::const_iterator it = std::lower_bound(
+    _timecodes.begin(), _timecodes.end(), value);
+
+  if (it != _timecodes.end() && *it == value) {
+    _copy(_segments[it - _timecodes.begin()], out);
+  }
+}
+
+// The segments are read from their own files, not from a data stream given
+// to Load().
+bool SegmentListMedia::getInitSegmentRange(std::streamsize *offset,
+                                           std::streamsize *length) {
+  return false;
+}
+
+bool SegmentListMedia::getMediaSegmentRange(std::streampos timecode,
+                                            std::streamsize *offset,
+                                            std::streamsize *length) {
+  return false;
+}
+
+// The segments are not parsed, their frames are unknown.
+bool SegmentListMedia::getMediaSegmentFrames(std::streampos timecode,
+                                             std::vector<MediaFrame> *frames) {
+  return false;
+}
+
+const std::vector<uint32_t> &SegmentListMedia::getTimecodes() const {
+  return _timecodes;
+}
+
+}  // namespace peeracle
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_MEDIA_SEGMENTLISTMEDIA_H_
+#define PEERACLE_MEDIA_SEGMENTLISTMEDIA_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "peeracle/Media/MediaInterface.h"
+
+namespace peeracle {
+
+/**
+ * Media already cut into segments, each stored in a file of its own or in
+ * a byte range of a file, as listed by a DASH or HLS manifest.
+ *
+ * The segments and their timecodes are given by the caller rather than
+ * parsed from a container, so the files are only read when a segment is
+ * requested, and only for the bytes of that segment.
+ */
+class SegmentListMedia
+  : public MediaInterface {
+ public:
+  SegmentListMedia();
+  ~SegmentListMedia();
+
+  /**
+   * Set the init segment to \p length bytes at \p offset in the file at
+   * \p path. A \p length of -1 reaches the end of the file. Without init
+   * segment, getInitSegment() writes nothing.
+   */
+  void setInitSegment(const std::string &path, std::streamsize offset,
+                      std::streamsize length);
+
+  /**
+   * Add the media segment of \p timecode, in milliseconds, stored as
+   * setInitSegment() describes.
+   * \return false if \p timecode is not greater than the one of the
+   * previous media segment.
+   */
+  bool addMediaSegment(uint32_t timecode, const std::string &path,
+                       std::streamsize offset, std::streamsize length);
+
+  /**
+   * Check that every file listed can be opened and holds the range of its
+   * segment, so that a missing file is reported before any segment is
+   * read. \p dataStream is not used.
+   */
+  bool Load(DataStreamInterface *dataStream);
+  void getInitSegment(DataStreamInterface *out);
+  void getMediaSegment(std::streampos timecode, DataStreamInterface *out);
+  bool getInitSegmentRange(std::streamsize *offset, std::streamsize *length);
+  bool getMediaSegmentRange(std::streampos timecode, std::streamsize *offset,
+                            std::streamsize *length);
+  bool getMediaSegmentFrames(std::streampos timecode,
+                             std::vector<MediaFrame> *frames);
+  const std::vector<uint32_t> &getTimecodes() const;
+
+ private:
+  struct Segment {
+    std::string path;
+    std::streamsize offset;
+    std::streamsize length;
+  };
+
+  static bool _check(const Segment &segment);
+  static void _copy(const Segment &segment, DataStreamInterface *out);
+
+  Segment _initSegment;
+  std::vector<Segment> _segments;
+  std::vector<uint32_t> _timecodes;
+};
+
+}  // namespace peeracle
+
+#endif  // PEERACLE_MEDIA_SEGMENTLISTMEDIA_H_
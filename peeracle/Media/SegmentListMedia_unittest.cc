@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/FileDataStream.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Media/SegmentListMedia.h"
+
+namespace peeracle {
+
+class SegmentListMediaTest : public testing::Test {
+ protected:
+  SegmentListMediaTest() : _path("SegmentListMedia_unittest.tmp") {
+  }
+
+  virtual void SetUp() {
+    DataStreamInit dsInit;
+
+    remove(_path.c_str());
+    dsInit.path = _path;
+    dsInit.create = true;
+    FileDataStream file(dsInit);
+    ASSERT_TRUE(file.open());
+    ASSERT_EQ(26, file.write("abcdefghijklmnopqrstuvwxyz", 26));
+  }
+
+  virtual void TearDown() {
+    remove(_path.c_str());
+  }
+
+  std::string read(int32_t timecode) {
+    DataStreamInit dsInit;
+    MemoryDataStream out(dsInit);
+
+    if (timecode < 0) {
+      _media.getInitSegment(&out);
+    } else {
+      _media.getMediaSegment(timecode, &out);
+    }
+    return std::string(reinterpret_cast<const char *>(out.getBuffer()),
+                       static_cast<size_t>(out.length()));
+  }
+
+  std::string _path;
+  SegmentListMedia _media;
+};
+
+TEST_F(SegmentListMediaTest, Ranges) {
+  std::streamsize offset;
+  std::streamsize length;
+
+  EXPECT_FALSE(_media.Load(NULL));
+  _media.setInitSegment(_path, 0, 4);
+  ASSERT_TRUE(_media.addMediaSegment(0, _path, 4, 10));
+  ASSERT_TRUE(_media.addMediaSegment(2000, _path, 14, -1));
+  EXPECT_FALSE(_media.addMediaSegment(2000, _path, 0, -1));
+  EXPECT_FALSE(_media.addMediaSegment(1000, _path, 0, -1));
+  ASSERT_TRUE(_media.Load(NULL));
+
+  ASSERT_EQ(2, _media.getTimecodes().size());
+  EXPECT_EQ(2000, _media.getTimecodes()[1]);
+  EXPECT_EQ("abcd", read(-1));
+  EXPECT_EQ("efghijklmn", read(0));
+  EXPECT_EQ("opqrstuvwxyz", read(2000));
+  EXPECT_EQ("", read(1000));
+  EXPECT_FALSE(_media.getInitSegmentRange(&offset, &length));
+  EXPECT_FALSE(_media.getMediaSegmentRange(0, &offset, &length));
+}
+
+TEST_F(SegmentListMediaTest, Missing) {
+  _media.addMediaSegment(0, _path, 0, -1);
+  ASSERT_TRUE(_media.Load(NULL));
+
+  // A range past the end of the file.
+  _media.addMediaSegment(2000, _path, 20, 7);
+  EXPECT_FALSE(_media.Load(NULL));
+
+  SegmentListMedia missing;
+  missing.addMediaSegment(0, _path + ".missing", 0, -1);
+  EXPECT_FALSE(missing.Load(NULL));
+
+  SegmentListMedia missingInit;
+  missingInit.setInitSegment(_path + ".missing", 0, -1);
+  missingInit.addMediaSegment(0, _path, 0, -1);
+  EXPECT_FALSE(missingInit.Load(NULL));
+}
+
+}  // namespace peeracle
@@ -20,25 +20,516 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "peeracle/DataStream/DataStreamCopy.h"
 #include "peeracle/Media/WebMMedia.h"
 
 namespace peeracle {
 
-WebMMedia::WebMMedia() {
+static const uint32_t kEBML = 0x1A45DFA3;
+static const uint32_t kSegment = 0x18538067;
+static const uint32_t kSeekHead = 0x114D9B74;
+static const uint32_t kSeek = 0x4DBB;
+static const uint32_t kSeekID = 0x53AB;
+static const uint32_t kSeekPosition = 0x53AC;
+static const uint32_t kInfo = 0x1549A966;
+static const uint32_t kTimecodeScale = 0x2AD7B1;
+static const uint32_t kTracks = 0x1654AE6B;
+static const uint32_t kCluster = 0x1F43B675;
+static const uint32_t kTimecode = 0xE7;
+static const uint32_t kSimpleBlock = 0xA3;
+static const uint32_t kBlockGroup = 0xA0;
+static const uint32_t kBlock = 0xA1;
+static const uint32_t kReferenceBlock = 0xFB;
+static const uint32_t kCues = 0x1C53BB6B;
+static const uint32_t kCuePoint = 0xBB;
+static const uint32_t kCueTime = 0xB3;
+static const uint32_t kCueTrackPositions = 0xB7;
+static const uint32_t kCueClusterPosition = 0xF1;
+static const uint32_t kChapters = 0x1043A770;
+static const uint32_t kTags = 0x1254C367;
+static const uint32_t kAttachments = 0x1941A469;
+
+// Elements that can only appear at the top level of a Segment, which end a
+// Cluster of unknown size.
+static bool isTopLevel(uint32_t id) {
+  return id == kCluster || id == kCues || id == kSeekHead || id == kInfo ||
+    id == kTracks || id == kChapters || id == kTags || id == kAttachments;
+}
+
+// Decode the track number, relative timecode and flags that start the
+// payload of a SimpleBlock or Block element.
+static bool decodeBlockHeader(const uint8_t *data, uint64_t length,
+                              uint64_t *track, int16_t *timecode,
+                              uint8_t *flags) {
+  bool allOnes;
+  int trackLength = EBMLReader::decodeVint(
+    data, static_cast<size_t>(std::min<uint64_t>(length, 8)), 8, false,
+    track, &allOnes);
+
+  if (!trackLength || static_cast<uint64_t>(trackLength) + 3 > length) {
+    return false;
+  }
+
+  *timecode = static_cast<int16_t>((data[trackLength] << 8) |
+                                   data[trackLength + 1]);
+  *flags = data[trackLength + 2];
+  return true;
+}
+
+WebMMedia::WebMMedia() : _dataStream(NULL), _initOffset(0), _initLength(0),
+  _segmentOffset(0), _segmentEnd(0), _timecodeScale(1000000) {
 }
 
 WebMMedia::~WebMMedia() {
 }
 
 bool WebMMedia::Load(DataStreamInterface *dataStream) {
+  EBMLReader reader(dataStream);
+  EBMLElement element;
+  std::streamsize cues = -1;
+  std::streamsize firstCluster = -1;
+
+  _dataStream = dataStream;
+  _initLength = 0;
+  _timecodeScale = 1000000;
+  _timecodes.clear();
+  _clusters.clear();
+  if (!dataStream) {
+    return false;
+  }
+
+  _initOffset = dataStream->tell();
+  if (!reader.readElement(&element) || element.id != kEBML ||
+      !reader.skip(element) || !reader.readElement(&element) ||
+      element.id != kSegment) {
+    return false;
+  }
+
+  _segmentOffset = element.dataOffset;
+  _segmentEnd = EBMLReader::getEnd(element);
+  if (_segmentEnd == -1 || _segmentEnd > dataStream->length()) {
+    _segmentEnd = dataStream->length();
+  }
+
+  // The top level elements before the first Cluster make the init segment.
+  while (reader.tell() < _segmentEnd && reader.readElement(&element)) {
+    if (element.id == kCluster) {
+      firstCluster = element.offset;
+      break;
+    }
+
+    if (element.id == kSeekHead) {
+      if (!_readSeekHead(&reader, element, &cues)) {
+        return false;
+      }
+    } else if (element.id == kInfo) {
+      EBMLElement child;
+
+      while (reader.tell() < EBMLReader::getEnd(element) &&
+             reader.readElement(&child)) {
+        if (child.id == kTimecodeScale &&
+            !reader.readUnsigned(child, &_timecodeScale)) {
+          return false;
+        }
+        if (!reader.skip(child)) {
+          return false;
+        }
+      }
+    } else if (element.id == kCues) {
+      cues = element.offset;
+    }
+
+    if (!reader.skip(element)) {
+      return false;
+    }
+  }
+
+  if (firstCluster == -1) {
+    _initLength = _segmentEnd - _initOffset;
+    return true;
+  }
+
+  _initLength = firstCluster - _initOffset;
+  if (cues != -1 && _readCues(&reader, cues) && !_clusters.empty()) {
+    return true;
+  }
+
+  _timecodes.clear();
+  _clusters.clear();
+  return _scanClusters(&reader, firstCluster);
+}
+
+bool WebMMedia::_readSeekHead(EBMLReader *reader, const EBMLElement &seekHead,
+                              std::streamsize *cues) {
+  EBMLElement seek;
+
+  while (reader->tell() < EBMLReader::getEnd(seekHead) &&
+         reader->readElement(&seek)) {
+    EBMLElement child;
+    uint64_t id = 0;
+    uint64_t position = 0;
+    bool hasPosition = false;
+
+    while (seek.id == kSeek && reader->tell() < EBMLReader::getEnd(seek) &&
+           reader->readElement(&child)) {
+      if (child.id == kSeekID) {
+        if (!reader->readUnsigned(child, &id)) {
+          return false;
+        }
+      } else if (child.id == kSeekPosition) {
+        if (!reader->readUnsigned(child, &position)) {
+          return false;
+        }
+        hasPosition = true;
+      }
+
+      if (!reader->skip(child)) {
+        return false;
+      }
+    }
+
+    if (id == kCues && hasPosition &&
+        position < static_cast<uint64_t>(_segmentEnd - _segmentOffset)) {
+      *cues = _segmentOffset + static_cast<std::streamsize>(position);
+    }
+
+    if (!reader->skip(seek)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool WebMMedia::_readCues(EBMLReader *reader, std::streamsize offset) {
+  std::vector<std::pair<std::streamsize, uint64_t> > points;
+  std::streamsize firstCluster = _initOffset + _initLength;
+  std::vector<uint8_t> payload;
+  std::vector<EBMLElement> cuePoints;
+  const uint8_t *data;
+  EBMLElement cues;
+
+  if (!reader->seek(offset) || !reader->readElement(&cues) ||
+      cues.id != kCues || EBMLReader::getEnd(cues) == -1 ||
+      EBMLReader::getEnd(cues) > _dataStream->length()) {
+    return false;
+  }
+
+  // The Cues are read in one go and their thousands of small elements
+  // decoded from memory.
+  payload.resize(static_cast<size_t>(cues.size));
+  if (payload.empty() ||
+      _dataStream->read(reinterpret_cast<char *>(&payload[0]),
+                        static_cast<std::streamsize>(cues.size)) !=
+      static_cast<std::streamsize>(cues.size) ||
+      EBMLReader::scanElements(&payload[0], payload.size(), 0, &cuePoints) !=
+      payload.size()) {
+    return false;
+  }
+
+  data = &payload[0];
+
+  for (size_t p = 0; p < cuePoints.size(); ++p) {
+    const EBMLElement &cuePoint = cuePoints[p];
+    std::vector<EBMLElement> children;
+    uint64_t time = 0;
+    uint64_t position = 0;
+    bool hasTime = false;
+    bool hasPosition = false;
+
+    if (cuePoint.id != kCuePoint) {
+      continue;
+    }
+
+    if (EBMLReader::scanElements(data + cuePoint.dataOffset,
+                                 static_cast<size_t>(cuePoint.size),
+                                 cuePoint.dataOffset, &children) !=
+        cuePoint.size) {
+      return false;
+    }
+
+    for (size_t c = 0; c < children.size(); ++c) {
+      const EBMLElement &child = children[c];
+
+      if (child.id == kCueTime) {
+        if (!EBMLReader::decodeUnsigned(data + child.dataOffset, child.size,
+                                        &time)) {
+          return false;
+        }
+        hasTime = true;
+      } else if (child.id == kCueTrackPositions && !hasPosition) {
+        std::vector<EBMLElement> fields;
+
+        // Every track of a cue point is in the same Cluster.
+        if (EBMLReader::scanElements(data + child.dataOffset,
+                                     static_cast<size_t>(child.size),
+                                     child.dataOffset, &fields) !=
+            child.size) {
+          return false;
+        }
+
+        for (size_t f = 0; f < fields.size(); ++f) {
+          if (fields[f].id == kCueClusterPosition) {
+            if (!EBMLReader::decodeUnsigned(data + fields[f].dataOffset,
+                                            fields[f].size, &position)) {
+              return false;
+            }
+            hasPosition = true;
+          }
+        }
+      }
+    }
+
+    if (hasTime && hasPosition) {
+      std::streamsize cluster = _segmentOffset +
+        static_cast<std::streamsize>(position);
+
+      if (cluster < firstCluster || cluster >= _segmentEnd) {
+        return false;
+      }
+      points.push_back(std::make_pair(cluster, time));
+    }
+  }
+
+  // Several cue points can address the same Cluster, the earliest gives
+  // its timecode.
+  std::sort(points.begin(), points.end());
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (i && points[i].first == points[i - 1].first) {
+      continue;
+    }
+    _addCluster(points[i].first, points[i].second);
+  }
+  return true;
+}
+
+bool WebMMedia::_scanClusters(EBMLReader *reader, std::streamsize offset) {
+  EBMLElement element;
+
+  if (!reader->seek(offset)) {
+    return false;
+  }
+
+  while (reader->tell() < _segmentEnd && reader->readElement(&element)) {
+    if (element.id == kCluster) {
+      uint64_t timecode;
+
+      if (!_readClusterTimecode(reader, element, &timecode)) {
+        return false;
+      }
+      _addCluster(element.offset, timecode);
+    }
+
+    if (EBMLReader::getEnd(element) != -1) {
+      // A truncated file ends with the last complete element.
+      if (!reader->skip(element)) {
+        break;
+      }
+      continue;
+    }
+
+    if (element.id != kCluster || !reader->seek(element.dataOffset)) {
+      return false;
+    }
+
+    // A Cluster of unknown size, as written by live encoders, ends where
+    // the next top level element starts.
+    for (EBMLElement child; reader->tell() < _segmentEnd;) {
+      if (!reader->readElement(&child)) {
+        return false;
+      }
+      if (isTopLevel(child.id)) {
+        reader->seek(child.offset);
+        break;
+      }
+      if (!reader->skip(child)) {
+        return false;
+      }
+    }
+  }
+
   return true;
 }
 
+bool WebMMedia::_readClusterTimecode(EBMLReader *reader,
+                                     const EBMLElement &cluster,
+                                     uint64_t *timecode) {
+  std::streamsize end = EBMLReader::getEnd(cluster);
+  EBMLElement child;
+
+  // The Timecode is the first child of a Cluster in practice, the other
+  // children are skipped until it is found.
+  while ((end == -1 || reader->tell() < end) && reader->readElement(&child)) {
+    if (child.id == kTimecode) {
+      return reader->readUnsigned(child, timecode);
+    }
+    if (isTopLevel(child.id) || !reader->skip(child)) {
+      return false;
+    }
+  }
+  return false;
+}
+
+void WebMMedia::_addCluster(std::streamsize offset, uint64_t timecode) {
+  _clusters.push_back(offset);
+  _timecodes.push_back(static_cast<uint32_t>(timecode * _timecodeScale /
+                                             1000000));
+}
+
 void WebMMedia::getInitSegment(DataStreamInterface *out) {
+  std::streamsize offset;
+  std::streamsize length;
+
+  if (getInitSegmentRange(&offset, &length)) {
+    DataStreamCopy::copyRange(_dataStream, offset, length, out);
+  }
 }
 
 void WebMMedia::getMediaSegment(std::streampos timecode,
                                 DataStreamInterface *out) {
+  std::streamsize offset;
+  std::streamsize length;
+
+  if (getMediaSegmentRange(timecode, &offset, &length)) {
+    DataStreamCopy::copyRange(_dataStream, offset, length, out);
+  }
+}
+
+bool WebMMedia::getInitSegmentRange(std::streamsize *offset,
+                                    std::streamsize *length) {
+  if (!_dataStream || !_initLength) {
+    return false;
+  }
+
+  *offset = _initOffset;
+  *length = _initLength;
+  return true;
+}
+
+bool WebMMedia::getMediaSegmentRange(std::streampos timecode,
+                                     std::streamsize *offset,
+                                     std::streamsize *length) {
+  EBMLReader reader(_dataStream);
+  EBMLElement cluster;
+  std::vector<uint32_t>::const_iterator it =
+    std::lower_bound(_timecodes.begin(), _timecodes.end(),
+                     static_cast<uint32_t>(timecode));
+  size_t index = it - _timecodes.begin();
+  std::streamsize end;
+
+  // The Cues only give the Cluster offset, its size is in its header.
+  if (it == _timecodes.end() || *it != static_cast<uint32_t>(timecode) ||
+      !reader.seek(_clusters[index]) || !reader.readElement(&cluster) ||
+      cluster.id != kCluster) {
+    return false;
+  }
+
+  end = EBMLReader::getEnd(cluster);
+  if (end == -1) {
+    end = index + 1 < _clusters.size() ? _clusters[index + 1] : _segmentEnd;
+  }
+
+  *offset = cluster.offset;
+  *length = std::min(end, _dataStream->length()) - cluster.offset;
+  return true;
+}
+
+bool WebMMedia::getMediaSegmentFrames(std::streampos timecode,
+                                      std::vector<MediaFrame> *frames) {
+  std::streamsize offset;
+  std::streamsize length;
+  std::vector<uint8_t> cluster;
+  std::vector<EBMLElement> children;
+  std::vector<int16_t> relativeTimecodes;
+  EBMLElement header;
+  uint64_t clusterTimecode = static_cast<uint64_t>(timecode) * 1000000 /
+    _timecodeScale;
+  int headerLength;
+
+  frames->clear();
+  if (!getMediaSegmentRange(timecode, &offset, &length) || !length ||
+      _dataStream->seek(offset) != offset) {
+    return false;
+  }
+
+  cluster.resize(static_cast<size_t>(length));
+  if (_dataStream->read(reinterpret_cast<char *>(&cluster[0]), length) !=
+      length) {
+    return false;
+  }
+
+  headerLength = EBMLReader::decodeHeader(&cluster[0], cluster.size(), 0,
+                                          &header);
+  if (!headerLength || header.id != kCluster) {
+    return false;
+  }
+
+  EBMLReader::scanElements(&cluster[headerLength],
+                           cluster.size() - headerLength, headerLength,
+                           &children);
+  for (size_t c = 0; c < children.size(); ++c) {
+    const EBMLElement &child = children[c];
+    const uint8_t *payload = &cluster[static_cast<size_t>(child.dataOffset)];
+    std::vector<EBMLElement> blockChildren;
+    MediaFrame frame;
+    uint64_t track;
+    int16_t relative;
+    uint8_t flags;
+
+    if (child.id == kTimecode) {
+      EBMLReader::decodeUnsigned(payload, child.size, &clusterTimecode);
+      continue;
+    }
+
+    if (child.id == kSimpleBlock) {
+      if (!decodeBlockHeader(payload, child.size, &track, &relative,
+                             &flags)) {
+        return false;
+      }
+      frame.keyframe = (flags & 0x80) != 0;
+    } else if (child.id == kBlockGroup) {
+      // A Block without ReferenceBlock does not depend on other frames.
+      EBMLReader::scanElements(payload, static_cast<size_t>(child.size),
+                               child.dataOffset, &blockChildren);
+      frame.keyframe = true;
+      track = 0;
+      for (size_t b = 0; b < blockChildren.size(); ++b) {
+        const EBMLElement &blockChild = blockChildren[b];
+
+        if (blockChild.id == kReferenceBlock) {
+          frame.keyframe = false;
+        } else if (blockChild.id == kBlock && !decodeBlockHeader(
+                     &cluster[static_cast<size_t>(blockChild.dataOffset)],
+                     blockChild.size, &track, &relative, &flags)) {
+          return false;
+        }
+      }
+      if (!track) {
+        return false;
+      }
+    } else {
+      continue;
+    }
+
+    frame.offset = child.offset;
+    frame.length = EBMLReader::getEnd(child) - child.offset;
+    frame.track = static_cast<uint32_t>(track);
+    frames->push_back(frame);
+    relativeTimecodes.push_back(relative);
+  }
+
+  // The Cluster Timecode normally comes first, but may follow blocks.
+  for (size_t f = 0; f < frames->size(); ++f) {
+    int64_t ticks = static_cast<int64_t>(clusterTimecode) +
+      relativeTimecodes[f];
+
+    (*frames)[f].timecode = ticks > 0 ? static_cast<uint32_t>(
+      static_cast<uint64_t>(ticks) * _timecodeScale / 1000000) : 0;
+  }
+  return true;
 }
 
 const std::vector<uint32_t> &WebMMedia::getTimecodes() const {
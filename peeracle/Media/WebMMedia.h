@@ -26,10 +26,23 @@
 #include <stdint.h>
 #include <vector>
 
+#include "peeracle/Media/EBMLReader.h"
 #include "peeracle/Media/MediaInterface.h"
 
 namespace peeracle {
 
+/**
+ * WebM media, indexed by reading element headers only.
+ *
+ * The init segment is everything before the first Cluster. Each Cluster is
+ * a media segment, keyed by its timecode in milliseconds. The cluster
+ * offsets and timecodes come from the Cues element when the SeekHead or
+ * the top level elements before the first Cluster point to one, otherwise
+ * from a scan of the Cluster headers, skipping their payload.
+ *
+ * The data stream given to Load() is read again by getInitSegment() and
+ * getMediaSegment(), it must outlive this object.
+ */
 class WebMMedia
   : public MediaInterface {
  public:
@@ -39,10 +52,30 @@ class WebMMedia
   bool Load(DataStreamInterface *dataStream);
   void getInitSegment(DataStreamInterface *out);
   void getMediaSegment(std::streampos timecode, DataStreamInterface *out);
+  bool getInitSegmentRange(std::streamsize *offset, std::streamsize *length);
+  bool getMediaSegmentRange(std::streampos timecode, std::streamsize *offset,
+                            std::streamsize *length);
+  bool getMediaSegmentFrames(std::streampos timecode,
+                             std::vector<MediaFrame> *frames);
   const std::vector<uint32_t> &getTimecodes() const;
 
  private:
+  bool _readSeekHead(EBMLReader *reader, const EBMLElement &seekHead,
+                     std::streamsize *cues);
+  bool _readCues(EBMLReader *reader, std::streamsize offset);
+  bool _scanClusters(EBMLReader *reader, std::streamsize offset);
+  bool _readClusterTimecode(EBMLReader *reader, const EBMLElement &cluster,
+                            uint64_t *timecode);
+  void _addCluster(std::streamsize offset, uint64_t timecode);
+
+  DataStreamInterface *_dataStream;
+  std::streamsize _initOffset;
+  std::streamsize _initLength;
+  std::streamsize _segmentOffset;
+  std::streamsize _segmentEnd;
+  uint64_t _timecodeScale;
   std::vector<uint32_t> _timecodes;
+  std::vector<std::streamsize> _clusters;
 };
 
 }  // namespace peeracle
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Media/EBMLReader.h"
+#include "peeracle/Media/WebMMedia.h"
+#include "test/benchmark.h"
+
+namespace peeracle {
+
+static const int64_t kMinNanos = 500000000;
+static const uint32_t kBlocksPerCluster = 60;
+static const uint32_t kCluster = 0x1F43B675;
+
+// A WebM file shaped like the WebMMedia_unittest sample: an init segment
+// of about 4.5 KB, then Clusters of 2 seconds of 30 fps video and audio
+// blocks, indexed by Cues at the end.
+class SampleMedia : public SyntheticMedia {
+ public:
+  explicit SampleMedia(uint32_t clusterCount)
+    : SyntheticMedia(clusterCount, 2000, kBlocksPerCluster) {
+  }
+
+  // Mostly small blocks, with a large key frame every Cluster.
+  uint32_t getFrameLength(uint32_t segment, uint32_t frame) {
+    uint32_t state = (segment * kBlocksPerCluster + frame) * 1664525 +
+      1013904223;
+
+    return frame ? 200 + (state >> 22) : 60000;
+  }
+};
+
+// Read element headers one byte at a time, as EBMLReader did before it
+// decoded them from a single peek.
+class ByteReader {
+ public:
+  explicit ByteReader(DataStreamInterface *dataStream)
+    : _dataStream(dataStream) {
+  }
+
+  bool readElement(EBMLElement *element) {
+    uint64_t id;
+    uint64_t size;
+    bool allOnes;
+
+    element->offset = _dataStream->tell();
+    if (!_readVint(4, true, &id, &allOnes) ||
+        !_readVint(8, false, &size, &allOnes)) {
+      return false;
+    }
+
+    element->id = static_cast<uint32_t>(id);
+    element->size = allOnes ? EBMLReader::kUnknownSize : size;
+    element->dataOffset = _dataStream->tell();
+    return true;
+  }
+
+  bool seek(std::streamsize offset) {
+    return _dataStream->seek(offset) == offset;
+  }
+
+ private:
+  bool _readVint(int maxLength, bool keepMarker, uint64_t *value,
+                 bool *allOnes) {
+    uint8_t first;
+    uint8_t byte;
+    uint8_t mask = 0x80;
+    int length = 1;
+    uint64_t result;
+
+    if (_dataStream->read(&first) == -1 || !first) {
+      return false;
+    }
+
+    while (!(first & mask)) {
+      mask >>= 1;
+      ++length;
+    }
+
+    if (length > maxLength) {
+      return false;
+    }
+
+    result = keepMarker ? first : first & (mask - 1);
+    *allOnes = (first & (mask - 1)) == mask - 1;
+    for (int i = 0; i < length - 1; ++i) {
+      if (_dataStream->read(&byte) == -1) {
+        return false;
+      }
+      result = (result << 8) | byte;
+      *allOnes = *allOnes && byte == 0xFF;
+    }
+
+    *value = result;
+    return true;
+  }
+
+  DataStreamInterface *_dataStream;
+};
+
+// Visit every element header of the Segment and of its Clusters, which is
+// the work of indexing a file without Cues.
+template<typename Reader>
+class WalkCase : public Benchmark::Case {
+ public:
+  explicit WalkCase(MemoryDataStream *in) : _in(in), _count(0) {
+  }
+
+  void run() {
+    Reader reader(_in);
+    EBMLElement element;
+    std::streamsize end;
+
+    _count = 0;
+    _in->seek(0);
+    if (!reader.readElement(&element) || !reader.readElement(&element)) {
+      return;
+    }
+
+    end = EBMLReader::getEnd(element);
+    while (_in->tell() < end && reader.readElement(&element)) {
+      ++_count;
+      if (element.id != kCluster) {
+        reader.seek(EBMLReader::getEnd(element));
+        continue;
+      }
+
+      for (EBMLElement child; _in->tell() < EBMLReader::getEnd(element) &&
+           reader.readElement(&child);) {
+        ++_count;
+        reader.seek(EBMLReader::getEnd(child));
+      }
+    }
+  }
+
+  uint64_t getCount() const {
+    return _count;
+  }
+
+ private:
+  MemoryDataStream *_in;
+  uint64_t _count;
+};
+
+// The same walk, with the headers of each level decoded in a batch from
+// the file in memory.
+class ScanCase : public Benchmark::Case {
+ public:
+  explicit ScanCase(MemoryDataStream *in) : _in(in), _count(0) {
+  }
+
+  void run() {
+    const uint8_t *data = _in->getBuffer();
+    size_t length = static_cast<size_t>(_in->length());
+    std::vector<EBMLElement> elements;
+    std::vector<EBMLElement> children;
+
+    _count = 0;
+    EBMLReader::scanElements(data, length, 0, &elements);
+    if (elements.size() < 2) {
+      return;
+    }
+
+    EBMLElement segment = elements[1];
+    elements.clear();
+    EBMLReader::scanElements(data + segment.dataOffset,
+                             static_cast<size_t>(segment.size),
+                             segment.dataOffset, &elements);
+    for (size_t i = 0; i < elements.size(); ++i) {
+      ++_count;
+      if (elements[i].id == kCluster) {
+        children.clear();
+        EBMLReader::scanElements(data + elements[i].dataOffset,
+                                 static_cast<size_t>(elements[i].size),
+                                 elements[i].dataOffset, &children);
+        _count += children.size();
+      }
+    }
+  }
+
+  uint64_t getCount() const {
+    return _count;
+  }
+
+ private:
+  MemoryDataStream *_in;
+  uint64_t _count;
+};
+
+class LoadCase : public Benchmark::Case {
+ public:
+  explicit LoadCase(MemoryDataStream *in) : _in(in) {
+  }
+
+  void run() {
+    WebMMedia media;
+
+    _in->seek(0);
+    media.Load(_in);
+  }
+
+ private:
+  MemoryDataStream *_in;
+};
+
+static void addRow(BenchmarkTable *table, const std::string &name,
+                   Benchmark::Case *benchmarkCase, uint64_t headers) {
+  double nanos = Benchmark::measure(benchmarkCase, kMinNanos);
+
+  table->addRow();
+  table->addCell(name);
+  table->addCell(Benchmark::formatTime(nanos));
+  table->addCell(headers ? Benchmark::formatCount(
+    static_cast<double>(headers) * 1e9 / nanos) + "/s" : "-");
+}
+
+static int run(uint32_t clusterCount) {
+  std::vector<uint8_t> bytes;
+  DataStreamInit dsInit;
+  MemoryDataStream in(dsInit);
+  WalkCase<ByteReader> byteWalk(&in);
+  WalkCase<EBMLReader> peekWalk(&in);
+  ScanCase scan(&in);
+  LoadCase load(&in);
+
+  SampleMedia media(clusterCount);
+
+  media.writeWebM(true, false, &bytes);
+  in.write(reinterpret_cast<const char *>(&bytes[0]),
+           static_cast<std::streamsize>(bytes.size()));
+
+  byteWalk.run();
+  peekWalk.run();
+  scan.run();
+  if (!byteWalk.getCount() || byteWalk.getCount() != peekWalk.getCount() ||
+      byteWalk.getCount() != scan.getCount()) {
+    std::cerr << "the element walks disagree" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  BenchmarkTable table("WebM of " + Benchmark::formatCount(clusterCount) +
+                       " Clusters (" +
+                       Benchmark::formatSize(static_cast<double>(
+                         bytes.size())) + ", " +
+                       Benchmark::formatCount(static_cast<double>(
+                         scan.getCount())) + " elements)");
+
+  table.addColumn("operation");
+  table.addColumn("time");
+  table.addColumn("headers");
+  addRow(&table, "walk, byte reads", &byteWalk, byteWalk.getCount());
+  addRow(&table, "walk, EBMLReader", &peekWalk, peekWalk.getCount());
+  addRow(&table, "walk, scanElements", &scan, scan.getCount());
+  addRow(&table, "WebMMedia::Load (Cues)", &load, 0);
+  table.print(&std::cout);
+  return EXIT_SUCCESS;
+}
+
+}  // namespace peeracle
+
+int main(int argc, char **argv) {
+  uint32_t clusterCount = 1800;
+
+  if (argc > 1) {
+    clusterCount = static_cast<uint32_t>(strtoul(argv[1], NULL, 10));
+  }
+
+  if (!clusterCount) {
+    std::cerr << "usage: " << argv[0] << " [clusters]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return peeracle::run(clusterCount);
+}
@@ -20,10 +20,13 @@
  * SOFTWARE.
  */
 
+#include <cstring>
+#include <vector>
 #include "third_party/googletest/gtest/include/gtest/gtest.h"
 #include "peeracle/DataStream/FileDataStream.h"
 #include "peeracle/DataStream/MemoryDataStream.h"
 #include "peeracle/Media/WebMMedia.h"
+#include "test/benchmark.h"
 
 namespace peeracle {
 
@@ -414,49 +417,62 @@ static const unsigned char _expectedInitBytes[] = {
 
 static const unsigned int _expectedInitLength = 4557;
 
+static const uint32_t kCluster = 0x1F43B675;
+static const uint32_t kCues = 0x1C53BB6B;
+
+static std::vector<uint8_t> element(uint32_t id,
+                                    const std::vector<uint8_t> &payload,
+                                    bool unknownSize = false) {
+  std::vector<uint8_t> result;
+
+  SyntheticMedia::putElement(id, payload, &result, unknownSize);
+  return result;
+}
+
+static std::vector<uint8_t> unsignedElement(uint32_t id, uint64_t value,
+                                            int length) {
+  std::vector<uint8_t> result;
+
+  SyntheticMedia::putUnsigned(id, value, length, &result);
+  return result;
+}
+
+static void append(std::vector<uint8_t> *out,
+                   const std::vector<uint8_t> &bytes) {
+  out->insert(out->end(), bytes.begin(), bytes.end());
+}
+
 class WebMMediaTest : public testing::Test {
  protected:
   WebMMediaTest() : _media(NULL), _webmToTest(NULL) {
   }
 
   virtual void SetUp() {
+    DataStreamInit dsInit;
+    std::vector<uint8_t> bytes(_expectedInitBytes,
+                               _expectedInitBytes + _expectedInitLength);
+
+    SyntheticMedia clusters(30, 2000, 1);
+
+    // The sample init segment followed by a Cluster every 2 seconds. Its
+    // SeekHead points to Cues past the end of the file, so the Clusters
+    // are found by scanning.
+    clusters.writeClusters(&bytes);
+    for (uint32_t timecode = 0; timecode < 60000; timecode += 2000) {
+      _expectedTimecodes.push_back(timecode);
+    }
+
+    _webmToTest = new MemoryDataStream(dsInit);
+    _webmToTest->write(reinterpret_cast<const char *>(&bytes[0]),
+                       static_cast<std::streamsize>(bytes.size()));
+    _webmToTest->seek(0);
     _media = new WebMMedia();
-    _media->Load(NULL);
-
-    _expectedTimecodes.push_back(0);
-    _expectedTimecodes.push_back(2000);
-    _expectedTimecodes.push_back(4000);
-    _expectedTimecodes.push_back(6000);
-    _expectedTimecodes.push_back(8000);
-    _expectedTimecodes.push_back(10000);
-    _expectedTimecodes.push_back(12000);
-    _expectedTimecodes.push_back(14000);
-    _expectedTimecodes.push_back(16000);
-    _expectedTimecodes.push_back(18000);
-    _expectedTimecodes.push_back(20000);
-    _expectedTimecodes.push_back(22000);
-    _expectedTimecodes.push_back(24000);
-    _expectedTimecodes.push_back(26000);
-    _expectedTimecodes.push_back(28000);
-    _expectedTimecodes.push_back(30000);
-    _expectedTimecodes.push_back(32000);
-    _expectedTimecodes.push_back(34000);
-    _expectedTimecodes.push_back(36000);
-    _expectedTimecodes.push_back(38000);
-    _expectedTimecodes.push_back(40000);
-    _expectedTimecodes.push_back(42000);
-    _expectedTimecodes.push_back(44000);
-    _expectedTimecodes.push_back(46000);
-    _expectedTimecodes.push_back(48000);
-    _expectedTimecodes.push_back(50000);
-    _expectedTimecodes.push_back(52000);
-    _expectedTimecodes.push_back(54000);
-    _expectedTimecodes.push_back(56000);
-    _expectedTimecodes.push_back(58000);
+    ASSERT_TRUE(_media->Load(_webmToTest));
   }
 
   virtual void TearDown() {
     delete _media;
+    delete _webmToTest;
   }
 
   std::vector<uint32_t> _expectedTimecodes;
@@ -475,6 +491,7 @@ TEST_F(WebMMediaTest, getInitSegment) {
 
   ASSERT_EQ(_expectedInitLength, actualDS->length());
 
+  ASSERT_EQ(0, actualDS->seek(0));
   actualBytes = new uint8_t[actualDS->length()];
   actualDS->read(reinterpret_cast<char*>(actualBytes), actualDS->length());
 
@@ -482,7 +499,7 @@ TEST_F(WebMMediaTest, getInitSegment) {
     EXPECT_EQ(_expectedInitBytes[i], actualBytes[i]);
   }
 
-  delete actualBytes;
+  delete[] actualBytes;
   delete actualDS;
 }
 
@@ -496,6 +513,272 @@ TEST_F(WebMMediaTest, getMediaSegment) {
   }
 }
 
+class WebMMediaParseTest : public testing::Test {
+ protected:
+  WebMMediaParseTest() : _ds(NULL), _initLength(0) {
+  }
+
+  virtual void SetUp() {
+    DataStreamInit dsInit;
+
+    _ds = new MemoryDataStream(dsInit);
+  }
+
+  virtual void TearDown() {
+    delete _ds;
+  }
+
+  // Write a WebM file of 4 clusters of 2 seconds. With \p cues, a SeekHead
+  // points to Cues written after the clusters. \p live gives the segment
+  // and the clusters an unknown size. Clusters hold a Timecode only when
+  // \p clusterTimecodes is set.
+  void write(bool cues, bool live, uint64_t timecodeScale,
+             bool clusterTimecodes) {
+    std::vector<uint8_t> seek;
+    std::vector<uint8_t> seekHead;
+    std::vector<uint8_t> info = element(0x1549A966,
+      unsignedElement(0x2AD7B1, timecodeScale, 3));
+    std::vector<uint8_t> tracks = element(0x1654AE6B,
+      std::vector<uint8_t>(48, 0xAE));
+    std::vector<uint8_t> clusters;
+    std::vector<uint8_t> cuePoints;
+    std::vector<uint8_t> body;
+
+    // Positions are written on 8 bytes, the SeekHead size does not depend
+    // on the Cues position.
+    for (int pass = 0; cues && pass < 2; ++pass) {
+      seek = unsignedElement(0x53AB, kCues, 4);
+      append(&seek, unsignedElement(0x53AC, seekHead.size() + info.size() +
+                                    tracks.size() + clusters.size(), 8));
+      seekHead = element(0x114D9B74, element(0x4DBB, seek));
+
+      clusters.clear();
+      cuePoints.clear();
+      _clusters.clear();
+      _timecodes.clear();
+      for (uint32_t i = 0; i < 4; ++i) {
+        std::vector<uint8_t> payload;
+        std::vector<uint8_t> cuePoint;
+        std::vector<uint8_t> position;
+        uint64_t timecode = i * 2000ULL * 1000000 / timecodeScale;
+        size_t offset = seekHead.size() + info.size() + tracks.size() +
+          clusters.size();
+
+        if (clusterTimecodes) {
+          append(&payload, unsignedElement(0xE7, timecode, 4));
+        }
+        append(&payload, element(0xA3, std::vector<uint8_t>(100 + i * 37,
+                                                            i + 1)));
+        _clusters.push_back(element(kCluster, payload, live));
+        _timecodes.push_back(i * 2000);
+        append(&clusters, _clusters.back());
+
+        append(&position, unsignedElement(0xF7, 1, 1));
+        append(&position, unsignedElement(0xF1, offset, 8));
+        append(&cuePoint, unsignedElement(0xB3, timecode, 4));
+        append(&cuePoint, element(0xB7, position));
+        append(&cuePoints, element(0xBB, cuePoint));
+      }
+    }
+
+    append(&body, seekHead);
+    append(&body, info);
+    append(&body, tracks);
+    append(&body, clusters);
+    if (cues) {
+      append(&body, element(kCues, cuePoints));
+    }
+
+    _bytes = element(0x1A45DFA3, element(0x4282,
+                                         std::vector<uint8_t>(4, 'w')));
+    SyntheticMedia::putId(0x18538067, &_bytes);
+    SyntheticMedia::putSize(live ? SyntheticMedia::kUnknownSize :
+                            body.size(), 8, &_bytes);
+    _initLength = _bytes.size() + seekHead.size() + info.size() +
+      tracks.size();
+    append(&_bytes, body);
+
+    _ds->write(reinterpret_cast<const char *>(&_bytes[0]), _bytes.size());
+    _ds->seek(0);
+  }
+
+  void expectSegments(WebMMedia *media) {
+    DataStreamInit dsInit;
+    MemoryDataStream init(dsInit);
+    std::streamsize offset;
+    std::streamsize length;
+
+    media->getInitSegment(&init);
+    ASSERT_EQ(_initLength, init.length());
+    EXPECT_EQ(0, memcmp(&_bytes[0], init.getBuffer(), _initLength));
+    ASSERT_TRUE(media->getInitSegmentRange(&offset, &length));
+    EXPECT_EQ(0, offset);
+    EXPECT_EQ(_initLength, length);
+
+    ASSERT_EQ(_timecodes, media->getTimecodes());
+    for (size_t i = 0; i < _timecodes.size(); ++i) {
+      MemoryDataStream segment(dsInit);
+
+      media->getMediaSegment(_timecodes[i], &segment);
+      ASSERT_EQ(_clusters[i].size(), segment.length());
+      EXPECT_EQ(0, memcmp(&_clusters[i][0], segment.getBuffer(),
+                          _clusters[i].size()));
+
+      ASSERT_TRUE(media->getMediaSegmentRange(_timecodes[i], &offset,
+                                              &length));
+      ASSERT_EQ(_clusters[i].size(), length);
+      EXPECT_EQ(0, memcmp(&_clusters[i][0], &_bytes[offset],
+                          _clusters[i].size()));
+    }
+    EXPECT_FALSE(media->getMediaSegmentRange(1, &offset, &length));
+  }
+
+  MemoryDataStream *_ds;
+  std::vector<uint8_t> _bytes;
+  size_t _initLength;
+  std::vector<std::vector<uint8_t> > _clusters;
+  std::vector<uint32_t> _timecodes;
+};
+
+TEST_F(WebMMediaParseTest, Cues) {
+  WebMMedia media;
+
+  write(true, false, 1000000, true);
+  ASSERT_TRUE(media.Load(_ds));
+  expectSegments(&media);
+}
+
+TEST_F(WebMMediaParseTest, CuesWithoutClusterTimecodes) {
+  WebMMedia media;
+
+  // Only the Cues give the timecodes, the clusters are not read.
+  write(true, false, 500000, false);
+  ASSERT_TRUE(media.Load(_ds));
+  expectSegments(&media);
+}
+
+TEST_F(WebMMediaParseTest, ClusterScan) {
+  WebMMedia media;
+
+  write(false, false, 1000000, true);
+  ASSERT_TRUE(media.Load(_ds));
+  expectSegments(&media);
+}
+
+TEST_F(WebMMediaParseTest, UnknownSizes) {
+  WebMMedia media;
+
+  write(false, true, 1000000, true);
+  ASSERT_TRUE(media.Load(_ds));
+  expectSegments(&media);
+}
+
+TEST_F(WebMMediaParseTest, InitSegmentOnly) {
+  WebMMedia media;
+  DataStreamInit dsInit;
+  MemoryDataStream init(dsInit);
+
+  // A real init segment, whose SeekHead points to Cues past its end.
+  _ds->write(reinterpret_cast<const char *>(_expectedInitBytes),
+             _expectedInitLength);
+  _ds->seek(0);
+  ASSERT_TRUE(media.Load(_ds));
+  EXPECT_TRUE(media.getTimecodes().empty());
+
+  media.getInitSegment(&init);
+  ASSERT_EQ(_expectedInitLength, init.length());
+  EXPECT_EQ(0, memcmp(_expectedInitBytes, init.getBuffer(),
+                      _expectedInitLength));
+}
+
+TEST_F(WebMMediaParseTest, Frames) {
+  WebMMedia media;
+  std::vector<MediaFrame> frames;
+  std::vector<uint8_t> payload;
+  std::vector<uint8_t> block;
+  std::vector<uint8_t> group;
+  std::vector<uint8_t> cluster;
+  std::vector<uint8_t> body = element(0x1549A966,
+    unsignedElement(0x2AD7B1, 500000, 3));
+  size_t first;
+  size_t second;
+
+  // A key frame of track 1, a predicted frame of track 2 in a BlockGroup,
+  // then a predicted frame of track 1 before a late Cluster Timecode.
+  block.push_back(0x81);
+  block.push_back(0x00);
+  block.push_back(0x00);
+  block.push_back(0x80);
+  block.insert(block.end(), 300, 0x11);
+  append(&payload, element(0xA3, block));
+  first = payload.size();
+
+  block[0] = 0x82;
+  block[2] = 20;
+  block[3] = 0x00;
+  group = element(0xA1, block);
+  append(&group, unsignedElement(0xFB, 0xFFEC, 2));
+  append(&payload, element(0xA0, group));
+  second = payload.size();
+
+  block[0] = 0x81;
+  block[1] = 0xFF;
+  block[2] = 0xF6;
+  block.resize(40);
+  append(&payload, element(0xA3, block));
+  append(&payload, unsignedElement(0xE7, 8000, 4));
+  cluster = element(kCluster, payload);
+  append(&body, cluster);
+
+  _bytes = element(0x1A45DFA3, element(0x4282,
+                                       std::vector<uint8_t>(4, 'w')));
+  append(&_bytes, element(0x18538067, body));
+  _ds->write(reinterpret_cast<const char *>(&_bytes[0]), _bytes.size());
+  _ds->seek(0);
+  ASSERT_TRUE(media.Load(_ds));
+  ASSERT_EQ(1U, media.getTimecodes().size());
+  EXPECT_FALSE(media.getMediaSegmentFrames(1, &frames));
+
+  ASSERT_TRUE(media.getMediaSegmentFrames(media.getTimecodes()[0], &frames));
+  ASSERT_EQ(3U, frames.size());
+  EXPECT_EQ(cluster.size() - payload.size(),
+            static_cast<size_t>(frames[0].offset));
+  EXPECT_EQ(first, static_cast<size_t>(frames[0].length));
+  EXPECT_EQ(1U, frames[0].track);
+  EXPECT_EQ(4000U, frames[0].timecode);
+  EXPECT_TRUE(frames[0].keyframe);
+
+  EXPECT_EQ(frames[0].offset + frames[0].length, frames[1].offset);
+  EXPECT_EQ(second - first, static_cast<size_t>(frames[1].length));
+  EXPECT_EQ(2U, frames[1].track);
+  EXPECT_EQ(4010U, frames[1].timecode);
+  EXPECT_FALSE(frames[1].keyframe);
+
+  EXPECT_EQ(frames[1].offset + frames[1].length, frames[2].offset);
+  EXPECT_EQ(1U, frames[2].track);
+  EXPECT_EQ(3995U, frames[2].timecode);
+  EXPECT_FALSE(frames[2].keyframe);
+}
+
+TEST_F(WebMMediaParseTest, Corrupted) {
+  WebMMedia media;
+  DataStreamInit dsInit;
+  MemoryDataStream truncated(dsInit);
+
+  EXPECT_FALSE(media.Load(NULL));
+
+  write(true, false, 1000000, true);
+  truncated.write(reinterpret_cast<const char *>(&_bytes[0]), 3);
+  truncated.seek(0);
+  EXPECT_FALSE(media.Load(&truncated));
+
+  _bytes[0] = 0x1B;
+  _ds->write(reinterpret_cast<const char *>(&_bytes[0]), 1);
+  _ds->seek(0);
+  EXPECT_FALSE(media.Load(_ds));
+  EXPECT_TRUE(media.getTimecodes().empty());
+}
+
 }  // namespace Media
 
 }  // namespace peeracle
@@ -0,0 +1,1073 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/MappedDataStream.h"
+#include "peeracle/Metadata/ManifestImporter.h"
+
+namespace peeracle {
+
+static const uint8_t kVideoType = 1;
+static const uint8_t kAudioType = 2;
+
+typedef std::map<std::string, std::string> Attributes;
+
+static bool readFile(const std::string &path, std::string *content) {
+  DataStreamInit dsInit;
+
+  dsInit.path = path;
+  MappedDataStream file(dsInit);
+
+  if (!file.open()) {
+    return false;
+  }
+
+  content->assign(reinterpret_cast<const char *>(file.getBuffer()),
+                  static_cast<size_t>(file.length()));
+  return true;
+}
+
+static std::string trim(const std::string &value) {
+  size_t first = value.find_first_not_of(" \t\r\n");
+  size_t last = value.find_last_not_of(" \t\r\n");
+
+  if (first == std::string::npos) {
+    return std::string();
+  }
+  return value.substr(first, last - first + 1);
+}
+
+static bool startsWith(const std::string &value, const std::string &prefix) {
+  return value.compare(0, prefix.size(), prefix) == 0;
+}
+
+static uint64_t toUnsigned(const std::string &value) {
+  return strtoull(value.c_str(), NULL, 10);
+}
+
+static std::string toString(uint64_t value, int width) {
+  std::ostringstream stream;
+
+  stream << std::setw(width) << std::setfill('0') << value;
+  return stream.str();
+}
+
+// Resolve a segment URL against the URL of the file referring to it. Only
+// local paths are supported, a file:// URL is taken as its path.
+static bool resolve(const std::string &base, const std::string &reference,
+                    std::string *path) {
+  std::string url = reference.substr(0, reference.find_first_of("?#"));
+  size_t slash = base.rfind('/');
+
+  if (startsWith(url, "file://")) {
+    url = url.substr(7);
+  } else if (url.find("://") != std::string::npos) {
+    return false;
+  }
+
+  if (url.empty()) {
+    *path = base;
+  } else if (url[0] == '/' || slash == std::string::npos) {
+    *path = url;
+  } else {
+    *path = base.substr(0, slash + 1) + url;
+  }
+  return true;
+}
+
+// Parse a byte range written as "first-last", both included.
+static bool parseRange(const std::string &range, std::streamsize *offset,
+                       std::streamsize *length) {
+  size_t dash = range.find('-');
+  uint64_t first;
+  uint64_t last;
+
+  if (dash == std::string::npos) {
+    return false;
+  }
+
+  first = toUnsigned(range.substr(0, dash));
+  last = toUnsigned(range.substr(dash + 1));
+  if (last < first) {
+    return false;
+  }
+
+  *offset = static_cast<std::streamsize>(first);
+  *length = static_cast<std::streamsize>(last - first + 1);
+  return true;
+}
+
+// Parse an ISO 8601 duration as used by DASH, such as "PT1H2M3.5S", into
+// milliseconds.
+static bool parseDuration(const std::string &value, double *milliseconds) {
+  bool time = false;
+  const char *cursor = value.c_str();
+  double result = 0;
+
+  if (*cursor++ != 'P') {
+    return false;
+  }
+
+  while (*cursor) {
+    char *end;
+    double number;
+
+    if (*cursor == 'T') {
+      time = true;
+      ++cursor;
+      continue;
+    }
+
+    number = strtod(cursor, &end);
+    if (end == cursor) {
+      return false;
+    }
+
+    switch (*end) {
+      case 'D':
+        result += number * 86400000.0;
+        break;
+      case 'H':
+        result += number * 3600000.0;
+        break;
+      case 'M':
+        // Months are ambiguous and never used for media durations.
+        if (!time) {
+          return false;
+        }
+        result += number * 60000.0;
+        break;
+      case 'S':
+        result += number * 1000.0;
+        break;
+      default:
+        return false;
+    }
+    cursor = end + 1;
+  }
+
+  *milliseconds = result;
+  return true;
+}
+
+static std::string decodeEntities(const std::string &value) {
+  static const struct {
+    const char *entity;
+    char character;
+  } kEntities[] = {
+    { "&amp;", '&' },
+    { "&lt;", '<' },
+    { "&gt;", '>' },
+    { "&quot;", '"' },
+    { "&apos;", '\'' },
+  };
+  std::string result;
+
+  for (size_t i = 0; i < value.size(); ++i) {
+    size_t e = 0;
+
+    if (value[i] == '&') {
+      for (; e < sizeof(kEntities) / sizeof(kEntities[0]); ++e) {
+        if (!value.compare(i, strlen(kEntities[e].entity),
+                           kEntities[e].entity)) {
+          break;
+        }
+      }
+    }
+
+    if (value[i] != '&' || e == sizeof(kEntities) / sizeof(kEntities[0])) {
+      result += value[i];
+      continue;
+    }
+
+    result += kEntities[e].character;
+    i += strlen(kEntities[e].entity) - 1;
+  }
+  return result;
+}
+
+struct XMLTag {
+  std::string name;
+  Attributes attributes;
+  bool closing;
+  bool empty;
+};
+
+// Read the next element tag of \p xml from \p position, skipping comments,
+// declarations and processing instructions. The text found before the tag
+// is stored in \p text. This is enough for manifests, which do not use
+// CDATA sections or nested markup in their text.
+static bool nextTag(const std::string &xml, size_t *position, XMLTag *tag,
+                    std::string *text) {
+  size_t cursor;
+
+  text->clear();
+  for (;;) {
+    size_t start = xml.find('<', *position);
+    const char *end = "";
+
+    if (start == std::string::npos) {
+      return false;
+    }
+
+    text->append(xml, *position, start - *position);
+    if (!xml.compare(start, 4, "<!--")) {
+      end = "-->";
+    } else if (!xml.compare(start, 2, "<?")) {
+      end = "?>";
+    } else if (!xml.compare(start, 2, "<!")) {
+      end = ">";
+    }
+
+    if (!*end) {
+      cursor = start + 1;
+      break;
+    }
+
+    *position = xml.find(end, start);
+    if (*position == std::string::npos) {
+      return false;
+    }
+    *position += strlen(end);
+  }
+
+  *text = decodeEntities(*text);
+  tag->attributes.clear();
+  tag->closing = cursor < xml.size() && xml[cursor] == '/';
+  tag->empty = false;
+  if (tag->closing) {
+    ++cursor;
+  }
+
+  size_t nameEnd = xml.find_first_of(" \t\r\n/>", cursor);
+  if (nameEnd == std::string::npos) {
+    return false;
+  }
+  tag->name = xml.substr(cursor, nameEnd - cursor);
+  if (tag->name.find(':') != std::string::npos) {
+    tag->name = tag->name.substr(tag->name.find(':') + 1);
+  }
+
+  for (cursor = nameEnd; cursor < xml.size();) {
+    size_t equal;
+    size_t valueEnd;
+    char quote;
+
+    cursor = xml.find_first_not_of(" \t\r\n", cursor);
+    if (cursor == std::string::npos) {
+      return false;
+    }
+
+    if (xml[cursor] == '>') {
+      *position = cursor + 1;
+      return true;
+    }
+
+    if (xml[cursor] == '/') {
+      tag->empty = true;
+      ++cursor;
+      continue;
+    }
+
+    equal = xml.find('=', cursor);
+    if (equal == std::string::npos || equal + 1 >= xml.size()) {
+      return false;
+    }
+
+    valueEnd = xml.find_first_not_of(" \t\r\n", equal + 1);
+    if (valueEnd == std::string::npos ||
+        (xml[valueEnd] != '"' && xml[valueEnd] != '\'')) {
+      return false;
+    }
+
+    quote = xml[valueEnd];
+    cursor = valueEnd + 1;
+    valueEnd = xml.find(quote, cursor);
+    if (valueEnd == std::string::npos) {
+      return false;
+    }
+
+    tag->attributes[trim(xml.substr(nameEnd, equal - nameEnd))] =
+      decodeEntities(xml.substr(cursor, valueEnd - cursor));
+    cursor = valueEnd + 1;
+    nameEnd = cursor;
+  }
+  return false;
+}
+
+static const std::string &getAttribute(const Attributes &attributes,
+                                       const std::string &name) {
+  static const std::string kEmpty;
+  Attributes::const_iterator it = attributes.find(name);
+
+  return it == attributes.end() ? kEmpty : it->second;
+}
+
+// Expand the $RepresentationID$, $Bandwidth$, $Number$ and $Time$
+// identifiers of a DASH SegmentTemplate, with their optional %0<width>d
+// format tag.
+static bool expandTemplate(const std::string &pattern, const std::string &id,
+                           uint32_t bandwidth, uint64_t number,
+                           uint64_t time, std::string *result) {
+  result->clear();
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    size_t end;
+    size_t format;
+    std::string identifier;
+    int width = 1;
+
+    if (pattern[i] != '$') {
+      *result += pattern[i];
+      continue;
+    }
+
+    end = pattern.find('$', i + 1);
+    if (end == std::string::npos) {
+      return false;
+    }
+
+    identifier = pattern.substr(i + 1, end - i - 1);
+    format = identifier.find('%');
+    if (format != std::string::npos) {
+      if (identifier.compare(format, 2, "%0") ||
+          identifier[identifier.size() - 1] != 'd') {
+        return false;
+      }
+      width = atoi(identifier.c_str() + format + 2);
+      identifier = identifier.substr(0, format);
+    }
+
+    if (identifier.empty()) {
+      *result += '$';
+    } else if (identifier == "RepresentationID") {
+      *result += id;
+    } else if (identifier == "Bandwidth") {
+      *result += toString(bandwidth, width);
+    } else if (identifier == "Number") {
+      *result += toString(number, width);
+    } else if (identifier == "Time") {
+      *result += toString(time, width);
+    } else {
+      return false;
+    }
+    i = end;
+  }
+  return true;
+}
+
+static void setCodecs(const std::string &mimeType, const std::string &codecs,
+                      MetadataStreamInit *init) {
+  init->mimeType = mimeType;
+  if (!codecs.empty()) {
+    init->mimeType += "; codecs=\"" + codecs + "\"";
+  }
+}
+
+struct TimelineEntry {
+  bool hasTime;
+  uint64_t time;
+  uint64_t duration;
+  int64_t repeat;
+};
+
+struct SegmentURL {
+  std::string media;
+  std::string mediaRange;
+};
+
+// The state of a Period, AdaptationSet or Representation, inherited by the
+// elements it contains.
+struct ManifestImporter::DASHLevel {
+  DASHLevel() : hasBaseURL(false), bandwidth(0), width(0), height(0),
+    numChannels(0), samplingFrequency(0), hasSegments(false),
+    segmentList(false), timescale(1), duration(0), startNumber(1),
+    presentationTimeOffset(0) {
+  }
+
+  std::string baseURL;
+  bool hasBaseURL;
+  std::string id;
+  std::string mimeType;
+  std::string contentType;
+  std::string codecs;
+  uint32_t bandwidth;
+  int32_t width;
+  int32_t height;
+  int32_t numChannels;
+  int32_t samplingFrequency;
+
+  bool hasSegments;
+  bool segmentList;
+  std::string media;
+  std::string initialization;
+  std::string initializationRange;
+  uint64_t timescale;
+  uint64_t duration;
+  uint64_t startNumber;
+  uint64_t presentationTimeOffset;
+  std::vector<TimelineEntry> timeline;
+  std::vector<SegmentURL> segmentURLs;
+};
+
+ManifestImporter::ManifestImporter() : _duration(0) {
+}
+
+ManifestImporter::~ManifestImporter() {
+  _clear();
+}
+
+void ManifestImporter::_clear() {
+  for (size_t s = 0; s < _streams.size(); ++s) {
+    delete _streams[s].media;
+  }
+  _streams.clear();
+  _duration = 0;
+}
+
+ManifestImporter::Format ManifestImporter::detect(
+    const std::string &manifest) {
+  size_t start = 0;
+
+  // Skip a UTF-8 byte order mark.
+  if (!manifest.compare(0, 3, "\xEF\xBB\xBF")) {
+    start = 3;
+  }
+
+  start = manifest.find_first_not_of(" \t\r\n", start);
+  if (start == std::string::npos) {
+    return kUnknown;
+  }
+
+  if (!manifest.compare(start, 7, "#EXTM3U")) {
+    return kHLS;
+  }
+
+  if (manifest[start] == '<' && manifest.find("MPD") != std::string::npos) {
+    return kDASH;
+  }
+  return kUnknown;
+}
+
+bool ManifestImporter::load(const std::string &path) {
+  std::string manifest;
+  bool result = false;
+
+  _clear();
+  if (!readFile(path, &manifest)) {
+    return false;
+  }
+
+  switch (detect(manifest)) {
+    case kDASH:
+      result = _loadDASH(manifest, path);
+      break;
+    case kHLS:
+      result = _loadHLS(manifest, path);
+      break;
+    default:
+      break;
+  }
+
+  for (size_t s = 0; result && s < _streams.size(); ++s) {
+    result = _streams[s].media->Load(NULL);
+  }
+
+  if (!result || _streams.empty()) {
+    _clear();
+    return false;
+  }
+  return true;
+}
+
+bool ManifestImporter::_loadDASH(const std::string &manifest,
+                                 const std::string &path) {
+  std::vector<DASHLevel> levels(1);
+  size_t position = 0;
+  uint32_t periods = 0;
+  double periodDuration = 0;
+  bool inBaseURL = false;
+  XMLTag tag;
+  std::string text;
+
+  levels[0].baseURL = path;
+  while (nextTag(manifest, &position, &tag, &text)) {
+    DASHLevel &level = levels.back();
+    const Attributes &attributes = tag.attributes;
+
+    if (tag.closing) {
+      if (tag.name == "BaseURL" && inBaseURL) {
+        inBaseURL = false;
+        if (!level.hasBaseURL && !trim(text).empty()) {
+          if (!resolve(level.baseURL, trim(text), &level.baseURL)) {
+            return false;
+          }
+          level.hasBaseURL = true;
+        }
+      } else if (tag.name == "Representation" && levels.size() > 1) {
+        if (!_addDASHStream(level, periodDuration)) {
+          return false;
+        }
+        levels.pop_back();
+      } else if ((tag.name == "AdaptationSet" || tag.name == "Period") &&
+                 levels.size() > 1) {
+        levels.pop_back();
+      }
+
+      // Only the first Period is imported.
+      if (tag.name == "Period") {
+        break;
+      }
+      continue;
+    }
+
+    if (tag.name == "MPD") {
+      parseDuration(getAttribute(attributes, "mediaPresentationDuration"),
+                    &_duration);
+      periodDuration = _duration;
+      continue;
+    }
+
+    if (tag.name == "BaseURL") {
+      inBaseURL = !tag.empty;
+      continue;
+    }
+
+    if (tag.name == "Period" || tag.name == "AdaptationSet" ||
+        tag.name == "Representation") {
+      DASHLevel child = level;
+
+      if (tag.name == "Period") {
+        ++periods;
+        parseDuration(getAttribute(attributes, "duration"), &periodDuration);
+      }
+
+      child.hasBaseURL = false;
+      for (Attributes::const_iterator it = attributes.begin();
+           it != attributes.end(); ++it) {
+        if (it->first == "id") {
+          child.id = it->second;
+        } else if (it->first == "mimeType") {
+          child.mimeType = it->second;
+        } else if (it->first == "contentType") {
+          child.contentType = it->second;
+        } else if (it->first == "codecs") {
+          child.codecs = it->second;
+        } else if (it->first == "bandwidth") {
+          child.bandwidth = static_cast<uint32_t>(toUnsigned(it->second));
+        } else if (it->first == "width") {
+          child.width = atoi(it->second.c_str());
+        } else if (it->first == "height") {
+          child.height = atoi(it->second.c_str());
+        } else if (it->first == "audioSamplingRate") {
+          child.samplingFrequency = atoi(it->second.c_str());
+        }
+      }
+
+      if (tag.name == "Representation" && tag.empty) {
+        if (!_addDASHStream(child, periodDuration)) {
+          return false;
+        }
+      } else if (!tag.empty) {
+        levels.push_back(child);
+      }
+      continue;
+    }
+
+    if (tag.name == "AudioChannelConfiguration") {
+      int channels = atoi(getAttribute(attributes, "value").c_str());
+
+      if (channels > 0) {
+        level.numChannels = channels;
+      }
+    } else if (tag.name == "SegmentTemplate" || tag.name == "SegmentList") {
+      level.hasSegments = true;
+      level.segmentList = tag.name == "SegmentList";
+      if (level.segmentList) {
+        level.segmentURLs.clear();
+        level.initialization.clear();
+        level.initializationRange.clear();
+      }
+
+      for (Attributes::const_iterator it = attributes.begin();
+           it != attributes.end(); ++it) {
+        if (it->first == "media") {
+          level.media = it->second;
+        } else if (it->first == "initialization") {
+          level.initialization = it->second;
+        } else if (it->first == "timescale") {
+          level.timescale = toUnsigned(it->second);
+        } else if (it->first == "duration") {
+          level.duration = toUnsigned(it->second);
+        } else if (it->first == "startNumber") {
+          level.startNumber = toUnsigned(it->second);
+        } else if (it->first == "presentationTimeOffset") {
+          level.presentationTimeOffset = toUnsigned(it->second);
+        }
+      }
+    } else if (tag.name == "SegmentTimeline") {
+      level.timeline.clear();
+    } else if (tag.name == "S") {
+      TimelineEntry entry;
+
+      entry.hasTime = attributes.count("t") != 0;
+      entry.time = toUnsigned(getAttribute(attributes, "t"));
+      entry.duration = toUnsigned(getAttribute(attributes, "d"));
+      entry.repeat = atol(getAttribute(attributes, "r").c_str());
+      level.timeline.push_back(entry);
+    } else if (tag.name == "SegmentURL") {
+      SegmentURL url;
+
+      url.media = getAttribute(attributes, "media");
+      url.mediaRange = getAttribute(attributes, "mediaRange");
+      level.segmentURLs.push_back(url);
+    } else if (tag.name == "Initialization") {
+      level.initialization = getAttribute(attributes, "sourceURL");
+      level.initializationRange = getAttribute(attributes, "range");
+    }
+  }
+
+  return periods > 0;
+}
+
+bool ManifestImporter::_addDASHStream(const DASHLevel &level,
+                                      double periodDuration) {
+  Stream stream;
+  std::vector<uint64_t> times;
+  std::vector<uint64_t> numbers;
+  std::string url;
+  std::string path;
+  std::streamsize offset = 0;
+  std::streamsize length = -1;
+
+  if (!level.hasSegments || !level.timescale) {
+    return false;
+  }
+
+  // List the start time and number of every segment, in the timescale of
+  // the template.
+  uint64_t end = level.presentationTimeOffset + static_cast<uint64_t>(
+    periodDuration * level.timescale / 1000.0 + 0.5);
+  uint64_t number = level.startNumber;
+  uint64_t time = level.presentationTimeOffset;
+
+  for (size_t e = 0; e < level.timeline.size(); ++e) {
+    const TimelineEntry &entry = level.timeline[e];
+    int64_t repeat = entry.repeat;
+
+    if (!entry.duration) {
+      return false;
+    }
+
+    if (entry.hasTime) {
+      time = entry.time;
+    }
+
+    // A negative repeat count lasts until the next entry or the end of the
+    // Period.
+    if (repeat < 0) {
+      uint64_t until = e + 1 < level.timeline.size() &&
+        level.timeline[e + 1].hasTime ? level.timeline[e + 1].time : end;
+
+      repeat = until > time ?
+        static_cast<int64_t>((until - time + entry.duration - 1) /
+                             entry.duration) - 1 : 0;
+    }
+
+    for (int64_t r = 0; r <= repeat; ++r) {
+      times.push_back(time);
+      numbers.push_back(number++);
+      time += entry.duration;
+    }
+  }
+
+  if (level.timeline.empty()) {
+    uint64_t count = level.segmentList ? level.segmentURLs.size() : 0;
+
+    if (!level.segmentList) {
+      if (!level.duration) {
+        return false;
+      }
+      count = (end - level.presentationTimeOffset + level.duration - 1) /
+        level.duration;
+    } else if (count > 1 && !level.duration) {
+      return false;
+    }
+
+    for (uint64_t i = 0; i < count; ++i) {
+      times.push_back(level.presentationTimeOffset + i * level.duration);
+      numbers.push_back(level.startNumber + i);
+    }
+  }
+
+  if (times.empty() ||
+      (level.segmentList && times.size() > level.segmentURLs.size())) {
+    return false;
+  }
+
+  stream.init.type = startsWith(level.mimeType, "video/") ? kVideoType :
+    startsWith(level.mimeType, "audio/") ? kAudioType :
+    level.contentType == "video" ? kVideoType :
+    level.contentType == "audio" ? kAudioType : 0;
+  setCodecs(level.mimeType, level.codecs, &stream.init);
+  stream.init.bandwidth = level.bandwidth;
+  stream.init.width = level.width;
+  stream.init.height = level.height;
+  stream.init.numChannels = level.numChannels;
+  stream.init.samplingFrequency = level.samplingFrequency;
+  stream.media = new SegmentListMedia();
+  _streams.push_back(stream);
+
+  if (!level.initialization.empty() || !level.initializationRange.empty()) {
+    if (!expandTemplate(level.initialization, level.id, level.bandwidth, 0,
+                        0, &url) || !resolve(level.baseURL, url, &path) ||
+        (!level.initializationRange.empty() &&
+         !parseRange(level.initializationRange, &offset, &length))) {
+      return false;
+    }
+    stream.media->setInitSegment(path, offset, length);
+  }
+
+  for (size_t i = 0; i < times.size(); ++i) {
+    uint64_t timecode = times[i] > level.presentationTimeOffset ?
+      (times[i] - level.presentationTimeOffset) * 1000 / level.timescale : 0;
+
+    offset = 0;
+    length = -1;
+    if (level.segmentList) {
+      url = level.segmentURLs[i].media;
+      if (!level.segmentURLs[i].mediaRange.empty() &&
+          !parseRange(level.segmentURLs[i].mediaRange, &offset, &length)) {
+        return false;
+      }
+    } else if (!expandTemplate(level.media, level.id, level.bandwidth,
+                               numbers[i], times[i], &url)) {
+      return false;
+    }
+
+    if (!resolve(level.baseURL, url, &path) ||
+        !stream.media->addMediaSegment(static_cast<uint32_t>(timecode), path,
+                                       offset, length)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Parse an HLS attribute list, such as BANDWIDTH=800000,CODECS="a,b".
+static void parseAttributeList(const std::string &list,
+                               Attributes *attributes) {
+  attributes->clear();
+  for (size_t cursor = 0; cursor < list.size();) {
+    size_t equal = list.find('=', cursor);
+    size_t end;
+    std::string value;
+
+    if (equal == std::string::npos) {
+      return;
+    }
+
+    if (equal + 1 < list.size() && list[equal + 1] == '"') {
+      end = list.find('"', equal + 2);
+      if (end == std::string::npos) {
+        return;
+      }
+      value = list.substr(equal + 2, end - equal - 2);
+      end = list.find(',', end);
+    } else {
+      end = list.find(',', equal);
+      value = list.substr(equal + 1, end == std::string::npos ?
+                          std::string::npos : end - equal - 1);
+    }
+
+    (*attributes)[trim(list.substr(cursor, equal - cursor))] = value;
+    cursor = end == std::string::npos ? list.size() : end + 1;
+  }
+}
+
+static void splitLines(const std::string &content,
+                       std::vector<std::string> *lines) {
+  std::istringstream stream(content);
+  std::string line;
+
+  lines->clear();
+  while (std::getline(stream, line)) {
+    line = trim(line);
+    if (!line.empty()) {
+      lines->push_back(line);
+    }
+  }
+}
+
+// Tell whether an HLS CODECS attribute only lists audio codecs, for
+// audio only variants that have no RESOLUTION.
+static bool isAudioCodecs(const std::string &codecs) {
+  static const char *kAudioCodecs[] = {
+    "mp4a", "ac-3", "ec-3", "opus", "flac", "vorbis"
+  };
+  std::istringstream stream(codecs);
+  std::string codec;
+
+  while (std::getline(stream, codec, ',')) {
+    size_t c = 0;
+
+    codec = trim(codec);
+    while (c < sizeof(kAudioCodecs) / sizeof(kAudioCodecs[0]) &&
+           !startsWith(codec, kAudioCodecs[c])) {
+      ++c;
+    }
+
+    if (c == sizeof(kAudioCodecs) / sizeof(kAudioCodecs[0])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Guess the mime type of HLS segments, which playlists do not declare,
+// from their file extension.
+static std::string guessMimeType(const std::string &path, uint8_t type) {
+  std::string extension = path.substr(path.rfind('.') + 1);
+  const char *kind = type == kAudioType ? "audio/" : "video/";
+
+  if (extension == "ts") {
+    return "video/mp2t";
+  } else if (extension == "aac") {
+    return "audio/aac";
+  } else if (extension == "webm") {
+    return std::string(kind) + "webm";
+  }
+  return std::string(kind) + "mp4";
+}
+
+bool ManifestImporter::_loadHLS(const std::string &manifest,
+                                const std::string &path) {
+  std::vector<std::string> lines;
+  std::vector<std::string> playlists;
+  Attributes attributes;
+
+  splitLines(manifest, &lines);
+  if (manifest.find("#EXT-X-STREAM-INF") == std::string::npos) {
+    return _loadMediaPlaylist(manifest, path, MetadataStreamInit(),
+                              std::string());
+  }
+
+  for (size_t l = 0; l < lines.size(); ++l) {
+    MetadataStreamInit init;
+    std::string playlist;
+    std::string content;
+    std::string codecs;
+    bool variant = startsWith(lines[l], "#EXT-X-STREAM-INF:");
+
+    if (variant) {
+      std::string resolution;
+      size_t x;
+
+      parseAttributeList(lines[l].substr(18), &attributes);
+      if (l + 1 >= lines.size() || lines[l + 1][0] == '#') {
+        return false;
+      }
+
+      codecs = attributes["CODECS"];
+      resolution = attributes["RESOLUTION"];
+      x = resolution.find('x');
+      init.type = !codecs.empty() && x == std::string::npos &&
+        isAudioCodecs(codecs) ? kAudioType : kVideoType;
+      init.bandwidth = static_cast<uint32_t>(
+        toUnsigned(attributes["BANDWIDTH"]));
+      if (x != std::string::npos) {
+        init.width = atoi(resolution.c_str());
+        init.height = atoi(resolution.c_str() + x + 1);
+      }
+      playlist = lines[++l];
+    } else if (startsWith(lines[l], "#EXT-X-MEDIA:")) {
+      parseAttributeList(lines[l].substr(13), &attributes);
+      if (attributes["TYPE"] != "AUDIO" || attributes["URI"].empty()) {
+        continue;
+      }
+
+      init.type = kAudioType;
+      init.numChannels = atoi(attributes["CHANNELS"].c_str());
+      codecs = attributes["CODECS"];
+      playlist = attributes["URI"];
+    } else {
+      continue;
+    }
+
+    if (!resolve(path, playlist, &playlist)) {
+      return false;
+    }
+
+    // Variants sharing a media playlist, for different audio groups, make
+    // a single stream.
+    bool seen = false;
+    for (size_t p = 0; p < playlists.size(); ++p) {
+      seen = seen || playlists[p] == playlist;
+    }
+    if (seen) {
+      continue;
+    }
+
+    playlists.push_back(playlist);
+    if (!readFile(playlist, &content) || detect(content) != kHLS ||
+        !_loadMediaPlaylist(content, playlist, init, codecs)) {
+      return false;
+    }
+  }
+
+  return !_streams.empty();
+}
+
+bool ManifestImporter::_loadMediaPlaylist(const std::string &manifest,
+                                          const std::string &path,
+                                          const MetadataStreamInit &init,
+                                          const std::string &codecs) {
+  std::vector<std::string> lines;
+  std::string mapPath;
+  std::string lastPath;
+  std::streamsize lastEnd = 0;
+  std::streamsize offset = 0;
+  std::streamsize length = -1;
+  bool hasRange = false;
+  double time = 0;
+  double duration = -1;
+  Stream stream;
+  Attributes attributes;
+
+  splitLines(manifest, &lines);
+  stream.init = init;
+  stream.media = new SegmentListMedia();
+  _streams.push_back(stream);
+
+  for (size_t l = 0; l < lines.size(); ++l) {
+    const std::string &line = lines[l];
+
+    if (startsWith(line, "#EXTINF:")) {
+      duration = strtod(line.c_str() + 8, NULL);
+    } else if (startsWith(line, "#EXT-X-BYTERANGE:")) {
+      size_t at = line.find('@');
+
+      length = static_cast<std::streamsize>(toUnsigned(line.substr(17)));
+      offset = at == std::string::npos ? -1 :
+        static_cast<std::streamsize>(toUnsigned(line.substr(at + 1)));
+      hasRange = true;
+    } else if (startsWith(line, "#EXT-X-MAP:")) {
+      std::string initPath;
+      std::streamsize initOffset = 0;
+      std::streamsize initLength = -1;
+      size_t at;
+
+      parseAttributeList(line.substr(11), &attributes);
+      if (!resolve(path, attributes["URI"], &initPath)) {
+        return false;
+      }
+
+      at = attributes["BYTERANGE"].find('@');
+      if (!attributes["BYTERANGE"].empty()) {
+        initLength = static_cast<std::streamsize>(
+          toUnsigned(attributes["BYTERANGE"]));
+        initOffset = at == std::string::npos ? 0 :
+          static_cast<std::streamsize>(
+            toUnsigned(attributes["BYTERANGE"].substr(at + 1)));
+      }
+
+      // A stream has a single init segment.
+      if (!mapPath.empty() && mapPath != initPath) {
+        return false;
+      }
+      mapPath = initPath;
+      stream.media->setInitSegment(initPath, initOffset, initLength);
+    } else if (line[0] != '#') {
+      std::string segmentPath;
+
+      if (duration < 0 || !resolve(path, line, &segmentPath)) {
+        return false;
+      }
+
+      // A byte range without offset follows the previous one of the same
+      // file.
+      if (hasRange && offset == -1) {
+        if (segmentPath != lastPath) {
+          return false;
+        }
+        offset = lastEnd;
+      }
+
+      if (!stream.media->addMediaSegment(
+            static_cast<uint32_t>(time * 1000.0 + 0.5), segmentPath,
+            hasRange ? offset : 0, hasRange ? length : -1)) {
+        return false;
+      }
+
+      lastPath = segmentPath;
+      lastEnd = hasRange ? offset + length : 0;
+      time += duration;
+      duration = -1;
+      hasRange = false;
+      offset = 0;
+      length = -1;
+    }
+  }
+
+  if (lastPath.empty()) {
+    return false;
+  }
+
+  setCodecs(guessMimeType(lastPath, init.type), codecs,
+            &_streams.back().init);
+  if (time * 1000.0 > _duration) {
+    _duration = time * 1000.0;
+  }
+  return true;
+}
+
+size_t ManifestImporter::getStreamCount() const {
+  return _streams.size();
+}
+
+const MetadataStreamInit &ManifestImporter::getStreamInit(
+    size_t index) const {
+  return _streams[index].init;
+}
+
+MediaInterface *ManifestImporter::getMedia(size_t index) const {
+  return _streams[index].media;
+}
+
+double ManifestImporter::getDuration() const {
+  return _duration;
+}
+
+void ManifestImporter::addStreams(MetadataBuilder *builder,
+                                  ChunkerInterface *chunker) {
+  for (size_t s = 0; s < _streams.size(); ++s) {
+    builder->addStream(_streams[s].init, _streams[s].media, chunker);
+  }
+}
+
+}  // namespace peeracle
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_METADATA_MANIFESTIMPORTER_H_
+#define PEERACLE_METADATA_MANIFESTIMPORTER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "peeracle/Chunker/ChunkerInterface.h"
+#include "peeracle/Media/SegmentListMedia.h"
+#include "peeracle/Metadata/MetadataBuilder.h"
+#include "peeracle/Metadata/MetadataStreamInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Import content that is already packaged for DASH or HLS, from its
+ * manifest and the segment files it lists, without parsing the media
+ * containers. The streams and the segment timecodes come from the
+ * manifest, and only the segment bytes are read, when MetadataBuilder
+ * hashes them.
+ *
+ * A DASH MPD gives a stream per Representation of its first Period, whose
+ * segments are listed by a SegmentTemplate, with or without a
+ * SegmentTimeline, or by a SegmentList. Representations only described by
+ * a SegmentBase are indexed inside the media and are not supported.
+ * An HLS master playlist gives a stream per variant and per alternative
+ * audio rendition, read from their media playlists, and a media playlist
+ * gives a single stream.
+ *
+ * Segment URLs are resolved against the manifest path and must name local
+ * files.
+ * \addtogroup Metadata
+ */
+class ManifestImporter {
+ public:
+  enum Format {
+    kUnknown,
+    kDASH,
+    kHLS
+  };
+
+  ManifestImporter();
+  ~ManifestImporter();
+
+  /**
+   * Detect the format of a manifest from its content.
+   */
+  static Format detect(const std::string &manifest);
+
+  /**
+   * Read the manifest at \p path, then check that every segment file it
+   * lists exists and holds the byte range of its segment.
+   * \return false if the manifest can not be read or describes content
+   * that is not supported, in which case no stream is imported.
+   */
+  bool load(const std::string &path);
+
+  size_t getStreamCount() const;
+  const MetadataStreamInit &getStreamInit(size_t index) const;
+  MediaInterface *getMedia(size_t index) const;
+
+  /**
+   * Get the content duration in milliseconds, as declared by a DASH MPD or
+   * as the longest HLS media playlist.
+   */
+  double getDuration() const;
+
+  /**
+   * Add every stream imported to \p builder, to be chunked by \p chunker.
+   * The medias remain owned by this object.
+   */
+  void addStreams(MetadataBuilder *builder, ChunkerInterface *chunker);
+
+ private:
+  struct Stream {
+    MetadataStreamInit init;
+    SegmentListMedia *media;
+  };
+
+  struct DASHLevel;
+
+  bool _loadDASH(const std::string &manifest, const std::string &path);
+  bool _addDASHStream(const DASHLevel &level, double periodDuration);
+  bool _loadHLS(const std::string &manifest, const std::string &path);
+  bool _loadMediaPlaylist(const std::string &manifest, const std::string &path,
+                          const MetadataStreamInit &init,
+                          const std::string &codecs);
+  void _clear();
+
+  std::vector<Stream> _streams;
+  double _duration;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_METADATA_MANIFESTIMPORTER_H_
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/Chunker/FixedSizeChunker.h"
+#include "peeracle/DataStream/FileDataStream.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Metadata/ManifestImporter.h"
+#include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataBuilder.h"
+
+namespace peeracle {
+
+class ManifestImporterTest : public testing::Test {
+ protected:
+  ManifestImporterTest() : _state(0x4D504421) {
+  }
+
+  virtual void TearDown() {
+    for (size_t f = 0; f < _files.size(); ++f) {
+      remove(_files[f].c_str());
+    }
+  }
+
+  // Write \p length pseudo random bytes to \p path.
+  const std::vector<uint8_t> &writeFile(const std::string &path,
+                                        size_t length) {
+    std::vector<uint8_t> &bytes = _bytes[path];
+
+    bytes.resize(length);
+    for (size_t i = 0; i < length; ++i) {
+      _state ^= _state << 13;
+      _state ^= _state >> 17;
+      _state ^= _state << 5;
+      bytes[i] = static_cast<uint8_t>(_state);
+    }
+    writeFile(path, std::string(bytes.begin(), bytes.end()));
+    return bytes;
+  }
+
+  void writeFile(const std::string &path, const std::string &content) {
+    DataStreamInit dsInit;
+
+    remove(path.c_str());
+    _files.push_back(path);
+    dsInit.path = path;
+    dsInit.create = true;
+    FileDataStream file(dsInit);
+    ASSERT_TRUE(file.open());
+    ASSERT_EQ(static_cast<std::streamsize>(content.size()),
+              file.write(content.c_str(), content.size()));
+  }
+
+  std::string read(MediaInterface *media, int32_t timecode) {
+    DataStreamInit dsInit;
+    MemoryDataStream out(dsInit);
+
+    if (timecode < 0) {
+      media->getInitSegment(&out);
+    } else {
+      media->getMediaSegment(timecode, &out);
+    }
+    return std::string(reinterpret_cast<const char *>(out.getBuffer()),
+                       static_cast<size_t>(out.length()));
+  }
+
+  std::string bytes(const std::string &path, size_t offset = 0,
+                    size_t length = std::string::npos) {
+    const std::vector<uint8_t> &file = _bytes[path];
+
+    return std::string(file.begin(), file.end()).substr(offset, length);
+  }
+
+  uint32_t _state;
+  std::vector<std::string> _files;
+  std::map<std::string, std::vector<uint8_t> > _bytes;
+};
+
+TEST_F(ManifestImporterTest, Detect) {
+  EXPECT_EQ(ManifestImporter::kHLS,
+            ManifestImporter::detect("#EXTM3U\n#EXT-X-VERSION:7\n"));
+  EXPECT_EQ(ManifestImporter::kDASH, ManifestImporter::detect(
+    "\xEF\xBB\xBF<?xml version=\"1.0\"?>\n<MPD type=\"static\"></MPD>"));
+  EXPECT_EQ(ManifestImporter::kUnknown,
+            ManifestImporter::detect("\x1A\x45\xDF\xA3"));
+  EXPECT_EQ(ManifestImporter::kUnknown, ManifestImporter::detect(""));
+}
+
+TEST_F(ManifestImporterTest, DASHSegmentTemplate) {
+  ManifestImporter importer;
+
+  writeFile("mi_v1_init.mp4", 700);
+  writeFile("mi_v1_0.m4s", 5000);
+  writeFile("mi_v1_180000.m4s", 4000);
+  writeFile("mi_v1_360000.m4s", 3000);
+  writeFile("mi_v1_540000.m4s", 1000);
+  writeFile("mi_a_init.mp4", 500);
+  writeFile("mi_a_00001.m4s", 600);
+  writeFile("mi_a_00002.m4s", 601);
+  writeFile("mi_a_00003.m4s", 602);
+  writeFile("mi.mpd",
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<!-- Packaged by a CDN -->\n"
+    "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"static\"\n"
+    "     mediaPresentationDuration=\"PT7.5S\">\n"
+    "  <Period id=\"0\">\n"
+    "    <AdaptationSet mimeType=\"video/mp4\" codecs=\"avc1.64001f\">\n"
+    "      <SegmentTemplate timescale=\"90000\"\n"
+    "          initialization=\"mi_$RepresentationID$_init.mp4\"\n"
+    "          media=\"mi_$RepresentationID$_$Time$.m4s\">\n"
+    "        <SegmentTimeline>\n"
+    "          <S t=\"0\" d=\"180000\" r=\"2\"/>\n"
+    "          <S d=\"135000\"/>\n"
+    "        </SegmentTimeline>\n"
+    "      </SegmentTemplate>\n"
+    "      <Representation id=\"v1\" bandwidth=\"2500000\" width=\"1280\"\n"
+    "          height=\"720\"/>\n"
+    "    </AdaptationSet>\n"
+    "    <AdaptationSet contentType=\"audio\" mimeType=\"audio/mp4\">\n"
+    "      <Representation id=\"a\" codecs=\"mp4a.40.2\" bandwidth=\"128000\"\n"
+    "          audioSamplingRate=\"48000\">\n"
+    "        <AudioChannelConfiguration value=\"2\" schemeIdUri=\"urn:mpeg:"
+    "dash:23003:3:audio_channel_configuration:2011\"/>\n"
+    "        <SegmentTemplate timescale=\"48000\" duration=\"144000\"\n"
+    "            startNumber=\"1\" initialization=\"mi_a_init.mp4\"\n"
+    "            media=\"mi_a_$Number%05d$.m4s\"/>\n"
+    "      </Representation>\n"
+    "    </AdaptationSet>\n"
+    "  </Period>\n"
+    "</MPD>\n");
+
+  ASSERT_TRUE(importer.load("mi.mpd"));
+  EXPECT_EQ(7500.0, importer.getDuration());
+  ASSERT_EQ(2, importer.getStreamCount());
+
+  const MetadataStreamInit &video = importer.getStreamInit(0);
+  MediaInterface *media = importer.getMedia(0);
+  EXPECT_EQ(1, video.type);
+  EXPECT_EQ("video/mp4; codecs=\"avc1.64001f\"", video.mimeType);
+  EXPECT_EQ(2500000, video.bandwidth);
+  EXPECT_EQ(1280, video.width);
+  EXPECT_EQ(720, video.height);
+  ASSERT_EQ(4, media->getTimecodes().size());
+  EXPECT_EQ(0, media->getTimecodes()[0]);
+  EXPECT_EQ(2000, media->getTimecodes()[1]);
+  EXPECT_EQ(4000, media->getTimecodes()[2]);
+  EXPECT_EQ(6000, media->getTimecodes()[3]);
+  EXPECT_EQ(bytes("mi_v1_init.mp4"), read(media, -1));
+  EXPECT_EQ(bytes("mi_v1_360000.m4s"), read(media, 4000));
+
+  const MetadataStreamInit &audio = importer.getStreamInit(1);
+  media = importer.getMedia(1);
+  EXPECT_EQ(2, audio.type);
+  EXPECT_EQ("audio/mp4; codecs=\"mp4a.40.2\"", audio.mimeType);
+  EXPECT_EQ(2, audio.numChannels);
+  EXPECT_EQ(48000, audio.samplingFrequency);
+  ASSERT_EQ(3, media->getTimecodes().size());
+  EXPECT_EQ(3000, media->getTimecodes()[1]);
+  EXPECT_EQ(bytes("mi_a_00003.m4s"), read(media, 6000));
+}
+
+TEST_F(ManifestImporterTest, DASHSegmentList) {
+  ManifestImporter importer;
+
+  writeFile("mi_list.mp4", 10000);
+  writeFile("mi_list.mpd",
+    "<MPD mediaPresentationDuration=\"PT4S\"><Period>\n"
+    "  <BaseURL>mi_list.mp4</BaseURL>\n"
+    "  <AdaptationSet mimeType=\"video/webm\" codecs=\"vp9\">\n"
+    "    <Representation id=\"1\" bandwidth=\"800000\">\n"
+    "      <SegmentList timescale=\"1000\" duration=\"2000\">\n"
+    "        <Initialization range=\"0-999\"/>\n"
+    "        <SegmentURL mediaRange=\"1000-5999\"/>\n"
+    "        <SegmentURL mediaRange=\"6000-9999\"/>\n"
+    "      </SegmentList>\n"
+    "    </Representation>\n"
+    "  </AdaptationSet>\n"
+    "</Period></MPD>\n");
+
+  ASSERT_TRUE(importer.load("mi_list.mpd"));
+  ASSERT_EQ(1, importer.getStreamCount());
+  EXPECT_EQ("video/webm; codecs=\"vp9\"", importer.getStreamInit(0).mimeType);
+
+  MediaInterface *media = importer.getMedia(0);
+  ASSERT_EQ(2, media->getTimecodes().size());
+  EXPECT_EQ(2000, media->getTimecodes()[1]);
+  EXPECT_EQ(bytes("mi_list.mp4", 0, 1000), read(media, -1));
+  EXPECT_EQ(bytes("mi_list.mp4", 1000, 5000), read(media, 0));
+  EXPECT_EQ(bytes("mi_list.mp4", 6000, 4000), read(media, 2000));
+}
+
+TEST_F(ManifestImporterTest, DASHUnsupported) {
+  ManifestImporter importer;
+
+  writeFile("mi_base.mpd",
+    "<MPD mediaPresentationDuration=\"PT4S\"><Period><AdaptationSet>\n"
+    "  <Representation id=\"1\" bandwidth=\"800000\">\n"
+    "    <BaseURL>mi_base.mp4</BaseURL>\n"
+    "    <SegmentBase indexRange=\"800-1200\"/>\n"
+    "  </Representation>\n"
+    "</AdaptationSet></Period></MPD>\n");
+  writeFile("mi_remote.mpd",
+    "<MPD mediaPresentationDuration=\"PT4S\"><Period>\n"
+    "  <BaseURL>https://cdn.example.com/title/</BaseURL>\n"
+    "  <AdaptationSet><SegmentTemplate duration=\"2\" media=\"$Number$\"/>\n"
+    "    <Representation id=\"1\" bandwidth=\"800000\"/>\n"
+    "  </AdaptationSet></Period></MPD>\n");
+
+  EXPECT_FALSE(importer.load("mi_base.mpd"));
+  EXPECT_FALSE(importer.load("mi_remote.mpd"));
+  EXPECT_FALSE(importer.load("mi_missing.mpd"));
+  EXPECT_EQ(0, importer.getStreamCount());
+}
+
+TEST_F(ManifestImporterTest, HLSMasterPlaylist) {
+  ManifestImporter importer;
+
+  writeFile("mi_hls_v.mp4", 9000);
+  writeFile("mi_hls_a_init.mp4", 300);
+  writeFile("mi_hls_a_0.m4a", 1500);
+  writeFile("mi_hls_a_1.m4a", 1400);
+  writeFile("mi_hls.m3u8",
+    "#EXTM3U\n"
+    "#EXT-X-INDEPENDENT-SEGMENTS\n"
+    "#EXT-X-MEDIA:TYPE=AUDIO,GROUP-ID=\"aac\",NAME=\"English\","
+    "CHANNELS=\"2\",URI=\"mi_hls_a.m3u8\"\n"
+    "#EXT-X-STREAM-INF:BANDWIDTH=1200000,RESOLUTION=640x360,"
+    "CODECS=\"avc1.4d401e,mp4a.40.2\",AUDIO=\"aac\"\n"
+    "mi_hls_v.m3u8\n"
+    "#EXT-X-STREAM-INF:BANDWIDTH=1300000,RESOLUTION=640x360,"
+    "CODECS=\"avc1.4d401e,mp4a.40.2\",AUDIO=\"aac\"\n"
+    "mi_hls_v.m3u8\n");
+  writeFile("mi_hls_v.m3u8",
+    "#EXTM3U\r\n"
+    "#EXT-X-TARGETDURATION:4\r\n"
+    "#EXT-X-MAP:URI=\"mi_hls_v.mp4\",BYTERANGE=\"800@0\"\r\n"
+    "#EXTINF:4.004,\r\n"
+    "#EXT-X-BYTERANGE:5000@800\r\n"
+    "mi_hls_v.mp4\r\n"
+    "#EXTINF:3.5,\r\n"
+    "#EXT-X-BYTERANGE:3200\r\n"
+    "mi_hls_v.mp4\r\n"
+    "#EXT-X-ENDLIST\r\n");
+  writeFile("mi_hls_a.m3u8",
+    "#EXTM3U\n"
+    "#EXT-X-MAP:URI=\"mi_hls_a_init.mp4\"\n"
+    "#EXTINF:4.0,\n"
+    "mi_hls_a_0.m4a\n"
+    "#EXTINF:3.6,\n"
+    "mi_hls_a_1.m4a\n"
+    "#EXT-X-ENDLIST\n");
+
+  ASSERT_TRUE(importer.load("mi_hls.m3u8"));
+  EXPECT_EQ(7600.0, importer.getDuration());
+  ASSERT_EQ(2, importer.getStreamCount());
+
+  const MetadataStreamInit &audio = importer.getStreamInit(0);
+  MediaInterface *media = importer.getMedia(0);
+  EXPECT_EQ(2, audio.type);
+  EXPECT_EQ("audio/mp4", audio.mimeType);
+  EXPECT_EQ(2, audio.numChannels);
+  ASSERT_EQ(2, media->getTimecodes().size());
+  EXPECT_EQ(4000, media->getTimecodes()[1]);
+  EXPECT_EQ(bytes("mi_hls_a_init.mp4"), read(media, -1));
+  EXPECT_EQ(bytes("mi_hls_a_1.m4a"), read(media, 4000));
+
+  // The second variant shares the media playlist of the first.
+  const MetadataStreamInit &video = importer.getStreamInit(1);
+  media = importer.getMedia(1);
+  EXPECT_EQ(1, video.type);
+  EXPECT_EQ("video/mp4; codecs=\"avc1.4d401e,mp4a.40.2\"", video.mimeType);
+  EXPECT_EQ(1200000, video.bandwidth);
+  EXPECT_EQ(640, video.width);
+  EXPECT_EQ(360, video.height);
+  ASSERT_EQ(2, media->getTimecodes().size());
+  EXPECT_EQ(4004, media->getTimecodes()[1]);
+  EXPECT_EQ(bytes("mi_hls_v.mp4", 0, 800), read(media, -1));
+  EXPECT_EQ(bytes("mi_hls_v.mp4", 800, 5000), read(media, 0));
+  EXPECT_EQ(bytes("mi_hls_v.mp4", 5800, 3200), read(media, 4004));
+}
+
+TEST_F(ManifestImporterTest, HLSMissingSegment) {
+  ManifestImporter importer;
+
+  writeFile("mi_ts_0.ts", 1880);
+  writeFile("mi_ts.m3u8",
+    "#EXTM3U\n#EXTINF:6,\nmi_ts_0.ts\n#EXTINF:6,\nmi_ts_1.ts\n");
+  EXPECT_FALSE(importer.load("mi_ts.m3u8"));
+  EXPECT_EQ(0, importer.getStreamCount());
+
+  writeFile("mi_ts_1.ts", 1880);
+  ASSERT_TRUE(importer.load("mi_ts.m3u8"));
+  ASSERT_EQ(1, importer.getStreamCount());
+  EXPECT_EQ("video/mp2t", importer.getStreamInit(0).mimeType);
+  EXPECT_EQ(12000.0, importer.getDuration());
+}
+
+// The metadata built from a manifest only covers the segment bytes, as if
+// the media had been parsed.
+TEST_F(ManifestImporterTest, Build) {
+  ManifestImporter importer;
+  FixedSizeChunker chunker(1024);
+  DataStreamInit dsInit;
+  MemoryDataStream out(dsInit);
+  Metadata metadata;
+  Metadata loaded;
+
+  writeFile("mi_build_init.mp4", 400);
+  writeFile("mi_build_0.m4s", 3000);
+  writeFile("mi_build_1.m4s", 2500);
+  writeFile("mi_build.m3u8",
+    "#EXTM3U\n#EXT-X-MAP:URI=\"mi_build_init.mp4\"\n"
+    "#EXTINF:2,\nmi_build_0.m4s\n#EXTINF:2,\nmi_build_1.m4s\n");
+
+  ASSERT_TRUE(importer.load("mi_build.m3u8"));
+  metadata.setHashAlgorithm("murmur3_x86_128");
+  metadata.setTimecodeScale(1000000);
+  metadata.setDuration(importer.getDuration());
+
+  MetadataBuilder builder(&metadata);
+  importer.addStreams(&builder, &chunker);
+  ASSERT_TRUE(builder.build(&out));
+
+  ASSERT_EQ(0, out.seek(0));
+  ASSERT_TRUE(loaded.unserialize(&out));
+  EXPECT_EQ(4000.0, loaded.getDuration());
+  ASSERT_EQ(1, loaded.getStreams().size());
+
+  MetadataStreamInterface *stream = loaded.getStreams()[0];
+  EXPECT_EQ("video/mp4", stream->getMimeType());
+  ASSERT_EQ(400, stream->getInitSegmentLength());
+  EXPECT_EQ(0, memcmp(&_bytes["mi_build_init.mp4"][0],
+                      stream->getInitSegment(), 400));
+  ASSERT_EQ(2, stream->getMediaSegments().size());
+  EXPECT_EQ(2000, stream->getMediaSegments()[1]->getTimecode());
+  EXPECT_EQ(3000, stream->getMediaSegments()[0]->getLength());
+  EXPECT_EQ(2500, stream->getMediaSegments()[1]->getLength());
+  EXPECT_EQ(3, stream->getMediaSegments()[1]->getChunks().size());
+}
+
+}  // namespace peeracle
@@ -21,52 +21,195 @@
  */
 
 #include <iostream>
-#include <iomanip>
-#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Hash/Hex.h"
 #include "peeracle/Hash/Murmur3Hash.h"
 #include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataArena.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
 #include "peeracle/Metadata/MetadataStream.h"
+#include "peeracle/Metadata/MetadataV3Writer.h"
+#include "peeracle/Metadata/MetadataView.h"
 
 namespace peeracle {
 
-Metadata::Metadata() {
+Metadata::Metadata() : _idPending(true), _magic(0), _version(2),
+  _timeCodeScale(0), _duration(0), _live(false), _lazy(false),
+  _dataStream(NULL),
+  _arena(NULL) {
+}
+
+Metadata::~Metadata() {
+  for (size_t i = 0; i < _streams.size(); ++i) {
+    delete _streams[i];
+  }
+  delete _arena;
+}
+
+uint64_t Metadata::getSerializedSize() {
+  if (_version == 3) {
+    MetadataV3Writer writer(this);
+
+    return writer.getSize();
+  }
+  return _getSerializedSizeV2();
+}
+
+uint64_t Metadata::_getSerializedSizeV2() {
+  uint64_t size = 4 + sizeof(uint32_t) + _hashAlgorithm.size() + 1 +
+    sizeof(_timeCodeScale) + sizeof(_duration) + sizeof(uint32_t) +
+    sizeof(uint32_t);
+
+  for (size_t i = 0; i < _trackers.size(); ++i) {
+    size += _trackers[i].size() + 1;
+  }
+
+  for (size_t i = 0; i < _streams.size(); ++i) {
+    size += _streams[i]->getSerializedSize();
+  }
+
+  if (_live) {
+    size += sizeof(uint32_t);
+  }
+  return size;
+}
+
+uint64_t Metadata::getMemoryUsage() {
+  uint64_t size = sizeof(*this) + _id.capacity() + _hashAlgorithm.capacity() +
+    _trackersAddress.capacity() + _empty.capacity() +
+    _trackers.capacity() * sizeof(std::string) +
+    _streams.capacity() * sizeof(MetadataStreamInterface *);
+
+  for (size_t i = 0; i < _trackers.size(); ++i) {
+    size += _trackers[i].capacity();
+  }
+
+  for (size_t i = 0; i < _streams.size(); ++i) {
+    size += _streams[i]->getMemoryUsage();
+  }
+
+  if (_arena) {
+    size += _arena->getMemoryUsage();
+  }
+  return size;
+}
+
+void Metadata::compact() {
+  MetadataArena *arena = new MetadataArena();
+  uint64_t size = 0;
+
+  // Unless chunks are loaded lazily, the size of everything moved to the
+  // arena is known and it fits in a single block.
+  for (size_t s = 0; !_dataStream && s < _streams.size(); ++s) {
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      _streams[s]->getMediaSegments();
+
+    size += _streams[s]->getInitSegmentLength();
+    for (size_t i = 0; i < segments.size(); ++i) {
+      size += segments[i]->getChunkCount() * 16;
+    }
+  }
+  arena->reserve(static_cast<size_t>(size));
+
+  for (size_t s = 0; s < _streams.size(); ++s) {
+    _streams[s]->compact(arena);
+  }
+
+  std::vector<std::string>(_trackers).swap(_trackers);
+  std::vector<MetadataStreamInterface *>(_streams).swap(_streams);
+
+  delete _arena;
+  _arena = arena;
 }
 
 bool Metadata::serialize(DataStreamInterface *dataStream) {
-  uint32_t trackersSize;
+  if (_version == 3) {
+    MetadataV3Writer writer(this);
 
-  if (_trackers.size() > 0) {
-    trackersSize = static_cast<uint32_t>(_trackers.size());
-  } else {
-    trackersSize = 0;
+    return writer.write(dataStream);
   }
+  return _version == 2 && _serializeV2(dataStream);
+}
 
-  dataStream->write("PRCL", 4);
-  dataStream->write(static_cast<int32_t>(2));
-  dataStream->write(_hashAlgorithm);
-  dataStream->write(_timeCodeScale);
-  dataStream->write(_duration);
-  dataStream->write(trackersSize);
+bool Metadata::_serializeV2(DataStreamInterface *dataStream) {
+  DataStreamInit dsInit;
+  MemoryDataStream buffer(dsInit);
+  uint64_t size = _getSerializedSizeV2();
 
-  for (size_t i = 0; i < _trackers.size(); i++) {
-    dataStream->write(_trackers[i]);
+  if (size > static_cast<uint64_t>(0x7FFFFFFF)) {
+    return false;
   }
 
-  dataStream->write(0);
-  return false;
+  buffer.reserve(static_cast<std::streamsize>(size));
+  if (buffer.write("PRCL", 4) == -1 ||
+      buffer.write(static_cast<uint32_t>(2)) == -1 ||
+      buffer.write(_hashAlgorithm) == -1 ||
+      buffer.write(_timeCodeScale) == -1 ||
+      buffer.write(_duration) == -1 ||
+      buffer.write(static_cast<uint32_t>(_trackers.size())) == -1) {
+    return false;
+  }
+
+  for (size_t i = 0; i < _trackers.size(); ++i) {
+    if (buffer.write(_trackers[i]) == -1) {
+      return false;
+    }
+  }
+
+  if (buffer.write(static_cast<uint32_t>(_streams.size())) == -1) {
+    return false;
+  }
+
+  for (size_t i = 0; i < _streams.size(); ++i) {
+    if (!_streams[i]->serialize(&buffer)) {
+      return false;
+    }
+  }
+
+  // The flags come last and are only written when set, so that readers
+  // which stop after the streams still load the file.
+  if (_live && buffer.write(MetadataView::kLive) == -1) {
+    return false;
+  }
+
+  if (buffer.length() != static_cast<std::streamsize>(size)) {
+    return false;
+  }
+
+  return dataStream->write(reinterpret_cast<const char *>(buffer.getBuffer()),
+                           buffer.length()) == buffer.length();
 }
 
 bool Metadata::unserialize(DataStreamInterface *dataStream) {
-  HashInterface *hash;
-  uint8_t id[16];
+  std::streamsize start = dataStream->tell();
+  uint8_t version[4];
   uint32_t trackerCount;
   uint32_t streamCount;
+  uint32_t flags;
   std::string tracker;
-  std::stringstream buffer;
-  MetadataStreamInterface *stream;
+  MetadataStream *stream;
 
+  _id.clear();
+  _idPending = false;
+  _live = false;
+  _dataStream = NULL;
   if (dataStream->read(&_magic) == -1 ||
-    dataStream->read(&_version) == -1 ||
+      dataStream->peek(version, sizeof(version)) == -1) {
+    return false;
+  }
+
+  // Version 3 files store the version, like every other field, in big
+  // endian.
+  if (!version[0] && !version[1] && !version[2] &&
+      version[3] == MetadataView::kVersion) {
+    return dataStream->seek(start) == start &&
+      _unserializeView(dataStream);
+  }
+
+  if (dataStream->read(&_version) == -1 ||
     dataStream->read(&_hashAlgorithm) == -1 ||
     dataStream->read(&_timeCodeScale) == -1 ||
     dataStream->read(&_duration) == -1 ||
@@ -74,12 +217,10 @@ bool Metadata::unserialize(DataStreamInterface *dataStream) {
     return false;
   }
 
-  if (_hashAlgorithm != "murmur3_x86_128") {
+  if (_version != 2 || _hashAlgorithm != "murmur3_x86_128") {
     return false;
   }
 
-  hash = new Murmur3Hash();
-
   for (size_t i = 0; i < trackerCount; ++i) {
     if (dataStream->read(&tracker) == -1) {
       return false;
@@ -93,26 +234,291 @@ bool Metadata::unserialize(DataStreamInterface *dataStream) {
 
   for (size_t i = 0; i < streamCount; ++i) {
     stream = new MetadataStream();
-    if (!stream->unserialize(dataStream, _hashAlgorithm, hash)) {
+    if (_lazy ? !stream->unserializeIndex(dataStream, _hashAlgorithm) :
+        !stream->unserialize(dataStream, _hashAlgorithm, NULL)) {
+      delete stream;
       return false;
     }
     _streams.push_back(stream);
   }
 
-  hash->final(id);
-  for (int i = 0; i < 16; ++i) {
-    buffer << std::hex << std::setfill('0');
-    buffer << std::setw(2)  << static_cast<unsigned>(id[i]);
+  if (dataStream->length() - dataStream->tell() >=
+      static_cast<std::streamsize>(sizeof(flags))) {
+    if (dataStream->read(&flags) == -1) {
+      return false;
+    }
+    _live = (flags & MetadataView::kLive) != 0;
+  }
+
+  if (_lazy) {
+    _dataStream = dataStream;
   }
 
-  _id = buffer.str();
+  // A version 2 file has no stored id, it is computed on first use instead
+  // of hashing every chunk now.
+  _idPending = true;
   return true;
 }
 
+bool Metadata::_unserializeView(DataStreamInterface *dataStream) {
+  std::streamsize start = dataStream->tell();
+  std::streamsize length = dataStream->length() - start;
+  const uint8_t *buffer = dataStream->getBuffer();
+  std::vector<uint8_t> index;
+  MetadataView view;
+
+  if (length <= 0) {
+    return false;
+  }
+
+  // A data stream held in memory is parsed in place. Otherwise the whole
+  // file is read, or only up to the chunk table when chunks are lazy.
+  if (buffer) {
+    if (!view.open(buffer + start, static_cast<size_t>(length))) {
+      return false;
+    }
+  } else {
+    uint64_t indexLength = _lazy ? MetadataView::kHeaderSize :
+      static_cast<uint64_t>(length);
+
+    while (indexLength > index.size()) {
+      std::streamsize offset = static_cast<std::streamsize>(index.size());
+      std::streamsize size = static_cast<std::streamsize>(indexLength) -
+        offset;
+
+      if (indexLength > static_cast<uint64_t>(length)) {
+        return false;
+      }
+
+      index.resize(static_cast<size_t>(indexLength));
+      if (dataStream->read(reinterpret_cast<char *>(&index[offset]), size) !=
+          size) {
+        return false;
+      }
+
+      if (_lazy) {
+        indexLength = MetadataView::getIndexLength(&index[0], index.size());
+      }
+    }
+
+    if (!indexLength ||
+        !view.openIndex(&index[0], index.size(),
+                        static_cast<uint64_t>(length))) {
+      return false;
+    }
+  }
+
+  _version = view.getVersion();
+  _hashAlgorithm = view.getHashAlgorithm();
+  _timeCodeScale = view.getTimecodeScale();
+  _duration = view.getDuration();
+  _live = view.isLive();
+  for (uint32_t i = 0; i < view.getTrackerCount(); ++i) {
+    _trackers.push_back(view.getTrackerUrl(i));
+  }
+
+  for (uint32_t s = 0; s < view.getStreamCount(); ++s) {
+    MetadataView::Stream streamView;
+    MetadataStreamInit init;
+    MetadataStream *stream;
+
+    if (!view.getStream(s, &streamView)) {
+      return false;
+    }
+
+    init.type = streamView.getType();
+    init.mimeType = streamView.getMimeType();
+    init.bandwidth = streamView.getBandwidth();
+    init.width = streamView.getWidth();
+    init.height = streamView.getHeight();
+    init.numChannels = streamView.getNumChannels();
+    init.samplingFrequency = streamView.getSamplingFrequency();
+    init.chunkSize = streamView.getChunkSize();
+    stream = new MetadataStream(init);
+    _streams.push_back(stream);
+    stream->setInitSegment(streamView.getInitSegment(),
+                           streamView.getInitSegmentLength());
+
+    for (uint32_t i = 0; i < streamView.getSegmentCount(); ++i) {
+      MetadataView::Segment segmentView;
+      MetadataMediaSegment *segment;
+
+      if (!streamView.getSegment(i, &segmentView)) {
+        return false;
+      }
+
+      segment = new MetadataMediaSegment();
+      segment->setTimecode(segmentView.getTimecode());
+      segment->setLength(segmentView.getLength());
+      if (_lazy) {
+        segment->setChunkTable(dataStream, start +
+                               view.getChunkTableOffset() +
+                               static_cast<std::streamsize>(
+                                 segmentView.getFirstChunk()) *
+                               MetadataView::kChunkSize,
+                               segmentView.getChunkCount());
+      } else {
+        for (uint32_t c = 0; c < segmentView.getChunkCount(); ++c) {
+          segment->addChunk(segmentView.getChunk(c),
+                            segmentView.getChunkLength(c));
+        }
+      }
+      stream->addMediaSegment(segment);
+    }
+  }
+
+  if (_lazy) {
+    _dataStream = dataStream;
+  }
+
+  _id = Hex::encode(view.getId(), MetadataView::kDigestSize);
+  return dataStream->seek(start + length) == start + length;
+}
+
 const std::string &Metadata::getId() {
+  // The id stays pending when a chunk can not be read, so that a later
+  // call computes it again.
+  if (_idPending && _computeId(&_id)) {
+    _idPending = false;
+  }
   return _id;
 }
 
+bool Metadata::verifyId() {
+  std::string id;
+
+  return !getId().empty() && _computeId(&id) && id == _id;
+}
+
+bool Metadata::_computeId(std::string *id) {
+  Murmur3Hash hash;
+  uint8_t digest[16];
+
+  for (size_t s = 0; s < _streams.size(); ++s) {
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      _streams[s]->getMediaSegments();
+
+    hash.update(_streams[s]->getInitSegment(),
+                _streams[s]->getInitSegmentLength());
+    for (size_t i = 0; !isLive() && i < segments.size(); ++i) {
+      if (!segments[i]->updateHash(&hash)) {
+        return false;
+      }
+    }
+  }
+
+  hash.final(digest);
+  *id = Hex::encode(digest, sizeof(digest));
+  return true;
+}
+
+bool Metadata::isLive() {
+  return _live;
+}
+
+bool Metadata::serializeDelta(DataStreamInterface *dataStream,
+                              const std::vector<uint32_t> &firstSegments) {
+  uint32_t blockCount = 0;
+
+  for (size_t s = 0; s < _streams.size(); ++s) {
+    uint32_t first = s < firstSegments.size() ? firstSegments[s] : 0;
+
+    if (first < _streams[s]->getMediaSegments().size()) {
+      ++blockCount;
+    }
+  }
+
+  if (dataStream->write("PRCD", 4) == -1 ||
+      dataStream->write(static_cast<uint32_t>(1)) == -1 ||
+      dataStream->write(getId()) == -1 ||
+      dataStream->write(_live ? MetadataView::kLive : 0) == -1 ||
+      dataStream->write(blockCount) == -1) {
+    return false;
+  }
+
+  for (size_t s = 0; s < _streams.size(); ++s) {
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      _streams[s]->getMediaSegments();
+    uint32_t first = s < firstSegments.size() ? firstSegments[s] : 0;
+
+    if (first >= segments.size()) {
+      continue;
+    }
+
+    if (dataStream->write(static_cast<uint32_t>(s)) == -1 ||
+        dataStream->write(static_cast<uint32_t>(segments.size() - first)) ==
+        -1) {
+      return false;
+    }
+
+    for (size_t i = first; i < segments.size(); ++i) {
+      if (!segments[i]->serialize(dataStream, _streams[s]->getChunkSize())) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool Metadata::unserializeDelta(DataStreamInterface *dataStream) {
+  std::vector<std::pair<uint32_t, MetadataMediaSegmentInterface *> > added;
+  uint32_t magic;
+  uint32_t version;
+  std::string id;
+  uint32_t flags;
+  uint32_t blockCount;
+  bool result = true;
+
+  if (!isLive() || dataStream->read(&magic) == -1 ||
+      dataStream->read(&version) == -1 || dataStream->read(&id) == -1 ||
+      dataStream->read(&flags) == -1 || dataStream->read(&blockCount) == -1 ||
+      magic != 0x50524344 || version != 1 ||
+      !(flags & MetadataView::kLive) || id != getId()) {
+    return false;
+  }
+
+  // Parse the whole delta before appending anything, so a truncated delta
+  // leaves the metadata untouched.
+  for (uint32_t b = 0; result && b < blockCount; ++b) {
+    uint32_t stream;
+    uint32_t segmentCount;
+
+    if (dataStream->read(&stream) == -1 ||
+        dataStream->read(&segmentCount) == -1 || stream >= _streams.size()) {
+      result = false;
+      break;
+    }
+
+    for (uint32_t i = 0; i < segmentCount; ++i) {
+      MetadataMediaSegmentInterface *segment = new MetadataMediaSegment();
+
+      added.push_back(std::make_pair(stream, segment));
+      if (!segment->unserialize(dataStream, _hashAlgorithm,
+                                _streams[stream]->getChunkSize(), NULL)) {
+        result = false;
+        break;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < added.size(); ++i) {
+    MetadataStreamInterface *stream = _streams[added[i].first];
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      stream->getMediaSegments();
+
+    // Deltas may overlap, segments already known are skipped.
+    if (!result || (!segments.empty() &&
+        added[i].second->getTimecode() <= segments.back()->getTimecode())) {
+      delete added[i].second;
+      continue;
+    }
+    stream->addMediaSegment(added[i].second);
+  }
+
+  return result;
+}
+
 uint32_t Metadata::getMagic() {
   return _magic;
 }
@@ -141,6 +547,14 @@ std::vector<MetadataStreamInterface *> &Metadata::getStreams() {
   return _streams;
 }
 
+void Metadata::setLazy(bool lazy) {
+  _lazy = lazy;
+}
+
+void Metadata::setVersion(uint32_t version) {
+  _version = version;
+}
+
 void Metadata::setHashAlgorithm(const std::string &hashAlgorithm) {
   _hashAlgorithm = hashAlgorithm;
 }
@@ -156,4 +570,8 @@ void Metadata::setDuration(double duration) {
 void Metadata::addTracker(const std::string &tracker) {
   _trackers.push_back(tracker);
 }
+
+void Metadata::setLive(bool live) {
+  _live = live;
+}
 }  // namespace peeracle
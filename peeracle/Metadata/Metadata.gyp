@@ -29,16 +29,40 @@
       'type': 'static_library',
       'standalone_static_library': 1,
       'dependencies': [
+        '../Chunker/Chunker.gyp:peeracle_chunker',
         '../DataStream/DataStream.gyp:peeracle_datastream',
         '../Hash/Hash.gyp:peeracle_hash',
+        '../Media/Media.gyp:peeracle_media',
+        '../Utils/Utils.gyp:peeracle_logger',
       ],
       'sources': [
+        'ManifestImporter.cc',
+        'ManifestImporter.h',
         'MetadataInterface.h',
         'Metadata.cc',
         'Metadata.h',
+        'MetadataArena.cc',
+        'MetadataArena.h',
+        'MetadataBuilder.cc',
+        'MetadataBuilder.h',
+        'MetadataChunkIndex.cc',
+        'MetadataChunkIndex.h',
+        'MetadataFrameMap.cc',
+        'MetadataFrameMap.h',
+        'MetadataGenerator.cc',
+        'MetadataGenerator.h',
+        'MetadataSegmentIterator.cc',
+        'MetadataSegmentIterator.h',
         'MetadataStream.cc',
         'MetadataStream.h',
         'MetadataStreamInterface.h',
+        'MetadataV3Writer.cc',
+        'MetadataV3Writer.h',
+        'MetadataVerifier.cc',
+        'MetadataVerifier.h',
+        'MetadataVerifierObserver.h',
+        'MetadataView.cc',
+        'MetadataView.h',
         'MetadataMediaSegment.cc',
         'MetadataMediaSegment.h',
         'MetadataMediaSegmentInterface.h',
@@ -53,10 +77,79 @@
           'type': 'executable',
           'dependencies': [
             'peeracle_metadata',
+            '../Utils/Utils.gyp:peeracle_workerpool',
             '<(DEPTH)/test/test.gyp:peeracle_tests_utils',
           ],
           'sources': [
+            'ManifestImporter_unittest.cc',
             'Metadata_unittest.cc',
+            'MetadataBuilder_unittest.cc',
+            'MetadataChunkIndex_unittest.cc',
+            'MetadataFrameMap_unittest.cc',
+            'MetadataStream_unittest.cc',
+            'MetadataVerifier_unittest.cc',
+            'MetadataView_unittest.cc',
+          ],
+        },
+      ],
+    }],
+    ['build_benchmarks == 1', {
+      'targets': [
+        {
+          'target_name': 'peeracle_metadata_benchmark',
+          'type': 'executable',
+          'dependencies': [
+            'peeracle_metadata',
+            '<(DEPTH)/test/test.gyp:peeracle_benchmark_utils',
+          ],
+          'sources': [
+            'MetadataStream_benchmark.cc',
+          ],
+        },
+        {
+          'target_name': 'peeracle_metadata_builder_benchmark',
+          'type': 'executable',
+          'dependencies': [
+            'peeracle_metadata',
+            '../Utils/Utils.gyp:peeracle_workerpool',
+            '<(DEPTH)/test/test.gyp:peeracle_benchmark_utils',
+          ],
+          'sources': [
+            'MetadataBuilder_benchmark.cc',
+          ],
+        },
+        {
+          'target_name': 'peeracle_metadata_serialize_benchmark',
+          'type': 'executable',
+          'dependencies': [
+            'peeracle_metadata',
+            '<(DEPTH)/test/test.gyp:peeracle_benchmark_utils',
+          ],
+          'sources': [
+            'Metadata_benchmark.cc',
+          ],
+        },
+        {
+          'target_name': 'peeracle_metadata_parse_benchmark',
+          'type': 'executable',
+          'dependencies': [
+            'peeracle_metadata',
+            '<(DEPTH)/test/test.gyp:peeracle_benchmark_utils',
+          ],
+          'sources': [
+            'MetadataParse_benchmark.cc',
+          ],
+        },
+        {
+          'target_name': 'peeracle_metadata_verify_benchmark',
+          'type': 'executable',
+          'dependencies': [
+            'peeracle_metadata',
+            '../Utils/Utils.gyp:peeracle_workerpool',
+            '<(DEPTH)/test/test.gyp:peeracle_benchmark_utils',
+          ],
+          'sources': [
+            'MetadataVerify_benchmark.cc',
           ],
         },
       ],
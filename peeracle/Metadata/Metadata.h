@@ -29,9 +29,16 @@
 
 namespace peeracle {
 
+class MetadataArena;
+
+/**
+ * A metadata owns its streams, including the ones added to getStreams(),
+ * and deletes them with itself.
+ */
 class Metadata : public MetadataInterface {
  public:
   Metadata();
+  ~Metadata();
 
   const std::string &getId();
   uint32_t getMagic();
@@ -42,21 +49,48 @@ class Metadata : public MetadataInterface {
   std::vector<std::string> &getTrackerUrls();
   std::vector<MetadataStreamInterface *> &getStreams();
 
+  void setVersion(uint32_t version);
   void setHashAlgorithm(const std::string &hashAlgorithm);
   void setTimecodeScale(uint32_t timecodeScale);
   void setDuration(double duration);
   void addTracker(const std::string &tracker);
+  void setLive(bool live);
+
+  /**
+   * Only index the media segments in unserialize(), reading their chunk
+   * hashes from the data stream when first accessed. The chunk table of a
+   * version 3 file is not read at all by unserialize(). The data stream
+   * given to unserialize() must then outlive this object and keep its
+   * content.
+   */
+  void setLazy(bool lazy);
 
+  bool isLive();
+
+  uint64_t getSerializedSize();
+  uint64_t getMemoryUsage();
+  void compact();
   bool serialize(DataStreamInterface *dataStream);
   bool unserialize(DataStreamInterface *dataStream);
+  bool verifyId();
+  bool serializeDelta(DataStreamInterface *dataStream,
+                      const std::vector<uint32_t> &firstSegments);
+  bool unserializeDelta(DataStreamInterface *dataStream);
 
  private:
+  uint64_t _getSerializedSizeV2();
+  bool _serializeV2(DataStreamInterface *dataStream);
+  bool _unserializeView(DataStreamInterface *dataStream);
+  bool _computeId(std::string *id);
+
   std::string _id;
+  bool _idPending;
   uint32_t _magic;
   uint32_t _version;
   std::string _hashAlgorithm;
   uint32_t _timeCodeScale;
   double _duration;
+  bool _live;
   uint32_t _trackersNumber;
   std::string _trackersAddress;
   uint32_t _streamsNumber;
@@ -64,6 +98,10 @@ class Metadata : public MetadataInterface {
   std::string _empty;
   std::vector<std::string> _trackers;
   std::vector<MetadataStreamInterface *> _streams;
+
+  bool _lazy;
+  DataStreamInterface *_dataStream;
+  MetadataArena *_arena;
 };
 
 }  // namespace peeracle
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string>
+#include "peeracle/Metadata/MetadataArena.h"
+
+namespace peeracle {
+
+const size_t MetadataArena::kBlockSize = 65536;
+
+MetadataArena::MetadataArena() : _blocksSize(0), _cursor(NULL),
+  _remaining(0) {
+}
+
+MetadataArena::~MetadataArena() {
+  for (size_t i = 0; i < _blocks.size(); ++i) {
+    delete[] _blocks[i];
+  }
+}
+
+void MetadataArena::reserve(size_t size) {
+  if (size <= _remaining) {
+    return;
+  }
+
+  _cursor = new uint8_t[size];
+  _remaining = size;
+  _blocks.push_back(_cursor);
+  _blocksSize += size;
+}
+
+uint8_t *MetadataArena::allocate(size_t size) {
+  uint8_t *pointer;
+
+  if (size > _remaining) {
+    reserve(size > kBlockSize ? size : kBlockSize);
+  }
+
+  pointer = _cursor;
+  _cursor += size;
+  _remaining -= size;
+  return pointer;
+}
+
+const std::string *MetadataArena::intern(const std::string &value) {
+  return &*_strings.insert(value).first;
+}
+
+uint64_t MetadataArena::getMemoryUsage() const {
+  uint64_t size = sizeof(*this) + _blocksSize +
+    _blocks.capacity() * sizeof(uint8_t *);
+
+  for (std::set<std::string>::const_iterator it = _strings.begin();
+       it != _strings.end(); ++it) {
+    size += sizeof(*it) + it->capacity();
+  }
+  return size;
+}
+
+}  // namespace peeracle
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_METADATA_METADATAARENA_H_
+#define PEERACLE_METADATA_METADATAARENA_H_
+
+#include <stdint.h>
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace peeracle {
+
+/**
+ * Storage for the init segments, chunk hashes and strings of a compacted
+ * metadata. Bytes are carved from a few large blocks instead of one heap
+ * allocation each, and equal strings are stored once. Everything is freed
+ * with the arena.
+ * \addtogroup Metadata
+ */
+class MetadataArena {
+ public:
+  MetadataArena();
+  ~MetadataArena();
+
+  /**
+   * Make the next allocations totalling \p size bytes come from a single
+   * block.
+   */
+  void reserve(size_t size);
+
+  uint8_t *allocate(size_t size);
+
+  /**
+   * Get a copy of \p value shared with every other string interned in this
+   * arena.
+   */
+  const std::string *intern(const std::string &value);
+
+  /**
+   * Get the number of bytes held by the blocks and the interned strings.
+   */
+  uint64_t getMemoryUsage() const;
+
+ private:
+  static const size_t kBlockSize;
+
+  std::vector<uint8_t *> _blocks;
+  uint64_t _blocksSize;
+  uint8_t *_cursor;
+  size_t _remaining;
+  std::set<std::string> _strings;
+};
+
+}  // namespace peeracle
+
+#endif  // PEERACLE_METADATA_METADATAARENA_H_
@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Hash/Hex.h"
+#include "peeracle/Hash/Murmur3Hash.h"
+#include "peeracle/Metadata/MetadataBuilder.h"
+#include "peeracle/Metadata/MetadataStream.h"
+#include "peeracle/Metadata/MetadataV3Writer.h"
+
+namespace peeracle {
+
+static bool readRange(DataStreamInterface *dataStream,
+                      std::streamsize offset, std::streamsize length,
+                      std::vector<uint8_t> *buffer) {
+  buffer->resize(static_cast<size_t>(length));
+  if (!length) {
+    return true;
+  }
+
+  return dataStream->seek(offset) == offset &&
+    dataStream->read(reinterpret_cast<char *>(&(*buffer)[0]), length) ==
+    length;
+}
+
+static bool readAll(DataStreamInterface *dataStream,
+                    std::vector<uint8_t> *buffer) {
+  return readRange(dataStream, 0, dataStream->length(), buffer);
+}
+
+// The number of segments per thread read between two waits on the pool,
+// enough to keep the threads busy while the calling thread writes.
+static const size_t kSegmentsPerThread = 2;
+
+class MetadataBuilder::SegmentTask : public WorkerPoolInterface::Task {
+ public:
+  SegmentTask() : _source(0), _index(0), _timecode(0), _chunker(NULL) {
+  }
+
+  void reset(size_t source, uint32_t index, uint32_t timecode,
+             ChunkerInterface *chunker) {
+    _source = source;
+    _index = index;
+    _timecode = timecode;
+    _chunker = chunker;
+    _digests.clear();
+    _lengths.clear();
+  }
+
+  void run() {
+    for (size_t offset = 0; offset < _buffer.size();) {
+      size_t length = _chunker->next(&_buffer[offset],
+                                     _buffer.size() - offset);
+      size_t first = _digests.size();
+
+      _digests.resize(first + 16);
+      Murmur3Hash::digest(&_buffer[offset], length, &_digests[first]);
+      _lengths.push_back(static_cast<uint32_t>(length));
+      offset += length;
+    }
+  }
+
+  size_t getSource() const {
+    return _source;
+  }
+
+  uint32_t getIndex() const {
+    return _index;
+  }
+
+  uint32_t getTimecode() const {
+    return _timecode;
+  }
+
+  std::vector<uint8_t> *getBuffer() {
+    return &_buffer;
+  }
+
+  const std::vector<uint8_t> &getDigests() const {
+    return _digests;
+  }
+
+  const std::vector<uint32_t> &getLengths() const {
+    return _lengths;
+  }
+
+ private:
+  size_t _source;
+  uint32_t _index;
+  uint32_t _timecode;
+  ChunkerInterface *_chunker;
+  std::vector<uint8_t> _buffer;
+  std::vector<uint8_t> _digests;
+  std::vector<uint32_t> _lengths;
+};
+
+MetadataBuilder::MetadataBuilder(MetadataInterface *metadata) :
+  _metadata(metadata), _pool(NULL) {
+}
+
+MetadataBuilder::MetadataBuilder(MetadataInterface *metadata,
+                                 WorkerPoolInterface *pool) :
+  _metadata(metadata), _pool(pool) {
+}
+
+void MetadataBuilder::addStream(const MetadataStreamInit &init,
+                                MediaInterface *media,
+                                ChunkerInterface *chunker) {
+  addStream(init, media, NULL, chunker);
+}
+
+void MetadataBuilder::addStream(const MetadataStreamInit &init,
+                                MediaInterface *media,
+                                DataStreamInterface *dataStream,
+                                ChunkerInterface *chunker) {
+  Source source;
+
+  source.init = init;
+  source.init.chunkSize = chunker->getChunkSize();
+  source.media = media;
+  source.dataStream = dataStream;
+  source.chunker = chunker;
+  _sources.push_back(source);
+}
+
+bool MetadataBuilder::_readInitSegment(const Source &source,
+                                       std::vector<uint8_t> *buffer) {
+  DataStreamInit dsInit;
+  MemoryDataStream initSegment(dsInit);
+  std::streamsize offset;
+  std::streamsize length;
+
+  if (source.dataStream &&
+      source.media->getInitSegmentRange(&offset, &length)) {
+    return readRange(source.dataStream, offset, length, buffer);
+  }
+
+  source.media->getInitSegment(&initSegment);
+  return readAll(&initSegment, buffer);
+}
+
+bool MetadataBuilder::_readMediaSegment(const Source &source,
+                                        uint32_t timecode,
+                                        std::vector<uint8_t> *buffer) {
+  DataStreamInit dsInit;
+  MemoryDataStream mediaSegment(dsInit);
+  std::streamsize offset;
+  std::streamsize length;
+
+  // A segment stored as is in the media file is read straight to the task
+  // buffer, a generated one is copied from the stream the media writes.
+  if (source.dataStream &&
+      source.media->getMediaSegmentRange(timecode, &offset, &length)) {
+    return readRange(source.dataStream, offset, length, buffer);
+  }
+
+  source.media->getMediaSegment(timecode, &mediaSegment);
+  return readAll(&mediaSegment, buffer);
+}
+
+bool MetadataBuilder::_buildHeader(MetadataV3Writer *writer,
+                                   DataStreamInterface *out) {
+  std::vector<MetadataStreamInterface *> streams;
+  std::vector<uint32_t> segmentCounts;
+  bool result = true;
+
+  for (size_t s = 0; result && s < _sources.size(); ++s) {
+    Source &source = _sources[s];
+    MetadataStream *stream = new MetadataStream(source.init);
+
+    streams.push_back(stream);
+    result = _readInitSegment(source, &_buffer);
+    if (result) {
+      uint32_t initLength = static_cast<uint32_t>(_buffer.size());
+
+      stream->setInitSegment(initLength ? &_buffer[0] : NULL, initLength);
+      segmentCounts.push_back(
+        static_cast<uint32_t>(source.media->getTimecodes().size()));
+      _updateId(s, stream->getInitSegment(), initLength);
+    }
+  }
+
+  // The init segments are only kept until they are written.
+  result = result && writer->begin(out, streams, segmentCounts);
+  for (size_t s = 0; s < streams.size(); ++s) {
+    delete streams[s];
+  }
+  return result;
+}
+
+bool MetadataBuilder::build(DataStreamInterface *out) {
+  MetadataV3Writer writer(_metadata);
+  uint8_t digest[16];
+
+  // The header, stream records and init segments are written first, then
+  // each segment record is filled in place as its chunks are appended.
+  // The content id hashes the streams one after the other, so the first
+  // stream is hashed as it is written and the chunk hashes of the others
+  // are kept until it is done.
+  _id.clear();
+  _idHash.init();
+  _idPending.assign(_sources.size(), std::vector<uint8_t>());
+  if (!_buildHeader(&writer, out) || !_buildStreams(&writer)) {
+    return false;
+  }
+
+  for (size_t s = 1; s < _idPending.size(); ++s) {
+    if (!_idPending[s].empty()) {
+      _idHash.update(&_idPending[s][0], _idPending[s].size());
+    }
+  }
+  _idPending.clear();
+  _idHash.final(digest);
+  if (!writer.end(digest)) {
+    return false;
+  }
+
+  _id = Hex::encode(digest, sizeof(digest));
+  return true;
+}
+
+bool MetadataBuilder::_buildStreams(MetadataV3Writer *writer) {
+  std::vector<size_t> cursors(_sources.size());
+  size_t threadCount = _pool ? _pool->getThreadCount() : 0;
+  size_t batchSize = threadCount ? threadCount * kSegmentsPerThread : 1;
+  std::vector<SegmentTask> tasks(batchSize * 2);
+  SegmentTask *current = &tasks[0];
+  SegmentTask *next = &tasks[batchSize];
+  size_t currentCount;
+  size_t turn = 0;
+  bool ok = true;
+
+  // Read a batch while the previous one is hashed by the pool, then write
+  // the previous one once it is done. Without threads, every segment is
+  // read, hashed and written in turn.
+  currentCount = _readBatch(current, batchSize, &cursors, &turn, &ok);
+  while (currentCount) {
+    size_t nextCount;
+
+    for (size_t t = 0; t < currentCount; ++t) {
+      if (threadCount) {
+        _pool->post(&current[t]);
+      } else {
+        current[t].run();
+      }
+    }
+
+    nextCount = ok ? _readBatch(next, batchSize, &cursors, &turn, &ok) : 0;
+    if (threadCount) {
+      _pool->wait();
+    }
+
+    if (!ok || !_writeBatch(current, currentCount, writer)) {
+      return false;
+    }
+
+    std::swap(current, next);
+    currentCount = nextCount;
+  }
+
+  return ok;
+}
+
+size_t MetadataBuilder::_readBatch(SegmentTask *batch, size_t batchSize,
+                                   std::vector<size_t> *cursors, size_t *turn,
+                                   bool *ok) {
+  size_t count = 0;
+  size_t idle = 0;
+
+  // Take one segment of each stream in turn, so that the renditions of a
+  // title are read, and their chunkers called, side by side.
+  while (count < batchSize && idle < _sources.size()) {
+    size_t s = *turn;
+    Source &source = _sources[s];
+    const std::vector<uint32_t> &timecodes = source.media->getTimecodes();
+    size_t &cursor = (*cursors)[s];
+
+    *turn = (s + 1) % _sources.size();
+    if (cursor >= timecodes.size()) {
+      ++idle;
+      continue;
+    }
+
+    SegmentTask &task = batch[count];
+
+    task.reset(s, static_cast<uint32_t>(cursor), timecodes[cursor],
+               source.chunker);
+    if (!_readMediaSegment(source, timecodes[cursor], task.getBuffer())) {
+      *ok = false;
+      return count;
+    }
+
+    ++cursor;
+    ++count;
+    idle = 0;
+  }
+
+  return count;
+}
+
+bool MetadataBuilder::_writeBatch(SegmentTask *batch, size_t count,
+                                  MetadataV3Writer *writer) {
+  bool live = _metadata->isLive();
+
+  for (size_t t = 0; t < count; ++t) {
+    SegmentTask &task = batch[t];
+    const std::vector<uint8_t> &digests = task.getDigests();
+    const std::vector<uint32_t> &lengths = task.getLengths();
+
+    if (!live && !digests.empty()) {
+      _updateId(task.getSource(), &digests[0], digests.size());
+    }
+
+    if (!writer->writeSegment(
+        static_cast<uint32_t>(task.getSource()), task.getIndex(),
+        task.getTimecode(), static_cast<uint32_t>(task.getBuffer()->size()),
+        digests.empty() ? NULL : &digests[0],
+        lengths.empty() ? NULL : &lengths[0],
+        static_cast<uint32_t>(lengths.size()))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void MetadataBuilder::_updateId(size_t source, const uint8_t *data,
+                                size_t length) {
+  if (!source) {
+    _idHash.update(data, length);
+  } else {
+    _idPending[source].insert(_idPending[source].end(), data, data + length);
+  }
+}
+
+const std::string &MetadataBuilder::getId() const {
+  return _id;
+}
+
+}  // namespace peeracle
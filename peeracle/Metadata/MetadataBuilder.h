@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_METADATA_METADATABUILDER_H_
+#define PEERACLE_METADATA_METADATABUILDER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "peeracle/Chunker/ChunkerInterface.h"
+#include "peeracle/DataStream/DataStreamInterface.h"
+#include "peeracle/Hash/Murmur3Hash.h"
+#include "peeracle/Media/MediaInterface.h"
+#include "peeracle/Metadata/MetadataInterface.h"
+#include "peeracle/Metadata/MetadataStreamInterface.h"
+#include "peeracle/Utils/WorkerPoolInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+class MetadataV3Writer;
+
+/**
+ * Produce a metadata file from media files in a single pass.
+ * Media segments are read in batches, taking turns between the streams,
+ * so that every rendition of a title is processed at once. A batch is
+ * chunked and hashed by the threads of a worker pool while the next one is
+ * read, then written before the one after is read. The file is written in
+ * the version 3 layout, with the content id in its header: each segment
+ * record is filled in place and its chunk hashes appended to the chunk
+ * table. The content id covers the streams in order, so the first stream
+ * is hashed as it is written while the init segment and chunk hashes of
+ * the others are kept until the end. Apart from those 16 bytes per chunk,
+ * the memory used only depends on the batch size and the largest segment.
+ * \addtogroup Metadata
+ */
+class MetadataBuilder {
+ public:
+  /**
+   * @param metadata the header fields to write: hash algorithm, timecode
+   * scale, duration, live flag and trackers. Its streams are ignored.
+   */
+  explicit MetadataBuilder(MetadataInterface *metadata);
+
+  /**
+   * @param pool a started pool to chunk and hash media segments with.
+   * Segments are processed by the calling thread when \p pool is NULL or
+   * has no threads. The chunkers are then called from the pool threads,
+   * concurrently for segments of the same stream.
+   */
+  MetadataBuilder(MetadataInterface *metadata, WorkerPoolInterface *pool);
+
+  /**
+   * Add a stream to the metadata. \p media and \p chunker are not owned and
+   * must remain valid until build() returns. The chunk size written for the
+   * stream is the one of \p chunker, whatever \p init.chunkSize is.
+   */
+  void addStream(const MetadataStreamInit &init, MediaInterface *media,
+                 ChunkerInterface *chunker);
+
+  /**
+   * Add a stream whose media was loaded from \p dataStream. The segments
+   * stored as is in \p dataStream are then read straight from their range
+   * instead of being copied through MediaInterface::getMediaSegment().
+   * \p dataStream must remain valid until build() returns.
+   */
+  void addStream(const MetadataStreamInit &init, MediaInterface *media,
+                 DataStreamInterface *dataStream, ChunkerInterface *chunker);
+
+  /**
+   * Write the metadata of every stream added to \p out, which must be
+   * seekable.
+   * \return false if the hash algorithm is not supported or \p out failed.
+   */
+  bool build(DataStreamInterface *out);
+
+  /**
+   * Get the content id of the last metadata built, as
+   * MetadataInterface::getId() would return it once the file is loaded.
+   * The id of a live metadata only covers the init segments.
+   */
+  const std::string &getId() const;
+
+ private:
+  struct Source {
+    MetadataStreamInit init;
+    MediaInterface *media;
+    DataStreamInterface *dataStream;
+    ChunkerInterface *chunker;
+  };
+
+  class SegmentTask;
+
+  bool _readInitSegment(const Source &source, std::vector<uint8_t> *buffer);
+  bool _readMediaSegment(const Source &source, uint32_t timecode,
+                         std::vector<uint8_t> *buffer);
+  bool _buildHeader(MetadataV3Writer *writer, DataStreamInterface *out);
+  bool _buildStreams(MetadataV3Writer *writer);
+  size_t _readBatch(SegmentTask *batch, size_t batchSize,
+                    std::vector<size_t> *cursors, size_t *turn, bool *ok);
+  bool _writeBatch(SegmentTask *batch, size_t count,
+                   MetadataV3Writer *writer);
+  void _updateId(size_t source, const uint8_t *data, size_t length);
+
+  MetadataInterface *_metadata;
+  WorkerPoolInterface *_pool;
+  std::vector<Source> _sources;
+  std::vector<uint8_t> _buffer;
+  Murmur3Hash _idHash;
+  std::vector<std::vector<uint8_t> > _idPending;
+  std::string _id;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_METADATA_METADATABUILDER_H_
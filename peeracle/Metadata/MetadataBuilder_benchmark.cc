@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "peeracle/Chunker/ContentDefinedChunker.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Media/WebMMedia.h"
+#include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataBuilder.h"
+#include "peeracle/Utils/WorkerPool.h"
+#include "test/benchmark.h"
+
+namespace peeracle {
+
+static const int64_t kMinNanos = 1000000000;
+static const uint32_t kClusterDuration = 2000;
+static const uint32_t kBlocksPerCluster = 60;
+
+// The renditions of MetadataGenerator::addDefaultStreams().
+static const uint32_t kBandwidths[] = {
+  8000000, 5000000, 2500000, 1200000, 600000, 128000
+};
+static const size_t kRenditionCount =
+  sizeof(kBandwidths) / sizeof(kBandwidths[0]);
+
+// A WebM file of \p duration milliseconds at \p bandwidth bits per second:
+// Clusters of 2 seconds indexed by Cues at the end. The blocks hold pseudo
+// random bytes, so that content defined chunks have their usual length.
+class RenditionMedia : public SyntheticMedia {
+ public:
+  RenditionMedia(uint32_t duration, uint32_t bandwidth, uint32_t seed)
+    : SyntheticMedia((duration + kClusterDuration - 1) / kClusterDuration,
+                     kClusterDuration, kBlocksPerCluster),
+      _blockLength(bandwidth / 8 * (kClusterDuration / 1000) /
+                   kBlocksPerCluster),
+      _state(seed) {
+  }
+
+  uint32_t getFrameLength(uint32_t segment, uint32_t frame) {
+    return _blockLength;
+  }
+
+  void fillFrame(uint32_t segment, uint32_t frame,
+                 std::vector<uint8_t> *payload) {
+    for (size_t i = 0; i < payload->size(); ++i) {
+      _state = _state * 1664525 + 1013904223;
+      (*payload)[i] = static_cast<uint8_t>(_state >> 24);
+    }
+  }
+
+ private:
+  uint32_t _blockLength;
+  uint32_t _state;
+};
+
+// Ingest a title end to end: parse every rendition, then chunk, hash and
+// write the metadata of all of them.
+class IngestCase : public Benchmark::Case {
+ public:
+  IngestCase(Metadata *metadata, std::vector<MemoryDataStream *> *files,
+             size_t renditions, WorkerPoolInterface *pool)
+    : _metadata(metadata), _files(files), _renditions(renditions),
+      _pool(pool), _chunker(65536), _ok(true) {
+  }
+
+  void run() {
+    DataStreamInit dsInit;
+    MemoryDataStream out(dsInit);
+    std::vector<WebMMedia *> medias;
+    MetadataBuilder builder(_metadata, _pool);
+
+    for (size_t r = 0; r < _renditions; ++r) {
+      MetadataStreamInit init;
+      WebMMedia *media = new WebMMedia();
+
+      (*_files)[r]->seek(0);
+      _ok = media->Load((*_files)[r]) && _ok;
+      init.bandwidth = kBandwidths[r];
+      builder.addStream(init, media, (*_files)[r], &_chunker);
+      medias.push_back(media);
+    }
+
+    _ok = builder.build(&out) && _ok;
+    for (size_t m = 0; m < medias.size(); ++m) {
+      delete medias[m];
+    }
+  }
+
+  bool isOk() const {
+    return _ok;
+  }
+
+ private:
+  Metadata *_metadata;
+  std::vector<MemoryDataStream *> *_files;
+  size_t _renditions;
+  WorkerPoolInterface *_pool;
+  ContentDefinedChunker _chunker;
+  bool _ok;
+};
+
+static void addRow(BenchmarkTable *table, const std::string &name,
+                   Benchmark::Case *benchmarkCase, uint64_t bytes) {
+  double nanos = Benchmark::measure(benchmarkCase, kMinNanos);
+
+  table->addRow();
+  table->addCell(name);
+  table->addCell(Benchmark::formatTime(nanos));
+  table->addCell(Benchmark::formatRate(static_cast<double>(bytes) * 1e9 /
+                                       nanos));
+}
+
+static int run(uint32_t duration) {
+  Metadata metadata;
+  DataStreamInit dsInit;
+  std::vector<MemoryDataStream *> files;
+  std::vector<uint8_t> bytes;
+  WorkerPool pool;
+  size_t threads = WorkerPool::getProcessorCount();
+  uint64_t firstSize = 0;
+  uint64_t totalSize = 0;
+  int result = EXIT_SUCCESS;
+
+  metadata.setHashAlgorithm("murmur3_x86_128");
+  metadata.setTimecodeScale(1000000);
+  metadata.setDuration(duration);
+
+  for (size_t r = 0; r < kRenditionCount; ++r) {
+    RenditionMedia media(duration, kBandwidths[r],
+                         static_cast<uint32_t>(0x5745424D + r));
+
+    media.writeWebM(true, false, &bytes);
+    files.push_back(new MemoryDataStream(dsInit));
+    files.back()->write(reinterpret_cast<const char *>(&bytes[0]),
+                        static_cast<std::streamsize>(bytes.size()));
+    totalSize += bytes.size();
+    if (!r) {
+      firstSize = bytes.size();
+    }
+  }
+
+  if (!pool.start(threads)) {
+    std::cerr << "unable to start the worker threads" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  IngestCase singleSequential(&metadata, &files, 1, NULL);
+  IngestCase singleParallel(&metadata, &files, 1, &pool);
+  IngestCase ladderSequential(&metadata, &files, kRenditionCount, NULL);
+  IngestCase ladderParallel(&metadata, &files, kRenditionCount, &pool);
+  std::string threadsName = Benchmark::formatCount(
+    static_cast<double>(threads)) + " pool thread" + (threads > 1 ? "s" : "");
+  std::string ladderName = Benchmark::formatCount(
+    static_cast<double>(kRenditionCount)) + " renditions";
+  BenchmarkTable table("Ingest of " +
+                       Benchmark::formatCount(duration / 1000.0) +
+                       " s of WebM, " + Benchmark::formatSize(
+                         static_cast<double>(totalSize)) + " in " +
+                       ladderName);
+
+  table.addColumn("operation");
+  table.addColumn("time");
+  table.addColumn("throughput");
+  addRow(&table, "1 rendition, calling thread", &singleSequential, firstSize);
+  addRow(&table, "1 rendition, " + threadsName, &singleParallel, firstSize);
+  addRow(&table, ladderName + ", calling thread", &ladderSequential, totalSize);
+  addRow(&table, ladderName + ", " + threadsName, &ladderParallel,
+         totalSize);
+  table.print(&std::cout);
+
+  if (!singleSequential.isOk() || !singleParallel.isOk() ||
+      !ladderSequential.isOk() || !ladderParallel.isOk()) {
+    std::cerr << "unable to build the metadata" << std::endl;
+    result = EXIT_FAILURE;
+  }
+
+  pool.stop();
+  for (size_t f = 0; f < files.size(); ++f) {
+    delete files[f];
+  }
+  return result;
+}
+
+}  // namespace peeracle
+
+int main(int argc, char **argv) {
+  uint32_t duration = 30;
+
+  if (argc > 1) {
+    duration = static_cast<uint32_t>(strtoul(argv[1], NULL, 10));
+  }
+
+  if (!duration) {
+    std::cerr << "usage: " << argv[0] << " [seconds per rendition]"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return peeracle::run(duration * 1000);
+}
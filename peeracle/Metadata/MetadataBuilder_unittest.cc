@@ -0,0 +1,547 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/Chunker/ContentDefinedChunker.h"
+#include "peeracle/Chunker/FixedSizeChunker.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Hash/Murmur3Hash.h"
+#include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataBuilder.h"
+#include "peeracle/Utils/WorkerPool.h"
+
+namespace peeracle {
+
+class FakeMedia : public MediaInterface {
+ public:
+  FakeMedia(uint32_t seed, size_t initLength) : _state(seed), _copies(0) {
+    fill(&_initSegment, initLength);
+  }
+
+  ~FakeMedia() {
+  }
+
+  void addSegment(uint32_t timecode, size_t length) {
+    _timecodes.push_back(timecode);
+    _segments.push_back(std::vector<uint8_t>());
+    fill(&_segments.back(), length);
+  }
+
+  bool Load(DataStreamInterface *dataStream) {
+    return true;
+  }
+
+  void getInitSegment(DataStreamInterface *out) {
+    ++_copies;
+    write(_initSegment, out);
+  }
+
+  void getMediaSegment(std::streampos timecode, DataStreamInterface *out) {
+    ++_copies;
+    for (size_t i = 0; i < _timecodes.size(); ++i) {
+      if (_timecodes[i] == timecode) {
+        write(_segments[i], out);
+      }
+    }
+  }
+
+  // The segments are generated in memory, not read from a data stream,
+  // until they are stored to a file.
+  bool getInitSegmentRange(std::streamsize *offset, std::streamsize *length) {
+    if (_offsets.empty()) {
+      return false;
+    }
+
+    *offset = 0;
+    *length = static_cast<std::streamsize>(_initSegment.size());
+    return true;
+  }
+
+  bool getMediaSegmentRange(std::streampos timecode, std::streamsize *offset,
+                            std::streamsize *length) {
+    for (size_t i = 0; i < _offsets.size(); ++i) {
+      if (_timecodes[i] == timecode) {
+        *offset = _offsets[i];
+        *length = static_cast<std::streamsize>(_segments[i].size());
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Write the init segment and the media segments back to back to
+  // \p file, which their ranges then refer to.
+  void store(DataStreamInterface *file) {
+    write(_initSegment, file);
+    for (size_t i = 0; i < _segments.size(); ++i) {
+      _offsets.push_back(file->tell());
+      write(_segments[i], file);
+    }
+  }
+
+  size_t getCopies() const {
+    return _copies;
+  }
+
+  bool getMediaSegmentFrames(std::streampos timecode,
+                             std::vector<MediaFrame> *frames) {
+    return false;
+  }
+
+  const std::vector<uint32_t> &getTimecodes() const {
+    return _timecodes;
+  }
+
+  const std::vector<uint8_t> &getSegment(size_t index) const {
+    return _segments[index];
+  }
+
+ private:
+  void fill(std::vector<uint8_t> *data, size_t length) {
+    data->resize(length);
+    for (size_t i = 0; i < length; ++i) {
+      _state ^= _state << 13;
+      _state ^= _state >> 17;
+      _state ^= _state << 5;
+      (*data)[i] = static_cast<uint8_t>(_state);
+    }
+  }
+
+  void write(const std::vector<uint8_t> &data, DataStreamInterface *out) {
+    if (!data.empty()) {
+      out->write(reinterpret_cast<const char *>(&data[0]), data.size());
+    }
+  }
+
+  uint32_t _state;
+  size_t _copies;
+  std::vector<uint8_t> _initSegment;
+  std::vector<std::vector<uint8_t> > _segments;
+  std::vector<uint32_t> _timecodes;
+  std::vector<std::streamsize> _offsets;
+};
+
+// A memory data stream whose raw reads can be made to fail, as a file
+// would on an I/O error.
+class FailingDataStream : public MemoryDataStream {
+ public:
+  explicit FailingDataStream(const DataStreamInit &dsInit)
+    : MemoryDataStream(dsInit), _failing(false) {
+  }
+
+  void setFailing(bool failing) {
+    _failing = failing;
+  }
+
+  using MemoryDataStream::read;
+
+  std::streamsize read(char *buffer, std::streamsize length) {
+    if (_failing) {
+      return -1;
+    }
+    return MemoryDataStream::read(buffer, length);
+  }
+
+ private:
+  bool _failing;
+};
+
+class MetadataBuilderTest : public testing::Test {
+ protected:
+  MetadataBuilderTest() : _video(0x5052434C, 4557), _audio(0x12345678, 943),
+    _fixedChunker(16384), _cdcChunker(8192) {
+  }
+
+  virtual void SetUp() {
+    uint32_t timecode = 0;
+
+    for (size_t i = 0; i < 12; ++i) {
+      _video.addSegment(timecode, 40000 + i * 3001);
+      _audio.addSegment(timecode, 9000 + i * 17);
+      timecode += 2000;
+    }
+    _video.addSegment(timecode, 0);
+
+    _metadata.setHashAlgorithm("murmur3_x86_128");
+    _metadata.setTimecodeScale(1000000);
+    _metadata.setDuration(24000.0);
+    _metadata.addTracker("wss://tracker.peeracle.org");
+  }
+
+  void expectStream(MetadataStreamInterface *stream, FakeMedia *media,
+                    uint32_t chunkSize) {
+    Murmur3Hash hash;
+    uint8_t digest[16];
+
+    EXPECT_EQ(chunkSize, stream->getChunkSize());
+    ASSERT_EQ(media->getTimecodes().size(),
+              stream->getMediaSegments().size());
+
+    for (size_t s = 0; s < media->getTimecodes().size(); ++s) {
+      MetadataMediaSegmentInterface *segment = stream->getMediaSegments()[s];
+      const std::vector<uint8_t> &data = media->getSegment(s);
+      size_t offset = 0;
+
+      EXPECT_EQ(media->getTimecodes()[s], segment->getTimecode());
+      ASSERT_EQ(data.size(), segment->getLength());
+      ASSERT_EQ(segment->getChunks().size(),
+                segment->getChunkLengths().size());
+
+      for (size_t c = 0; c < segment->getChunks().size(); ++c) {
+        uint32_t length = segment->getChunkLengths()[c];
+
+        ASSERT_LE(offset + length, data.size());
+        hash.init();
+        hash.update(&data[offset], length);
+        hash.final(digest);
+        EXPECT_EQ(0, memcmp(digest, segment->getChunks()[c], 16));
+        offset += length;
+      }
+      EXPECT_EQ(data.size(), offset);
+    }
+  }
+
+  FakeMedia _video;
+  FakeMedia _audio;
+  FixedSizeChunker _fixedChunker;
+  ContentDefinedChunker _cdcChunker;
+  Metadata _metadata;
+};
+
+TEST_F(MetadataBuilderTest, BuildAndLoad) {
+  DataStreamInit dsInit;
+  MemoryDataStream out(dsInit);
+  MetadataBuilder builder(&_metadata);
+  MetadataStreamInit video;
+  MetadataStreamInit audio;
+  Metadata loaded;
+
+  video.type = 1;
+  video.mimeType = "video/webm; codecs=\"vp8\"";
+  video.bandwidth = 1000000;
+  video.width = 1280;
+  video.height = 720;
+  audio.type = 2;
+  audio.mimeType = "audio/webm; codecs=\"vorbis\"";
+  audio.bandwidth = 128000;
+  audio.numChannels = 2;
+  audio.samplingFrequency = 44100;
+
+  builder.addStream(video, &_video, &_fixedChunker);
+  builder.addStream(audio, &_audio, &_cdcChunker);
+  ASSERT_TRUE(builder.build(&out));
+  EXPECT_EQ(32, builder.getId().size());
+
+  ASSERT_EQ(0, out.seek(0));
+  ASSERT_TRUE(loaded.unserialize(&out));
+  EXPECT_EQ(out.length(), out.tell());
+  EXPECT_EQ(builder.getId(), loaded.getId());
+  EXPECT_EQ(1000000, loaded.getTimecodeScale());
+  EXPECT_EQ(24000.0, loaded.getDuration());
+  ASSERT_EQ(1, loaded.getTrackerUrls().size());
+  EXPECT_EQ("wss://tracker.peeracle.org", loaded.getTrackerUrls()[0]);
+  ASSERT_EQ(2, loaded.getStreams().size());
+
+  MetadataStreamInterface *stream = loaded.getStreams()[0];
+  EXPECT_EQ(1, stream->getType());
+  EXPECT_EQ(video.mimeType, stream->getMimeType());
+  EXPECT_EQ(1280, stream->getWidth());
+  EXPECT_EQ(720, stream->getHeight());
+  EXPECT_EQ(4557, stream->getInitSegmentLength());
+  expectStream(stream, &_video, 16384);
+
+  stream = loaded.getStreams()[1];
+  EXPECT_EQ(2, stream->getType());
+  EXPECT_EQ(2, stream->getNumChannels());
+  EXPECT_EQ(44100, stream->getSamplingFrequency());
+  EXPECT_EQ(943, stream->getInitSegmentLength());
+  expectStream(stream, &_audio, 0);
+}
+
+TEST_F(MetadataBuilderTest, SegmentRanges) {
+  DataStreamInit dsInit;
+  MemoryDataStream copied(dsInit);
+  MemoryDataStream ranged(dsInit);
+  MemoryDataStream file(dsInit);
+  MetadataBuilder copyBuilder(&_metadata);
+  MetadataBuilder rangeBuilder(&_metadata);
+  MetadataStreamInit video;
+  size_t copies;
+
+  copyBuilder.addStream(video, &_video, &_fixedChunker);
+  ASSERT_TRUE(copyBuilder.build(&copied));
+  copies = _video.getCopies();
+  EXPECT_EQ(_video.getTimecodes().size() + 1, copies);
+
+  // Segments stored in the media file are read from it, not copied.
+  _video.store(&file);
+  rangeBuilder.addStream(video, &_video, &file, &_fixedChunker);
+  ASSERT_TRUE(rangeBuilder.build(&ranged));
+  EXPECT_EQ(copies, _video.getCopies());
+  EXPECT_EQ(copyBuilder.getId(), rangeBuilder.getId());
+  ASSERT_EQ(copied.length(), ranged.length());
+  EXPECT_EQ(0, memcmp(copied.getBuffer(), ranged.getBuffer(),
+                      static_cast<size_t>(ranged.length())));
+}
+
+TEST_F(MetadataBuilderTest, LazyLoad) {
+  DataStreamInit dsInit;
+  MemoryDataStream out(dsInit);
+  MetadataBuilder builder(&_metadata);
+  MetadataStreamInit video;
+  MetadataStreamInit audio;
+  Metadata eager;
+  Metadata lazy;
+
+  builder.addStream(video, &_video, &_fixedChunker);
+  builder.addStream(audio, &_audio, &_cdcChunker);
+  ASSERT_TRUE(builder.build(&out));
+
+  ASSERT_EQ(0, out.seek(0));
+  ASSERT_TRUE(eager.unserialize(&out));
+  ASSERT_EQ(0, out.seek(0));
+  lazy.setLazy(true);
+  ASSERT_TRUE(lazy.unserialize(&out));
+  EXPECT_EQ(out.length(), out.tell());
+
+  EXPECT_EQ(builder.getId(), lazy.getId());
+  EXPECT_EQ(out.length(), out.tell());
+  ASSERT_EQ(2, lazy.getStreams().size());
+
+  for (size_t s = 0; s < 2; ++s) {
+    std::vector<MetadataMediaSegmentInterface *> &expected =
+      eager.getStreams()[s]->getMediaSegments();
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      lazy.getStreams()[s]->getMediaSegments();
+
+    ASSERT_EQ(expected.size(), segments.size());
+    for (size_t i = 0; i < segments.size(); ++i) {
+      EXPECT_EQ(expected[i]->getTimecode(), segments[i]->getTimecode());
+      EXPECT_EQ(expected[i]->getLength(), segments[i]->getLength());
+      EXPECT_EQ(expected[i]->getChunkCount(), segments[i]->getChunkCount());
+      EXPECT_EQ(expected[i]->getChunkLengths(),
+                segments[i]->getChunkLengths());
+      ASSERT_EQ(expected[i]->getChunks().size(),
+                segments[i]->getChunks().size());
+      for (size_t c = 0; c < segments[i]->getChunks().size(); ++c) {
+        EXPECT_EQ(0, memcmp(expected[i]->getChunks()[c],
+                            segments[i]->getChunks()[c], 16));
+      }
+    }
+  }
+  EXPECT_EQ(out.length(), out.tell());
+}
+
+TEST_F(MetadataBuilderTest, LazyLoadError) {
+  DataStreamInit dsInit;
+  FailingDataStream out(dsInit);
+  MetadataBuilder builder(&_metadata);
+  MetadataStreamInit video;
+  MetadataStreamInit audio;
+  Metadata lazy;
+
+  builder.addStream(video, &_video, &_fixedChunker);
+  builder.addStream(audio, &_audio, &_cdcChunker);
+  ASSERT_TRUE(builder.build(&out));
+
+  ASSERT_EQ(0, out.seek(0));
+  lazy.setLazy(true);
+  ASSERT_TRUE(lazy.unserialize(&out));
+  ASSERT_EQ(2, lazy.getStreams().size());
+
+  MetadataMediaSegmentInterface *segment =
+    lazy.getStreams()[1]->getMediaSegments()[3];
+  uint32_t chunkCount = segment->getChunkCount();
+
+  // A failed read is reported, and leaves the segment lazy.
+  out.setFailing(true);
+  EXPECT_TRUE(segment->getChunks().empty());
+  EXPECT_TRUE(segment->hasLoadError());
+  EXPECT_EQ(chunkCount, segment->getChunkCount());
+  EXPECT_EQ(builder.getId(), lazy.getId());
+  EXPECT_FALSE(lazy.verifyId());
+
+  out.setFailing(false);
+  EXPECT_EQ(chunkCount, segment->getChunks().size());
+  EXPECT_FALSE(segment->hasLoadError());
+  EXPECT_EQ(builder.getId(), lazy.getId());
+  EXPECT_TRUE(lazy.verifyId());
+}
+
+TEST_F(MetadataBuilderTest, LiveDelta) {
+  DataStreamInit dsInit;
+  MemoryDataStream full(dsInit);
+  MemoryDataStream start(dsInit);
+  MemoryDataStream delta(dsInit);
+  FakeMedia video(0x5052434C, 4557);
+  MetadataStreamInit init;
+  Metadata producer;
+  Metadata client;
+
+  // The same media, before and after 6 more segments were produced.
+  for (uint32_t i = 0; i < 6; ++i) {
+    video.addSegment(i * 2000, 40000 + i * 3001);
+  }
+
+  _metadata.setLive(true);
+  MetadataBuilder startBuilder(&_metadata);
+  startBuilder.addStream(init, &video, &_cdcChunker);
+  startBuilder.addStream(init, &_audio, &_fixedChunker);
+  ASSERT_TRUE(startBuilder.build(&start));
+
+  for (uint32_t i = 6; i < 12; ++i) {
+    video.addSegment(i * 2000, 40000 + i * 3001);
+  }
+
+  MetadataBuilder fullBuilder(&_metadata);
+  fullBuilder.addStream(init, &video, &_cdcChunker);
+  fullBuilder.addStream(init, &_audio, &_fixedChunker);
+  ASSERT_TRUE(fullBuilder.build(&full));
+  EXPECT_EQ(startBuilder.getId(), fullBuilder.getId());
+
+  ASSERT_EQ(0, full.seek(0));
+  ASSERT_TRUE(producer.unserialize(&full));
+  ASSERT_EQ(0, start.seek(0));
+  ASSERT_TRUE(client.unserialize(&start));
+  EXPECT_TRUE(client.isLive());
+  EXPECT_EQ(24000.0, client.getDuration());
+  EXPECT_EQ(producer.getId(), client.getId());
+  EXPECT_EQ(fullBuilder.getId(), client.getId());
+
+  std::vector<uint32_t> known;
+  known.push_back(6);
+  known.push_back(12);
+  ASSERT_TRUE(producer.serializeDelta(&delta, known));
+
+  // Applying the delta twice appends the segments once.
+  for (int pass = 0; pass < 2; ++pass) {
+    ASSERT_EQ(0, delta.seek(0));
+    ASSERT_TRUE(client.unserializeDelta(&delta));
+    EXPECT_EQ(delta.length(), delta.tell());
+    ASSERT_EQ(12, client.getStreams()[0]->getMediaSegments().size());
+    ASSERT_EQ(12, client.getStreams()[1]->getMediaSegments().size());
+  }
+
+  uint32_t index;
+  ASSERT_TRUE(client.getStreams()[0]->findSegmentByTimecode(22500, &index));
+  EXPECT_EQ(11, index);
+  expectStream(client.getStreams()[0], &video, 0);
+  EXPECT_EQ(fullBuilder.getId(), client.getId());
+
+  // A truncated delta appends nothing.
+  MemoryDataStream truncated(dsInit);
+  std::vector<uint8_t> bytes(static_cast<size_t>(delta.length() - 1));
+  known[0] = 0;
+  ASSERT_EQ(0, delta.seek(0));
+  ASSERT_EQ(bytes.size(), delta.read(reinterpret_cast<char *>(&bytes[0]),
+                                     bytes.size()));
+  truncated.write(reinterpret_cast<char *>(&bytes[0]), bytes.size());
+  ASSERT_EQ(0, truncated.seek(0));
+  EXPECT_FALSE(client.unserializeDelta(&truncated));
+  EXPECT_EQ(12, client.getStreams()[0]->getMediaSegments().size());
+
+  // The live flag is kept by version 2 files, and a delta without it is
+  // rejected.
+  MemoryDataStream v2(dsInit);
+  Metadata reloaded;
+  ASSERT_TRUE(client.serialize(&v2));
+  ASSERT_EQ(0, v2.seek(0));
+  ASSERT_TRUE(reloaded.unserialize(&v2));
+  EXPECT_TRUE(reloaded.isLive());
+  EXPECT_EQ(client.getId(), reloaded.getId());
+
+  std::vector<uint8_t> vod(static_cast<size_t>(delta.length()));
+  MemoryDataStream vodDelta(dsInit);
+  ASSERT_EQ(0, delta.seek(0));
+  ASSERT_EQ(vod.size(), delta.read(reinterpret_cast<char *>(&vod[0]),
+                                   vod.size()));
+  vod[4 + 4 + client.getId().size() + 1 + 3] = 0;
+  vodDelta.write(reinterpret_cast<char *>(&vod[0]), vod.size());
+  ASSERT_EQ(0, vodDelta.seek(0));
+  EXPECT_FALSE(reloaded.unserializeDelta(&vodDelta));
+
+  // A video on demand metadata does not take deltas.
+  ASSERT_EQ(0, delta.seek(0));
+  _metadata.setLive(false);
+  EXPECT_FALSE(_metadata.unserializeDelta(&delta));
+}
+
+TEST_F(MetadataBuilderTest, Parallel) {
+  DataStreamInit dsInit;
+  MemoryDataStream sequential(dsInit);
+  MemoryDataStream parallel(dsInit);
+  MetadataBuilder sequentialBuilder(&_metadata);
+  WorkerPool pool;
+  FakeMedia rendition(0xCAFE, 2048);
+  MetadataStreamInit init;
+  Metadata loaded;
+
+  // A third stream, shorter than the others, ends before the last batch.
+  for (uint32_t i = 0; i < 5; ++i) {
+    rendition.addSegment(i * 2000, 70000 + i * 101);
+  }
+
+  ASSERT_TRUE(pool.start(3));
+  MetadataBuilder parallelBuilder(&_metadata, &pool);
+  sequentialBuilder.addStream(init, &_video, &_fixedChunker);
+  sequentialBuilder.addStream(init, &_audio, &_cdcChunker);
+  sequentialBuilder.addStream(init, &rendition, &_cdcChunker);
+  parallelBuilder.addStream(init, &_video, &_fixedChunker);
+  parallelBuilder.addStream(init, &_audio, &_cdcChunker);
+  parallelBuilder.addStream(init, &rendition, &_cdcChunker);
+  ASSERT_TRUE(sequentialBuilder.build(&sequential));
+  ASSERT_TRUE(parallelBuilder.build(&parallel));
+  pool.stop();
+
+  // The streams are written in the order they were added, whatever the
+  // order their segments were hashed in.
+  EXPECT_EQ(sequentialBuilder.getId(), parallelBuilder.getId());
+  ASSERT_EQ(sequential.length(), parallel.length());
+  EXPECT_EQ(0, memcmp(sequential.getBuffer(), parallel.getBuffer(),
+                      static_cast<size_t>(sequential.length())));
+
+  ASSERT_EQ(0, parallel.seek(0));
+  ASSERT_TRUE(loaded.unserialize(&parallel));
+  EXPECT_EQ(parallelBuilder.getId(), loaded.getId());
+  ASSERT_EQ(3, loaded.getStreams().size());
+  expectStream(loaded.getStreams()[0], &_video, 16384);
+  expectStream(loaded.getStreams()[1], &_audio, 0);
+  expectStream(loaded.getStreams()[2], &rendition, 0);
+}
+
+TEST_F(MetadataBuilderTest, UnsupportedHashAlgorithm) {
+  DataStreamInit dsInit;
+  MemoryDataStream out(dsInit);
+  MetadataBuilder builder(&_metadata);
+  MetadataStreamInit video;
+
+  _metadata.setHashAlgorithm("sha1");
+  builder.addStream(video, &_video, &_fixedChunker);
+  EXPECT_FALSE(builder.build(&out));
+  EXPECT_EQ(0, out.length());
+  EXPECT_TRUE(builder.getId().empty());
+}
+
+}  // namespace peeracle
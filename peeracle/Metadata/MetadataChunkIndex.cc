@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "peeracle/Metadata/MetadataChunkIndex.h"
+
+namespace peeracle {
+
+MetadataChunkIndex::MetadataChunkIndex() : _metadata(NULL) {
+}
+
+bool MetadataChunkIndex::build(MetadataInterface *metadata) {
+  _metadata = metadata;
+  _streams.clear();
+  if (!update()) {
+    _streams.clear();
+    return false;
+  }
+  return true;
+}
+
+bool MetadataChunkIndex::update() {
+  size_t streamCount;
+
+  if (!_metadata) {
+    return true;
+  }
+
+  streamCount = _metadata->getStreams().size();
+  if (_streams.size() < streamCount) {
+    _streams.resize(streamCount);
+  }
+
+  for (size_t s = 0; s < streamCount; ++s) {
+    if (!_indexSegments(static_cast<uint32_t>(s))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MetadataChunkIndex::_indexSegments(uint32_t stream) {
+  MetadataStreamInterface *metadataStream = _metadata->getStreams()[stream];
+  std::vector<MetadataMediaSegmentInterface *> &segments =
+    metadataStream->getMediaSegments();
+  uint32_t chunkSize = metadataStream->getChunkSize();
+  StreamIndex &index = _streams[stream];
+
+  for (size_t i = index.segmentFirstChunk.size() - 1; i < segments.size();
+       ++i) {
+    uint32_t chunkCount = segments[i]->getChunkCount();
+    uint32_t remaining = segments[i]->getLength();
+    uint32_t offset = 0;
+
+    if (!chunkSize && segments[i]->getChunkLengths().size() != chunkCount) {
+      return false;
+    }
+
+    for (uint32_t c = 0; c < chunkCount; ++c) {
+      uint32_t length;
+
+      if (chunkSize) {
+        length = remaining < chunkSize ? remaining : chunkSize;
+      } else {
+        length = segments[i]->getChunkLengths()[c];
+      }
+
+      index.chunkSegment.push_back(static_cast<uint32_t>(i));
+      index.chunkOffset.push_back(offset);
+      index.chunkLength.push_back(length);
+      offset += length;
+      remaining -= length < remaining ? length : remaining;
+    }
+
+    index.segmentFirstChunk.push_back(
+      static_cast<uint32_t>(index.chunkSegment.size()));
+  }
+
+  return true;
+}
+
+uint32_t MetadataChunkIndex::getChunkCount(uint32_t stream) const {
+  if (stream >= _streams.size()) {
+    return 0;
+  }
+  return static_cast<uint32_t>(_streams[stream].chunkSegment.size());
+}
+
+uint32_t MetadataChunkIndex::getFirstChunk(uint32_t stream,
+                                           uint32_t segment) const {
+  if (stream >= _streams.size() ||
+      segment >= _streams[stream].segmentFirstChunk.size()) {
+    return getChunkCount(stream);
+  }
+  return _streams[stream].segmentFirstChunk[segment];
+}
+
+bool MetadataChunkIndex::locate(uint32_t stream, uint32_t chunk,
+                                Location *location) const {
+  if (stream >= _streams.size() ||
+      chunk >= _streams[stream].chunkSegment.size()) {
+    return false;
+  }
+
+  const StreamIndex &index = _streams[stream];
+  location->segment = index.chunkSegment[chunk];
+  location->chunk = chunk - index.segmentFirstChunk[location->segment];
+  location->offset = index.chunkOffset[chunk];
+  location->length = index.chunkLength[chunk];
+  location->streamOffset = _metadata->getStreams()[stream]->
+    getSegmentOffset(location->segment) + location->offset;
+  return true;
+}
+
+bool MetadataChunkIndex::find(uint32_t stream, uint32_t segment,
+                              uint32_t offset, uint32_t *chunk) const {
+  std::vector<uint32_t>::const_iterator first;
+  std::vector<uint32_t>::const_iterator last;
+  std::vector<uint32_t>::const_iterator it;
+
+  if (stream >= _streams.size() ||
+      segment + 1 >= _streams[stream].segmentFirstChunk.size()) {
+    return false;
+  }
+
+  const StreamIndex &index = _streams[stream];
+  first = index.chunkOffset.begin() + index.segmentFirstChunk[segment];
+  last = index.chunkOffset.begin() + index.segmentFirstChunk[segment + 1];
+  if (first == last) {
+    return false;
+  }
+
+  it = std::upper_bound(first, last, offset) - 1;
+  if (offset - *it >= index.chunkLength[it - index.chunkOffset.begin()]) {
+    return false;
+  }
+
+  *chunk = static_cast<uint32_t>(it - index.chunkOffset.begin());
+  return true;
+}
+
+}  // namespace peeracle
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_METADATA_METADATACHUNKINDEX_H_
+#define PEERACLE_METADATA_METADATACHUNKINDEX_H_
+
+#include <stdint.h>
+#include <vector>
+#include "peeracle/Metadata/MetadataInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Number the chunks of every stream of a metadata, segment after segment,
+ * and resolve these (stream, chunk) numbers to their location. Chunks are
+ * numbered per stream, so that segments appended to a live stream never
+ * shift the chunks of the other streams.
+ * Chunk numbers are what peers exchange, so piece pickers and storage use
+ * this index instead of walking the segments.
+ * \addtogroup Metadata
+ */
+class MetadataChunkIndex {
+ public:
+  struct Location {
+    Location()
+      : segment(0),
+        chunk(0),
+        offset(0),
+        streamOffset(0),
+        length(0) {
+    }
+
+    uint32_t segment;
+    uint32_t chunk;
+    uint32_t offset;
+    uint64_t streamOffset;
+    uint32_t length;
+  };
+
+  MetadataChunkIndex();
+
+  /**
+   * Index the chunks of \p metadata. Chunks of lazily loaded segments with
+   * a fixed chunk size are indexed without loading them.
+   * \p metadata must outlive the index. Segments added later are not
+   * indexed until update() is called.
+   * \return false if the chunk lengths of a segment could not be read, the
+   * index is then empty.
+   */
+  bool build(MetadataInterface *metadata);
+
+  /**
+   * Index the segments appended to the streams, and the streams added,
+   * since the last build() or update(). The chunks already indexed keep
+   * their numbers, so this costs the new chunks only.
+   * \return false if the chunk lengths of a segment could not be read, the
+   * segments before it stay indexed.
+   */
+  bool update();
+
+  /**
+   * Get the number of indexed chunks of \p stream, 0 if it is out of range.
+   */
+  uint32_t getChunkCount(uint32_t stream) const;
+
+  /**
+   * Get the number of the first chunk of \p segment in \p stream. A
+   * \p segment equal to the number of indexed segments gives
+   * getChunkCount().
+   */
+  uint32_t getFirstChunk(uint32_t stream, uint32_t segment) const;
+
+  /**
+   * Find where the chunk numbered \p chunk of \p stream is, in O(1).
+   * \p location receives the segment index, the chunk index in the
+   * segment, its offset in the segment and in the stream media segments,
+   * and its length.
+   * \return false if \p stream or \p chunk is out of range.
+   */
+  bool locate(uint32_t stream, uint32_t chunk, Location *location) const;
+
+  /**
+   * Find the number of the chunk holding the byte at \p offset of a
+   * segment, in O(log n) of the segment chunk count.
+   * \return false if the stream, segment or offset is out of range.
+   */
+  bool find(uint32_t stream, uint32_t segment, uint32_t offset,
+            uint32_t *chunk) const;
+
+ private:
+  struct StreamIndex {
+    StreamIndex() : segmentFirstChunk(1, 0) {
+    }
+
+    // The first chunk of every indexed segment followed by the chunk
+    // count, then the segment, offset and length of every chunk.
+    std::vector<uint32_t> segmentFirstChunk;
+    std::vector<uint32_t> chunkSegment;
+    std::vector<uint32_t> chunkOffset;
+    std::vector<uint32_t> chunkLength;
+  };
+
+  bool _indexSegments(uint32_t stream);
+
+  MetadataInterface *_metadata;
+  std::vector<StreamIndex> _streams;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_METADATA_METADATACHUNKINDEX_H_
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataChunkIndex.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Metadata/MetadataStream.h"
+
+namespace peeracle {
+
+class MetadataChunkIndexTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    MetadataStreamInit fixed;
+    MetadataStreamInit variable;
+    uint8_t digest[16] = { 0 };
+
+    fixed.chunkSize = 1000;
+    _streams.push_back(new MetadataStream(fixed));
+    _streams.push_back(new MetadataStream(variable));
+
+    // 2500 bytes segments of 3 fixed chunks, and an empty segment.
+    for (uint32_t i = 0; i < 4; ++i) {
+      MetadataMediaSegment *segment = new MetadataMediaSegment();
+
+      segment->setTimecode(i * 2000);
+      segment->setLength(i == 2 ? 0 : 2500);
+      for (uint32_t c = 0; i != 2 && c < 3; ++c) {
+        segment->addChunk(digest, c < 2 ? 1000 : 500);
+      }
+      _streams[0]->addMediaSegment(segment);
+    }
+
+    // Segments of i + 1 content-defined chunks of 10, 20, ... bytes.
+    for (uint32_t i = 0; i < 5; ++i) {
+      MetadataMediaSegment *segment = new MetadataMediaSegment();
+      uint32_t length = 0;
+
+      for (uint32_t c = 0; c <= i; ++c) {
+        segment->addChunk(digest, (c + 1) * 10);
+        length += (c + 1) * 10;
+      }
+      segment->setTimecode(i * 2000);
+      segment->setLength(length);
+      _streams[1]->addMediaSegment(segment);
+    }
+
+    for (size_t s = 0; s < _streams.size(); ++s) {
+      _metadata.getStreams().push_back(_streams[s]);
+    }
+    _index.build(&_metadata);
+  }
+
+  Metadata _metadata;
+  std::vector<MetadataStream *> _streams;
+  MetadataChunkIndex _index;
+};
+
+TEST_F(MetadataChunkIndexTest, Locate) {
+  MetadataChunkIndex::Location location;
+
+  ASSERT_EQ(9, _index.getChunkCount(0));
+  ASSERT_EQ(15, _index.getChunkCount(1));
+  EXPECT_EQ(0, _index.getChunkCount(2));
+  EXPECT_EQ(0, _index.getFirstChunk(0, 0));
+  EXPECT_EQ(6, _index.getFirstChunk(0, 2));
+  EXPECT_EQ(6, _index.getFirstChunk(0, 3));
+  EXPECT_EQ(9, _index.getFirstChunk(0, 4));
+  EXPECT_EQ(0, _index.getFirstChunk(1, 0));
+  EXPECT_EQ(1 + 2 + 3, _index.getFirstChunk(1, 3));
+
+  ASSERT_TRUE(_index.locate(0, 5, &location));
+  EXPECT_EQ(1, location.segment);
+  EXPECT_EQ(2, location.chunk);
+  EXPECT_EQ(2000, location.offset);
+  EXPECT_EQ(4500, location.streamOffset);
+  EXPECT_EQ(500, location.length);
+
+  ASSERT_TRUE(_index.locate(0, 6, &location));
+  EXPECT_EQ(3, location.segment);
+  EXPECT_EQ(0, location.chunk);
+  EXPECT_EQ(5000, location.streamOffset);
+
+  ASSERT_TRUE(_index.locate(1, 1 + 2 + 3 + 4 + 3, &location));
+  EXPECT_EQ(4, location.segment);
+  EXPECT_EQ(3, location.chunk);
+  EXPECT_EQ(60, location.offset);
+  EXPECT_EQ(10 + 30 + 60 + 100 + 60, location.streamOffset);
+  EXPECT_EQ(40, location.length);
+
+  EXPECT_FALSE(_index.locate(0, 9, &location));
+  EXPECT_FALSE(_index.locate(1, 15, &location));
+  EXPECT_FALSE(_index.locate(2, 0, &location));
+}
+
+TEST_F(MetadataChunkIndexTest, Find) {
+  MetadataChunkIndex::Location location;
+  uint32_t chunk;
+
+  for (uint32_t s = 0; s < 2; ++s) {
+    for (uint32_t c = 0; c < _index.getChunkCount(s); ++c) {
+      ASSERT_TRUE(_index.locate(s, c, &location));
+      ASSERT_TRUE(_index.find(s, location.segment, location.offset, &chunk));
+      EXPECT_EQ(c, chunk);
+      ASSERT_TRUE(_index.find(s, location.segment,
+                              location.offset + location.length - 1,
+                              &chunk));
+      EXPECT_EQ(c, chunk);
+    }
+  }
+
+  EXPECT_FALSE(_index.find(0, 0, 2500, &chunk));
+  EXPECT_FALSE(_index.find(0, 2, 0, &chunk));
+  EXPECT_FALSE(_index.find(0, 4, 0, &chunk));
+  EXPECT_FALSE(_index.find(2, 0, 0, &chunk));
+}
+
+TEST_F(MetadataChunkIndexTest, LiveAppend) {
+  MetadataChunkIndex::Location location;
+  MetadataMediaSegment *segment = new MetadataMediaSegment();
+  uint8_t digest[16] = { 0 };
+  uint32_t chunk;
+
+  segment->setTimecode(8000);
+  segment->setLength(1500);
+  segment->addChunk(digest, 1000);
+  segment->addChunk(digest, 500);
+  _streams[0]->addMediaSegment(segment);
+
+  // The new segment is unknown until update(), the indexed chunks keep
+  // their numbers.
+  EXPECT_EQ(9, _index.getChunkCount(0));
+  EXPECT_FALSE(_index.find(0, 4, 0, &chunk));
+  ASSERT_TRUE(_index.update());
+  EXPECT_EQ(11, _index.getChunkCount(0));
+  EXPECT_EQ(15, _index.getChunkCount(1));
+  EXPECT_EQ(9, _index.getFirstChunk(0, 4));
+
+  ASSERT_TRUE(_index.locate(0, 10, &location));
+  EXPECT_EQ(4, location.segment);
+  EXPECT_EQ(1, location.chunk);
+  EXPECT_EQ(7500 + 1000, location.streamOffset);
+  ASSERT_TRUE(_index.find(0, 4, 1200, &chunk));
+  EXPECT_EQ(10, chunk);
+
+  // The chunks of the other stream are not shifted.
+  ASSERT_TRUE(_index.locate(1, 0, &location));
+  EXPECT_EQ(0, location.segment);
+  EXPECT_EQ(10, location.length);
+}
+
+}  // namespace peeracle
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "peeracle/Metadata/MetadataFrameMap.h"
+
+namespace peeracle {
+
+MetadataFrameMap::MetadataFrameMap() {
+}
+
+bool MetadataFrameMap::build(MetadataMediaSegmentInterface *segment,
+                             const std::vector<MediaFrame> &frames) {
+  const std::vector<uint32_t> &lengths = segment->getChunkLengths();
+  uint64_t chunkEnd = 0;
+  uint64_t previousEnd = 0;
+  uint32_t chunk = 0;
+
+  _chunkCounts.clear();
+  _frameEnds.clear();
+  if (segment->hasLoadError()) {
+    return false;
+  }
+
+  for (size_t f = 0; f < frames.size(); ++f) {
+    const MediaFrame &frame = frames[f];
+    uint64_t end;
+
+    if (frame.offset < 0 || frame.length <= 0 ||
+        static_cast<uint64_t>(frame.offset) < previousEnd) {
+      _chunkCounts.clear();
+      _frameEnds.clear();
+      return false;
+    }
+
+    // Frames are ordered, the chunk holding the end of a frame is found by
+    // walking the chunks once for the whole segment.
+    end = static_cast<uint64_t>(frame.offset + frame.length);
+    while (chunkEnd < end && chunk < lengths.size()) {
+      chunkEnd += lengths[chunk++];
+    }
+
+    if (chunkEnd < end) {
+      _chunkCounts.clear();
+      _frameEnds.clear();
+      return false;
+    }
+
+    _chunkCounts.push_back(chunk);
+    _frameEnds.push_back(end);
+    previousEnd = end;
+  }
+
+  return true;
+}
+
+size_t MetadataFrameMap::getFrameCount() const {
+  return _chunkCounts.size();
+}
+
+uint32_t MetadataFrameMap::getChunkCount(size_t frame) const {
+  return frame < _chunkCounts.size() ? _chunkCounts[frame] : 0;
+}
+
+size_t MetadataFrameMap::getFrameCount(uint32_t chunkCount) const {
+  return std::upper_bound(_chunkCounts.begin(), _chunkCounts.end(),
+                          chunkCount) - _chunkCounts.begin();
+}
+
+uint64_t MetadataFrameMap::getPlayableLength(uint32_t chunkCount) const {
+  size_t count = getFrameCount(chunkCount);
+
+  return count ? _frameEnds[count - 1] : 0;
+}
+
+}  // namespace peeracle
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_METADATA_METADATAFRAMEMAP_H_
+#define PEERACLE_METADATA_METADATAFRAMEMAP_H_
+
+#include <stdint.h>
+#include <vector>
+#include "peeracle/Media/MediaInterface.h"
+#include "peeracle/Metadata/MetadataMediaSegmentInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Map the frames of a media segment, as listed by
+ * MediaInterface::getMediaSegmentFrames(), onto its chunks, so that the
+ * start of a segment can be demuxed once its leading chunks are verified
+ * instead of waiting for the whole segment.
+ * \addtogroup Metadata
+ */
+class MetadataFrameMap {
+ public:
+  MetadataFrameMap();
+
+  /**
+   * Map \p frames onto the chunks of \p segment.
+   * \return false if the frames are not ordered by offset, overlap, or do
+   * not fit in the segment chunks, or if the chunks could not be read.
+   */
+  bool build(MetadataMediaSegmentInterface *segment,
+             const std::vector<MediaFrame> &frames);
+
+  size_t getFrameCount() const;
+
+  /**
+   * Get the number of leading chunks needed to read the frame at \p frame
+   * and every frame before it.
+   */
+  uint32_t getChunkCount(size_t frame) const;
+
+  /**
+   * Get the number of leading frames entirely held by the first
+   * \p chunkCount chunks, in O(log n) of the frame count.
+   */
+  size_t getFrameCount(uint32_t chunkCount) const;
+
+  /**
+   * Get the number of leading segment bytes that can be given to a demuxer
+   * once the first \p chunkCount chunks are received: the end of the last
+   * complete frame, or 0 if no frame is complete.
+   */
+  uint64_t getPlayableLength(uint32_t chunkCount) const;
+
+ private:
+  std::vector<uint32_t> _chunkCounts;
+  std::vector<uint64_t> _frameEnds;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_METADATA_METADATAFRAMEMAP_H_
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/Metadata/MetadataFrameMap.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+
+namespace peeracle {
+
+static MediaFrame frame(std::streamsize offset, std::streamsize length) {
+  MediaFrame result;
+
+  result.offset = offset;
+  result.length = length;
+  return result;
+}
+
+class MetadataFrameMapTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    uint8_t digest[16] = { 0 };
+
+    // Chunks of 1000 bytes, the last one shorter.
+    _segment.setLength(3500);
+    _segment.addChunk(digest, 1000);
+    _segment.addChunk(digest, 1000);
+    _segment.addChunk(digest, 1000);
+    _segment.addChunk(digest, 500);
+  }
+
+  MetadataMediaSegment _segment;
+};
+
+TEST_F(MetadataFrameMapTest, Build) {
+  MetadataFrameMap map;
+  std::vector<MediaFrame> frames;
+
+  // A segment header, then frames ending inside the first chunk, on the
+  // end of the second one, and across the last two.
+  frames.push_back(frame(40, 900));
+  frames.push_back(frame(940, 1060));
+  frames.push_back(frame(2000, 200));
+  frames.push_back(frame(2200, 1300));
+  ASSERT_TRUE(map.build(&_segment, frames));
+  ASSERT_EQ(4U, map.getFrameCount());
+  EXPECT_EQ(1U, map.getChunkCount(0));
+  EXPECT_EQ(2U, map.getChunkCount(1));
+  EXPECT_EQ(3U, map.getChunkCount(2));
+  EXPECT_EQ(4U, map.getChunkCount(3));
+  EXPECT_EQ(0U, map.getChunkCount(4));
+
+  EXPECT_EQ(0U, map.getFrameCount(0U));
+  EXPECT_EQ(1U, map.getFrameCount(1U));
+  EXPECT_EQ(3U, map.getFrameCount(3U));
+  EXPECT_EQ(4U, map.getFrameCount(5U));
+
+  EXPECT_EQ(0U, map.getPlayableLength(0));
+  EXPECT_EQ(940U, map.getPlayableLength(1));
+  EXPECT_EQ(2000U, map.getPlayableLength(2));
+  EXPECT_EQ(3500U, map.getPlayableLength(4));
+}
+
+TEST_F(MetadataFrameMapTest, Invalid) {
+  MetadataFrameMap map;
+  std::vector<MediaFrame> frames;
+
+  frames.push_back(frame(0, 1000));
+  frames.push_back(frame(2000, 1501));
+  EXPECT_FALSE(map.build(&_segment, frames));
+  EXPECT_EQ(0U, map.getFrameCount());
+
+  frames[1] = frame(999, 10);
+  EXPECT_FALSE(map.build(&_segment, frames));
+
+  frames[1] = frame(1000, 0);
+  EXPECT_FALSE(map.build(&_segment, frames));
+
+  frames.clear();
+  EXPECT_TRUE(map.build(&_segment, frames));
+  EXPECT_EQ(0U, map.getPlayableLength(4));
+}
+
+}  // namespace peeracle
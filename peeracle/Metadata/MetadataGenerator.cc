@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include "peeracle/Metadata/MetadataGenerator.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Metadata/MetadataStream.h"
+
+namespace peeracle {
+
+static const uint32_t kInitSegmentLength = 4096;
+static const uint32_t kMinChunkLength = 16384;
+static const uint32_t kMaxChunkLength = 114688;
+
+MetadataGenerator::MetadataGenerator(uint32_t duration,
+                                     uint32_t segmentDuration, uint32_t seed)
+  : _duration(duration), _segmentDuration(segmentDuration), _seed(seed),
+    _state(seed), _chunkCount(0) {
+}
+
+void MetadataGenerator::addStream(const MetadataStreamInit &init) {
+  _streams.push_back(init);
+}
+
+void MetadataGenerator::addDefaultStreams(uint32_t chunkSize) {
+  static const struct {
+    uint32_t bandwidth;
+    int32_t width;
+    int32_t height;
+  } kLadder[] = {
+    { 8000000, 1920, 1080 },
+    { 5000000, 1280, 720 },
+    { 2500000, 854, 480 },
+    { 1200000, 640, 360 },
+    { 600000, 426, 240 },
+  };
+  MetadataStreamInit audio;
+
+  for (size_t i = 0; i < sizeof(kLadder) / sizeof(kLadder[0]); ++i) {
+    MetadataStreamInit video;
+
+    video.type = 1;
+    video.mimeType = "video/webm; codecs=\"vp9\"";
+    video.bandwidth = kLadder[i].bandwidth;
+    video.width = kLadder[i].width;
+    video.height = kLadder[i].height;
+    video.chunkSize = chunkSize;
+    addStream(video);
+  }
+
+  audio.type = 2;
+  audio.mimeType = "audio/webm; codecs=\"opus\"";
+  audio.bandwidth = 128000;
+  audio.numChannels = 2;
+  audio.samplingFrequency = 48000;
+  audio.chunkSize = chunkSize;
+  addStream(audio);
+}
+
+uint32_t MetadataGenerator::_next() {
+  _state ^= _state << 13;
+  _state ^= _state >> 17;
+  _state ^= _state << 5;
+  return _state;
+}
+
+bool MetadataGenerator::write(DataStreamInterface *out) {
+  uint32_t segmentCount = (_duration + _segmentDuration - 1) /
+    _segmentDuration;
+  std::vector<uint8_t> initSegment(kInitSegmentLength);
+  uint8_t digest[16];
+
+  _state = _seed ? _seed : 1;
+  _chunkCount = 0;
+
+  if (out->write("PRCL", 4) == -1 ||
+      out->write(static_cast<uint32_t>(2)) == -1 ||
+      out->write(std::string("murmur3_x86_128")) == -1 ||
+      out->write(static_cast<uint32_t>(1000000)) == -1 ||
+      out->write(static_cast<double>(_duration)) == -1 ||
+      out->write(static_cast<uint32_t>(1)) == -1 ||
+      out->write(std::string("wss://tracker.peeracle.org")) == -1 ||
+      out->write(static_cast<uint32_t>(_streams.size())) == -1) {
+    return false;
+  }
+
+  for (size_t s = 0; s < _streams.size(); ++s) {
+    MetadataStream stream(_streams[s]);
+    uint32_t chunkSize = _streams[s].chunkSize;
+
+    for (size_t i = 0; i < initSegment.size(); ++i) {
+      initSegment[i] = static_cast<uint8_t>(_next());
+    }
+    stream.setInitSegment(&initSegment[0], kInitSegmentLength);
+    if (!stream.serializeHeader(out, segmentCount)) {
+      return false;
+    }
+
+    for (uint32_t i = 0; i < segmentCount; ++i) {
+      MetadataMediaSegment segment;
+      uint32_t timecode = i * _segmentDuration;
+      uint32_t duration = _duration - timecode < _segmentDuration ?
+        _duration - timecode : _segmentDuration;
+      // Variable bitrate: each segment is 75 to 125% of the average size.
+      uint64_t length = static_cast<uint64_t>(_streams[s].bandwidth) / 8 *
+        duration / 1000 * (768 + _next() % 512) / 1024;
+
+      if (!length) {
+        length = 1;
+      }
+
+      segment.setTimecode(timecode);
+      segment.setLength(static_cast<uint32_t>(length));
+      for (uint64_t offset = 0; offset < length;) {
+        uint64_t chunkLength = chunkSize ? chunkSize : kMinChunkLength +
+          _next() % (kMaxChunkLength - kMinChunkLength);
+
+        if (chunkLength > length - offset) {
+          chunkLength = length - offset;
+        }
+
+        for (size_t b = 0; b < sizeof(digest); b += 4) {
+          uint32_t random = _next();
+
+          digest[b] = static_cast<uint8_t>(random);
+          digest[b + 1] = static_cast<uint8_t>(random >> 8);
+          digest[b + 2] = static_cast<uint8_t>(random >> 16);
+          digest[b + 3] = static_cast<uint8_t>(random >> 24);
+        }
+        segment.addChunk(digest, static_cast<uint32_t>(chunkLength));
+        offset += chunkLength;
+        ++_chunkCount;
+      }
+
+      if (!segment.serialize(out, chunkSize)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+uint64_t MetadataGenerator::getChunkCount() const {
+  return _chunkCount;
+}
+
+}  // namespace peeracle
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_METADATA_METADATAGENERATOR_H_
+#define PEERACLE_METADATA_METADATAGENERATOR_H_
+
+#include <stdint.h>
+#include <vector>
+#include "peeracle/DataStream/DataStreamInterface.h"
+#include "peeracle/Metadata/MetadataStreamInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Produce synthetic metadata files shaped like real adaptive streaming
+ * content, for tests and benchmarks. Segment sizes follow the bandwidth of
+ * each stream with some variation, chunk hashes are pseudo random, and the
+ * output only depends on the parameters and the seed.
+ * Like MetadataBuilder, segments are written one at a time, so generating
+ * a large file does not need much memory.
+ * \addtogroup Metadata
+ */
+class MetadataGenerator {
+ public:
+  /**
+   * @param duration the content duration in milliseconds.
+   * @param segmentDuration the media segment duration in milliseconds.
+   * @param seed the seed of the pseudo random generator.
+   */
+  MetadataGenerator(uint32_t duration, uint32_t segmentDuration,
+                    uint32_t seed);
+
+  /**
+   * Add a stream. A \p init.chunkSize of 0 gives content defined chunks,
+   * between 16 and 112 KB.
+   */
+  void addStream(const MetadataStreamInit &init);
+
+  /**
+   * Add a 1080p to 240p video ladder and a stereo audio stream, all with
+   * chunks of \p chunkSize bytes.
+   */
+  void addDefaultStreams(uint32_t chunkSize);
+
+  /**
+   * Write the metadata in the version 2 layout read by
+   * Metadata::unserialize().
+   */
+  bool write(DataStreamInterface *out);
+
+  /**
+   * Get the number of chunks written by the last call to write().
+   */
+  uint64_t getChunkCount() const;
+
+ private:
+  uint32_t _next();
+
+  uint32_t _duration;
+  uint32_t _segmentDuration;
+  uint32_t _seed;
+  uint32_t _state;
+  uint64_t _chunkCount;
+  std::vector<MetadataStreamInit> _streams;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_METADATA_METADATAGENERATOR_H_
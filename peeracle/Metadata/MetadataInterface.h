@@ -43,14 +43,103 @@ class MetadataInterface {
   virtual std::vector<std::string> &getTrackerUrls() = 0;
   virtual std::vector<MetadataStreamInterface *> &getStreams() = 0;
 
+  /**
+   * Select the layout serialize() writes: version 2, the default, or the
+   * version 3 layout described in MetadataView. unserialize() sets it to
+   * the version of the file read.
+   */
+  virtual void setVersion(uint32_t version) = 0;
   virtual void setHashAlgorithm(const std::string &hashAlgorithm) = 0;
   virtual void setTimecodeScale(uint32_t timecodeScale) = 0;
   virtual void setDuration(double duration) = 0;
   virtual void addTracker(const std::string &tracker) = 0;
 
+  /**
+   * Mark the metadata as describing a live content, whatever its duration.
+   */
+  virtual void setLive(bool live) = 0;
+
+  /**
+   * A live metadata has its streams grow through delta records, and its id
+   * only covers the init segments. The flag is stored in the file and in
+   * every delta record.
+   */
+  virtual bool isLive() = 0;
+
+  /**
+   * Get the number of bytes serialize() writes.
+   */
+  virtual uint64_t getSerializedSize() = 0;
+
+  /**
+   * Get the number of bytes held by the metadata, its streams and its
+   * arena. The count covers the objects and the buffers they own, not the
+   * allocator overhead.
+   */
+  virtual uint64_t getMemoryUsage() = 0;
+
+  /**
+   * Move the init segments and chunk hashes of every stream to a single
+   * arena owned by the metadata, intern repeated strings and release the
+   * spare capacity, so that a long lived metadata does not keep one heap
+   * block per chunk. Calling it again after adding segments compacts them
+   * to a new arena.
+   */
+  virtual void compact() = 0;
+
+  /**
+   * Write the metadata header, streams, init segments and chunk hashes in
+   * the layout selected by setVersion(). A version 3 file also stores the
+   * content id, which is the id computed for the same content in version 2.
+   * A live version 2 file ends with its flags, MetadataView::kLive, after
+   * the streams.
+   * The output is laid out in a buffer of getSerializedSize() bytes, then
+   * written to \p dataStream at once.
+   * \return false if the version is not supported, or the id of a version 3
+   * file can not be computed.
+   */
   virtual bool serialize(DataStreamInterface *dataStream) = 0;
+
+  /**
+   * Read a metadata written by serialize() or by MetadataV3Writer.
+   * A version 3 file stores the content id in its header, which getId()
+   * returns as is. The id of a version 2 file is computed from the streams
+   * on the first call to getId(). A version 3 file held in memory is parsed
+   * in place instead of being copied.
+   */
   virtual bool unserialize(DataStreamInterface *dataStream) = 0;
 
+  /**
+   * Compute the content id from the init segments and chunk hashes, as
+   * described in MetadataView, and compare it to getId(), to check a header
+   * id against the content it describes. This hashes the whole metadata,
+   * and reads every chunk of a lazy metadata.
+   * \return false if the ids differ, the metadata has no id or a chunk
+   * could not be read.
+   */
+  virtual bool verifyId() = 0;
+
+  /**
+   * Write a delta record holding the media segments of every stream from
+   * the index given in \p firstSegments, 0 for missing streams.
+   * A delta record is made of:
+   * - the "PRCD" magic, a version, the metadata id and its flags, with
+   *   MetadataView::kLive set,
+   * - a block count, then per block a stream index, a segment count and
+   *   the segments, serialized as in the metadata.
+   */
+  virtual bool serializeDelta(DataStreamInterface *dataStream,
+                              const std::vector<uint32_t> &firstSegments) = 0;
+
+  /**
+   * Append the media segments of a delta record to a live metadata.
+   * Segments older than the last one of their stream are skipped, so
+   * overlapping deltas can be applied.
+   * \return false if the metadata or the delta is not live, the delta is
+   * for another id, or it is corrupted, in which case nothing is appended.
+   */
+  virtual bool unserializeDelta(DataStreamInterface *dataStream) = 0;
+
   virtual ~MetadataInterface() { }
 };
 
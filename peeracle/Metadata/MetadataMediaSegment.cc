@@ -20,18 +20,25 @@
  * SOFTWARE.
  */
 
-#include <iomanip>
-#include <iostream>
-#include <sstream>
+#include <cstring>
 #include <string>
 #include <vector>
 
 #include "peeracle/Hash/Murmur3Hash.h"
+#include "peeracle/Metadata/MetadataArena.h"
 #include "peeracle/Metadata/MetadataMediaSegment.h"
 
 namespace peeracle {
 
-MetadataMediaSegment::MetadataMediaSegment() {
+MetadataMediaSegment::MetadataMediaSegment() : _dataStream(NULL),
+  _loadError(false), _offset(0), _chunkCount(0), _chunkSize(0),
+  _timecode(0), _length(0), _arenaChunks(0) {
+}
+
+MetadataMediaSegment::~MetadataMediaSegment() {
+  for (size_t i = _arenaChunks; i < _chunks.size(); ++i) {
+    delete[] _chunks[i];
+  }
 }
 
 uint32_t MetadataMediaSegment::getTimecode() {
@@ -43,11 +50,132 @@ uint32_t MetadataMediaSegment::getLength() {
 }
 
 const std::vector<uint8_t *> &MetadataMediaSegment::getChunks() {
+  _load();
   return _chunks;
 }
 
+const std::vector<uint32_t> &MetadataMediaSegment::getChunkLengths() {
+  _load();
+  return _chunkLengths;
+}
+
+uint32_t MetadataMediaSegment::getChunkCount() {
+  if (_dataStream) {
+    return _chunkCount;
+  }
+  return static_cast<uint32_t>(_chunks.size());
+}
+
+bool MetadataMediaSegment::hasLoadError() {
+  return _loadError;
+}
+
+bool MetadataMediaSegment::updateHash(HashInterface *hash) {
+  if (!_dataStream) {
+    for (size_t c = 0; c < _chunks.size(); ++c) {
+      hash->update(_chunks[c], 16);
+    }
+    return true;
+  }
+
+  size_t stride = _chunkSize ? 16 : 20;
+  std::vector<uint8_t> table(_chunkCount * stride);
+  std::streamsize position = _dataStream->tell();
+
+  if (table.empty()) {
+    return true;
+  }
+
+  if (_dataStream->seek(_offset) == -1 ||
+      _dataStream->read(reinterpret_cast<char *>(&table[0]),
+                        table.size()) != static_cast<std::streamsize>(
+                          table.size())) {
+    _dataStream->seek(position);
+    return false;
+  }
+
+  for (size_t offset = stride - 16; offset < table.size(); offset += stride) {
+    hash->update(&table[offset], 16);
+  }
+  _dataStream->seek(position);
+  return true;
+}
+
+void MetadataMediaSegment::setTimecode(uint32_t timecode) {
+  _timecode = timecode;
+}
+
+void MetadataMediaSegment::setLength(uint32_t length) {
+  _length = length;
+}
+
+void MetadataMediaSegment::addChunk(const uint8_t *hash, uint32_t length) {
+  uint8_t *chunk;
+
+  if (!_load()) {
+    return;
+  }
+
+  chunk = new uint8_t[16];
+  memcpy(chunk, hash, 16);
+  _chunks.push_back(chunk);
+  _chunkLengths.push_back(length);
+}
+
+uint64_t MetadataMediaSegment::getSerializedSize(uint32_t chunkSize) {
+  uint64_t stride = chunkSize ? 16 : 20;
+
+  return 12 + getChunkCount() * stride;
+}
+
+uint64_t MetadataMediaSegment::getMemoryUsage() {
+  return sizeof(*this) + _chunks.capacity() * sizeof(uint8_t *) +
+    _chunkLengths.capacity() * sizeof(uint32_t) +
+    (_chunks.size() - _arenaChunks) * 16;
+}
+
+void MetadataMediaSegment::compact(MetadataArena *arena) {
+  uint8_t *hashes;
+
+  if (_dataStream) {
+    return;
+  }
+
+  hashes = arena->allocate(_chunks.size() * 16);
+  for (size_t i = 0; i < _chunks.size(); ++i) {
+    memcpy(hashes + i * 16, _chunks[i], 16);
+    if (i >= _arenaChunks) {
+      delete[] _chunks[i];
+    }
+    _chunks[i] = hashes + i * 16;
+  }
+  _arenaChunks = _chunks.size();
+
+  std::vector<uint8_t *>(_chunks).swap(_chunks);
+  std::vector<uint32_t>(_chunkLengths).swap(_chunkLengths);
+}
+
+bool MetadataMediaSegment::serialize(DataStreamInterface *dataStream,
+                                     uint32_t chunkSize) {
+  if (!_load() || dataStream->write(_timecode) == -1 ||
+      dataStream->write(_length) == -1 ||
+      dataStream->write(static_cast<uint32_t>(_chunks.size())) == -1) {
+    return false;
+  }
+
+  for (size_t c = 0; c < _chunks.size(); ++c) {
+    if (!chunkSize && dataStream->write(_chunkLengths[c]) == -1) {
+      return false;
+    }
+    Murmur3Hash::serialize(_chunks[c], dataStream);
+  }
+
+  return true;
+}
+
 bool MetadataMediaSegment::unserialize(DataStreamInterface *dataStream,
                                        const std::string &hashAlgorithm,
+                                       uint32_t chunkSize,
                                        HashInterface *hash) {
   uint32_t chunkCount;
 
@@ -60,14 +188,112 @@ bool MetadataMediaSegment::unserialize(DataStreamInterface *dataStream,
     return false;
   }
 
+  _chunkSize = chunkSize;
+  return _unserializeChunks(dataStream, chunkCount, hash);
+}
+
+bool MetadataMediaSegment::unserializeIndex(DataStreamInterface *dataStream,
+                                            const std::string &hashAlgorithm,
+                                            uint32_t chunkSize) {
+  std::streamsize stride = chunkSize ? 16 : 20;
+
+  if (dataStream->read(&_timecode) == -1 ||
+    dataStream->read(&_length) == -1 ||
+    dataStream->read(&_chunkCount) == -1) {
+    return false;
+  }
+
+  if (hashAlgorithm != "murmur3_x86_128") {
+    return false;
+  }
+
+  _chunkSize = chunkSize;
+  _offset = dataStream->tell();
+  if (dataStream->seek(_offset + _chunkCount * stride) == -1) {
+    return false;
+  }
+
+  _dataStream = dataStream;
+  return true;
+}
+
+void MetadataMediaSegment::setChunkTable(DataStreamInterface *dataStream,
+                                         std::streamsize offset,
+                                         uint32_t chunkCount) {
+  // Each record has its chunk length, as with a chunk size of 0.
+  _chunkSize = 0;
+  _offset = offset;
+  _chunkCount = chunkCount;
+  _dataStream = dataStream;
+}
+
+bool MetadataMediaSegment::_unserializeChunks(DataStreamInterface *dataStream,
+                                              uint32_t chunkCount,
+                                              HashInterface *hash) {
+  uint32_t chunkLength;
+  uint32_t remaining;
+  uint64_t total = 0;
+
+  // A chunk size of 0 means the chunk boundaries were defined by the
+  // content, each chunk hash is then preceded by the chunk length.
+  remaining = _length;
   for (uint32_t c = 0; c < chunkCount; ++c) {
     uint8_t *chunk = new uint8_t[16];
 
-    Murmur3Hash::unserialize(dataStream, chunk);
+    if (!_chunkSize) {
+      if (dataStream->read(&chunkLength) == -1) {
+        delete[] chunk;
+        return false;
+      }
+    } else {
+      chunkLength = remaining > _chunkSize ? _chunkSize : remaining;
+    }
+
+    total += chunkLength;
+    remaining -= chunkLength < remaining ? chunkLength : remaining;
+    if (dataStream->read(reinterpret_cast<char *>(chunk), 16) != 16) {
+      delete[] chunk;
+      return false;
+    }
     _chunks.push_back(chunk);
-    hash->update(chunk, 16);
+    _chunkLengths.push_back(chunkLength);
+    if (hash) {
+      hash->update(chunk, 16);
+    }
+  }
+
+  // Recorded chunk lengths must cover the segment exactly, or finding a
+  // chunk by its offset would read past the segment or miss its end.
+  return _chunkSize || total == _length;
+}
+
+bool MetadataMediaSegment::_load() {
+  std::streamsize position;
+  bool loaded;
+
+  if (!_dataStream) {
+    return true;
+  }
+
+  // On failure the segment stays lazy, so that the next access reads the
+  // chunks again instead of seeing a segment without chunks.
+  position = _dataStream->tell();
+  loaded = _dataStream->seek(_offset) != -1 &&
+    _unserializeChunks(_dataStream, _chunkCount, NULL);
+  _dataStream->seek(position);
+
+  if (!loaded) {
+    for (size_t i = 0; i < _chunks.size(); ++i) {
+      delete[] _chunks[i];
+    }
+    _chunks.clear();
+    _chunkLengths.clear();
+    _loadError = true;
+    return false;
   }
 
+  _dataStream = NULL;
+  _loadError = false;
   return true;
 }
 
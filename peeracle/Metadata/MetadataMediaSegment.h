@@ -34,18 +34,63 @@ class MetadataMediaSegment
   : public MetadataMediaSegmentInterface {
  public:
   MetadataMediaSegment();
+  ~MetadataMediaSegment();
 
   uint32_t getTimecode();
   uint32_t getLength();
   const std::vector<uint8_t *> &getChunks();
+  const std::vector<uint32_t> &getChunkLengths();
+  uint32_t getChunkCount();
+  bool hasLoadError();
+  bool updateHash(HashInterface *hash);
 
+  void setTimecode(uint32_t timecode);
+  void setLength(uint32_t length);
+  void addChunk(const uint8_t *hash, uint32_t length);
+
+  uint64_t getSerializedSize(uint32_t chunkSize);
+  uint64_t getMemoryUsage();
+  void compact(MetadataArena *arena);
+  bool serialize(DataStreamInterface *dataStream, uint32_t chunkSize);
   bool unserialize(DataStreamInterface *dataStream,
-                   const std::string &hashName, HashInterface *hash);
+                   const std::string &hashName, uint32_t chunkSize,
+                   HashInterface *hash);
+
+  /**
+   * Read the segment timecode, length and chunk count, then skip its chunk
+   * hashes. They are read from \p dataStream when first accessed, so
+   * \p dataStream must outlive this segment and keep its content.
+   */
+  bool unserializeIndex(DataStreamInterface *dataStream,
+                        const std::string &hashName, uint32_t chunkSize);
+
+  /**
+   * Read the \p chunkCount chunk hashes from \p dataStream at \p offset
+   * when first accessed, as records of a chunk length and a hash, the
+   * layout of a version 3 chunk table. \p dataStream must outlive this
+   * segment and keep its content.
+   */
+  void setChunkTable(DataStreamInterface *dataStream, std::streamsize offset,
+                     uint32_t chunkCount);
 
  private:
+  bool _unserializeChunks(DataStreamInterface *dataStream,
+                          uint32_t chunkCount, HashInterface *hash);
+  bool _load();
+
+  DataStreamInterface *_dataStream;
+  bool _loadError;
+  std::streamsize _offset;
+  uint32_t _chunkCount;
+  uint32_t _chunkSize;
   uint32_t _timecode;
   uint32_t _length;
   std::vector<uint8_t *> _chunks;
+
+  // The first _arenaChunks hashes live in an arena, the others were
+  // allocated one by one.
+  size_t _arenaChunks;
+  std::vector<uint32_t> _chunkLengths;
 };
 
 }  // namespace peeracle
@@ -33,14 +33,61 @@
 
 namespace peeracle {
 
+class MetadataArena;
+
 class MetadataMediaSegmentInterface {
  public:
   virtual uint32_t getTimecode() = 0;
   virtual uint32_t getLength() = 0;
   virtual const std::vector<uint8_t *> &getChunks() = 0;
+  virtual const std::vector<uint32_t> &getChunkLengths() = 0;
+  virtual uint32_t getChunkCount() = 0;
+
+  /**
+   * Tell whether the last attempt to read the chunks of a lazily loaded
+   * segment failed. getChunks() and getChunkLengths() are then empty, and
+   * the chunks are read again on the next access.
+   */
+  virtual bool hasLoadError() = 0;
+
+  /**
+   * Feed the chunk hashes of this segment to \p hash, as done when
+   * computing the metadata id. Lazily loaded chunks stay unloaded.
+   * \return false if the chunk hashes could not be read.
+   */
+  virtual bool updateHash(HashInterface *hash) = 0;
+
+  virtual void setTimecode(uint32_t timecode) = 0;
+  virtual void setLength(uint32_t length) = 0;
+
+  /**
+   * Append a chunk. Does nothing if the chunks of a lazily loaded segment
+   * could not be read, which hasLoadError() then tells.
+   */
+  virtual void addChunk(const uint8_t *hash, uint32_t length) = 0;
+
+  /**
+   * Get the number of bytes serialize() writes, without loading the chunks.
+   */
+  virtual uint64_t getSerializedSize(uint32_t chunkSize) = 0;
+
+  /**
+   * Get the number of bytes held by this segment, leaving out what
+   * compact() moved to an arena.
+   */
+  virtual uint64_t getMemoryUsage() = 0;
+
+  /**
+   * Move the chunk hashes to \p arena and release the spare capacity.
+   * Lazily loaded chunks stay unloaded.
+   */
+  virtual void compact(MetadataArena *arena) = 0;
 
+  virtual bool serialize(DataStreamInterface *dataStream,
+                         uint32_t chunkSize) = 0;
   virtual bool unserialize(DataStreamInterface *dataStream,
                            const std::string &hashName,
+                           uint32_t chunkSize,
                            HashInterface *hash) = 0;
 
   virtual ~MetadataMediaSegmentInterface() {}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/FileDataStream.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataGenerator.h"
+#include "peeracle/Metadata/MetadataV3Writer.h"
+#include "test/benchmark.h"
+
+// Every allocation is prefixed with its size, so that the benchmark can
+// track the number of allocations and the peak heap usage of a parse.
+static const size_t kHeaderSize = 16;
+static uint64_t gAllocations = 0;
+static uint64_t gHeapBytes = 0;
+static uint64_t gPeakHeapBytes = 0;
+
+static void *countedAlloc(size_t size) {
+  uint8_t *block = static_cast<uint8_t *>(malloc(size + kHeaderSize));
+
+  if (!block) {
+    throw std::bad_alloc();
+  }
+
+  *reinterpret_cast<size_t *>(block) = size;
+  ++gAllocations;
+  gHeapBytes += size;
+  if (gHeapBytes > gPeakHeapBytes) {
+    gPeakHeapBytes = gHeapBytes;
+  }
+  return block + kHeaderSize;
+}
+
+static void countedFree(void *pointer) {
+  uint8_t *block;
+
+  if (!pointer) {
+    return;
+  }
+
+  block = static_cast<uint8_t *>(pointer) - kHeaderSize;
+  gHeapBytes -= *reinterpret_cast<size_t *>(block);
+  free(block);
+}
+
+void *operator new(size_t size) {
+  return countedAlloc(size);
+}
+
+void *operator new[](size_t size) {
+  return countedAlloc(size);
+}
+
+void operator delete(void *pointer) throw() {
+  countedFree(pointer);
+}
+
+void operator delete[](void *pointer) throw() {
+  countedFree(pointer);
+}
+
+namespace peeracle {
+
+static const int64_t kMinNanos = 500000000;
+static const char *kFilePath = "MetadataParse_benchmark.tmp";
+
+class ParseCase : public Benchmark::Case {
+ public:
+  ParseCase(DataStreamInterface *in, bool lazy, bool id)
+    : _in(in), _lazy(lazy), _id(id), _result(false) {
+  }
+
+  void run() {
+    Metadata metadata;
+
+    metadata.setLazy(_lazy);
+    _in->seek(0);
+    _result = metadata.unserialize(_in);
+    if (_result && _id) {
+      _result = !metadata.getId().empty();
+    }
+  }
+
+  bool getResult() const {
+    return _result;
+  }
+
+ private:
+  DataStreamInterface *_in;
+  bool _lazy;
+  bool _id;
+  bool _result;
+};
+
+static bool addRow(BenchmarkTable *table, const std::string &name,
+                   DataStreamInterface *in, bool lazy, bool id) {
+  ParseCase parseCase(in, lazy, id);
+  uint64_t size = static_cast<uint64_t>(in->length());
+  uint64_t allocations = gAllocations;
+  uint64_t heapBytes = gHeapBytes;
+  double nanos;
+
+  // Measure a single parse for the memory figures, then time it.
+  gPeakHeapBytes = heapBytes;
+  parseCase.run();
+  if (!parseCase.getResult()) {
+    std::cerr << "unable to parse the metadata from " << name << std::endl;
+    return false;
+  }
+  allocations = gAllocations - allocations;
+  heapBytes = gPeakHeapBytes - heapBytes;
+
+  nanos = Benchmark::measure(&parseCase, kMinNanos);
+  table->addRow();
+  table->addCell(name);
+  table->addCell(Benchmark::formatTime(nanos));
+  table->addCell(Benchmark::formatRate(static_cast<double>(size) * 1e9 /
+                                       nanos));
+  table->addCell(Benchmark::formatSize(static_cast<double>(heapBytes)));
+  table->addCell(Benchmark::formatCount(static_cast<double>(allocations)));
+  return true;
+}
+
+static bool run(const std::string &name, uint32_t duration,
+                uint32_t chunkSize) {
+  MetadataGenerator generator(duration, 2000, 0x5052434C);
+  DataStreamInit dsInit;
+  MemoryDataStream memory(dsInit);
+  MemoryDataStream v3(dsInit);
+  Metadata metadata;
+  FileDataStream *file;
+  uint64_t size;
+  bool result;
+
+  generator.addDefaultStreams(chunkSize);
+  if (!generator.write(&memory)) {
+    std::cerr << "unable to generate the metadata" << std::endl;
+    return false;
+  }
+  size = static_cast<uint64_t>(memory.length());
+
+  MetadataV3Writer writer(&metadata);
+  if (memory.seek(0) != 0 || !metadata.unserialize(&memory) ||
+      !writer.write(&v3)) {
+    std::cerr << "unable to convert the metadata to version 3" << std::endl;
+    return false;
+  }
+
+  dsInit.path = kFilePath;
+  dsInit.create = true;
+  remove(kFilePath);
+  file = new FileDataStream(dsInit);
+  if (!file->open() ||
+      file->write(reinterpret_cast<const char *>(memory.getBuffer()),
+                  memory.length()) != memory.length()) {
+    std::cerr << "unable to write " << kFilePath << std::endl;
+    delete file;
+    return false;
+  }
+
+  BenchmarkTable table(name + ": " +
+                       Benchmark::formatCount(static_cast<double>(
+                         generator.getChunkCount())) + " chunks, " +
+                       Benchmark::formatSize(static_cast<double>(size)));
+
+  table.addColumn("source");
+  table.addColumn("parse time");
+  table.addColumn("throughput");
+  table.addColumn("peak memory");
+  table.addColumn("allocations");
+
+  // Opening a file also gives its id: version 2 files hash every chunk for
+  // it, version 3 files store it in their header.
+  result = addRow(&table, "memory", &memory, false, false) &&
+    addRow(&table, "memory (lazy)", &memory, true, false) &&
+    addRow(&table, "memory + id", &memory, false, true) &&
+    addRow(&table, "memory v3 + id", &v3, false, true) &&
+    addRow(&table, "file", file, false, false) &&
+    addRow(&table, "file (lazy)", file, true, false);
+  if (result) {
+    table.print(&std::cout);
+  }
+
+  delete file;
+  remove(kFilePath);
+  return result;
+}
+
+}  // namespace peeracle
+
+int main() {
+  // 6 streams of 2 second segments, from 10 minutes to 2 hours with up to a
+  // million chunks.
+  if (!peeracle::run("10 minutes, 64 KB chunks", 600000, 65536) ||
+      !peeracle::run("2 hours, 64 KB chunks", 7200000, 65536) ||
+      !peeracle::run("2 hours, 16 KB chunks", 7200000, 16384)) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_METADATA_METADATASEGMENTITERATOR_H_
+#define PEERACLE_METADATA_METADATASEGMENTITERATOR_H_
+
+#include <stdint.h>
+#include "peeracle/Metadata/MetadataStreamInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Walk the media segments of a stream from a playback position, to know
+ * which segments to prefetch next. Segments are returned in the stream
+ * order, which is the timecode order for every metadata produced by
+ * MetadataBuilder.
+ * \addtogroup Metadata
+ */
+class MetadataSegmentIterator {
+ public:
+  /**
+   * Start at the segment playing at \p timecode, or at the first segment if
+   * \p timecode is before it.
+   */
+  MetadataSegmentIterator(MetadataStreamInterface *stream, uint32_t timecode);
+
+  bool hasNext() const;
+
+  /**
+   * Get the index in MetadataStreamInterface::getMediaSegments() of the
+   * segment next() returns.
+   */
+  uint32_t getIndex() const;
+  MetadataMediaSegmentInterface *next();
+
+ private:
+  MetadataStreamInterface *_stream;
+  uint32_t _index;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_METADATA_METADATASEGMENTITERATOR_H_
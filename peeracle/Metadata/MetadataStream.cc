@@ -20,13 +20,35 @@
  * SOFTWARE.
  */
 
-#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include "peeracle/Metadata/MetadataArena.h"
 #include "peeracle/Metadata/MetadataStream.h"
 #include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Utils/Logger.h"
 
 namespace peeracle {
 
-MetadataStream::MetadataStream() {
+MetadataStream::MetadataStream() : _type(0), _internedMimeType(NULL),
+  _bandwidth(0), _width(0), _height(0), _numChannels(0),
+  _samplingFrequency(0), _chunkSize(0), _initSegment(NULL),
+  _initSegmentLength(0), _ownsInitSegment(true), _offsets(1, 0) {
+}
+
+MetadataStream::MetadataStream(const MetadataStreamInit &init) :
+  _type(init.type), _mimeType(init.mimeType), _internedMimeType(NULL),
+  _bandwidth(init.bandwidth), _width(init.width), _height(init.height),
+  _numChannels(init.numChannels), _samplingFrequency(init.samplingFrequency),
+  _chunkSize(init.chunkSize), _initSegment(NULL), _initSegmentLength(0),
+  _ownsInitSegment(true), _offsets(1, 0) {
+}
+
+MetadataStream::~MetadataStream() {
+  for (size_t i = 0; i < _mediaSegments.size(); ++i) {
+    delete _mediaSegments[i];
+  }
+  _releaseInitSegment();
 }
 
 uint8_t MetadataStream::getType() {
@@ -34,6 +56,9 @@ uint8_t MetadataStream::getType() {
 }
 
 const std::string &MetadataStream::getMimeType() {
+  if (_internedMimeType) {
+    return *_internedMimeType;
+  }
   return _mimeType;
 }
 
@@ -74,12 +99,182 @@ std::vector<MetadataMediaSegmentInterface *>
   return _mediaSegments;
 }
 
-bool MetadataStream::unserialize(DataStreamInterface *dataStream,
-                                 const std::string &hashName,
-                                 HashInterface *hash) {
-  uint32_t mediaSegmentCount;
-  MetadataMediaSegmentInterface *mediaSegment;
+void MetadataStream::setInitSegment(const uint8_t *buffer,
+                                    uint32_t length) {
+  _releaseInitSegment();
+  _initSegment = new uint8_t[length];
+  _initSegmentLength = length;
+  memcpy(_initSegment, buffer, length);
+}
+
+void MetadataStream::_releaseInitSegment() {
+  if (_ownsInitSegment) {
+    delete[] _initSegment;
+  }
+  _initSegment = NULL;
+  _ownsInitSegment = true;
+}
+
+void MetadataStream::addMediaSegment(MetadataMediaSegmentInterface *segment) {
+  uint32_t index = static_cast<uint32_t>(_mediaSegments.size());
+
+  _mediaSegments.push_back(segment);
+
+  // Live streams append segments in timecode order, which extends the
+  // index in place. Only an out of order segment sorts it again.
+  if (!_timecodeIndex.empty() &&
+      segment->getTimecode() < _timecodeIndex.back().first) {
+    _buildIndex();
+    return;
+  }
+
+  _timecodeIndex.push_back(std::make_pair(segment->getTimecode(), index));
+  _offsets.push_back(_offsets.back() + segment->getLength());
+}
+
+bool MetadataStream::findSegmentByTimecode(uint32_t timecode,
+                                           uint32_t *index) {
+  std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it;
+
+  it = std::upper_bound(_timecodeIndex.begin(), _timecodeIndex.end(),
+                        std::make_pair(timecode, 0xFFFFFFFF));
+  if (it == _timecodeIndex.begin()) {
+    return false;
+  }
+
+  *index = (--it)->second;
+  return true;
+}
+
+bool MetadataStream::findSegmentByOffset(uint64_t offset, uint32_t *index) {
+  std::vector<uint64_t>::const_iterator it;
 
+  if (offset >= _offsets.back()) {
+    return false;
+  }
+
+  it = std::upper_bound(_offsets.begin(), _offsets.end(), offset);
+  *index = static_cast<uint32_t>(it - _offsets.begin()) - 1;
+  return true;
+}
+
+uint64_t MetadataStream::getSegmentOffset(uint32_t index) {
+  if (index >= _offsets.size()) {
+    return _offsets.back();
+  }
+  return _offsets[index];
+}
+
+void MetadataStream::_buildIndex() {
+  uint64_t offset = 0;
+
+  _timecodeIndex.resize(_mediaSegments.size());
+  _offsets.resize(_mediaSegments.size() + 1);
+  for (size_t i = 0; i < _mediaSegments.size(); ++i) {
+    _timecodeIndex[i].first = _mediaSegments[i]->getTimecode();
+    _timecodeIndex[i].second = static_cast<uint32_t>(i);
+    _offsets[i] = offset;
+    offset += _mediaSegments[i]->getLength();
+  }
+  _offsets[_mediaSegments.size()] = offset;
+
+  // Segments are normally stored in timecode order already.
+  std::stable_sort(_timecodeIndex.begin(), _timecodeIndex.end());
+}
+
+bool MetadataStream::serializeHeader(DataStreamInterface *dataStream,
+                                     uint32_t mediaSegmentCount) {
+  if (dataStream->write(_type) == -1 ||
+      dataStream->write(getMimeType()) == -1 ||
+      dataStream->write(_bandwidth) == -1 ||
+      dataStream->write(_width) == -1 ||
+      dataStream->write(_height) == -1 ||
+      dataStream->write(_numChannels) == -1 ||
+      dataStream->write(_samplingFrequency) == -1 ||
+      dataStream->write(_chunkSize) == -1 ||
+      dataStream->write(_initSegmentLength) == -1) {
+    return false;
+  }
+
+  if (_initSegmentLength &&
+      dataStream->write(reinterpret_cast<const char *>(_initSegment),
+                        _initSegmentLength) == -1) {
+    return false;
+  }
+
+  return dataStream->write(mediaSegmentCount) != -1;
+}
+
+uint64_t MetadataStream::getSerializedSize() {
+  uint64_t size = sizeof(_type) + getMimeType().size() + 1 +
+    sizeof(_bandwidth) + sizeof(_width) + sizeof(_height) +
+    sizeof(_numChannels) + sizeof(_samplingFrequency) + sizeof(_chunkSize) +
+    sizeof(_initSegmentLength) + _initSegmentLength + sizeof(uint32_t);
+
+  for (size_t i = 0; i < _mediaSegments.size(); ++i) {
+    size += _mediaSegments[i]->getSerializedSize(_chunkSize);
+  }
+  return size;
+}
+
+uint64_t MetadataStream::getMemoryUsage() {
+  uint64_t size = sizeof(*this) + _mimeType.capacity() +
+    _mediaSegments.capacity() * sizeof(MetadataMediaSegmentInterface *) +
+    _timecodeIndex.capacity() * sizeof(_timecodeIndex[0]) +
+    _offsets.capacity() * sizeof(uint64_t);
+
+  if (_ownsInitSegment) {
+    size += _initSegmentLength;
+  }
+
+  for (size_t i = 0; i < _mediaSegments.size(); ++i) {
+    size += _mediaSegments[i]->getMemoryUsage();
+  }
+  return size;
+}
+
+void MetadataStream::compact(MetadataArena *arena) {
+  uint8_t *initSegment = arena->allocate(_initSegmentLength);
+
+  if (_initSegmentLength) {
+    memcpy(initSegment, _initSegment, _initSegmentLength);
+  }
+  _releaseInitSegment();
+  _initSegment = initSegment;
+  _ownsInitSegment = false;
+
+  _internedMimeType = arena->intern(getMimeType());
+  std::string().swap(_mimeType);
+
+  for (size_t i = 0; i < _mediaSegments.size(); ++i) {
+    _mediaSegments[i]->compact(arena);
+  }
+
+  std::vector<MetadataMediaSegmentInterface *>(_mediaSegments)
+    .swap(_mediaSegments);
+  std::vector<std::pair<uint32_t, uint32_t> >(_timecodeIndex)
+    .swap(_timecodeIndex);
+  std::vector<uint64_t>(_offsets).swap(_offsets);
+}
+
+bool MetadataStream::serialize(DataStreamInterface *dataStream) {
+  if (!serializeHeader(dataStream,
+                       static_cast<uint32_t>(_mediaSegments.size()))) {
+    return false;
+  }
+
+  for (size_t i = 0; i < _mediaSegments.size(); ++i) {
+    if (!_mediaSegments[i]->serialize(dataStream, _chunkSize)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool MetadataStream::unserializeHeader(DataStreamInterface *dataStream,
+                                       uint32_t *mediaSegmentCount) {
+  this->_internedMimeType = NULL;
   if (dataStream->read(&this->_type) == -1 ||
       dataStream->read(&this->_mimeType) == -1 ||
       dataStream->read(&this->_bandwidth) == -1 ||
@@ -92,32 +287,86 @@ bool MetadataStream::unserialize(DataStreamInterface *dataStream,
     return false;
   }
 
+  if (this->_initSegmentLength >
+      dataStream->length() - dataStream->tell()) {
+    return false;
+  }
+
+  this->_releaseInitSegment();
   this->_initSegment = new uint8_t[this->_initSegmentLength];
   if (dataStream->read(reinterpret_cast<char *>(this->_initSegment),
                        this->_initSegmentLength) == -1) {
     return false;
   }
 
-  hash->update(this->_initSegment, this->_initSegmentLength);
+  if (dataStream->read(mediaSegmentCount) == -1) {
+    return false;
+  }
+
+  PEERACLE_LOG(Verbose) << "type = " << this->_type << " mimeType = " <<
+    this->_mimeType << " bandwidth = " << this->_bandwidth << " width = " <<
+    this->_width << " height = " << this->_height << " numChannels = " <<
+    this->_numChannels << " samplingFrequency = " << this->_samplingFrequency <<
+    " chunksize = " << this->_chunkSize << " initSegmentLength = " <<
+    this->_initSegmentLength;
+  return true;
+}
+
+bool MetadataStream::unserialize(DataStreamInterface *dataStream,
+                                 const std::string &hashName,
+                                 HashInterface *hash) {
+  uint32_t mediaSegmentCount;
+  MetadataMediaSegmentInterface *mediaSegment;
+
+  if (!unserializeHeader(dataStream, &mediaSegmentCount)) {
+    return false;
+  }
+
+  if (hash) {
+    hash->update(this->_initSegment, this->_initSegmentLength);
+  }
+
+  for (size_t i = 0; i < mediaSegmentCount; ++i) {
+    mediaSegment = new MetadataMediaSegment();
+    if (!mediaSegment->unserialize(dataStream, hashName, _chunkSize,
+                                    hash)) {
+      delete mediaSegment;
+      return false;
+    }
+    _mediaSegments.push_back(mediaSegment);
+  }
+
+  _buildIndex();
+  return true;
+}
+
+bool MetadataStream::unserializeIndex(DataStreamInterface *dataStream,
+                                      const std::string &hashName) {
+  uint32_t mediaSegmentCount;
+  MetadataMediaSegment *mediaSegment;
+
+  if (!unserializeHeader(dataStream, &mediaSegmentCount)) {
+    return false;
+  }
 
-  if (dataStream->read(&mediaSegmentCount) == -1) {
+  // Every segment takes at least its timecode, length and chunk count, so
+  // a corrupted count is rejected before anything is reserved for it.
+  if (mediaSegmentCount > (dataStream->length() - dataStream->tell()) /
+      (3 * sizeof(uint32_t))) {
     return false;
   }
 
+  _mediaSegments.reserve(mediaSegmentCount);
   for (size_t i = 0; i < mediaSegmentCount; ++i) {
     mediaSegment = new MetadataMediaSegment();
-    if (!mediaSegment->unserialize(dataStream, hashName, hash)) {
+    if (!mediaSegment->unserializeIndex(dataStream, hashName, _chunkSize)) {
+      delete mediaSegment;
       return false;
     }
     _mediaSegments.push_back(mediaSegment);
   }
 
-  std::cout << "type = " << this->_type << " mimeType = " << this->_mimeType
-  << " bandwidth = " << this->_bandwidth << " width = " << this->_width
-  << " height = " << this->_height << " numChannels = " << this->_numChannels
-  << " samplingFrequency = " << this->_samplingFrequency << " chunksize = "
-  << this->_chunkSize << " initSegmentLength = " << this->_initSegmentLength
-  << std::endl;
+  _buildIndex();
   return true;
 }
 
@@ -24,6 +24,7 @@
 #define PEERACLE_METADATA_METADATASTREAM_H_
 
 #include <string>
+#include <utility>
 #include <vector>
 #include "peeracle/Hash/HashInterface.h"
 #include "peeracle/Metadata/MetadataStreamInterface.h"
@@ -34,6 +35,8 @@ class MetadataStream
   : public MetadataStreamInterface {
  public:
   MetadataStream();
+  explicit MetadataStream(const MetadataStreamInit &init);
+  ~MetadataStream();
 
   uint8_t getType();
   const std::string &getMimeType();
@@ -46,13 +49,52 @@ class MetadataStream
   uint8_t *getInitSegment();
   uint32_t getInitSegmentLength();
   std::vector<MetadataMediaSegmentInterface *> &getMediaSegments();
+  bool findSegmentByTimecode(uint32_t timecode, uint32_t *index);
+  bool findSegmentByOffset(uint64_t offset, uint32_t *index);
+  uint64_t getSegmentOffset(uint32_t index);
 
+  void setInitSegment(const uint8_t *buffer, uint32_t length);
+  void addMediaSegment(MetadataMediaSegmentInterface *segment);
+
+  /**
+   * Write the stream description and its initialization segment, followed
+   * by \p mediaSegmentCount. The caller is expected to write that many
+   * media segments next, which lets a stream be written without keeping
+   * all of its media segments in memory.
+   */
+  bool serializeHeader(DataStreamInterface *dataStream,
+                       uint32_t mediaSegmentCount);
+
+  uint64_t getSerializedSize();
+  uint64_t getMemoryUsage();
+  void compact(MetadataArena *arena);
+  bool serialize(DataStreamInterface *dataStream);
   bool unserialize(DataStreamInterface *dataStream,
                    const std::string &hashName, HashInterface *hash);
 
+  /**
+   * Read the stream description and its initialization segment, and
+   * return the number of media segments that follow in
+   * \p mediaSegmentCount. The counterpart of serializeHeader().
+   */
+  bool unserializeHeader(DataStreamInterface *dataStream,
+                         uint32_t *mediaSegmentCount);
+
+  /**
+   * Like unserialize(), but only index the media segments: their chunk
+   * hashes are read from \p dataStream when first accessed, so
+   * \p dataStream must outlive this stream and keep its content.
+   */
+  bool unserializeIndex(DataStreamInterface *dataStream,
+                        const std::string &hashName);
+
  private:
+  void _buildIndex();
+  void _releaseInitSegment();
+
   uint8_t _type;
   std::string _mimeType;
+  const std::string *_internedMimeType;
   uint32_t _bandwidth;
   int32_t _width;
   int32_t _height;
@@ -61,7 +103,14 @@ class MetadataStream
   uint32_t _chunkSize;
   uint8_t *_initSegment;
   uint32_t _initSegmentLength;
+  bool _ownsInitSegment;
   std::vector<MetadataMediaSegmentInterface *> _mediaSegments;
+
+  // (timecode, segment index) pairs sorted by timecode, and the offset of
+  // every segment followed by the total length. Kept up to date as
+  // segments are added, so that lookups only read them.
+  std::vector<std::pair<uint32_t, uint32_t> > _timecodeIndex;
+  std::vector<uint64_t> _offsets;
 };
 
 }  // namespace peeracle
@@ -34,6 +34,28 @@
 
 namespace peeracle {
 
+struct MetadataStreamInit {
+  MetadataStreamInit()
+    : type(0),
+      mimeType(""),
+      bandwidth(0),
+      width(0),
+      height(0),
+      numChannels(0),
+      samplingFrequency(0),
+      chunkSize(0) {
+  }
+
+  uint8_t type;
+  std::string mimeType;
+  uint32_t bandwidth;
+  int32_t width;
+  int32_t height;
+  int32_t numChannels;
+  int32_t samplingFrequency;
+  uint32_t chunkSize;
+};
+
 class MetadataStreamInterface {
  public:
   virtual uint8_t getType() = 0;
@@ -48,6 +70,56 @@ class MetadataStreamInterface {
   virtual uint32_t getInitSegmentLength() = 0;
   virtual std::vector<MetadataMediaSegmentInterface *> &getMediaSegments() = 0;
 
+  /**
+   * Find the media segment playing at \p timecode, that is the segment with
+   * the greatest timecode lower or equal to \p timecode, in O(log n).
+   * @param timecode a timecode in the metadata timecode scale.
+   * @param index receives the index of the segment in getMediaSegments().
+   * \return false if \p timecode is before the first segment.
+   */
+  virtual bool findSegmentByTimecode(uint32_t timecode, uint32_t *index) = 0;
+
+  /**
+   * Find the media segment holding the byte at \p offset, counted from the
+   * start of the first media segment, in O(log n).
+   * \return false if \p offset is past the last segment.
+   */
+  virtual bool findSegmentByOffset(uint64_t offset, uint32_t *index) = 0;
+
+  /**
+   * Get the offset of the media segment at \p index, counted from the start
+   * of the first media segment. An \p index equal to the number of segments
+   * gives the total length of the media segments.
+   */
+  virtual uint64_t getSegmentOffset(uint32_t index) = 0;
+
+  virtual void setInitSegment(const uint8_t *buffer, uint32_t length) = 0;
+
+  /**
+   * Append \p segment and index it, in O(1) when its timecode is not before
+   * the last one. Its timecode and length must be set beforehand.
+   */
+  virtual void addMediaSegment(MetadataMediaSegmentInterface *segment) = 0;
+
+  /**
+   * Get the number of bytes serialize() writes.
+   */
+  virtual uint64_t getSerializedSize() = 0;
+
+  /**
+   * Get the number of bytes held by this stream and its media segments,
+   * leaving out what compact() moved to an arena.
+   */
+  virtual uint64_t getMemoryUsage() = 0;
+
+  /**
+   * Move the init segment and the chunk hashes to \p arena, share the
+   * mime type with the other streams using it and release the spare
+   * capacity.
+   */
+  virtual void compact(MetadataArena *arena) = 0;
+
+  virtual bool serialize(DataStreamInterface *dataStream) = 0;
   virtual bool unserialize(DataStreamInterface *dataStream,
                            const std::string &hashName,
                            HashInterface *hash) = 0;
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Metadata/MetadataStream.h"
+#include "test/benchmark.h"
+
+namespace peeracle {
+
+static const int64_t kMinNanos = 200000000;
+static const uint32_t kSegmentDuration = 2000;
+static const size_t kQueryCount = 1024;
+
+class LookupCase : public Benchmark::Case {
+ public:
+  LookupCase(MetadataStream *stream, const std::vector<uint64_t> &queries)
+    : _stream(stream), _queries(queries), _found(0) {
+  }
+
+ protected:
+  MetadataStream *_stream;
+  const std::vector<uint64_t> &_queries;
+  uint64_t _found;
+};
+
+class LinearTimecodeCase : public LookupCase {
+ public:
+  LinearTimecodeCase(MetadataStream *stream,
+                     const std::vector<uint64_t> &queries)
+    : LookupCase(stream, queries) {
+  }
+
+  void run() {
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      _stream->getMediaSegments();
+
+    for (size_t q = 0; q < _queries.size(); ++q) {
+      size_t i = 0;
+
+      while (i + 1 < segments.size() &&
+             segments[i + 1]->getTimecode() <= _queries[q]) {
+        ++i;
+      }
+      _found += i;
+    }
+  }
+};
+
+class IndexedTimecodeCase : public LookupCase {
+ public:
+  IndexedTimecodeCase(MetadataStream *stream,
+                      const std::vector<uint64_t> &queries)
+    : LookupCase(stream, queries) {
+  }
+
+  void run() {
+    uint32_t index;
+
+    for (size_t q = 0; q < _queries.size(); ++q) {
+      if (_stream->findSegmentByTimecode(static_cast<uint32_t>(_queries[q]),
+                                         &index)) {
+        _found += index;
+      }
+    }
+  }
+};
+
+class LinearOffsetCase : public LookupCase {
+ public:
+  LinearOffsetCase(MetadataStream *stream,
+                   const std::vector<uint64_t> &queries)
+    : LookupCase(stream, queries) {
+  }
+
+  void run() {
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      _stream->getMediaSegments();
+
+    for (size_t q = 0; q < _queries.size(); ++q) {
+      uint64_t offset = 0;
+      size_t i = 0;
+
+      while (i < segments.size() &&
+             offset + segments[i]->getLength() <= _queries[q]) {
+        offset += segments[i++]->getLength();
+      }
+      _found += i;
+    }
+  }
+};
+
+class IndexedOffsetCase : public LookupCase {
+ public:
+  IndexedOffsetCase(MetadataStream *stream,
+                    const std::vector<uint64_t> &queries)
+    : LookupCase(stream, queries) {
+  }
+
+  void run() {
+    uint32_t index;
+
+    for (size_t q = 0; q < _queries.size(); ++q) {
+      if (_stream->findSegmentByOffset(_queries[q], &index)) {
+        _found += index;
+      }
+    }
+  }
+};
+
+class AppendCase : public Benchmark::Case {
+ public:
+  explicit AppendCase(MetadataStream *stream) : _stream(stream) {
+  }
+
+  void run() {
+    MetadataMediaSegment *segment = new MetadataMediaSegment();
+    uint32_t index;
+
+    // A live append, in timecode order, followed by a lookup.
+    segment->setTimecode(0xFFFFFFFF);
+    _stream->addMediaSegment(segment);
+    _stream->findSegmentByTimecode(0, &index);
+  }
+
+ private:
+  MetadataStream *_stream;
+};
+
+static std::string perLookup(Benchmark::Case *benchmarkCase) {
+  return Benchmark::formatTime(Benchmark::measure(benchmarkCase, kMinNanos) /
+                               kQueryCount);
+}
+
+static int run(uint32_t segmentCount) {
+  MetadataStream stream;
+  std::vector<uint64_t> timecodes(kQueryCount);
+  std::vector<uint64_t> offsets(kQueryCount);
+  uint32_t state = 0x5052434C;
+  BenchmarkTable table("Segment lookup in a stream of " +
+                       Benchmark::formatCount(segmentCount) + " segments");
+
+  for (uint32_t i = 0; i < segmentCount; ++i) {
+    MetadataMediaSegment *segment = new MetadataMediaSegment();
+
+    state = state * 1664525 + 1013904223;
+    segment->setTimecode(i * kSegmentDuration);
+    segment->setLength(400000 + (state >> 12));
+    stream.addMediaSegment(segment);
+  }
+
+  uint64_t duration = static_cast<uint64_t>(segmentCount) * kSegmentDuration;
+  uint64_t length = stream.getSegmentOffset(segmentCount);
+  for (size_t q = 0; q < kQueryCount; ++q) {
+    state = state * 1664525 + 1013904223;
+    timecodes[q] = static_cast<uint64_t>(duration * (state / 4294967296.0));
+    state = state * 1664525 + 1013904223;
+    offsets[q] = static_cast<uint64_t>(length * (state / 4294967296.0));
+  }
+
+  LinearTimecodeCase linearTimecode(&stream, timecodes);
+  IndexedTimecodeCase indexedTimecode(&stream, timecodes);
+  LinearOffsetCase linearOffset(&stream, offsets);
+  IndexedOffsetCase indexedOffset(&stream, offsets);
+
+  table.addColumn("lookup");
+  table.addColumn("linear scan");
+  table.addColumn("index");
+  table.addRow();
+  table.addCell("by timecode");
+  table.addCell(perLookup(&linearTimecode));
+  table.addCell(perLookup(&indexedTimecode));
+  table.addRow();
+  table.addCell("by byte offset");
+  table.addCell(perLookup(&linearOffset));
+  table.addCell(perLookup(&indexedOffset));
+  table.print(&std::cout);
+
+  AppendCase append(&stream);
+  std::cout << "append and lookup: "
+            << Benchmark::formatTime(Benchmark::measure(&append, kMinNanos))
+            << std::endl;
+  return EXIT_SUCCESS;
+}
+
+}  // namespace peeracle
+
+int main(int argc, char **argv) {
+  uint32_t segmentCount = 100000;
+
+  if (argc > 1) {
+    segmentCount = static_cast<uint32_t>(strtoul(argv[1], NULL, 10));
+  }
+
+  if (!segmentCount) {
+    std::cerr << "usage: " << argv[0] << " [segment count]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return peeracle::run(segmentCount);
+}
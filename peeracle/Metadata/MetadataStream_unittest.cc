@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Metadata/MetadataSegmentIterator.h"
+#include "peeracle/Metadata/MetadataStream.h"
+
+namespace peeracle {
+
+class MetadataStreamTest : public testing::Test {
+ protected:
+  void addSegment(uint32_t timecode, uint32_t length) {
+    MetadataMediaSegment *segment = new MetadataMediaSegment();
+
+    segment->setTimecode(timecode);
+    segment->setLength(length);
+    _stream.addMediaSegment(segment);
+  }
+
+  MetadataStream _stream;
+};
+
+TEST_F(MetadataStreamTest, CorruptedCounts) {
+  DataStreamInit dsInit;
+  MemoryDataStream ds(dsInit);
+
+  ds.write(static_cast<uint8_t>(1));
+  ds.write(std::string("video/webm"));
+  for (int i = 0; i < 6; ++i) {
+    ds.write(static_cast<uint32_t>(0));
+  }
+
+  // Neither the init segment nor the segment index is allocated from a
+  // length the stream can not hold.
+  ds.write(static_cast<uint32_t>(0xFFFFFFF0));
+  ASSERT_EQ(0, ds.seek(0));
+  EXPECT_FALSE(_stream.unserializeIndex(&ds, "murmur3_x86_128"));
+
+  ASSERT_EQ(36, ds.seek(36));
+  ds.write(static_cast<uint32_t>(0));
+  ds.write(static_cast<uint32_t>(0xFFFFFFF0));
+  ASSERT_EQ(0, ds.seek(0));
+  EXPECT_FALSE(_stream.unserializeIndex(&ds, "murmur3_x86_128"));
+  EXPECT_EQ(0, _stream.getMediaSegments().size());
+}
+
+TEST_F(MetadataStreamTest, FindSegmentByTimecode) {
+  uint32_t index = 42;
+
+  EXPECT_FALSE(_stream.findSegmentByTimecode(0, &index));
+  for (uint32_t i = 0; i < 100; ++i) {
+    addSegment(1000 + i * 2000, 100);
+  }
+
+  EXPECT_FALSE(_stream.findSegmentByTimecode(999, &index));
+  EXPECT_EQ(42, index);
+  ASSERT_TRUE(_stream.findSegmentByTimecode(1000, &index));
+  EXPECT_EQ(0, index);
+  ASSERT_TRUE(_stream.findSegmentByTimecode(2999, &index));
+  EXPECT_EQ(0, index);
+  ASSERT_TRUE(_stream.findSegmentByTimecode(3000, &index));
+  EXPECT_EQ(1, index);
+  ASSERT_TRUE(_stream.findSegmentByTimecode(0xFFFFFFFF, &index));
+  EXPECT_EQ(99, index);
+
+  // Segments added out of order are still found.
+  addSegment(500, 100);
+  ASSERT_TRUE(_stream.findSegmentByTimecode(999, &index));
+  EXPECT_EQ(100, index);
+  ASSERT_TRUE(_stream.findSegmentByTimecode(1000, &index));
+  EXPECT_EQ(0, index);
+}
+
+TEST_F(MetadataStreamTest, FindSegmentByOffset) {
+  uint32_t index = 42;
+
+  EXPECT_FALSE(_stream.findSegmentByOffset(0, &index));
+  EXPECT_EQ(0, _stream.getSegmentOffset(0));
+
+  addSegment(0, 100);
+  addSegment(2000, 0);
+  addSegment(4000, 50);
+  addSegment(6000, 25);
+
+  ASSERT_TRUE(_stream.findSegmentByOffset(0, &index));
+  EXPECT_EQ(0, index);
+  ASSERT_TRUE(_stream.findSegmentByOffset(99, &index));
+  EXPECT_EQ(0, index);
+  ASSERT_TRUE(_stream.findSegmentByOffset(100, &index));
+  EXPECT_EQ(2, index);
+  ASSERT_TRUE(_stream.findSegmentByOffset(174, &index));
+  EXPECT_EQ(3, index);
+  EXPECT_FALSE(_stream.findSegmentByOffset(175, &index));
+
+  EXPECT_EQ(0, _stream.getSegmentOffset(0));
+  EXPECT_EQ(100, _stream.getSegmentOffset(1));
+  EXPECT_EQ(100, _stream.getSegmentOffset(2));
+  EXPECT_EQ(150, _stream.getSegmentOffset(3));
+  EXPECT_EQ(175, _stream.getSegmentOffset(4));
+
+  // Segments added after a lookup, in order or not, are indexed too.
+  addSegment(8000, 10);
+  EXPECT_EQ(185, _stream.getSegmentOffset(5));
+  ASSERT_TRUE(_stream.findSegmentByOffset(180, &index));
+  EXPECT_EQ(4, index);
+  addSegment(1000, 5);
+  EXPECT_EQ(190, _stream.getSegmentOffset(6));
+  ASSERT_TRUE(_stream.findSegmentByOffset(187, &index));
+  EXPECT_EQ(5, index);
+  ASSERT_TRUE(_stream.findSegmentByTimecode(1999, &index));
+  EXPECT_EQ(5, index);
+  ASSERT_TRUE(_stream.findSegmentByTimecode(9000, &index));
+  EXPECT_EQ(4, index);
+}
+
+TEST_F(MetadataStreamTest, SegmentIterator) {
+  for (uint32_t i = 0; i < 10; ++i) {
+    addSegment(i * 2000, 100);
+  }
+
+  MetadataSegmentIterator it(&_stream, 7500);
+  for (uint32_t i = 3; i < 10; ++i) {
+    ASSERT_TRUE(it.hasNext());
+    EXPECT_EQ(i, it.getIndex());
+    EXPECT_EQ(_stream.getMediaSegments()[i], it.next());
+  }
+  EXPECT_FALSE(it.hasNext());
+  EXPECT_TRUE(it.next() == NULL);
+
+  MetadataSegmentIterator first(&_stream, 0);
+  EXPECT_EQ(0, first.getIndex());
+}
+
+}  // namespace peeracle
@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "peeracle/Hash/Hex.h"
+#include "peeracle/Metadata/MetadataV3Writer.h"
+#include "peeracle/Metadata/MetadataView.h"
+
+namespace peeracle {
+
+static void store32(uint8_t *p, uint32_t value) {
+  p[0] = static_cast<uint8_t>(value >> 24);
+  p[1] = static_cast<uint8_t>(value >> 16);
+  p[2] = static_cast<uint8_t>(value >> 8);
+  p[3] = static_cast<uint8_t>(value);
+}
+
+static void storeDouble(uint8_t *p, double value) {
+  uint64_t bits;
+
+  memcpy(&bits, &value, sizeof(bits));
+  store32(p, static_cast<uint32_t>(bits >> 32));
+  store32(p + 4, static_cast<uint32_t>(bits));
+}
+
+static uint64_t align(uint64_t offset) {
+  return (offset + MetadataView::kAlignment - 1) &
+    ~static_cast<uint64_t>(MetadataView::kAlignment - 1);
+}
+
+// The sections in file order, the chunk table last so that it can grow.
+static const uint32_t kSectionOrder[MetadataView::kSectionCount] = {
+  MetadataView::kStrings, MetadataView::kTrackers, MetadataView::kStreams,
+  MetadataView::kSegments, MetadataView::kInitSegments, MetadataView::kChunks
+};
+
+MetadataV3Writer::MetadataV3Writer(MetadataInterface *metadata) :
+  _metadata(metadata), _hashAlgorithm(0), _out(NULL), _start(0),
+  _chunkCount(0) {
+  memset(_counts, 0, sizeof(_counts));
+  memset(_lengths, 0, sizeof(_lengths));
+  memset(_offsets, 0, sizeof(_offsets));
+}
+
+uint32_t MetadataV3Writer::_addString(const std::string &value) {
+  uint32_t offset = static_cast<uint32_t>(_strings.size());
+
+  _strings.append(value.c_str(), strlen(value.c_str()) + 1);
+  return offset;
+}
+
+uint64_t MetadataV3Writer::getSize() {
+  std::vector<MetadataStreamInterface *> &streams = _metadata->getStreams();
+  std::vector<uint32_t> segmentCounts;
+  uint64_t chunkCount = 0;
+
+  for (size_t s = 0; s < streams.size(); ++s) {
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      streams[s]->getMediaSegments();
+
+    segmentCounts.push_back(static_cast<uint32_t>(segments.size()));
+    for (size_t i = 0; i < segments.size(); ++i) {
+      chunkCount += segments[i]->getChunkCount();
+    }
+  }
+
+  return _layout(streams, segmentCounts, chunkCount);
+}
+
+uint64_t MetadataV3Writer::_layout(
+    const std::vector<MetadataStreamInterface *> &streams,
+    const std::vector<uint32_t> &segmentCounts, uint64_t chunkCount) {
+  std::vector<std::string> &trackers = _metadata->getTrackerUrls();
+  uint64_t offset;
+
+  memset(_counts, 0, sizeof(_counts));
+  memset(_lengths, 0, sizeof(_lengths));
+  _strings.clear();
+  _trackerUrls.clear();
+  _mimeTypes.clear();
+
+  _hashAlgorithm = _addString(_metadata->getHashAlgorithm());
+  for (size_t i = 0; i < trackers.size(); ++i) {
+    _trackerUrls.push_back(_addString(trackers[i]));
+  }
+
+  for (size_t s = 0; s < streams.size(); ++s) {
+    _mimeTypes.push_back(_addString(streams[s]->getMimeType()));
+    _counts[MetadataView::kSegments] += segmentCounts[s];
+    _lengths[MetadataView::kInitSegments] +=
+      streams[s]->getInitSegmentLength();
+  }
+
+  _counts[MetadataView::kStrings] = _strings.size();
+  _counts[MetadataView::kTrackers] = trackers.size();
+  _counts[MetadataView::kStreams] = streams.size();
+  _counts[MetadataView::kChunks] = chunkCount;
+  _counts[MetadataView::kInitSegments] =
+    _lengths[MetadataView::kInitSegments];
+  _lengths[MetadataView::kStrings] = _strings.size();
+  _lengths[MetadataView::kTrackers] = _counts[MetadataView::kTrackers] * 4;
+  _lengths[MetadataView::kStreams] =
+    _counts[MetadataView::kStreams] * MetadataView::kStreamSize;
+  _lengths[MetadataView::kSegments] =
+    _counts[MetadataView::kSegments] * MetadataView::kSegmentSize;
+  _lengths[MetadataView::kChunks] = chunkCount * MetadataView::kChunkSize;
+
+  offset = MetadataView::kHeaderSize +
+    MetadataView::kSectionCount * MetadataView::kSectionSize;
+  for (uint32_t i = 0; i < MetadataView::kSectionCount; ++i) {
+    _offsets[kSectionOrder[i]] = align(offset);
+    offset = _offsets[kSectionOrder[i]] + _lengths[kSectionOrder[i]];
+  }
+  return offset;
+}
+
+// Write the header, the directory and every table but the segment records,
+// the init segments and the chunks to the start of the file at p.
+void MetadataV3Writer::_writeIndex(
+    uint8_t *p, const std::vector<MetadataStreamInterface *> &streams,
+    const std::vector<uint32_t> &segmentCounts) {
+  uint32_t initOffset = 0;
+  uint32_t segmentIndex = 0;
+
+  store32(p, MetadataView::kMagic);
+  store32(p + 4, MetadataView::kVersion);
+  store32(p + 8, _metadata->isLive() ? MetadataView::kLive : 0);
+  store32(p + 12, _metadata->getTimecodeScale());
+  storeDouble(p + 16, _metadata->getDuration());
+  store32(p + 40, _hashAlgorithm);
+  store32(p + 44, static_cast<uint32_t>(streams.size()));
+  store32(p + 48, static_cast<uint32_t>(_trackerUrls.size()));
+  store32(p + 52, MetadataView::kSectionCount);
+
+  for (uint32_t i = 0; i < MetadataView::kSectionCount; ++i) {
+    uint8_t *entry = p + MetadataView::kHeaderSize +
+      i * MetadataView::kSectionSize;
+    uint32_t type = kSectionOrder[i];
+
+    store32(entry, type);
+    store32(entry + 4, static_cast<uint32_t>(_counts[type]));
+    store32(entry + 8, static_cast<uint32_t>(_offsets[type]));
+    store32(entry + 12, static_cast<uint32_t>(_lengths[type]));
+  }
+
+  memcpy(p + _offsets[MetadataView::kStrings], _strings.data(),
+         _strings.size());
+
+  for (size_t i = 0; i < _trackerUrls.size(); ++i) {
+    store32(p + _offsets[MetadataView::kTrackers] + i * 4, _trackerUrls[i]);
+  }
+
+  for (size_t s = 0; s < streams.size(); ++s) {
+    MetadataStreamInterface *stream = streams[s];
+    uint8_t *record = p + _offsets[MetadataView::kStreams] +
+      s * MetadataView::kStreamSize;
+
+    record[0] = stream->getType();
+    store32(record + 4, _mimeTypes[s]);
+    store32(record + 8, stream->getBandwidth());
+    store32(record + 12, static_cast<uint32_t>(stream->getWidth()));
+    store32(record + 16, static_cast<uint32_t>(stream->getHeight()));
+    store32(record + 20, static_cast<uint32_t>(stream->getNumChannels()));
+    store32(record + 24,
+            static_cast<uint32_t>(stream->getSamplingFrequency()));
+    store32(record + 28, stream->getChunkSize());
+    store32(record + 32, initOffset);
+    store32(record + 36, stream->getInitSegmentLength());
+    store32(record + 40, segmentIndex);
+    store32(record + 44, segmentCounts[s]);
+
+    initOffset += stream->getInitSegmentLength();
+    segmentIndex += segmentCounts[s];
+  }
+}
+
+bool MetadataV3Writer::write(DataStreamInterface *out) {
+  std::vector<MetadataStreamInterface *> &streams = _metadata->getStreams();
+  std::vector<uint8_t> buffer;
+  uint8_t id[MetadataView::kDigestSize];
+  uint64_t size;
+
+  if (_metadata->getHashAlgorithm() != "murmur3_x86_128" ||
+      !Hex::decode(_metadata->getId(), id, sizeof(id))) {
+    return false;
+  }
+
+  size = getSize();
+  if (size > 0xFFFFFFFF) {
+    return false;
+  }
+
+  std::vector<uint32_t> segmentCounts;
+  for (size_t s = 0; s < streams.size(); ++s) {
+    segmentCounts.push_back(
+      static_cast<uint32_t>(streams[s]->getMediaSegments().size()));
+  }
+
+  buffer.resize(static_cast<size_t>(size));
+  uint8_t *p = &buffer[0];
+
+  _writeIndex(p, streams, segmentCounts);
+  memcpy(p + 24, id, sizeof(id));
+
+  uint64_t initOffset = _offsets[MetadataView::kInitSegments];
+  uint32_t segmentIndex = 0;
+  uint32_t chunkIndex = 0;
+
+  for (size_t s = 0; s < streams.size(); ++s) {
+    MetadataStreamInterface *stream = streams[s];
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      stream->getMediaSegments();
+
+    if (stream->getInitSegmentLength()) {
+      memcpy(p + initOffset, stream->getInitSegment(),
+             stream->getInitSegmentLength());
+    }
+    initOffset += stream->getInitSegmentLength();
+
+    for (size_t i = 0; i < segments.size(); ++i) {
+      uint32_t chunkCount = segments[i]->getChunkCount();
+      const std::vector<uint8_t *> &chunks = segments[i]->getChunks();
+      const std::vector<uint32_t> &chunkLengths =
+        segments[i]->getChunkLengths();
+      uint8_t *segment = p + _offsets[MetadataView::kSegments] +
+        segmentIndex * MetadataView::kSegmentSize;
+
+      if (segments[i]->hasLoadError() || chunks.size() != chunkCount) {
+        return false;
+      }
+
+      store32(segment, segments[i]->getTimecode());
+      store32(segment + 4, segments[i]->getLength());
+      store32(segment + 8, chunkIndex);
+      store32(segment + 12, chunkCount);
+
+      for (size_t c = 0; c < chunks.size(); ++c) {
+        uint8_t *record = p + _offsets[MetadataView::kChunks] +
+          static_cast<uint64_t>(chunkIndex) * MetadataView::kChunkSize;
+
+        store32(record, chunkLengths[c]);
+        memcpy(record + 4, chunks[c], MetadataView::kDigestSize);
+        ++chunkIndex;
+      }
+      ++segmentIndex;
+    }
+  }
+
+  return out->write(reinterpret_cast<const char *>(p),
+                    static_cast<std::streamsize>(buffer.size())) ==
+    static_cast<std::streamsize>(buffer.size());
+}
+
+bool MetadataV3Writer::begin(
+    DataStreamInterface *out,
+    const std::vector<MetadataStreamInterface *> &streams,
+    const std::vector<uint32_t> &segmentCounts) {
+  std::vector<uint8_t> buffer;
+  uint64_t blank;
+
+  if (_metadata->getHashAlgorithm() != "murmur3_x86_128" ||
+      _layout(streams, segmentCounts, 0) > 0xFFFFFFFF) {
+    return false;
+  }
+
+  _out = out;
+  _start = out->tell();
+  _chunkCount = 0;
+  _segmentCounts = segmentCounts;
+  _firstSegments.clear();
+  for (size_t s = 0; s < segmentCounts.size(); ++s) {
+    _firstSegments.push_back(s ? _firstSegments[s - 1] +
+                             segmentCounts[s - 1] : 0);
+  }
+
+  // The header and the tables before the segment records are written at
+  // once, then the blank segment records, then the init segments.
+  buffer.resize(static_cast<size_t>(_offsets[MetadataView::kSegments]));
+  _writeIndex(&buffer[0], streams, segmentCounts);
+  if (_start == -1 ||
+      out->write(reinterpret_cast<const char *>(&buffer[0]),
+                 static_cast<std::streamsize>(buffer.size())) !=
+      static_cast<std::streamsize>(buffer.size())) {
+    return false;
+  }
+
+  blank = _offsets[MetadataView::kInitSegments] -
+    _offsets[MetadataView::kSegments];
+  buffer.assign(static_cast<size_t>(std::min<uint64_t>(blank, 65536)), 0);
+  while (blank) {
+    std::streamsize length = static_cast<std::streamsize>(
+      std::min<uint64_t>(blank, buffer.size()));
+
+    if (out->write(reinterpret_cast<const char *>(&buffer[0]), length) !=
+        length) {
+      return false;
+    }
+    blank -= length;
+  }
+
+  for (size_t s = 0; s < streams.size(); ++s) {
+    std::streamsize length = streams[s]->getInitSegmentLength();
+
+    if (length && out->write(reinterpret_cast<const char *>(
+          streams[s]->getInitSegment()), length) != length) {
+      return false;
+    }
+  }
+
+  blank = _offsets[MetadataView::kChunks] -
+    (_offsets[MetadataView::kInitSegments] +
+     _lengths[MetadataView::kInitSegments]);
+  buffer.assign(static_cast<size_t>(blank), 0);
+  return !blank || out->write(reinterpret_cast<const char *>(&buffer[0]),
+                              static_cast<std::streamsize>(blank)) ==
+    static_cast<std::streamsize>(blank);
+}
+
+bool MetadataV3Writer::writeSegment(uint32_t stream, uint32_t index,
+                                    uint32_t timecode, uint32_t length,
+                                    const uint8_t *digests,
+                                    const uint32_t *lengths,
+                                    uint32_t chunkCount) {
+  uint8_t record[MetadataView::kSegmentSize];
+  std::streamsize size = static_cast<std::streamsize>(chunkCount) *
+    MetadataView::kChunkSize;
+  std::streamsize end;
+
+  if (!_out || stream >= _segmentCounts.size() ||
+      index >= _segmentCounts[stream] ||
+      _offsets[MetadataView::kChunks] + (_chunkCount + chunkCount) *
+      MetadataView::kChunkSize > 0xFFFFFFFF) {
+    return false;
+  }
+
+  _records.resize(static_cast<size_t>(size));
+  for (uint32_t c = 0; c < chunkCount; ++c) {
+    uint8_t *chunk = &_records[c * MetadataView::kChunkSize];
+
+    store32(chunk, lengths[c]);
+    memcpy(chunk + 4, digests + c * MetadataView::kDigestSize,
+           MetadataView::kDigestSize);
+  }
+
+  store32(record, timecode);
+  store32(record + 4, length);
+  store32(record + 8, static_cast<uint32_t>(_chunkCount));
+  store32(record + 12, chunkCount);
+
+  // The data stream is kept at the end of the chunk table.
+  end = _out->tell() + size;
+  if ((size && _out->write(reinterpret_cast<const char *>(&_records[0]),
+                           size) != size) ||
+      _out->seek(_start + static_cast<std::streamsize>(
+        _offsets[MetadataView::kSegments] +
+        (_firstSegments[stream] + index) * MetadataView::kSegmentSize)) ==
+      -1 ||
+      _out->write(reinterpret_cast<const char *>(record), sizeof(record)) !=
+      static_cast<std::streamsize>(sizeof(record)) ||
+      _out->seek(end) != end) {
+    return false;
+  }
+
+  _chunkCount += chunkCount;
+  return true;
+}
+
+bool MetadataV3Writer::end(const uint8_t *id) {
+  std::streamsize end;
+
+  if (!_out) {
+    return false;
+  }
+
+  end = _out->tell();
+  _counts[MetadataView::kChunks] = _chunkCount;
+  _lengths[MetadataView::kChunks] = _chunkCount * MetadataView::kChunkSize;
+  return _writeDirectoryEntry(MetadataView::kChunks) &&
+    _out->seek(_start + 24) == _start + 24 &&
+    _out->write(reinterpret_cast<const char *>(id),
+                MetadataView::kDigestSize) == MetadataView::kDigestSize &&
+    _out->seek(end) == end;
+}
+
+bool MetadataV3Writer::_writeDirectoryEntry(uint32_t type) {
+  uint8_t entry[MetadataView::kSectionSize];
+  std::streamsize position;
+  uint32_t i = 0;
+
+  while (kSectionOrder[i] != type) {
+    ++i;
+  }
+
+  store32(entry, type);
+  store32(entry + 4, static_cast<uint32_t>(_counts[type]));
+  store32(entry + 8, static_cast<uint32_t>(_offsets[type]));
+  store32(entry + 12, static_cast<uint32_t>(_lengths[type]));
+  position = _start + MetadataView::kHeaderSize +
+    i * MetadataView::kSectionSize;
+  return _out->seek(position) == position &&
+    _out->write(reinterpret_cast<const char *>(entry), sizeof(entry)) ==
+    static_cast<std::streamsize>(sizeof(entry));
+}
+
+}  // namespace peeracle
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_METADATA_METADATAV3WRITER_H_
+#define PEERACLE_METADATA_METADATAV3WRITER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/DataStreamInterface.h"
+#include "peeracle/Metadata/MetadataInterface.h"
+#include "peeracle/Metadata/MetadataView.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Write a metadata in the version 3 layout described in MetadataView.
+ * write() lays the whole file out in a single buffer sized in advance,
+ * while begin(), writeSegment() and end() write it one media segment at a
+ * time, for a producer that does not hold every chunk hash at once.
+ * \addtogroup Metadata
+ */
+class MetadataV3Writer {
+ public:
+  explicit MetadataV3Writer(MetadataInterface *metadata);
+
+  /**
+   * Get the number of bytes write() writes.
+   */
+  uint64_t getSize();
+
+  /**
+   * Write the metadata to \p out, with the content id
+   * MetadataInterface::getId() gives.
+   * \return false if the hash algorithm is not supported, the id is not
+   * known, a table would not fit in 32 bits offsets, a chunk could not be
+   * read, or \p out failed.
+   */
+  bool write(DataStreamInterface *out);
+
+  /**
+   * Start writing to \p out the header fields of the metadata and
+   * \p streams, whose media segments are ignored: stream \p s gets
+   * \p segmentCounts[s] blank segment records, filled by writeSegment().
+   * \p out must be seekable, segment records and the header are written in
+   * place while the chunk table grows at the end of the file.
+   * \return false if the hash algorithm is not supported, a table would not
+   * fit in 32 bits offsets, or \p out failed.
+   */
+  bool begin(DataStreamInterface *out,
+             const std::vector<MetadataStreamInterface *> &streams,
+             const std::vector<uint32_t> &segmentCounts);
+
+  /**
+   * Write the media segment \p index of the stream \p stream, appending
+   * its \p chunkCount chunk hashes, kDigestSize bytes each at \p digests,
+   * and lengths to the chunk table.
+   */
+  bool writeSegment(uint32_t stream, uint32_t index, uint32_t timecode,
+                    uint32_t length, const uint8_t *digests,
+                    const uint32_t *lengths, uint32_t chunkCount);
+
+  /**
+   * Complete the file started by begin() with the content \p id,
+   * kDigestSize bytes long, leaving the data stream at its end.
+   */
+  bool end(const uint8_t *id);
+
+ private:
+  uint64_t _layout(const std::vector<MetadataStreamInterface *> &streams,
+                   const std::vector<uint32_t> &segmentCounts,
+                   uint64_t chunkCount);
+  void _writeIndex(uint8_t *p,
+                   const std::vector<MetadataStreamInterface *> &streams,
+                   const std::vector<uint32_t> &segmentCounts);
+  bool _writeDirectoryEntry(uint32_t type);
+  uint32_t _addString(const std::string &value);
+
+  MetadataInterface *_metadata;
+  std::string _strings;
+  uint32_t _hashAlgorithm;
+  std::vector<uint32_t> _trackerUrls;
+  std::vector<uint32_t> _mimeTypes;
+  uint64_t _counts[MetadataView::kSectionCount + 1];
+  uint64_t _lengths[MetadataView::kSectionCount + 1];
+  uint64_t _offsets[MetadataView::kSectionCount + 1];
+
+  DataStreamInterface *_out;
+  std::streamsize _start;
+  std::vector<uint32_t> _firstSegments;
+  std::vector<uint32_t> _segmentCounts;
+  uint64_t _chunkCount;
+  std::vector<uint8_t> _records;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_METADATA_METADATAV3WRITER_H_
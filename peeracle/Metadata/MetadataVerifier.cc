@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/MappedDataStream.h"
+#include "peeracle/Hash/Murmur3Hash.h"
+#include "peeracle/Metadata/MetadataVerifier.h"
+
+namespace peeracle {
+
+// The bytes hashed by a task, enough to make the posting overhead
+// negligible while keeping the threads busy until the end of a batch.
+static const uint64_t kTaskBytes = 4 * 1024 * 1024;
+
+// The number of tasks per thread posted between two progress reports.
+static const size_t kTasksPerBatch = 4;
+
+class MetadataVerifier::VerifyTask : public WorkerPoolInterface::Task {
+ public:
+  VerifyTask(const uint8_t *buffer, const std::vector<Chunk> *chunks,
+             std::vector<uint8_t> *results, size_t first, size_t count,
+             uint64_t bytes)
+    : _buffer(buffer), _chunks(chunks), _results(results), _first(first),
+      _count(count), _bytes(bytes) {
+  }
+
+  uint64_t getBytes() const {
+    return _bytes;
+  }
+
+  void run() {
+    uint8_t digest[16];
+
+    for (size_t i = _first; i < _first + _count; ++i) {
+      const Chunk &chunk = (*_chunks)[i];
+
+      Murmur3Hash::digest(_buffer + chunk.offset, chunk.length, digest);
+      (*_results)[i] = memcmp(digest, chunk.hash, sizeof(digest)) == 0;
+    }
+  }
+
+ private:
+  const uint8_t *_buffer;
+  const std::vector<Chunk> *_chunks;
+  std::vector<uint8_t> *_results;
+  size_t _first;
+  size_t _count;
+  uint64_t _bytes;
+};
+
+MetadataVerifier::MetadataVerifier(MetadataInterface *metadata,
+                                   WorkerPoolInterface *pool)
+  : _metadata(metadata), _pool(pool), _observer(NULL) {
+}
+
+void MetadataVerifier::setObserver(MetadataVerifierObserver *observer) {
+  _observer = observer;
+}
+
+bool MetadataVerifier::verify(uint32_t stream, const std::string &path,
+                              std::vector<Range> *mismatches) {
+  DataStreamInit dsInit;
+
+  dsInit.path = path;
+  MappedDataStream mapped(dsInit);
+  if (stream >= _metadata->getStreams().size() || !mapped.open()) {
+    return false;
+  }
+
+  return verify(stream, mapped.getBuffer(),
+                static_cast<uint64_t>(mapped.length()), mismatches);
+}
+
+bool MetadataVerifier::verify(uint32_t stream, const uint8_t *buffer,
+                              uint64_t length,
+                              std::vector<Range> *mismatches) {
+  std::vector<MetadataStreamInterface *> &streams = _metadata->getStreams();
+  std::vector<Chunk> chunks;
+  std::vector<uint8_t> results;
+  std::vector<VerifyTask> tasks;
+  uint64_t expected;
+  uint64_t total = 0;
+  uint64_t verified = 0;
+  size_t batchSize;
+
+  mismatches->clear();
+  if (stream >= streams.size()) {
+    return false;
+  }
+
+  MetadataStreamInterface *metadataStream = streams[stream];
+  std::vector<MetadataMediaSegmentInterface *> &segments =
+    metadataStream->getMediaSegments();
+  uint32_t initLength = metadataStream->getInitSegmentLength();
+
+  expected = initLength + metadataStream->getSegmentOffset(
+    static_cast<uint32_t>(segments.size()));
+  if (length < initLength || (initLength &&
+      memcmp(buffer, metadataStream->getInitSegment(), initLength))) {
+    _addMismatch(0, initLength, mismatches);
+  }
+
+  // List the chunks held by the buffer. Loading the hashes of lazily
+  // loaded segments reads the metadata stream, so it is done here rather
+  // than from the worker threads.
+  for (size_t s = 0; s < segments.size(); ++s) {
+    const std::vector<uint8_t *> &hashes = segments[s]->getChunks();
+    const std::vector<uint32_t> &lengths = segments[s]->getChunkLengths();
+    uint64_t offset = initLength +
+      metadataStream->getSegmentOffset(static_cast<uint32_t>(s));
+
+    if (segments[s]->hasLoadError()) {
+      return false;
+    }
+
+    for (size_t c = 0; c < hashes.size(); ++c) {
+      Chunk chunk;
+
+      chunk.offset = offset;
+      chunk.length = lengths[c];
+      chunk.hash = hashes[c];
+      offset += lengths[c];
+      if (chunk.offset + chunk.length <= length) {
+        chunks.push_back(chunk);
+        total += chunk.length;
+      }
+    }
+  }
+
+  results.resize(chunks.size());
+  for (size_t first = 0; first < chunks.size();) {
+    uint64_t bytes = 0;
+    size_t count = 0;
+
+    while (first + count < chunks.size() && bytes < kTaskBytes) {
+      bytes += chunks[first + count].length;
+      ++count;
+    }
+    tasks.push_back(VerifyTask(buffer, &chunks, &results, first, count,
+                               bytes));
+    first += count;
+  }
+
+  // Tasks are posted in batches, so that progress is reported from this
+  // thread between two of them.
+  batchSize = _pool->getThreadCount() * kTasksPerBatch;
+  for (size_t first = 0; first < tasks.size();) {
+    size_t last = first + (batchSize ? batchSize : 1);
+
+    if (last > tasks.size()) {
+      last = tasks.size();
+    }
+
+    for (size_t t = first; t < last; ++t) {
+      if (batchSize) {
+        _pool->post(&tasks[t]);
+      } else {
+        tasks[t].run();
+      }
+    }
+
+    if (batchSize) {
+      _pool->wait();
+    }
+
+    for (; first < last; ++first) {
+      verified += tasks[first].getBytes();
+    }
+
+    if (_observer) {
+      _observer->onProgress(stream, verified, total);
+    }
+  }
+
+  for (size_t c = 0; c < chunks.size(); ++c) {
+    if (!results[c]) {
+      _addMismatch(chunks[c].offset, chunks[c].length, mismatches);
+    }
+  }
+
+  // Chunks cut by the end of the buffer were not hashed, they are part of
+  // the missing bytes.
+  if (length < expected) {
+    uint64_t offset = chunks.empty() ? initLength :
+      chunks.back().offset + chunks.back().length;
+
+    _addMismatch(offset, expected - offset, mismatches);
+  }
+
+  return true;
+}
+
+void MetadataVerifier::_addMismatch(uint64_t offset, uint64_t length,
+                                    std::vector<Range> *mismatches) {
+  if (!length) {
+    return;
+  }
+
+  if (!mismatches->empty() &&
+      mismatches->back().offset + mismatches->back().length == offset) {
+    mismatches->back().length += length;
+    return;
+  }
+
+  Range range;
+
+  range.offset = offset;
+  range.length = length;
+  mismatches->push_back(range);
+}
+
+}  // namespace peeracle
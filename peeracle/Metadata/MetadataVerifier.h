@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_METADATA_METADATAVERIFIER_H_
+#define PEERACLE_METADATA_METADATAVERIFIER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "peeracle/Metadata/MetadataInterface.h"
+#include "peeracle/Metadata/MetadataVerifierObserver.h"
+#include "peeracle/Utils/WorkerPoolInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Check that a media file holds the content described by a metadata
+ * stream, before a seeder advertises it. The file is mapped in memory and
+ * its chunks are hashed in place, spread over the threads of a worker
+ * pool, so the check runs close to the disk bandwidth.
+ * The file of a stream is its init segment followed by its media segments,
+ * as the metadata lists them.
+ * \addtogroup Metadata
+ */
+class MetadataVerifier {
+ public:
+  /**
+   * A range of bytes of the media file.
+   */
+  struct Range {
+    Range() : offset(0), length(0) {
+    }
+
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  /**
+   * @param metadata the metadata to check files against. Lazily loaded
+   * chunks are loaded by verify().
+   * @param pool a started pool to hash the chunks with. Chunks are hashed
+   * by the calling thread when it has no threads.
+   */
+  MetadataVerifier(MetadataInterface *metadata, WorkerPoolInterface *pool);
+
+  void setObserver(MetadataVerifierObserver *observer);
+
+  /**
+   * Map the file at \p path and check it against \p stream.
+   * \return false if \p stream is out of range or the file could not be
+   * mapped.
+   */
+  bool verify(uint32_t stream, const std::string &path,
+              std::vector<Range> *mismatches);
+
+  /**
+   * Check \p length bytes at \p buffer against \p stream. \p mismatches
+   * receives the ranges of the init segment and chunks that do not match,
+   * contiguous ranges merged, in increasing order. Bytes missing at the end
+   * of \p buffer are reported as a mismatch, extra bytes are ignored.
+   * \return false if \p stream is out of range or its chunk hashes could
+   * not be read.
+   */
+  bool verify(uint32_t stream, const uint8_t *buffer, uint64_t length,
+              std::vector<Range> *mismatches);
+
+ private:
+  struct Chunk {
+    uint64_t offset;
+    uint32_t length;
+    const uint8_t *hash;
+  };
+
+  class VerifyTask;
+
+  static void _addMismatch(uint64_t offset, uint64_t length,
+                           std::vector<Range> *mismatches);
+
+  MetadataInterface *_metadata;
+  WorkerPoolInterface *_pool;
+  MetadataVerifierObserver *_observer;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_METADATA_METADATAVERIFIER_H_
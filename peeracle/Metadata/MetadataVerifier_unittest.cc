@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/FileDataStream.h"
+#include "peeracle/Hash/Murmur3Hash.h"
+#include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Metadata/MetadataStream.h"
+#include "peeracle/Metadata/MetadataVerifier.h"
+#include "peeracle/Utils/WorkerPool.h"
+
+namespace peeracle {
+
+class MetadataVerifierTest : public testing::Test,
+                             public MetadataVerifierObserver {
+ protected:
+  MetadataVerifierTest() : _path("MetadataVerifier_unittest.tmp"),
+                           _reports(0), _verified(0), _total(0) {
+  }
+
+  virtual void SetUp() {
+    static const uint32_t kSegments[] = { 10000, 4096, 0, 20000, 777 };
+    MetadataStreamInit streamInit;
+    MetadataStream *stream;
+    uint32_t state = 0x5052434C;
+    uint8_t digest[16];
+    size_t offset = 1000;
+
+    streamInit.chunkSize = 4096;
+    stream = new MetadataStream(streamInit);
+
+    for (size_t i = 0; i < sizeof(kSegments) / sizeof(kSegments[0]); ++i) {
+      _file.resize(_file.size() + kSegments[i] + (i ? 0 : 1000));
+    }
+    for (size_t i = 0; i < _file.size(); ++i) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      _file[i] = static_cast<uint8_t>(state);
+    }
+
+    stream->setInitSegment(&_file[0], 1000);
+    for (size_t i = 0; i < sizeof(kSegments) / sizeof(kSegments[0]); ++i) {
+      MetadataMediaSegment *segment = new MetadataMediaSegment();
+
+      segment->setTimecode(static_cast<uint32_t>(i * 2000));
+      segment->setLength(kSegments[i]);
+      for (uint32_t c = 0; c < kSegments[i]; c += 4096) {
+        uint32_t length = kSegments[i] - c < 4096 ? kSegments[i] - c : 4096;
+
+        Murmur3Hash::digest(&_file[offset + c], length, digest);
+        segment->addChunk(digest, length);
+      }
+      offset += kSegments[i];
+      stream->addMediaSegment(segment);
+    }
+    _metadata.getStreams().push_back(stream);
+  }
+
+  virtual void TearDown() {
+    remove(_path.c_str());
+  }
+
+  void onProgress(uint32_t stream, uint64_t verified, uint64_t total) {
+    EXPECT_EQ(0, stream);
+    EXPECT_GE(verified, _verified);
+    ++_reports;
+    _verified = verified;
+    _total = total;
+  }
+
+  std::string _path;
+  std::vector<uint8_t> _file;
+  Metadata _metadata;
+  size_t _reports;
+  uint64_t _verified;
+  uint64_t _total;
+};
+
+TEST_F(MetadataVerifierTest, Valid) {
+  WorkerPool pool;
+  std::vector<MetadataVerifier::Range> mismatches;
+
+  ASSERT_TRUE(pool.start(4));
+  MetadataVerifier verifier(&_metadata, &pool);
+
+  verifier.setObserver(this);
+  ASSERT_TRUE(verifier.verify(0, &_file[0], _file.size(), &mismatches));
+  EXPECT_TRUE(mismatches.empty());
+  EXPECT_LT(0, _reports);
+  EXPECT_EQ(_file.size() - 1000, _total);
+  EXPECT_EQ(_total, _verified);
+
+  // Extra bytes are ignored.
+  verifier.setObserver(NULL);
+  _file.push_back(0);
+  ASSERT_TRUE(verifier.verify(0, &_file[0], _file.size(), &mismatches));
+  EXPECT_TRUE(mismatches.empty());
+
+  EXPECT_FALSE(verifier.verify(1, &_file[0], _file.size(), &mismatches));
+  pool.stop();
+}
+
+TEST_F(MetadataVerifierTest, Mismatches) {
+  WorkerPool pool;
+  std::vector<MetadataVerifier::Range> mismatches;
+  MetadataVerifier verifier(&_metadata, &pool);
+
+  // Without threads, the chunks are hashed by the calling thread.
+  _file[10] ^= 1;
+  _file[1000 + 4096 + 5] ^= 1;
+  _file[1000 + 8192] ^= 1;
+  _file[1000 + 10000 + 4096 + 20000 - 1] ^= 1;
+  ASSERT_TRUE(verifier.verify(0, &_file[0], _file.size(), &mismatches));
+
+  ASSERT_EQ(3, mismatches.size());
+  EXPECT_EQ(0, mismatches[0].offset);
+  EXPECT_EQ(1000, mismatches[0].length);
+  // Two neighbour chunks, the second one being the end of the segment.
+  EXPECT_EQ(1000 + 4096, mismatches[1].offset);
+  EXPECT_EQ(10000 - 4096, mismatches[1].length);
+  EXPECT_EQ(1000 + 10000 + 4096 + 16384, mismatches[2].offset);
+  EXPECT_EQ(20000 - 16384, mismatches[2].length);
+}
+
+TEST_F(MetadataVerifierTest, Truncated) {
+  WorkerPool pool;
+  std::vector<MetadataVerifier::Range> mismatches;
+  MetadataVerifier verifier(&_metadata, &pool);
+  uint64_t expected = _file.size();
+
+  // The chunk cut in the middle is missing along with the rest.
+  ASSERT_TRUE(verifier.verify(0, &_file[0], 1000 + 10000 + 5000,
+                              &mismatches));
+  ASSERT_EQ(1, mismatches.size());
+  EXPECT_EQ(1000 + 10000 + 4096, mismatches[0].offset);
+  EXPECT_EQ(expected - mismatches[0].offset, mismatches[0].length);
+
+  ASSERT_TRUE(verifier.verify(0, &_file[0], 500, &mismatches));
+  ASSERT_EQ(1, mismatches.size());
+  EXPECT_EQ(0, mismatches[0].offset);
+  EXPECT_EQ(expected, mismatches[0].length);
+}
+
+TEST_F(MetadataVerifierTest, File) {
+  WorkerPool pool;
+  std::vector<MetadataVerifier::Range> mismatches;
+  MetadataVerifier verifier(&_metadata, &pool);
+  DataStreamInit dsInit;
+
+  EXPECT_FALSE(verifier.verify(0, _path, &mismatches));
+
+  dsInit.path = _path;
+  dsInit.create = true;
+  {
+    FileDataStream file(dsInit);
+
+    ASSERT_TRUE(file.open());
+    _file[20000] ^= 1;
+    file.write(reinterpret_cast<const char *>(&_file[0]), _file.size());
+  }
+
+  ASSERT_TRUE(pool.start(2));
+  ASSERT_TRUE(verifier.verify(0, _path, &mismatches));
+  ASSERT_EQ(1, mismatches.size());
+  EXPECT_EQ(1000 + 10000 + 4096 + 4096, mismatches[0].offset);
+  EXPECT_EQ(4096, mismatches[0].length);
+  pool.stop();
+}
+
+}  // namespace peeracle
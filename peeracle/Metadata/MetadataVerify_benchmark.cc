@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/FileDataStream.h"
+#include "peeracle/Hash/Murmur3Hash.h"
+#include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Metadata/MetadataStream.h"
+#include "peeracle/Metadata/MetadataVerifier.h"
+#include "peeracle/Utils/WorkerPool.h"
+#include "test/benchmark.h"
+
+namespace peeracle {
+
+static const int64_t kMinNanos = 1000000000;
+static const uint32_t kSegmentLength = 2 * 1024 * 1024;
+static const uint32_t kChunkSize = 65536;
+static const char *kFilePath = "MetadataVerify_benchmark.tmp";
+
+// Read every byte once, the bound a verification can reach.
+class ReadCase : public Benchmark::Case {
+ public:
+  explicit ReadCase(const std::vector<uint8_t> &file) : _file(file),
+                                                        _sum(0) {
+  }
+
+  void run() {
+    const uint64_t *words = reinterpret_cast<const uint64_t *>(&_file[0]);
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < _file.size() / sizeof(uint64_t); ++i) {
+      sum += words[i];
+    }
+    _sum += sum;
+  }
+
+  uint64_t getSum() const {
+    return _sum;
+  }
+
+ private:
+  const std::vector<uint8_t> &_file;
+  uint64_t _sum;
+};
+
+class VerifyCase : public Benchmark::Case {
+ public:
+  VerifyCase(MetadataVerifier *verifier, const std::vector<uint8_t> *file)
+    : _verifier(verifier), _file(file) {
+  }
+
+  void run() {
+    std::vector<MetadataVerifier::Range> mismatches;
+
+    if (_file) {
+      _verifier->verify(0, &(*_file)[0], _file->size(), &mismatches);
+    } else {
+      _verifier->verify(0, kFilePath, &mismatches);
+    }
+  }
+
+ private:
+  MetadataVerifier *_verifier;
+  const std::vector<uint8_t> *_file;
+};
+
+static std::string rate(Benchmark::Case *benchmarkCase, uint64_t bytes) {
+  double nanos = Benchmark::measure(benchmarkCase, kMinNanos);
+
+  return Benchmark::formatRate(static_cast<double>(bytes) * 1e9 / nanos);
+}
+
+static int run(uint32_t segmentCount) {
+  Metadata metadata;
+  MetadataStreamInit streamInit;
+  MetadataStream *stream;
+  std::vector<uint8_t> file;
+  DataStreamInit dsInit;
+  WorkerPool singlePool;
+  WorkerPool pool;
+  size_t threads = WorkerPool::getProcessorCount();
+  uint32_t state = 0x5052434C;
+  uint8_t digest[16];
+
+  file.resize(static_cast<size_t>(segmentCount) * kSegmentLength);
+  for (size_t i = 0; i < file.size(); ++i) {
+    state = state * 1664525 + 1013904223;
+    file[i] = static_cast<uint8_t>(state >> 24);
+  }
+
+  streamInit.chunkSize = kChunkSize;
+  stream = new MetadataStream(streamInit);
+  for (uint32_t i = 0; i < segmentCount; ++i) {
+    MetadataMediaSegment *segment = new MetadataMediaSegment();
+
+    segment->setTimecode(i * 2000);
+    segment->setLength(kSegmentLength);
+    for (uint32_t c = 0; c < kSegmentLength; c += kChunkSize) {
+      Murmur3Hash::digest(&file[static_cast<size_t>(i) * kSegmentLength + c],
+                          kChunkSize, digest);
+      segment->addChunk(digest, kChunkSize);
+    }
+    stream->addMediaSegment(segment);
+  }
+  metadata.getStreams().push_back(stream);
+
+  dsInit.path = kFilePath;
+  dsInit.create = true;
+  remove(kFilePath);
+  {
+    FileDataStream out(dsInit);
+
+    if (!out.open() ||
+        out.write(reinterpret_cast<const char *>(&file[0]),
+                  static_cast<std::streamsize>(file.size())) == -1) {
+      std::cerr << "unable to write " << kFilePath << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!singlePool.start(1) || !pool.start(threads)) {
+    std::cerr << "unable to start the worker threads" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  MetadataVerifier single(&metadata, &singlePool);
+  MetadataVerifier threaded(&metadata, &pool);
+  ReadCase read(file);
+  VerifyCase singleMemory(&single, &file);
+  VerifyCase threadedMemory(&threaded, &file);
+  VerifyCase threadedFile(&threaded, NULL);
+  std::string threadsName = Benchmark::formatCount(
+    static_cast<double>(threads)) + " threads";
+  BenchmarkTable table("Verification of " +
+                       Benchmark::formatSize(static_cast<double>(
+                         file.size())) + " in " +
+                       Benchmark::formatSize(kChunkSize) + " chunks");
+
+  table.addColumn("operation");
+  table.addColumn("throughput");
+  table.addRow();
+  table.addCell("memory read");
+  table.addCell(rate(&read, file.size()));
+  table.addRow();
+  table.addCell("verify buffer, 1 thread");
+  table.addCell(rate(&singleMemory, file.size()));
+  table.addRow();
+  table.addCell("verify buffer, " + threadsName);
+  table.addCell(rate(&threadedMemory, file.size()));
+  table.addRow();
+  table.addCell("verify mapped file, " + threadsName);
+  table.addCell(rate(&threadedFile, file.size()));
+  table.print(&std::cout);
+
+  pool.stop();
+  singlePool.stop();
+  remove(kFilePath);
+  return read.getSum() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}  // namespace peeracle
+
+int main(int argc, char **argv) {
+  uint32_t segmentCount = 128;
+
+  if (argc > 1) {
+    segmentCount = static_cast<uint32_t>(strtoul(argv[1], NULL, 10));
+  }
+
+  if (!segmentCount) {
+    std::cerr << "usage: " << argv[0] << " [2 MB segments]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return peeracle::run(segmentCount);
+}
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include "peeracle/Metadata/MetadataView.h"
+
+namespace peeracle {
+
+const uint32_t MetadataView::kMagic;
+const uint32_t MetadataView::kVersion;
+const uint32_t MetadataView::kAlignment;
+const uint32_t MetadataView::kHeaderSize;
+const uint32_t MetadataView::kSectionSize;
+const uint32_t MetadataView::kStreamSize;
+const uint32_t MetadataView::kSegmentSize;
+const uint32_t MetadataView::kDigestSize;
+const uint32_t MetadataView::kChunkSize;
+const uint32_t MetadataView::kLive;
+
+static uint32_t load32(const uint8_t *p) {
+  return (static_cast<uint32_t>(p[0]) << 24) |
+    (static_cast<uint32_t>(p[1]) << 16) |
+    (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+static double loadDouble(const uint8_t *p) {
+  uint64_t bits = (static_cast<uint64_t>(load32(p)) << 32) | load32(p + 4);
+  double value;
+
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Record size of every section, 1 for sections holding raw bytes.
+static const uint32_t kRecordSizes[MetadataView::kSectionCount + 1] = {
+  0, 1, 4, MetadataView::kStreamSize, MetadataView::kSegmentSize,
+  MetadataView::kChunkSize, 1
+};
+
+MetadataView::Segment::Segment() : _record(NULL), _chunks(NULL),
+  _chunkCount(0) {
+}
+
+uint32_t MetadataView::Segment::getTimecode() const {
+  return load32(_record);
+}
+
+uint32_t MetadataView::Segment::getLength() const {
+  return load32(_record + 4);
+}
+
+uint32_t MetadataView::Segment::getChunkCount() const {
+  return _chunkCount;
+}
+
+uint32_t MetadataView::Segment::getFirstChunk() const {
+  return load32(_record + 8);
+}
+
+const uint8_t *MetadataView::Segment::getChunk(uint32_t index) const {
+  if (index >= _chunkCount || !_chunks) {
+    return NULL;
+  }
+  return _chunks + index * kChunkSize + 4;
+}
+
+uint32_t MetadataView::Segment::getChunkLength(uint32_t index) const {
+  if (index >= _chunkCount || !_chunks) {
+    return 0;
+  }
+  return load32(_chunks + index * kChunkSize);
+}
+
+MetadataView::Stream::Stream() : _view(NULL), _record(NULL),
+  _firstSegment(0), _segmentCount(0) {
+}
+
+uint8_t MetadataView::Stream::getType() const {
+  return _record[0];
+}
+
+const char *MetadataView::Stream::getMimeType() const {
+  return _view->_string(load32(_record + 4));
+}
+
+uint32_t MetadataView::Stream::getBandwidth() const {
+  return load32(_record + 8);
+}
+
+int32_t MetadataView::Stream::getWidth() const {
+  return static_cast<int32_t>(load32(_record + 12));
+}
+
+int32_t MetadataView::Stream::getHeight() const {
+  return static_cast<int32_t>(load32(_record + 16));
+}
+
+int32_t MetadataView::Stream::getNumChannels() const {
+  return static_cast<int32_t>(load32(_record + 20));
+}
+
+int32_t MetadataView::Stream::getSamplingFrequency() const {
+  return static_cast<int32_t>(load32(_record + 24));
+}
+
+uint32_t MetadataView::Stream::getChunkSize() const {
+  return load32(_record + 28);
+}
+
+const uint8_t *MetadataView::Stream::getInitSegment() const {
+  return _view->_sections[kInitSegments].data + load32(_record + 32);
+}
+
+uint32_t MetadataView::Stream::getInitSegmentLength() const {
+  return load32(_record + 36);
+}
+
+uint32_t MetadataView::Stream::getSegmentCount() const {
+  return _segmentCount;
+}
+
+bool MetadataView::Stream::getSegment(uint32_t index,
+                                      Segment *segment) const {
+  const Table &chunks = _view->_sections[kChunks];
+  const uint8_t *record;
+  uint64_t firstChunk;
+  uint32_t chunkCount;
+
+  if (index >= _segmentCount) {
+    return false;
+  }
+
+  record = _view->_sections[kSegments].data +
+    (_firstSegment + index) * kSegmentSize;
+  firstChunk = load32(record + 8);
+  chunkCount = load32(record + 12);
+  if (firstChunk + chunkCount > chunks.count) {
+    return false;
+  }
+
+  segment->_record = record;
+  segment->_chunks = chunks.data ? chunks.data + firstChunk * kChunkSize :
+    NULL;
+  segment->_chunkCount = chunkCount;
+  return true;
+}
+
+MetadataView::MetadataView() : _buffer(NULL), _length(0),
+  _chunkTableOffset(0) {
+  memset(_sections, 0, sizeof(_sections));
+}
+
+bool MetadataView::open(const uint8_t *buffer, size_t length) {
+  return _open(buffer, length, length);
+}
+
+uint64_t MetadataView::getIndexLength(const uint8_t *buffer, size_t length) {
+  uint64_t end;
+
+  if (length < kHeaderSize) {
+    return kHeaderSize;
+  }
+
+  if (load32(buffer) != kMagic || load32(buffer + 4) != kVersion) {
+    return 0;
+  }
+
+  end = kHeaderSize + static_cast<uint64_t>(load32(buffer + 52)) *
+    kSectionSize;
+  if (length < end) {
+    return end;
+  }
+
+  for (uint32_t i = 0; i < load32(buffer + 52); ++i) {
+    const uint8_t *entry = buffer + kHeaderSize + i * kSectionSize;
+    uint64_t sectionEnd = static_cast<uint64_t>(load32(entry + 8)) +
+      load32(entry + 12);
+
+    if (load32(entry) != kChunks && sectionEnd > end) {
+      end = sectionEnd;
+    }
+  }
+  return end;
+}
+
+bool MetadataView::openIndex(const uint8_t *buffer, size_t length,
+                             uint64_t fileLength) {
+  return length <= fileLength && _open(buffer, length, fileLength);
+}
+
+bool MetadataView::_open(const uint8_t *buffer, size_t length,
+                         uint64_t fileLength) {
+  bool found[kSectionCount + 1] = { false };
+  uint32_t sectionCount;
+
+  _buffer = NULL;
+  _length = 0;
+  _chunkTableOffset = 0;
+  memset(_sections, 0, sizeof(_sections));
+
+  if (length < kHeaderSize || load32(buffer) != kMagic ||
+      load32(buffer + 4) != kVersion) {
+    return false;
+  }
+
+  sectionCount = load32(buffer + 52);
+  if (sectionCount > (length - kHeaderSize) / kSectionSize) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < sectionCount; ++i) {
+    const uint8_t *entry = buffer + kHeaderSize + i * kSectionSize;
+    uint32_t type = load32(entry);
+    uint32_t count = load32(entry + 4);
+    uint32_t offset = load32(entry + 8);
+    uint32_t size = load32(entry + 12);
+    uint64_t end = static_cast<uint64_t>(offset) + size;
+
+    // Only the chunk table may lie past the bytes given to openIndex().
+    if (end > (type == kChunks ? fileLength : length) ||
+        offset % kAlignment) {
+      return false;
+    }
+
+    // Unknown sections are left for newer readers.
+    if (type < kStrings || type > kSectionCount) {
+      continue;
+    }
+
+    if (found[type] ||
+        static_cast<uint64_t>(count) * kRecordSizes[type] > size) {
+      return false;
+    }
+
+    found[type] = true;
+    _sections[type].data = end <= length ? buffer + offset : NULL;
+    _sections[type].count = count;
+    _sections[type].length = size;
+    if (type == kChunks) {
+      _chunkTableOffset = offset;
+    }
+  }
+
+  for (uint32_t type = kStrings; type <= kSectionCount; ++type) {
+    if (!found[type]) {
+      return false;
+    }
+  }
+
+  const Table &strings = _sections[kStrings];
+  if (!strings.length || strings.data[strings.length - 1] != '\0' ||
+      load32(buffer + 40) >= strings.length ||
+      _sections[kTrackers].count != load32(buffer + 48) ||
+      _sections[kStreams].count != load32(buffer + 44)) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < _sections[kTrackers].count; ++i) {
+    if (load32(_sections[kTrackers].data + i * 4) >= strings.length) {
+      return false;
+    }
+  }
+
+  for (uint32_t i = 0; i < _sections[kStreams].count; ++i) {
+    const uint8_t *record = _sections[kStreams].data + i * kStreamSize;
+
+    if (load32(record + 4) >= strings.length ||
+        static_cast<uint64_t>(load32(record + 32)) + load32(record + 36) >
+        _sections[kInitSegments].length ||
+        static_cast<uint64_t>(load32(record + 40)) + load32(record + 44) >
+        _sections[kSegments].count) {
+      return false;
+    }
+  }
+
+  _buffer = buffer;
+  _length = length;
+  return true;
+}
+
+uint32_t MetadataView::getVersion() const {
+  return load32(_buffer + 4);
+}
+
+uint32_t MetadataView::getFlags() const {
+  return load32(_buffer + 8);
+}
+
+bool MetadataView::isLive() const {
+  return (getFlags() & kLive) != 0;
+}
+
+uint32_t MetadataView::getTimecodeScale() const {
+  return load32(_buffer + 12);
+}
+
+double MetadataView::getDuration() const {
+  return loadDouble(_buffer + 16);
+}
+
+const uint8_t *MetadataView::getId() const {
+  return _buffer + 24;
+}
+
+const char *MetadataView::getHashAlgorithm() const {
+  return _string(load32(_buffer + 40));
+}
+
+uint32_t MetadataView::getTrackerCount() const {
+  return _sections[kTrackers].count;
+}
+
+const char *MetadataView::getTrackerUrl(uint32_t index) const {
+  if (index >= _sections[kTrackers].count) {
+    return NULL;
+  }
+  return _string(load32(_sections[kTrackers].data + index * 4));
+}
+
+uint32_t MetadataView::getStreamCount() const {
+  return _sections[kStreams].count;
+}
+
+bool MetadataView::getStream(uint32_t index, Stream *stream) const {
+  const uint8_t *record;
+
+  if (index >= _sections[kStreams].count) {
+    return false;
+  }
+
+  record = _sections[kStreams].data + index * kStreamSize;
+  stream->_view = this;
+  stream->_record = record;
+  stream->_firstSegment = load32(record + 40);
+  stream->_segmentCount = load32(record + 44);
+  return true;
+}
+
+uint32_t MetadataView::getChunkTableOffset() const {
+  return _chunkTableOffset;
+}
+
+const char *MetadataView::_string(uint32_t offset) const {
+  return reinterpret_cast<const char *>(_sections[kStrings].data + offset);
+}
+
+}  // namespace peeracle
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_METADATA_METADATAVIEW_H_
+#define PEERACLE_METADATA_METADATAVIEW_H_
+
+#include <stdint.h>
+#include <cstdlib>
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Read a version 3 metadata file in place, without copying or allocating.
+ *
+ * A version 3 file starts with a fixed header, followed by a directory of
+ * sections. Every section starts on a 16 bytes boundary and holds
+ * fixed-width big-endian records, so any stream, segment or chunk is
+ * reached by indexing instead of parsing what comes before it:
+ *
+ * - header: magic "PRCL", version 3, flags (kLive), timecode scale,
+ *   duration, the 16 bytes content id, the hash algorithm, the stream,
+ *   tracker and section counts.
+ * - directory: one (type, count, offset, length) entry per section.
+ * - strings: NUL-terminated strings referenced by their offset.
+ * - trackers: the string offset of every tracker url.
+ * - streams: one record per stream, with its init segment range and its
+ *   range in the segments table.
+ * - segments: timecode, length and range in the chunk table of every
+ *   media segment, stream after stream.
+ * - init segments: the initialization segments, back to back.
+ * - chunks: the length and 16 bytes hash of every chunk. The table comes
+ *   last, so that a writer can append to it as segments are hashed, and a
+ *   reader can leave it on disk.
+ *
+ * The content id is the same as for a version 2 file: a single hash of
+ * the init segment then the hash of every chunk of each stream, stream
+ * after stream. The chunk hashes are left out when the metadata is live.
+ *
+ * The buffer given to open() must outlive the view and the Stream and
+ * Segment objects it returns.
+ * \addtogroup Metadata
+ */
+class MetadataView {
+ public:
+  static const uint32_t kMagic = 0x5052434C;
+  static const uint32_t kVersion = 3;
+  static const uint32_t kAlignment = 16;
+  static const uint32_t kHeaderSize = 64;
+  static const uint32_t kSectionSize = 16;
+  static const uint32_t kStreamSize = 48;
+  static const uint32_t kSegmentSize = 16;
+  static const uint32_t kDigestSize = 16;
+  static const uint32_t kChunkSize = 20;
+
+  /**
+   * Header flag of a live metadata, whose id only covers the init segments.
+   */
+  static const uint32_t kLive = 1;
+
+  enum Section {
+    kStrings = 1,
+    kTrackers,
+    kStreams,
+    kSegments,
+    kChunks,
+    kInitSegments,
+    kSectionCount = kInitSegments
+  };
+
+  class Segment {
+   public:
+    Segment();
+
+    uint32_t getTimecode() const;
+    uint32_t getLength() const;
+    uint32_t getChunkCount() const;
+
+    /**
+     * Get the index of the first chunk of the segment in the chunk table.
+     */
+    uint32_t getFirstChunk() const;
+
+    /**
+     * Get the hash of the chunk at \p index, kDigestSize bytes long.
+     * \return NULL if \p index is out of range or the view was opened with
+     * openIndex().
+     */
+    const uint8_t *getChunk(uint32_t index) const;
+    uint32_t getChunkLength(uint32_t index) const;
+
+   private:
+    friend class MetadataView;
+
+    const uint8_t *_record;
+    const uint8_t *_chunks;
+    uint32_t _chunkCount;
+  };
+
+  class Stream {
+   public:
+    Stream();
+
+    uint8_t getType() const;
+    const char *getMimeType() const;
+    uint32_t getBandwidth() const;
+    int32_t getWidth() const;
+    int32_t getHeight() const;
+    int32_t getNumChannels() const;
+    int32_t getSamplingFrequency() const;
+    uint32_t getChunkSize() const;
+    const uint8_t *getInitSegment() const;
+    uint32_t getInitSegmentLength() const;
+    uint32_t getSegmentCount() const;
+
+    /**
+     * Get the media segment at \p index of this stream.
+     * \return false if \p index is out of range or the segment chunk range
+     * lies outside of the chunk tables.
+     */
+    bool getSegment(uint32_t index, Segment *segment) const;
+
+   private:
+    friend class MetadataView;
+
+    const MetadataView *_view;
+    const uint8_t *_record;
+    uint32_t _firstSegment;
+    uint32_t _segmentCount;
+  };
+
+  MetadataView();
+
+  /**
+   * Check the header, the section directory and the stream records of the
+   * \p length bytes at \p buffer.
+   * \return false if the buffer is not a valid version 3 metadata file.
+   */
+  bool open(const uint8_t *buffer, size_t length);
+
+  /**
+   * Get the number of bytes at the start of a file that hold its header,
+   * its section directory and every section but the chunk table, from the
+   * \p length bytes read at \p buffer so far. Call it again while it
+   * returns more than \p length, the directory size is only known once the
+   * header is read.
+   * \return 0 if the header or the directory is not valid.
+   */
+  static uint64_t getIndexLength(const uint8_t *buffer, size_t length);
+
+  /**
+   * Like open(), for the getIndexLength() bytes at the start of a file of
+   * \p fileLength bytes. The chunk table is left out: segments only give
+   * the range of their records in it, at getChunkTableOffset().
+   */
+  bool openIndex(const uint8_t *buffer, size_t length, uint64_t fileLength);
+
+  uint32_t getVersion() const;
+  uint32_t getFlags() const;
+  bool isLive() const;
+  uint32_t getTimecodeScale() const;
+  double getDuration() const;
+
+  /**
+   * Get the content id, 16 bytes long.
+   */
+  const uint8_t *getId() const;
+  const char *getHashAlgorithm() const;
+  uint32_t getTrackerCount() const;
+  const char *getTrackerUrl(uint32_t index) const;
+  uint32_t getStreamCount() const;
+  bool getStream(uint32_t index, Stream *stream) const;
+
+  /**
+   * Get the offset of the chunk table from the start of the file.
+   */
+  uint32_t getChunkTableOffset() const;
+
+ private:
+  struct Table {
+    const uint8_t *data;
+    uint32_t count;
+    uint32_t length;
+  };
+
+  bool _open(const uint8_t *buffer, size_t length, uint64_t fileLength);
+  const char *_string(uint32_t offset) const;
+
+  const uint8_t *_buffer;
+  size_t _length;
+  Table _sections[kSectionCount + 1];
+  uint32_t _chunkTableOffset;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_METADATA_METADATAVIEW_H_
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Hash/Murmur3Hash.h"
+#include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Metadata/MetadataStream.h"
+#include "peeracle/Metadata/MetadataV3Writer.h"
+#include "peeracle/Metadata/MetadataView.h"
+
+namespace peeracle {
+
+class MetadataViewTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    MetadataStreamInit video;
+    MetadataStreamInit audio;
+    uint8_t init[300];
+    uint8_t digest[16];
+
+    for (size_t i = 0; i < sizeof(init); ++i) {
+      init[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    _metadata.setHashAlgorithm("murmur3_x86_128");
+    _metadata.setTimecodeScale(1000000);
+    _metadata.setDuration(7200000.5);
+    _metadata.addTracker("wss://tracker.peeracle.org");
+    _metadata.addTracker("ws://127.0.0.1:8080");
+
+    video.type = 1;
+    video.mimeType = "video/webm; codecs=\"vp9\"";
+    video.bandwidth = 2500000;
+    video.width = 1920;
+    video.height = 1080;
+    video.chunkSize = 16384;
+    audio.type = 2;
+    audio.mimeType = "audio/webm; codecs=\"opus\"";
+    audio.bandwidth = 96000;
+    audio.numChannels = 2;
+    audio.samplingFrequency = 48000;
+
+    _streams.push_back(new MetadataStream(video));
+    _streams.push_back(new MetadataStream(audio));
+    _streams[0]->setInitSegment(init, 211);
+    _streams[1]->setInitSegment(init + 11, 57);
+
+    for (size_t s = 0; s < _streams.size(); ++s) {
+      for (uint32_t i = 0; i < 50; ++i) {
+        MetadataMediaSegment *segment = new MetadataMediaSegment();
+        uint32_t chunkCount = (i * 3 + s) % 7;
+
+        segment->setTimecode(i * 2000);
+        segment->setLength(chunkCount * 1000);
+        for (uint32_t c = 0; c < chunkCount; ++c) {
+          memset(digest, static_cast<int>(s * 100 + i + c), sizeof(digest));
+          segment->addChunk(digest, 1000);
+        }
+        _streams[s]->addMediaSegment(segment);
+      }
+      _metadata.getStreams().push_back(_streams[s]);
+    }
+  }
+
+  void write(std::vector<uint8_t> *buffer) {
+    DataStreamInit dsInit;
+    MemoryDataStream out(dsInit);
+    MetadataV3Writer writer(&_metadata);
+
+    ASSERT_TRUE(writer.write(&out));
+    buffer->resize(static_cast<size_t>(out.length()));
+    out.seek(0);
+    out.read(reinterpret_cast<char *>(&(*buffer)[0]), out.length());
+  }
+
+  Metadata _metadata;
+  std::vector<MetadataStream *> _streams;
+};
+
+TEST_F(MetadataViewTest, WriteAndView) {
+  std::vector<uint8_t> buffer;
+  MetadataView view;
+  MetadataView::Stream stream;
+  MetadataView::Segment segment;
+  Murmur3Hash hash;
+  uint8_t id[16];
+
+  write(&buffer);
+  ASSERT_TRUE(view.open(&buffer[0], buffer.size()));
+  EXPECT_EQ(3, view.getVersion());
+  EXPECT_EQ(0, view.getFlags());
+  EXPECT_EQ(1000000, view.getTimecodeScale());
+  EXPECT_EQ(7200000.5, view.getDuration());
+  EXPECT_STREQ("murmur3_x86_128", view.getHashAlgorithm());
+  ASSERT_EQ(2, view.getTrackerCount());
+  EXPECT_STREQ("wss://tracker.peeracle.org", view.getTrackerUrl(0));
+  EXPECT_STREQ("ws://127.0.0.1:8080", view.getTrackerUrl(1));
+  EXPECT_TRUE(view.getTrackerUrl(2) == NULL);
+  ASSERT_EQ(2, view.getStreamCount());
+  EXPECT_FALSE(view.getStream(2, &stream));
+
+  for (uint32_t s = 0; s < 2; ++s) {
+    MetadataStream *expected = _streams[s];
+
+    ASSERT_TRUE(view.getStream(s, &stream));
+    EXPECT_EQ(expected->getType(), stream.getType());
+    EXPECT_EQ(expected->getMimeType(), stream.getMimeType());
+    EXPECT_EQ(expected->getBandwidth(), stream.getBandwidth());
+    EXPECT_EQ(expected->getWidth(), stream.getWidth());
+    EXPECT_EQ(expected->getHeight(), stream.getHeight());
+    EXPECT_EQ(expected->getNumChannels(), stream.getNumChannels());
+    EXPECT_EQ(expected->getSamplingFrequency(),
+              stream.getSamplingFrequency());
+    EXPECT_EQ(expected->getChunkSize(), stream.getChunkSize());
+    ASSERT_EQ(expected->getInitSegmentLength(),
+              stream.getInitSegmentLength());
+    EXPECT_EQ(0, memcmp(expected->getInitSegment(), stream.getInitSegment(),
+                        stream.getInitSegmentLength()));
+    hash.update(stream.getInitSegment(), stream.getInitSegmentLength());
+
+    ASSERT_EQ(expected->getMediaSegments().size(), stream.getSegmentCount());
+    EXPECT_FALSE(stream.getSegment(stream.getSegmentCount(), &segment));
+    for (uint32_t i = 0; i < stream.getSegmentCount(); ++i) {
+      MetadataMediaSegmentInterface *mediaSegment =
+        expected->getMediaSegments()[i];
+
+      ASSERT_TRUE(stream.getSegment(i, &segment));
+      EXPECT_EQ(mediaSegment->getTimecode(), segment.getTimecode());
+      EXPECT_EQ(mediaSegment->getLength(), segment.getLength());
+      ASSERT_EQ(mediaSegment->getChunkCount(), segment.getChunkCount());
+      for (uint32_t c = 0; c < segment.getChunkCount(); ++c) {
+        EXPECT_EQ(mediaSegment->getChunkLengths()[c],
+                  segment.getChunkLength(c));
+        EXPECT_EQ(0, memcmp(mediaSegment->getChunks()[c],
+                            segment.getChunk(c), 16));
+        hash.update(segment.getChunk(c), 16);
+      }
+      EXPECT_TRUE(segment.getChunk(segment.getChunkCount()) == NULL);
+    }
+  }
+
+  hash.final(id);
+  EXPECT_EQ(0, memcmp(id, view.getId(), sizeof(id)));
+}
+
+TEST_F(MetadataViewTest, RejectCorrupted) {
+  std::vector<uint8_t> buffer;
+  std::vector<uint8_t> corrupted;
+  MetadataView view;
+  Metadata metadata;
+  DataStreamInit dsInit;
+
+  write(&buffer);
+  EXPECT_FALSE(view.open(&buffer[0], MetadataView::kHeaderSize - 1));
+  EXPECT_FALSE(view.open(&buffer[0], buffer.size() - 1));
+
+  corrupted = buffer;
+  corrupted[7] = 2;
+  EXPECT_FALSE(view.open(&corrupted[0], corrupted.size()));
+
+  // Stream record pointing past the segments table.
+  corrupted = buffer;
+  uint32_t streams = MetadataView::kHeaderSize + 2 * MetadataView::kSectionSize;
+  uint32_t offset = (corrupted[streams + 8] << 24) |
+    (corrupted[streams + 9] << 16) | (corrupted[streams + 10] << 8) |
+    corrupted[streams + 11];
+  corrupted[offset + 44 + 3] = 200;
+  EXPECT_FALSE(view.open(&corrupted[0], corrupted.size()));
+
+  // Metadata reads version 3 files through a view, and refuses the same
+  // corruptions.
+  MemoryDataStream ds(dsInit);
+  ds.write(reinterpret_cast<const char *>(&corrupted[0]), corrupted.size());
+  ds.seek(0);
+  EXPECT_FALSE(metadata.unserialize(&ds));
+
+  EXPECT_TRUE(view.open(&buffer[0], buffer.size()));
+}
+
+}  // namespace peeracle
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "peeracle/DataStream/MemoryDataStream.h"
+#include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Metadata/MetadataStream.h"
+#include "test/benchmark.h"
+
+namespace peeracle {
+
+static const int64_t kMinNanos = 500000000;
+static const uint32_t kStreamCount = 4;
+static const uint32_t kChunkCount = 32;
+
+class MetadataCase : public Benchmark::Case {
+ public:
+  explicit MetadataCase(Metadata *metadata) : _metadata(metadata) {
+  }
+
+ protected:
+  Metadata *_metadata;
+};
+
+// Write every field straight to the output stream, letting it grow as
+// needed, as serialize() did before the output was presized.
+class StreamedWriteCase : public MetadataCase {
+ public:
+  explicit StreamedWriteCase(Metadata *metadata) : MetadataCase(metadata) {
+  }
+
+  void run() {
+    DataStreamInit dsInit;
+    MemoryDataStream out(dsInit);
+    std::vector<MetadataStreamInterface *> &streams =
+      _metadata->getStreams();
+
+    out.write("PRCL", 4);
+    out.write(static_cast<uint32_t>(2));
+    out.write(_metadata->getHashAlgorithm());
+    out.write(_metadata->getTimecodeScale());
+    out.write(_metadata->getDuration());
+    out.write(static_cast<uint32_t>(0));
+    out.write(static_cast<uint32_t>(streams.size()));
+    for (size_t s = 0; s < streams.size(); ++s) {
+      streams[s]->serialize(&out);
+    }
+  }
+};
+
+class SerializeCase : public MetadataCase {
+ public:
+  explicit SerializeCase(Metadata *metadata) : MetadataCase(metadata) {
+  }
+
+  void run() {
+    DataStreamInit dsInit;
+    MemoryDataStream out(dsInit);
+
+    _metadata->serialize(&out);
+  }
+};
+
+class UnserializeCase : public Benchmark::Case {
+ public:
+  UnserializeCase(MemoryDataStream *in, bool lazy) : _in(in), _lazy(lazy) {
+  }
+
+  void run() {
+    Metadata metadata;
+
+    metadata.setLazy(_lazy);
+    _in->seek(0);
+    metadata.unserialize(_in);
+    metadata.getId();
+  }
+
+ private:
+  MemoryDataStream *_in;
+  bool _lazy;
+};
+
+static std::string rate(Benchmark::Case *benchmarkCase, uint64_t bytes) {
+  double nanos = Benchmark::measure(benchmarkCase, kMinNanos);
+
+  return Benchmark::formatRate(static_cast<double>(bytes) * 1e9 / nanos);
+}
+
+static int run(uint32_t segmentCount) {
+  Metadata metadata;
+  std::vector<MetadataStream *> streams;
+  DataStreamInit dsInit;
+  MemoryDataStream serialized(dsInit);
+  uint8_t init[4096];
+  uint8_t digest[16];
+  uint32_t state = 0x5052434C;
+
+  metadata.setHashAlgorithm("murmur3_x86_128");
+  metadata.setTimecodeScale(1000000);
+  metadata.setDuration(segmentCount * 2000.0);
+
+  memset(init, 0x42, sizeof(init));
+  for (uint32_t s = 0; s < kStreamCount; ++s) {
+    MetadataStreamInit streamInit;
+
+    streamInit.type = static_cast<uint8_t>(s);
+    streamInit.mimeType = "video/webm; codecs=\"vp9\"";
+    streamInit.bandwidth = 1000000 * (s + 1);
+    // Half of the streams record a length for every chunk.
+    streamInit.chunkSize = s % 2 ? 0 : 16384;
+    streams.push_back(new MetadataStream(streamInit));
+    streams[s]->setInitSegment(init, sizeof(init));
+
+    for (uint32_t i = 0; i < segmentCount; ++i) {
+      MetadataMediaSegment *segment = new MetadataMediaSegment();
+
+      segment->setTimecode(i * 2000);
+      segment->setLength(kChunkCount * 16384);
+      for (uint32_t c = 0; c < kChunkCount; ++c) {
+        for (size_t b = 0; b < sizeof(digest); ++b) {
+          state = state * 1664525 + 1013904223;
+          digest[b] = static_cast<uint8_t>(state >> 24);
+        }
+        segment->addChunk(digest, 16384);
+      }
+      streams[s]->addMediaSegment(segment);
+    }
+    metadata.getStreams().push_back(streams[s]);
+  }
+
+  uint64_t size = metadata.getSerializedSize();
+  if (!metadata.serialize(&serialized)) {
+    std::cerr << "unable to serialize the metadata" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  StreamedWriteCase streamed(&metadata);
+  SerializeCase presized(&metadata);
+  UnserializeCase eager(&serialized, false);
+  UnserializeCase lazy(&serialized, true);
+  BenchmarkTable table("Metadata of " + Benchmark::formatCount(kStreamCount) +
+                       " streams of " + Benchmark::formatCount(segmentCount) +
+                       " segments (" +
+                       Benchmark::formatSize(static_cast<double>(size)) +
+                       ")");
+
+  table.addColumn("operation");
+  table.addColumn("throughput");
+  table.addRow();
+  table.addCell("streamed writes");
+  table.addCell(rate(&streamed, size));
+  table.addRow();
+  table.addCell("presized serialize");
+  table.addCell(rate(&presized, size));
+  table.addRow();
+  table.addCell("unserialize");
+  table.addCell(rate(&eager, size));
+  table.addRow();
+  table.addCell("lazy unserialize");
+  table.addCell(rate(&lazy, size));
+  table.print(&std::cout);
+  return EXIT_SUCCESS;
+}
+
+}  // namespace peeracle
+
+int main(int argc, char **argv) {
+  uint32_t segmentCount = 3600;
+
+  if (argc > 1) {
+    segmentCount = static_cast<uint32_t>(strtoul(argv[1], NULL, 10));
+  }
+
+  if (!segmentCount) {
+    std::cerr << "usage: " << argv[0] << " [segments per stream]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return peeracle::run(segmentCount);
+}
@@ -20,15 +20,53 @@
  * SOFTWARE.
  */
 
+#include <cstring>
 #include <string>
 #include <vector>
 #include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/Hash/Hex.h"
 #include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataGenerator.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Metadata/MetadataMediaSegmentInterface.h"
+#include "peeracle/Metadata/MetadataStream.h"
 #include "peeracle/Metadata/MetadataStreamInterface.h"
+#include "peeracle/Metadata/MetadataV3Writer.h"
+#include "peeracle/Metadata/MetadataView.h"
 #include "peeracle/DataStream/MemoryDataStream.h"
 
 namespace peeracle {
 
+// A data stream not held in memory, as a file, that counts the bytes read.
+class StreamedDataStream : public MemoryDataStream {
+ public:
+  explicit StreamedDataStream(const DataStreamInit &dsInit)
+    : MemoryDataStream(dsInit), _bytesRead(0) {
+  }
+
+  const uint8_t *getBuffer() const {
+    return NULL;
+  }
+
+  using MemoryDataStream::read;
+
+  std::streamsize read(char *buffer, std::streamsize length) {
+    std::streamsize result = MemoryDataStream::read(buffer, length);
+
+    if (result > 0) {
+      _bytesRead += static_cast<uint64_t>(result);
+    }
+    return result;
+  }
+
+  uint64_t getBytesRead() const {
+    return _bytesRead;
+  }
+
+ private:
+  uint64_t _bytesRead;
+};
+
 class MetadataTest : public testing::Test {
  protected:
   MetadataTest() : _metadata(NULL) {
@@ -210,87 +248,392 @@ TEST_F(MetadataTest, CorrectHeader) {
 }
 
 TEST_F(MetadataTest, Serialize) {
+  DataStreamInit dsInit;
+  MemoryDataStream v2(dsInit);
+  MemoryDataStream unsupported(dsInit);
+  std::vector<uint8_t> bytes;
+  MetadataView view;
   uint32_t magic;
   uint32_t version;
-  uint32_t timecodeScale;
-  double duration;
-  uint32_t numTrackers;
-  uint32_t numStreams;
-  std::streamsize s;
-  peeracle::MemoryDataStream *expectedDs;
+  std::string hashAlgorithm;
 
-  _metadata->setHashAlgorithm("crc32");
+  _metadata->setHashAlgorithm("murmur3_x86_128");
   _metadata->setTimecodeScale(1000000);
   _metadata->setDuration(794000.0);
   _metadata->addTracker("ws://127.0.0.1:8080");
 
-  s = _ds->write("PRCL", 4);
-  EXPECT_EQ(4, s);
-
-  s = _ds->write(static_cast<int32_t>(2));
-  EXPECT_EQ(sizeof(int32_t), s);
+  // Version 2 is written unless another version is selected.
+  ASSERT_TRUE(_metadata->serialize(&v2));
+  EXPECT_EQ(_metadata->getSerializedSize(), v2.length());
+  ASSERT_EQ(0, v2.seek(0));
+  EXPECT_EQ(sizeof(magic), v2.read(&magic));
+  EXPECT_EQ(0x5052434C, magic);
+  EXPECT_EQ(sizeof(version), v2.read(&version));
+  EXPECT_EQ(2, version);
+  EXPECT_EQ(15, v2.read(&hashAlgorithm));
+  EXPECT_EQ("murmur3_x86_128", hashAlgorithm);
 
-  s = _ds->write("crc32", 6);
-  EXPECT_EQ(6, s);
+  _metadata->setVersion(1);
+  EXPECT_FALSE(_metadata->serialize(&unsupported));
 
-  s = _ds->write(1000000);
-  EXPECT_EQ(sizeof(uint32_t), s);
+  _metadata->setVersion(3);
+  _metadata->setHashAlgorithm("crc32");
+  EXPECT_FALSE(_metadata->serialize(&unsupported));
+
+  _metadata->setHashAlgorithm("murmur3_x86_128");
+  ASSERT_TRUE(_metadata->serialize(_ds));
+  EXPECT_EQ(_metadata->getSerializedSize(), _ds->length());
+
+  bytes.assign(_ds->getBuffer(), _ds->getBuffer() + _ds->length());
+  ASSERT_TRUE(view.open(&bytes[0], bytes.size()));
+  EXPECT_EQ(3, view.getVersion());
+  EXPECT_EQ("murmur3_x86_128", std::string(view.getHashAlgorithm()));
+  EXPECT_EQ(1000000, view.getTimecodeScale());
+  EXPECT_EQ(794000.0, view.getDuration());
+  ASSERT_EQ(1, view.getTrackerCount());
+  EXPECT_EQ("ws://127.0.0.1:8080", std::string(view.getTrackerUrl(0)));
+  EXPECT_EQ(0, view.getStreamCount());
+
+  // The id of a metadata built in memory is computed when serialized.
+  EXPECT_EQ(32, _metadata->getId().size());
+  EXPECT_EQ(_metadata->getId(),
+            Hex::encode(view.getId(), MetadataView::kDigestSize));
+}
 
-  s = _ds->write(794000.0);
-  EXPECT_EQ(sizeof(double), s);
+TEST_F(MetadataTest, ContentDefinedChunks) {
+  bool res;
+  uint8_t chunkHash[16] = { 0 };
 
-  s = _ds->write(1);
-  EXPECT_EQ(sizeof(uint32_t), s);
+  _ds->write("PRCL", 4);
+  _ds->write(static_cast<int32_t>(2));
+  _ds->write("murmur3_x86_128", 16);
+  _ds->write(1000000);
+  _ds->write(794000.0);
+  _ds->write(0);
 
-  s = _ds->write("ws://127.0.0.1:8080", 20);
-  EXPECT_EQ(20, s);
+  _ds->write(1);
+  // write the number of streams
+  _ds->write(static_cast<uint8_t>(1));
+  _ds->write("video/webm", 11);
+  _ds->write(800000);
+  _ds->write(640);
+  _ds->write(360);
+  _ds->write(0);
+  _ds->write(0);
+  _ds->write(0);
+  // write a chunk size of 0, the chunk lengths are stored in the segments
+  _ds->write(4);
+  _ds->write("init", 4);
+
+  _ds->write(1);
+  // write the number of media segments
+  _ds->write(0);
+  _ds->write(90000);
+  _ds->write(2);
+  _ds->write(70000);
+  _ds->write(reinterpret_cast<char *>(chunkHash), 16);
+  _ds->write(20000);
+  _ds->write(reinterpret_cast<char *>(chunkHash), 16);
 
-  s = _ds->write(0);
-  EXPECT_EQ(sizeof(uint32_t), s);
+  _ds->seek(0);
+  res = _metadata->unserialize(_ds);
+  ASSERT_TRUE(res);
+
+  std::vector<MetadataStreamInterface *> &streams = _metadata->getStreams();
+  ASSERT_EQ(1, streams.size());
+  EXPECT_EQ(0, streams[0]->getChunkSize());
+
+  std::vector<MetadataMediaSegmentInterface *> &segments =
+    streams[0]->getMediaSegments();
+  ASSERT_EQ(1, segments.size());
+  ASSERT_EQ(2, segments[0]->getChunks().size());
+
+  const std::vector<uint32_t> &lengths = segments[0]->getChunkLengths();
+  ASSERT_EQ(2, lengths.size());
+  EXPECT_EQ(70000, lengths[0]);
+  EXPECT_EQ(20000, lengths[1]);
+
+  // The chunk lengths must add up to the segment length.
+  Metadata shorter;
+  ASSERT_EQ(124, _ds->seek(124));
+  _ds->write(10000);
+  _ds->seek(0);
+  EXPECT_FALSE(shorter.unserialize(_ds));
+}
 
+TEST_F(MetadataTest, RoundTrip) {
+  MetadataStreamInit video;
+  MetadataStreamInit audio;
+  std::vector<MetadataStream *> streams;
+  uint8_t init[100];
+  uint8_t digest[16];
   DataStreamInit dsInit;
-  expectedDs = new MemoryDataStream(dsInit);
-  _metadata->serialize(expectedDs);
-
-  s = expectedDs->seek(0);
-  EXPECT_EQ(0, s);
-
-  s = expectedDs->tell();
-  EXPECT_EQ(0, s);
-
-  s = expectedDs->read(&magic);
-  EXPECT_EQ(sizeof(magic), s);
-  EXPECT_EQ(0x5052434C, magic);
+  MemoryDataStream copyDs(dsInit);
+  MemoryDataStream v3Ds(dsInit);
+  Metadata copy;
 
-  s = expectedDs->read(&version);
-  EXPECT_EQ(sizeof(version), s);
-  EXPECT_EQ(2, version);
+  memset(init, 0x42, sizeof(init));
+  _metadata->setHashAlgorithm("murmur3_x86_128");
+  _metadata->setTimecodeScale(1000000);
+  _metadata->setDuration(60000.0);
+  _metadata->addTracker("ws://127.0.0.1:8080");
+  _metadata->addTracker("wss://tracker.peeracle.org");
+
+  video.type = 1;
+  video.mimeType = "video/webm; codecs=\"vp9\"";
+  video.bandwidth = 2500000;
+  video.width = 1920;
+  video.height = 1080;
+  video.chunkSize = 16384;
+  audio.type = 2;
+  audio.mimeType = "audio/webm; codecs=\"opus\"";
+  audio.bandwidth = 96000;
+  audio.numChannels = 2;
+  audio.samplingFrequency = 48000;
+
+  streams.push_back(new MetadataStream(video));
+  streams.push_back(new MetadataStream(audio));
+  streams[0]->setInitSegment(init, sizeof(init));
+  streams[1]->setInitSegment(init, 10);
+
+  for (size_t s = 0; s < streams.size(); ++s) {
+    for (uint32_t i = 0; i < 30; ++i) {
+      MetadataMediaSegment *segment = new MetadataMediaSegment();
+
+      segment->setTimecode(i * 2000);
+      segment->setLength(s ? i * 1000 + i * (i - 1) / 2 : i * 16384);
+      for (uint32_t c = 0; c < i; ++c) {
+        memset(digest, static_cast<int>(s + i + c), sizeof(digest));
+        segment->addChunk(digest, s ? 1000 + c : 16384);
+      }
+      streams[s]->addMediaSegment(segment);
+    }
+    _metadata->getStreams().push_back(streams[s]);
+  }
 
-  std::string hashAlgorithm;
-  s = expectedDs->read(&hashAlgorithm);
-  EXPECT_EQ(5, s);
-  EXPECT_EQ("crc32", hashAlgorithm);
+  ASSERT_TRUE(_metadata->serialize(_ds));
+  EXPECT_EQ(_metadata->getSerializedSize(), _ds->length());
+
+  ASSERT_EQ(0, _ds->seek(0));
+  ASSERT_TRUE(copy.unserialize(_ds));
+  EXPECT_EQ(_ds->length(), _ds->tell());
+  EXPECT_EQ(_metadata->getId(), copy.getId());
+  EXPECT_TRUE(copy.verifyId());
+  EXPECT_EQ(2, copy.getTrackerUrls().size());
+
+  std::vector<MetadataStreamInterface *> &copyStreams = copy.getStreams();
+  ASSERT_EQ(2, copyStreams.size());
+  EXPECT_EQ(video.mimeType, copyStreams[0]->getMimeType());
+  EXPECT_EQ(16384, copyStreams[0]->getChunkSize());
+  EXPECT_EQ(48000, copyStreams[1]->getSamplingFrequency());
+  EXPECT_EQ(0, copyStreams[1]->getChunkSize());
+  EXPECT_EQ(0, memcmp(init, copyStreams[0]->getInitSegment(), sizeof(init)));
+
+  const std::vector<uint32_t> &lengths =
+    copyStreams[1]->getMediaSegments()[5]->getChunkLengths();
+  ASSERT_EQ(5, lengths.size());
+  EXPECT_EQ(1004, lengths[4]);
+
+  ASSERT_TRUE(copy.serialize(&copyDs));
+  ASSERT_EQ(_ds->length(), copyDs.length());
+  EXPECT_EQ(0, memcmp(_ds->getBuffer(), copyDs.getBuffer(),
+                      static_cast<size_t>(copyDs.length())));
+
+  // The id stored by version 3 is the one computed for version 2.
+  Metadata v3;
+
+  _metadata->setVersion(3);
+  ASSERT_TRUE(_metadata->serialize(&v3Ds));
+  ASSERT_EQ(0, v3Ds.seek(0));
+  ASSERT_TRUE(v3.unserialize(&v3Ds));
+  EXPECT_EQ(3, v3.getVersion());
+  EXPECT_EQ(copy.getId(), v3.getId());
+  EXPECT_TRUE(v3.verifyId());
+}
 
-  s = expectedDs->read(&timecodeScale);
-  EXPECT_EQ(sizeof(timecodeScale), s);
-  EXPECT_EQ(1000000, timecodeScale);
+TEST_F(MetadataTest, Generator) {
+  MetadataGenerator generator(61000, 2000, 42);
+  uint64_t chunkCount = 0;
+
+  generator.addDefaultStreams(65536);
+  ASSERT_TRUE(generator.write(_ds));
+
+  ASSERT_EQ(0, _ds->seek(0));
+  ASSERT_TRUE(_metadata->unserialize(_ds));
+  EXPECT_EQ(_ds->length(), _ds->tell());
+  EXPECT_EQ(61000.0, _metadata->getDuration());
+
+  std::vector<MetadataStreamInterface *> &streams = _metadata->getStreams();
+  ASSERT_EQ(6, streams.size());
+  EXPECT_EQ(8000000, streams[0]->getBandwidth());
+  EXPECT_EQ(2, streams[5]->getNumChannels());
+
+  for (size_t s = 0; s < streams.size(); ++s) {
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      streams[s]->getMediaSegments();
+
+    ASSERT_EQ(31, segments.size());
+    EXPECT_EQ(60000, segments[30]->getTimecode());
+    for (size_t i = 0; i < segments.size(); ++i) {
+      EXPECT_EQ((segments[i]->getLength() + 65535) / 65536,
+                segments[i]->getChunkCount());
+      chunkCount += segments[i]->getChunkCount();
+    }
+  }
+  EXPECT_EQ(generator.getChunkCount(), chunkCount);
+}
 
-  s = expectedDs->read(&duration);
-  EXPECT_EQ(sizeof(duration), s);
-  EXPECT_EQ(794000.0, duration);
+TEST_F(MetadataTest, Compact) {
+  MetadataGenerator generator(61000, 2000, 7);
+  DataStreamInit dsInit;
+  MemoryDataStream before(dsInit);
+  MemoryDataStream after(dsInit);
+  MetadataMediaSegment *segment = new MetadataMediaSegment();
+  uint8_t digest[16] = { 0 };
+  uint64_t usage;
+  uint64_t streamUsage;
+
+  generator.addDefaultStreams(65536);
+  ASSERT_TRUE(generator.write(_ds));
+  ASSERT_EQ(0, _ds->seek(0));
+  ASSERT_TRUE(_metadata->unserialize(_ds));
+  ASSERT_TRUE(_metadata->serialize(&before));
+
+  std::vector<MetadataStreamInterface *> &streams = _metadata->getStreams();
+  usage = _metadata->getMemoryUsage();
+  streamUsage = streams[0]->getMemoryUsage();
+  EXPECT_LT(streams[0]->getMediaSegments()[0]->getMemoryUsage(), streamUsage);
+  EXPECT_LT(streamUsage, usage);
+
+  _metadata->compact();
+  EXPECT_LT(_metadata->getMemoryUsage(), usage);
+  EXPECT_LT(streams[0]->getMemoryUsage(), streamUsage);
+  EXPECT_EQ(&streams[0]->getMimeType(), &streams[4]->getMimeType());
+  EXPECT_EQ("video/webm; codecs=\"vp9\"", streams[4]->getMimeType());
+  ASSERT_TRUE(_metadata->serialize(&after));
+  ASSERT_EQ(before.length(), after.length());
+  EXPECT_EQ(0, memcmp(before.getBuffer(), after.getBuffer(),
+                      static_cast<size_t>(after.length())));
+
+  // Segments added after a compaction are moved by the next one.
+  segment->setTimecode(61000);
+  segment->setLength(100);
+  segment->addChunk(digest, 100);
+  streams[5]->addMediaSegment(segment);
+  usage = _metadata->getMemoryUsage();
+  _metadata->compact();
+  EXPECT_LT(_metadata->getMemoryUsage(), usage);
+  EXPECT_EQ(0, memcmp(digest, segment->getChunks()[0], sizeof(digest)));
+}
 
-  s = expectedDs->read(&numTrackers);
-  EXPECT_EQ(sizeof(numTrackers), s);
-  EXPECT_EQ(1, numTrackers);
+TEST_F(MetadataTest, StoredId) {
+  MetadataGenerator generator(31000, 2000, 3);
+  DataStreamInit dsInit;
+  MemoryDataStream v3(dsInit);
+  MemoryDataStream again(dsInit);
+  MemoryDataStream copyAgain(dsInit);
+  MemoryDataStream tampered(dsInit);
+  std::vector<uint8_t> bytes;
+  MetadataView view;
+  MetadataView::Stream stream;
+  MetadataView::Segment segment;
+  Metadata copy;
+  Metadata forged;
+
+  generator.addDefaultStreams(0);
+  ASSERT_TRUE(generator.write(_ds));
+  ASSERT_EQ(0, _ds->seek(0));
+  ASSERT_TRUE(_metadata->unserialize(_ds));
+  std::string id = _metadata->getId();
+  EXPECT_EQ(32, id.size());
+  EXPECT_TRUE(_metadata->verifyId());
+
+  MetadataV3Writer writer(_metadata);
+  ASSERT_TRUE(writer.write(&v3));
+  ASSERT_EQ(0, v3.seek(0));
+  ASSERT_TRUE(copy.unserialize(&v3));
+  EXPECT_EQ(3, copy.getVersion());
+  EXPECT_EQ(id, copy.getId());
+  EXPECT_TRUE(copy.verifyId());
+
+  // Read back, a version 3 file describes the same content with the same
+  // id.
+  _metadata->setVersion(3);
+  ASSERT_TRUE(_metadata->serialize(&again));
+  ASSERT_TRUE(copy.serialize(&copyAgain));
+  ASSERT_EQ(v3.length(), again.length());
+  ASSERT_EQ(again.length(), copyAgain.length());
+  EXPECT_EQ(0, memcmp(v3.getBuffer(), again.getBuffer(),
+                      static_cast<size_t>(again.length())));
+  EXPECT_EQ(0, memcmp(again.getBuffer(), copyAgain.getBuffer(),
+                      static_cast<size_t>(again.length())));
+
+  // The header id is kept as is, only verifyId() notices a changed chunk.
+  bytes.assign(v3.getBuffer(), v3.getBuffer() + v3.length());
+  ASSERT_TRUE(view.open(&bytes[0], bytes.size()));
+  ASSERT_TRUE(view.getStream(2, &stream));
+  ASSERT_TRUE(stream.getSegment(5, &segment));
+  bytes[segment.getChunk(0) - &bytes[0]] ^= 0x80;
+  tampered.write(reinterpret_cast<const char *>(&bytes[0]),
+                 static_cast<std::streamsize>(bytes.size()));
+  ASSERT_EQ(0, tampered.seek(0));
+  ASSERT_TRUE(forged.unserialize(&tampered));
+  EXPECT_EQ(id, forged.getId());
+  EXPECT_FALSE(forged.verifyId());
+}
 
-  std::string tracker;
-  s = expectedDs->read(&tracker);
-  EXPECT_EQ(19, s);
-  EXPECT_EQ("ws://127.0.0.1:8080", tracker);
+TEST_F(MetadataTest, LazyView) {
+  MetadataGenerator generator(61000, 2000, 5);
+  DataStreamInit dsInit;
+  StreamedDataStream file(dsInit);
+  Metadata lazy;
+  Metadata copy;
+
+  generator.addDefaultStreams(0);
+  ASSERT_TRUE(generator.write(_ds));
+  ASSERT_EQ(0, _ds->seek(0));
+  ASSERT_TRUE(_metadata->unserialize(_ds));
+  _metadata->setVersion(3);
+  ASSERT_TRUE(_metadata->serialize(&file));
+
+  // Only the index of a file not held in memory is read, the chunk table
+  // is left to the first access of each segment.
+  ASSERT_EQ(0, file.seek(0));
+  lazy.setLazy(true);
+  ASSERT_TRUE(lazy.unserialize(&file));
+  EXPECT_EQ(file.length(), file.tell());
+  EXPECT_LT(file.getBytesRead(), static_cast<uint64_t>(file.length()) / 2);
+  EXPECT_EQ(_metadata->getId(), lazy.getId());
+
+  std::vector<MetadataStreamInterface *> &streams = _metadata->getStreams();
+  std::vector<MetadataStreamInterface *> &lazyStreams = lazy.getStreams();
+  ASSERT_EQ(streams.size(), lazyStreams.size());
+  for (size_t s = 0; s < streams.size(); ++s) {
+    std::vector<MetadataMediaSegmentInterface *> &segments =
+      streams[s]->getMediaSegments();
+    std::vector<MetadataMediaSegmentInterface *> &lazySegments =
+      lazyStreams[s]->getMediaSegments();
+
+    ASSERT_EQ(segments.size(), lazySegments.size());
+    for (size_t i = 0; i < segments.size(); ++i) {
+      EXPECT_EQ(segments[i]->getChunkCount(),
+                lazySegments[i]->getChunkCount());
+      EXPECT_EQ(segments[i]->getChunkLengths(),
+                lazySegments[i]->getChunkLengths());
+      ASSERT_EQ(segments[i]->getChunkCount(),
+                lazySegments[i]->getChunks().size());
+      for (size_t c = 0; c < segments[i]->getChunkCount(); ++c) {
+        EXPECT_EQ(0, memcmp(segments[i]->getChunks()[c],
+                            lazySegments[i]->getChunks()[c], 16));
+      }
+    }
+  }
+  EXPECT_TRUE(lazy.verifyId());
 
-  s = expectedDs->read(&numStreams);
-  EXPECT_EQ(sizeof(numStreams), s);
-  EXPECT_EQ(0, numStreams);
+  ASSERT_EQ(0, file.seek(0));
+  ASSERT_TRUE(copy.unserialize(&file));
+  EXPECT_EQ(file.length(), file.tell());
+  EXPECT_TRUE(copy.verifyId());
 }
 
 }  // namespace peeracle
@@ -20,9 +20,9 @@
  * SOFTWARE.
  */
 
-#include <iostream>
 #include "peeracle/Peer/Peer.h"
 #include "peeracle/Peer/PeerImpl.h"
+#include "peeracle/Utils/Logger.h"
 
 namespace peeracle {
 
@@ -31,26 +31,22 @@ Peer::PeerImpl::DataChannelObserver::DataChannelObserver(
 }
 
 void Peer::PeerImpl::DataChannelObserver::OnStateChange() {
-  std::cout << "DataChannelObserver::OnStateChange " <<
-  this->_dataChannel->state() << std::endl;
+  PEERACLE_LOG(Verbose) << "DataChannelObserver::OnStateChange " <<
+    this->_dataChannel->state();
 
   if (this->_dataChannel->state() == webrtc::DataChannelInterface::kOpen) {
     uint8_t data[] = {0, 16, 32, 64};
     rtc::Buffer buffer(data, sizeof(data));
     webrtc::DataBuffer dataBuffer(buffer, true);
 
-    std::cout << "SEND MSG NOW" << std::endl;
     this->_dataChannel->Send(dataBuffer);
   }
 }
 
 void Peer::PeerImpl::DataChannelObserver::OnMessage(
   const webrtc::DataBuffer& buffer) {
-  std::cout << "GOT MSG!!!" << std::endl;
-  std::cout << "size = " << buffer.size() << std::endl;
-  for (size_t i = 0; i < buffer.size(); ++i) {
-    printf("data[%zu] = %d\n", i, buffer.data.data()[i]);
-  }
+  PEERACLE_LOG(Verbose) << "DataChannelObserver::OnMessage size " <<
+    buffer.size();
 }
 
 }  // namespace peeracle
@@ -20,9 +20,9 @@
  * SOFTWARE.
  */
 
-#include <iostream>
 #include "peeracle/Peer/Peer.h"
 #include "peeracle/Peer/PeerImpl.h"
+#include "peeracle/Utils/Logger.h"
 
 namespace peeracle {
 
@@ -43,8 +43,8 @@ void Peer::PeerImpl::OnRemoveStream(webrtc::MediaStreamInterface *stream) {
 }
 
 void Peer::PeerImpl::OnDataChannel(webrtc::DataChannelInterface *data_channel) {
-  std::cout << "Peer::PeerImpl::OnDataChannel " << data_channel->label() <<
-  std::endl;
+  PEERACLE_LOG(Verbose) << "Peer::PeerImpl::OnDataChannel " <<
+    data_channel->label();
   this->_dataChannel = data_channel;
   this->_dataChannelObserver = new PeerImpl::DataChannelObserver(data_channel);
   this->_dataChannel->RegisterObserver(this->_dataChannelObserver);
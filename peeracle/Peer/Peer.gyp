@@ -32,6 +32,7 @@
       'dependencies': [
         '<(webrtc_depot_dir)/talk/libjingle.gyp:libjingle_peerconnection',
         '../Tracker/Client/TrackerClient.gyp:peeracle_tracker_client',
+        '../Utils/Utils.gyp:peeracle_logger',
       ],
       'defines': [
         'BUILD_LIBPEERACLE',
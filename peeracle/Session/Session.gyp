@@ -31,7 +31,8 @@
       'standalone_static_library': 1,
       'dependencies': [
         '../Peer/Peer.gyp:peeracle_peer',
-        '../Tracker/Client/TrackerClient.gyp:peeracle_tracker_client'
+        '../Tracker/Client/TrackerClient.gyp:peeracle_tracker_client',
+        '../Utils/Utils.gyp:peeracle_logger',
       ],
       'conditions': [
         ['use_libwebsockets == 1', {
@@ -20,8 +20,8 @@
  * SOFTWARE.
  */
 
-#include <iostream>
 #include "peeracle/Session/SessionHandle.h"
+#include "peeracle/Utils/Logger.h"
 
 namespace peeracle {
 
@@ -39,9 +39,8 @@ MetadataInterface *SessionHandle::getMetadata() const {
 }
 
 void SessionHandle::onPeer(PeerInterface *peer, uint32_t got, bool poke) {
-  std::cout << "[SessionHandle] Peer connected " << peer->getId() <<
-    " for hash " << _metadata->getId() << " got " << got << " poke " << poke <<
-    std::endl;
+  PEERACLE_LOG(Info) << "[SessionHandle] Peer connected " << peer->getId() <<
+    " for hash " << _metadata->getId() << " got " << got << " poke " << poke;
 }
 
 }  // namespace peeracle
@@ -20,7 +20,6 @@
  * SOFTWARE.
  */
 
-#include <iostream>
 #include <map>
 #include <string>
 #include <vector>
@@ -29,6 +28,7 @@
 #include "peeracle/Session/SessionHandleInterface.h"
 #include "peeracle/Session/SessionPeerObserver.h"
 #include "peeracle/Session/SessionTrackerClientObserver.h"
+#include "peeracle/Utils/Logger.h"
 
 namespace peeracle {
 
@@ -40,7 +40,7 @@ SessionTrackerClientObserver::~SessionTrackerClientObserver() {
 }
 
 void SessionTrackerClientObserver::onConnect(const std::string &id) {
-  std::cout << "[Session] Connected with id " << id << std::endl;
+  PEERACLE_LOG(Info) << "[Session] Connected with id " << id;
 
   std::map<std::string, SessionHandleInterface *> &handles =
     _session->getHandles();
@@ -61,11 +61,11 @@ void SessionTrackerClientObserver::onConnect(const std::string &id) {
 }
 
 void SessionTrackerClientObserver::onDisconnect() {
-  std::cout << "[Session] Disconnected from tracker" << std::endl;
+  PEERACLE_LOG(Info) << "[Session] Disconnected from tracker";
 }
 
 void SessionTrackerClientObserver::onConnectionError() {
-  std::cout << "[Session] Error while connecting to the tracker" << std::endl;
+  PEERACLE_LOG(Error) << "[Session] Error while connecting to the tracker";
 }
 
 void SessionTrackerClientObserver::onPeerConnect(const std::string &hash,
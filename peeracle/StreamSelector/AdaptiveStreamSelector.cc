@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+#include "peeracle/StreamSelector/AdaptiveStreamSelector.h"
+
+namespace peeracle {
+
+static const uint32_t kNoRung = 0xFFFFFFFF;
+
+AdaptiveStreamSelector::Average::Average(uint32_t halfLife)
+  : _halfLife(halfLife ? halfLife : 1), _estimate(0), _totalWeight(0) {
+}
+
+void AdaptiveStreamSelector::Average::add(double weight, double value) {
+  double alpha = pow(0.5, weight / _halfLife);
+
+  _estimate = value * (1 - alpha) + _estimate * alpha;
+  _totalWeight += weight;
+}
+
+double AdaptiveStreamSelector::Average::get(double initial) const {
+  if (_totalWeight <= 0) {
+    return initial;
+  }
+
+  // The average starts at 0, remove that bias from the first samples.
+  return _estimate / (1 - pow(0.5, _totalWeight / _halfLife));
+}
+
+double AdaptiveStreamSelector::Average::getTotalWeight() const {
+  return _totalWeight;
+}
+
+AdaptiveStreamSelector::AdaptiveStreamSelector(
+  MetadataInterface *metadata, const AdaptiveStreamSelectorInit &init)
+  : _metadata(metadata), _init(init), _current(kNoRung), _bufferLevel(0),
+    _fast(init.fastHalfLife), _slow(init.slowHalfLife) {
+  std::vector<MetadataStreamInterface *> &streams = metadata->getStreams();
+  std::vector<std::pair<uint32_t, uint32_t> > ladder;
+  const std::string &contentType = init.contentType;
+
+  for (size_t i = 0; i < streams.size(); ++i) {
+    const std::string &mimeType = streams[i]->getMimeType();
+
+    if (!contentType.empty() &&
+        (mimeType.compare(0, contentType.size(), contentType) ||
+         mimeType.size() <= contentType.size() ||
+         mimeType[contentType.size()] != '/')) {
+      continue;
+    }
+    ladder.push_back(std::make_pair(streams[i]->getBandwidth(),
+                                    static_cast<uint32_t>(i)));
+  }
+
+  std::stable_sort(ladder.begin(), ladder.end());
+  for (size_t i = 0; i < ladder.size(); ++i) {
+    _ladder.push_back(ladder[i].second);
+  }
+}
+
+void AdaptiveStreamSelector::addSample(uint64_t bytes, uint32_t duration) {
+  double bitsPerSecond;
+
+  if (bytes < _init.minSampleBytes) {
+    return;
+  }
+
+  if (!duration) {
+    duration = 1;
+  }
+
+  bitsPerSecond = static_cast<double>(bytes) * 8000 / duration;
+  _fast.add(duration, bitsPerSecond);
+  _slow.add(duration, bitsPerSecond);
+}
+
+void AdaptiveStreamSelector::setBufferLevel(uint32_t bufferLevel) {
+  _bufferLevel = bufferLevel;
+}
+
+uint64_t AdaptiveStreamSelector::getThroughput() {
+  double initial = static_cast<double>(_init.initialThroughput);
+
+  return static_cast<uint64_t>(std::min(_fast.get(initial),
+                                        _slow.get(initial)) + 0.5);
+}
+
+uint32_t AdaptiveStreamSelector::_chooseRung() {
+  std::vector<MetadataStreamInterface *> &streams = _metadata->getStreams();
+  double budget = static_cast<double>(getThroughput()) * _init.safetyFactor;
+  uint32_t rung = 0;
+
+  for (uint32_t i = 1; i < _ladder.size(); ++i) {
+    if (streams[_ladder[i]]->getBandwidth() <= budget) {
+      rung = i;
+    }
+  }
+
+  // The first segment only depends on the throughput, the buffer being
+  // empty while starting.
+  if (_current == kNoRung) {
+    return rung;
+  }
+
+  if (!_bufferLevel) {
+    return 0;
+  }
+
+  if ((rung > _current && _bufferLevel < _init.lowBufferLevel) ||
+      (rung < _current && _bufferLevel >= _init.highBufferLevel)) {
+    return _current;
+  }
+  return rung;
+}
+
+bool AdaptiveStreamSelector::select(uint32_t timecode, uint32_t *stream,
+                                    uint32_t *segment) {
+  if (_ladder.empty()) {
+    return false;
+  }
+
+  _current = _chooseRung();
+  *stream = _ladder[_current];
+  return _metadata->getStreams()[*stream]->findSegmentByTimecode(timecode,
+                                                                 segment);
+}
+
+}  // namespace peeracle
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_STREAMSELECTOR_ADAPTIVESTREAMSELECTOR_H_
+#define PEERACLE_STREAMSELECTOR_ADAPTIVESTREAMSELECTOR_H_
+
+#include <string>
+#include <vector>
+#include "peeracle/Metadata/MetadataInterface.h"
+#include "peeracle/StreamSelector/StreamSelectorInterface.h"
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+struct AdaptiveStreamSelectorInit {
+  AdaptiveStreamSelectorInit()
+    : initialThroughput(1000000),
+      fastHalfLife(2000),
+      slowHalfLife(8000),
+      minSampleBytes(16384),
+      safetyFactor(0.85),
+      lowBufferLevel(8000),
+      highBufferLevel(20000) {
+  }
+
+  /**
+   * The first part of the mime type of the streams to choose from, such as
+   * "video" or "audio". Every stream is a candidate when empty.
+   */
+  std::string contentType;
+
+  /**
+   * The throughput assumed until enough bytes were downloaded, in bits per
+   * second.
+   */
+  uint64_t initialThroughput;
+
+  /**
+   * The half lives of the fast and slow throughput averages, in
+   * milliseconds of download time.
+   */
+  uint32_t fastHalfLife;
+  uint32_t slowHalfLife;
+
+  /**
+   * Downloads smaller than this are mostly latency and are not sampled.
+   */
+  uint64_t minSampleBytes;
+
+  /**
+   * The share of the estimated throughput a stream bandwidth may use.
+   */
+  double safetyFactor;
+
+  /**
+   * Below \p lowBufferLevel milliseconds of buffered media the selector
+   * never switches up, and it falls back to the lowest stream when the
+   * buffer is empty. Above \p highBufferLevel it does not switch down, the
+   * buffer absorbing the throughput drop.
+   */
+  uint32_t lowBufferLevel;
+  uint32_t highBufferLevel;
+};
+
+/**
+ * Choose among the streams of a metadata from two exponentially weighted
+ * moving averages of the throughput, a fast one to react to drops and a
+ * slow one to ignore spikes, the lower of both being used. The buffer
+ * level adds hysteresis around that choice, to avoid oscillating between
+ * streams.
+ * \addtogroup StreamSelector
+ */
+class AdaptiveStreamSelector
+  : public StreamSelectorInterface {
+ public:
+  AdaptiveStreamSelector(MetadataInterface *metadata,
+                         const AdaptiveStreamSelectorInit &init);
+
+  void addSample(uint64_t bytes, uint32_t duration);
+  void setBufferLevel(uint32_t bufferLevel);
+  uint64_t getThroughput();
+  bool select(uint32_t timecode, uint32_t *stream, uint32_t *segment);
+
+ private:
+  class Average {
+   public:
+    explicit Average(uint32_t halfLife);
+
+    void add(double weight, double value);
+    double get(double initial) const;
+    double getTotalWeight() const;
+
+   private:
+    double _halfLife;
+    double _estimate;
+    double _totalWeight;
+  };
+
+  uint32_t _chooseRung();
+
+  MetadataInterface *_metadata;
+  AdaptiveStreamSelectorInit _init;
+
+  // Indexes of the candidate streams, by increasing bandwidth.
+  std::vector<uint32_t> _ladder;
+  uint32_t _current;
+  uint32_t _bufferLevel;
+  Average _fast;
+  Average _slow;
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_STREAMSELECTOR_ADAPTIVESTREAMSELECTOR_H_
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_STREAMSELECTOR_STREAMSELECTORINTERFACE_H_
+#define PEERACLE_STREAMSELECTOR_STREAMSELECTORINTERFACE_H_
+
+#include <stdint.h>
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * StreamSelector module interface. A stream selector picks which
+ * representation of a metadata to download next, from the throughput
+ * measured on the previous downloads and the amount of media buffered by
+ * the player. It is asked once per media segment, so streams only switch
+ * at segment boundaries.
+ * \addtogroup StreamSelector
+ */
+class StreamSelectorInterface {
+ public:
+  /**
+   * Record a download of \p bytes that took \p duration milliseconds.
+   */
+  virtual void addSample(uint64_t bytes, uint32_t duration) = 0;
+
+  /**
+   * Set the duration of media buffered ahead of the playback position, in
+   * milliseconds.
+   */
+  virtual void setBufferLevel(uint32_t bufferLevel) = 0;
+
+  /**
+   * Get the estimated throughput in bits per second.
+   */
+  virtual uint64_t getThroughput() = 0;
+
+  /**
+   * Choose the stream to download the media segment playing at
+   * \p timecode from.
+   * @param timecode a timecode in the metadata timecode scale.
+   * @param stream receives the index of the stream in the metadata.
+   * @param segment receives the index of the media segment in that stream.
+   * \return false if no stream has a media segment at \p timecode.
+   */
+  virtual bool select(uint32_t timecode, uint32_t *stream,
+                      uint32_t *segment) = 0;
+
+  virtual ~StreamSelectorInterface() {}
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_STREAMSELECTOR_STREAMSELECTORINTERFACE_H_
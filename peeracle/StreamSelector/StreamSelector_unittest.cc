@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/Metadata/Metadata.h"
+#include "peeracle/Metadata/MetadataMediaSegment.h"
+#include "peeracle/Metadata/MetadataStream.h"
+#include "peeracle/StreamSelector/AdaptiveStreamSelector.h"
+
+namespace peeracle {
+
+class StreamSelectorTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    // Streams are added out of bandwidth order on purpose.
+    static const uint32_t kVideo[] = { 2500000, 600000, 5000000, 1200000 };
+
+    for (size_t i = 0; i < sizeof(kVideo) / sizeof(kVideo[0]); ++i) {
+      addStream("video/webm; codecs=\"vp9\"", kVideo[i]);
+    }
+    addStream("audio/webm; codecs=\"opus\"", 128000);
+    _init.contentType = "video";
+  }
+
+  void addStream(const std::string &mimeType, uint32_t bandwidth) {
+    MetadataStreamInit streamInit;
+    MetadataStream *stream;
+
+    streamInit.mimeType = mimeType;
+    streamInit.bandwidth = bandwidth;
+    stream = new MetadataStream(streamInit);
+    for (uint32_t i = 0; i < 10; ++i) {
+      MetadataMediaSegment *segment = new MetadataMediaSegment();
+
+      segment->setTimecode(i * 2000);
+      segment->setLength(bandwidth / 4);
+      stream->addMediaSegment(segment);
+    }
+    _metadata.getStreams().push_back(stream);
+  }
+
+  uint32_t select(StreamSelectorInterface *selector) {
+    uint32_t stream = 0xFFFFFFFF;
+    uint32_t segment;
+
+    EXPECT_TRUE(selector->select(0, &stream, &segment));
+    return stream;
+  }
+
+  // Record \p seconds of downloads at \p bitsPerSecond.
+  void download(StreamSelectorInterface *selector, uint64_t bitsPerSecond,
+                uint32_t seconds) {
+    for (uint32_t i = 0; i < seconds; ++i) {
+      selector->addSample(bitsPerSecond / 8, 1000);
+    }
+  }
+
+  Metadata _metadata;
+  AdaptiveStreamSelectorInit _init;
+};
+
+TEST_F(StreamSelectorTest, Ladder) {
+  AdaptiveStreamSelector video(&_metadata, _init);
+  AdaptiveStreamSelectorInit audioInit;
+  uint32_t stream;
+  uint32_t segment;
+
+  // 85% of the initial 1 Mbps fits the 600 kbps stream only.
+  EXPECT_EQ(1, select(&video));
+
+  audioInit.contentType = "audio";
+  AdaptiveStreamSelector audio(&_metadata, audioInit);
+  EXPECT_EQ(4, select(&audio));
+  ASSERT_TRUE(audio.select(4500, &stream, &segment));
+  EXPECT_EQ(2, segment);
+
+  audioInit.contentType = "text";
+  AdaptiveStreamSelector none(&_metadata, audioInit);
+  EXPECT_FALSE(none.select(0, &stream, &segment));
+}
+
+TEST_F(StreamSelectorTest, Throughput) {
+  AdaptiveStreamSelector selector(&_metadata, _init);
+
+  EXPECT_EQ(1000000, selector.getThroughput());
+
+  // Small downloads are not sampled.
+  selector.addSample(1000, 1);
+  EXPECT_EQ(1000000, selector.getThroughput());
+
+  // A single sample is the estimate.
+  selector.addSample(500000, 1000);
+  EXPECT_EQ(4000000, selector.getThroughput());
+
+  // The fast average follows a drop sooner than the slow one.
+  download(&selector, 1000000, 4);
+  EXPECT_LT(selector.getThroughput(), 2000000);
+  EXPECT_GT(selector.getThroughput(), 1000000);
+
+  // A spike is held back by the slow average.
+  download(&selector, 1000000, 30);
+  download(&selector, 20000000, 1);
+  EXPECT_LT(selector.getThroughput(), 4000000);
+}
+
+TEST_F(StreamSelectorTest, SwitchUp) {
+  AdaptiveStreamSelector selector(&_metadata, _init);
+
+  EXPECT_EQ(1, select(&selector));
+  download(&selector, 8000000, 30);
+
+  // Not enough media buffered to take the risk yet.
+  selector.setBufferLevel(4000);
+  EXPECT_EQ(1, select(&selector));
+
+  // 85% of 8 Mbps fits the 5 Mbps stream.
+  selector.setBufferLevel(10000);
+  EXPECT_EQ(2, select(&selector));
+}
+
+TEST_F(StreamSelectorTest, SwitchDown) {
+  AdaptiveStreamSelector selector(&_metadata, _init);
+
+  download(&selector, 8000000, 30);
+  EXPECT_EQ(2, select(&selector));
+  download(&selector, 2000000, 30);
+
+  // The buffer absorbs the drop.
+  selector.setBufferLevel(25000);
+  EXPECT_EQ(2, select(&selector));
+
+  // 85% of 2 Mbps fits the 1.2 Mbps stream.
+  selector.setBufferLevel(15000);
+  EXPECT_EQ(3, select(&selector));
+
+  // Rebuffering, go to the lowest stream.
+  selector.setBufferLevel(0);
+  EXPECT_EQ(1, select(&selector));
+}
+
+}  // namespace peeracle
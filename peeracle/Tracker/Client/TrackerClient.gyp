@@ -28,6 +28,9 @@
       'target_name': 'peeracle_tracker_client',
       'type': 'static_library',
       'standalone_static_library': 1,
+      'dependencies': [
+        '../../Utils/Utils.gyp:peeracle_logger',
+      ],
       'conditions': [
         ['use_libwebsockets == 1', {
           'defines': [
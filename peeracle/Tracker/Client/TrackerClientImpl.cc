@@ -26,13 +26,13 @@
 #include <cstring>
 #include <string>
 #include <sstream>
-#include <iostream>
 
 #include "third_party/libwebsockets/lib/libwebsockets.h"
 #include "peeracle/DataStream/MemoryDataStream.h"
 #include "peeracle/Tracker/Client/TrackerClient.h"
 #include "peeracle/Tracker/Client/TrackerClientImpl.h"
 #include "peeracle/Tracker/Message/TrackerMessage.h"
+#include "peeracle/Utils/Logger.h"
 
 namespace peeracle {
 
@@ -94,7 +94,7 @@ int TrackerClient::TrackerClientImpl::Callback(
       message->unserialize(dataStream);
 
       type = message->getType();
-      std::cout << "Got message type " << static_cast<int>(type) << std::endl;
+      PEERACLE_LOG(Verbose) << "Got message type " << static_cast<int>(type);
       switch (type) {
         case TrackerMessageInterface::kWelcome:
         {
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_UTILS_LOGSINKINTERFACE_H_
+#define PEERACLE_UTILS_LOGSINKINTERFACE_H_
+
+#include <cstdlib>
+
+namespace peeracle {
+
+class LogSinkInterface {
+ public:
+  virtual ~LogSinkInterface() {}
+
+  /**
+   * Receive one formatted log record, without trailing newline. Records are
+   * delivered in order from a single thread at a time, never from the thread
+   * that logged them.
+   * @param level the Logger::Level of the record.
+   * @param message the record text, \p length bytes, NUL terminated.
+   */
+  virtual void onLog(int level, const char *message, size_t length) = 0;
+};
+
+}  // namespace peeracle
+
+#endif  // PEERACLE_UTILS_LOGSINKINTERFACE_H_
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include "peeracle/Utils/Logger.h"
+#include "peeracle/Utils/LoggerImpl.h"
+
+namespace peeracle {
+
+static const char kLevelNames[] = "VIWE";
+
+const size_t Logger::kCapacity;
+const size_t Logger::kMaxLength;
+Logger::LoggerImpl Logger::_impl;
+volatile int Logger::_level = Logger::kInfo;
+
+bool Logger::start() {
+  return _impl.Start();
+}
+
+void Logger::stop() {
+  _impl.Stop();
+}
+
+void Logger::flush() {
+  _impl.Flush();
+}
+
+void Logger::setLevel(Level level) {
+  _level = level;
+}
+
+bool Logger::isEnabled(Level level) {
+  return level >= _level;
+}
+
+void Logger::setSink(LogSinkInterface *sink) {
+  _impl.SetSink(sink);
+}
+
+bool Logger::push(Level level, const char *message, size_t length) {
+  return _impl.Push(level, message, length);
+}
+
+uint32_t Logger::getDroppedCount() {
+  return _impl.GetDroppedCount();
+}
+
+LogMessage::LogMessage(Logger::Level level, const char *file, int line)
+  : _level(level) {
+  const char *name = strrchr(file, '/');
+
+#if defined(WEBRTC_WIN)
+  if (!name) {
+    name = strrchr(file, '\\');
+  }
+#endif  // WEBRTC_WIN
+
+  _stream << kLevelNames[level] << ' ' << (name ? name + 1 : file) << ':' <<
+    line << "] ";
+}
+
+LogMessage::~LogMessage() {
+  const std::string message = _stream.str();
+
+  Logger::push(_level, message.c_str(), message.size());
+}
+
+std::ostream &LogMessage::stream() {
+  return _stream;
+}
+
+}  // namespace peeracle
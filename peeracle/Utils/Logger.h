@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_UTILS_LOGGER_H_
+#define PEERACLE_UTILS_LOGGER_H_
+
+#include <stdint.h>
+#include <cstdlib>
+#include <ostream>
+#include <sstream>
+#include "peeracle/Utils/LogSinkInterface.h"
+
+/**
+ * Records below this level are removed at compile time, their arguments are
+ * never evaluated. Defaults to kInfo in release builds and kVerbose
+ * otherwise.
+ */
+#ifndef PEERACLE_LOG_MIN_LEVEL
+#  ifdef NDEBUG
+#    define PEERACLE_LOG_MIN_LEVEL 1
+#  else
+#    define PEERACLE_LOG_MIN_LEVEL 0
+#  endif
+#endif
+
+#define PEERACLE_LOG_ON(level) \
+  (peeracle::Logger::k##level >= PEERACLE_LOG_MIN_LEVEL && \
+  peeracle::Logger::isEnabled(peeracle::Logger::k##level))
+
+/**
+ * Log a record, used as a stream:
+ *   PEERACLE_LOG(Info) << "Connected with id " << id;
+ * \p level is one of Verbose, Info, Warning or Error.
+ */
+#define PEERACLE_LOG(level) \
+  !PEERACLE_LOG_ON(level) ? (void) 0 : \
+  peeracle::LogMessageVoidify() & \
+  peeracle::LogMessage(peeracle::Logger::k##level, __FILE__, __LINE__).stream()
+
+/**
+ * \addtogroup peeracle
+ * @{
+ * @namespace peeracle
+ * @brief peeracle namespace
+ */
+namespace peeracle {
+
+/**
+ * Leveled logging facility.
+ * \addtogroup Utils
+ *
+ * Logging never blocks on I/O: records are copied into a fixed size
+ * lock-free ring buffer and handed to the sink by a drain thread. Records
+ * logged while the buffer is full are dropped and counted.
+ */
+class Logger {
+ public:
+  enum Level {
+    kVerbose = 0,
+    kInfo = 1,
+    kWarning = 2,
+    kError = 3,
+    kNone = 4
+  };
+
+  /**
+   * Number of records the ring buffer holds.
+   */
+  static const size_t kCapacity = 1024;
+
+  /**
+   * Maximum length of a record, longer records are truncated.
+   */
+  static const size_t kMaxLength = 255;
+
+  /**
+   * Start the drain thread, records queued so far are delivered.
+   * \return false if the thread is already running or could not be started.
+   */
+  static bool start();
+
+  /**
+   * Deliver the queued records and join the drain thread.
+   */
+  static void stop();
+
+  /**
+   * Deliver the queued records from the calling thread.
+   */
+  static void flush();
+
+  /**
+   * Set the runtime threshold, records below \p level are discarded before
+   * being formatted. Defaults to kInfo.
+   */
+  static void setLevel(Level level);
+  static bool isEnabled(Level level);
+
+  /**
+   * Set the sink receiving the records, or NULL to write them to stderr. The
+   * logger does not take ownership of the sink.
+   */
+  static void setSink(LogSinkInterface *sink);
+
+  /**
+   * Queue a record.
+   * \return false if the ring buffer is full and the record was dropped.
+   */
+  static bool push(Level level, const char *message, size_t length);
+
+  /**
+   * Get the number of records dropped because the ring buffer was full.
+   */
+  static uint32_t getDroppedCount();
+
+ private:
+  class LoggerImpl;
+  static LoggerImpl _impl;
+  static volatile int _level;
+};
+
+class LogMessage {
+ public:
+  LogMessage(Logger::Level level, const char *file, int line);
+  ~LogMessage();
+
+  std::ostream &stream();
+
+ private:
+  Logger::Level _level;
+  std::ostringstream _stream;
+};
+
+/**
+ * Turns the stream expression of PEERACLE_LOG into void, so that both
+ * branches of its conditional have the same type.
+ */
+class LogMessageVoidify {
+ public:
+  void operator&(const std::ostream &) {}
+};
+
+/**
+ * @}
+ */
+}  // namespace peeracle
+
+#endif  // PEERACLE_UTILS_LOGGER_H_
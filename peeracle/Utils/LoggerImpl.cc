@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#if defined(WEBRTC_WIN)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#endif  // WEBRTC_WIN
+
+#include <cstdio>
+#include <cstring>
+#include "peeracle/Utils/LoggerImpl.h"
+
+namespace peeracle {
+
+static const int kDrainInterval = 50;
+static const uint32_t kMask = Logger::kCapacity - 1;
+
+static uint32_t atomicLoad(volatile uint32_t *value) {
+#if defined(WEBRTC_WIN)
+  return static_cast<uint32_t>(
+    InterlockedCompareExchange(reinterpret_cast<volatile LONG *>(value), 0,
+                               0));
+#else
+  return __sync_val_compare_and_swap(value, 0, 0);
+#endif  // WEBRTC_WIN
+}
+
+static void atomicStore(volatile uint32_t *value, uint32_t newValue) {
+#if defined(WEBRTC_WIN)
+  InterlockedExchange(reinterpret_cast<volatile LONG *>(value),
+                      static_cast<LONG>(newValue));
+#else
+  uint32_t previous = atomicLoad(value);
+  uint32_t current;
+
+  while ((current = __sync_val_compare_and_swap(value, previous, newValue)) !=
+         previous) {
+    previous = current;
+  }
+#endif  // WEBRTC_WIN
+}
+
+static uint32_t atomicCompareAndSwap(volatile uint32_t *value,
+                                     uint32_t expected, uint32_t newValue) {
+#if defined(WEBRTC_WIN)
+  return static_cast<uint32_t>(
+    InterlockedCompareExchange(reinterpret_cast<volatile LONG *>(value),
+                               static_cast<LONG>(newValue),
+                               static_cast<LONG>(expected)));
+#else
+  return __sync_val_compare_and_swap(value, expected, newValue);
+#endif  // WEBRTC_WIN
+}
+
+static void atomicIncrement(volatile uint32_t *value) {
+#if defined(WEBRTC_WIN)
+  InterlockedIncrement(reinterpret_cast<volatile LONG *>(value));
+#else
+  __sync_fetch_and_add(value, 1);
+#endif  // WEBRTC_WIN
+}
+
+Logger::LoggerImpl::LoggerImpl() : _enqueuePos(0), _dequeuePos(0),
+                                   _dropped(0), _wakeup(false, false),
+                                   _thread(NULL), _sink(NULL),
+                                   _stopping(false) {
+  for (uint32_t i = 0; i < kCapacity; ++i) {
+    _slots[i].sequence = i;
+  }
+}
+
+Logger::LoggerImpl::~LoggerImpl() {
+  Stop();
+}
+
+bool Logger::LoggerImpl::Start() {
+  if (_thread) {
+    return false;
+  }
+
+  _stopping = false;
+  _thread = new rtc::Thread();
+  _thread->SetName("peeracle_logger", this);
+  if (!_thread->Start(this)) {
+    delete _thread;
+    _thread = NULL;
+    return false;
+  }
+  return true;
+}
+
+void Logger::LoggerImpl::Stop() {
+  if (_thread) {
+    {
+      rtc::CritScope scope(&_drainLock);
+      _stopping = true;
+    }
+    _wakeup.Set();
+    _thread->Stop();
+    delete _thread;
+    _thread = NULL;
+  }
+  Drain();
+}
+
+void Logger::LoggerImpl::Flush() {
+  Drain();
+}
+
+void Logger::LoggerImpl::SetSink(LogSinkInterface *sink) {
+  rtc::CritScope scope(&_drainLock);
+  _sink = sink;
+}
+
+bool Logger::LoggerImpl::Push(Level level, const char *message,
+                              size_t length) {
+  uint32_t pos = atomicLoad(&_enqueuePos);
+  Slot *slot;
+
+  for (;;) {
+    uint32_t sequence;
+    int32_t diff;
+
+    slot = &_slots[pos & kMask];
+    sequence = atomicLoad(&slot->sequence);
+    diff = static_cast<int32_t>(sequence - pos);
+
+    if (diff == 0) {
+      uint32_t previous = atomicCompareAndSwap(&_enqueuePos, pos, pos + 1);
+
+      if (previous == pos) {
+        break;
+      }
+      pos = previous;
+    } else if (diff < 0) {
+      atomicIncrement(&_dropped);
+      return false;
+    } else {
+      pos = atomicLoad(&_enqueuePos);
+    }
+  }
+
+  if (length > kMaxLength) {
+    length = kMaxLength;
+  }
+
+  slot->level = level;
+  slot->length = static_cast<uint32_t>(length);
+  memcpy(slot->message, message, length);
+  slot->message[length] = '\0';
+  atomicStore(&slot->sequence, pos + 1);
+  return true;
+}
+
+uint32_t Logger::LoggerImpl::GetDroppedCount() {
+  return atomicLoad(&_dropped);
+}
+
+void Logger::LoggerImpl::Drain() {
+  rtc::CritScope scope(&_drainLock);
+
+  for (;;) {
+    Slot *slot = &_slots[_dequeuePos & kMask];
+
+    if (static_cast<int32_t>(atomicLoad(&slot->sequence) -
+                             (_dequeuePos + 1)) < 0) {
+      break;
+    }
+
+    if (_sink) {
+      _sink->onLog(slot->level, slot->message, slot->length);
+    } else {
+      fwrite(slot->message, 1, slot->length, stderr);
+      fputc('\n', stderr);
+    }
+
+    atomicStore(&slot->sequence, _dequeuePos + kCapacity);
+    ++_dequeuePos;
+  }
+}
+
+void Logger::LoggerImpl::Run(rtc::Thread *thread) {
+  for (;;) {
+    _wakeup.Wait(kDrainInterval);
+    Drain();
+
+    rtc::CritScope scope(&_drainLock);
+    if (_stopping) {
+      break;
+    }
+  }
+}
+
+}  // namespace peeracle
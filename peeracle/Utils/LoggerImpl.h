@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_UTILS_LOGGERIMPL_H_
+#define PEERACLE_UTILS_LOGGERIMPL_H_
+
+#include "third_party/webrtc/webrtc/base/criticalsection.h"
+#include "third_party/webrtc/webrtc/base/event.h"
+#include "third_party/webrtc/webrtc/base/thread.h"
+#include "peeracle/Utils/Logger.h"
+
+namespace peeracle {
+
+/**
+ * Bounded multiple producer ring buffer. Each slot carries a sequence number
+ * telling whether it is free for the producer at a given position or filled
+ * for the consumer, so producers only contend on one compare and swap and
+ * never take a lock. The consumer side is serialized by _drainLock.
+ */
+class Logger::LoggerImpl
+  : public rtc::Runnable {
+ public:
+  LoggerImpl();
+  ~LoggerImpl();
+
+  bool Start();
+  void Stop();
+  void Flush();
+  void SetSink(LogSinkInterface *sink);
+  bool Push(Level level, const char *message, size_t length);
+  uint32_t GetDroppedCount();
+
+  void Run(rtc::Thread *thread);
+
+ private:
+  struct Slot {
+    volatile uint32_t sequence;
+    int level;
+    uint32_t length;
+    char message[kMaxLength + 1];
+  };
+
+  void Drain();
+
+  Slot _slots[kCapacity];
+  volatile uint32_t _enqueuePos;
+  uint32_t _dequeuePos;
+  volatile uint32_t _dropped;
+
+  rtc::CriticalSection _drainLock;
+  rtc::Event _wakeup;
+  rtc::Thread *_thread;
+  LogSinkInterface *_sink;
+  bool _stopping;
+};
+
+}  // namespace peeracle
+
+#endif  // PEERACLE_UTILS_LOGGERIMPL_H_
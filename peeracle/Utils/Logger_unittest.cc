@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define PEERACLE_LOG_MIN_LEVEL 1
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/Utils/Logger.h"
+#include "peeracle/Utils/WorkerPool.h"
+
+namespace peeracle {
+
+class LoggerTest : public testing::Test {
+ protected:
+  class RecordSink : public LogSinkInterface {
+   public:
+    void onLog(int level, const char *message, size_t length) {
+      _levels.push_back(level);
+      _messages.push_back(std::string(message, length));
+    }
+
+    std::vector<int> _levels;
+    std::vector<std::string> _messages;
+  };
+
+  class LogTask : public WorkerPoolInterface::Task {
+   public:
+    void run() {
+      for (int i = 0; i < 1000; ++i) {
+        PEERACLE_LOG(Info) << "message " << i;
+      }
+    }
+  };
+
+  virtual void SetUp() {
+    Logger::flush();
+    Logger::setSink(&_sink);
+    Logger::setLevel(Logger::kInfo);
+  }
+
+  virtual void TearDown() {
+    Logger::stop();
+    Logger::setSink(NULL);
+    Logger::setLevel(Logger::kInfo);
+  }
+
+  static int count(int *calls) {
+    return ++*calls;
+  }
+
+  RecordSink _sink;
+};
+
+TEST_F(LoggerTest, Format) {
+  PEERACLE_LOG(Warning) << "value " << 42;
+  EXPECT_TRUE(_sink._messages.empty());
+
+  Logger::flush();
+  ASSERT_EQ(1, _sink._messages.size());
+  EXPECT_EQ(Logger::kWarning, _sink._levels[0]);
+  EXPECT_EQ(0, _sink._messages[0].find("W Logger_unittest.cc:"));
+  EXPECT_NE(std::string::npos, _sink._messages[0].find("] value 42"));
+}
+
+TEST_F(LoggerTest, RuntimeLevel) {
+  int calls = 0;
+
+  Logger::setLevel(Logger::kError);
+  PEERACLE_LOG(Warning) << count(&calls);
+  PEERACLE_LOG(Error) << count(&calls);
+  Logger::flush();
+
+  EXPECT_EQ(1, calls);
+  EXPECT_EQ(1, _sink._messages.size());
+}
+
+TEST_F(LoggerTest, CompileTimeLevel) {
+  int calls = 0;
+
+  Logger::setLevel(Logger::kVerbose);
+  PEERACLE_LOG(Verbose) << count(&calls);
+  Logger::flush();
+
+  EXPECT_EQ(0, calls);
+  EXPECT_TRUE(_sink._messages.empty());
+}
+
+TEST_F(LoggerTest, Truncate) {
+  std::string message(Logger::kMaxLength * 2, 'x');
+
+  EXPECT_TRUE(Logger::push(Logger::kInfo, message.c_str(), message.size()));
+  Logger::flush();
+
+  ASSERT_EQ(1, _sink._messages.size());
+  EXPECT_EQ(Logger::kMaxLength, _sink._messages[0].size());
+}
+
+TEST_F(LoggerTest, DropWhenFull) {
+  uint32_t dropped = Logger::getDroppedCount();
+
+  for (size_t i = 0; i < Logger::kCapacity + 10; ++i) {
+    Logger::push(Logger::kInfo, "x", 1);
+  }
+  EXPECT_EQ(dropped + 10, Logger::getDroppedCount());
+
+  Logger::flush();
+  EXPECT_EQ(Logger::kCapacity, _sink._messages.size());
+  EXPECT_TRUE(Logger::push(Logger::kInfo, "x", 1));
+}
+
+TEST_F(LoggerTest, ConcurrentProducers) {
+  WorkerPool pool;
+  std::vector<LogTask> tasks(8);
+  uint32_t dropped = Logger::getDroppedCount();
+
+  ASSERT_TRUE(Logger::start());
+  EXPECT_FALSE(Logger::start());
+  ASSERT_TRUE(pool.start(4));
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    pool.post(&tasks[i]);
+  }
+  pool.wait();
+  Logger::stop();
+
+  EXPECT_EQ(tasks.size() * 1000,
+            _sink._messages.size() + Logger::getDroppedCount() - dropped);
+}
+
+}  // namespace peeracle
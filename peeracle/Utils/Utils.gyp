@@ -21,7 +21,8 @@
 
 {
   'includes': [
-    '../../build/common.gypi'
+    '../../build/common.gypi',
+    '../../third_party/webrtc/webrtc/build/common.gypi'
   ],
   'targets': [
     {
@@ -51,6 +52,36 @@
         'RandomGeneratorInterface.h',
       ],
     },
+    {
+      'target_name': 'peeracle_workerpool',
+      'type': 'static_library',
+      'standalone_static_library': 1,
+      'dependencies': [
+        '<(webrtc_depot_dir)/webrtc/base/base.gyp:rtc_base',
+      ],
+      'sources': [
+        'WorkerPool.cc',
+        'WorkerPool.h',
+        'WorkerPoolImpl.cc',
+        'WorkerPoolImpl.h',
+        'WorkerPoolInterface.h',
+      ],
+    },
+    {
+      'target_name': 'peeracle_logger',
+      'type': 'static_library',
+      'standalone_static_library': 1,
+      'dependencies': [
+        '<(webrtc_depot_dir)/webrtc/base/base.gyp:rtc_base',
+      ],
+      'sources': [
+        'LogSinkInterface.h',
+        'Logger.cc',
+        'Logger.h',
+        'LoggerImpl.cc',
+        'LoggerImpl.h',
+      ],
+    },
   ],
   'conditions': [
     ['build_tests == 1', {
@@ -59,11 +90,15 @@
           'target_name': 'peeracle_utils_unittest',
           'type': 'executable',
           'dependencies': [
+            'peeracle_logger',
             'peeracle_randomgenerator',
+            'peeracle_workerpool',
             '<(DEPTH)/test/test.gyp:peeracle_tests_utils',
           ],
           'sources': [
+            'Logger_unittest.cc',
             'RandomGenerator_unittest.cc',
+            'WorkerPool_unittest.cc',
           ],
         },
       ],
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#if defined(WEBRTC_WIN)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <unistd.h>
+#endif  // WEBRTC_WIN
+
+#include "peeracle/Utils/WorkerPool.h"
+#include "peeracle/Utils/WorkerPoolImpl.h"
+
+namespace peeracle {
+
+WorkerPool::WorkerPool() : _impl(new WorkerPoolImpl()) {
+}
+
+WorkerPool::~WorkerPool() {
+  delete _impl;
+}
+
+bool WorkerPool::start(size_t threadCount) {
+  return _impl->Start(threadCount);
+}
+
+void WorkerPool::stop() {
+  _impl->Stop();
+}
+
+void WorkerPool::post(Task *task) {
+  _impl->Post(task);
+}
+
+void WorkerPool::wait() {
+  _impl->Wait();
+}
+
+size_t WorkerPool::getThreadCount() const {
+  return _impl->GetThreadCount();
+}
+
+size_t WorkerPool::getProcessorCount() {
+#if defined(WEBRTC_WIN)
+  SYSTEM_INFO info;
+
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);  // NOLINT
+
+  return count > 0 ? static_cast<size_t>(count) : 1;
+#endif
+}
+
+}  // namespace peeracle
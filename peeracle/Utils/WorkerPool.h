@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_UTILS_WORKERPOOL_H_
+#define PEERACLE_UTILS_WORKERPOOL_H_
+
+#include "peeracle/Utils/WorkerPoolInterface.h"
+
+namespace peeracle {
+
+class WorkerPool
+  : public WorkerPoolInterface {
+ public:
+  WorkerPool();
+  ~WorkerPool();
+
+  bool start(size_t threadCount);
+  void stop();
+  void post(Task *task);
+  void wait();
+  size_t getThreadCount() const;
+
+  /**
+   * Get the number of processors available, at least 1.
+   */
+  static size_t getProcessorCount();
+
+ private:
+  class WorkerPoolImpl;
+  WorkerPoolImpl *_impl;
+};
+
+}  // namespace peeracle
+
+#endif  // PEERACLE_UTILS_WORKERPOOL_H_
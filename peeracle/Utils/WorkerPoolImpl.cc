@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "peeracle/Utils/WorkerPoolImpl.h"
+
+namespace peeracle {
+
+WorkerPool::WorkerPoolImpl::WorkerPoolImpl() : _wakeup(false, false),
+                                               _idle(true, true),
+                                               _pending(0),
+                                               _stopping(false) {
+}
+
+WorkerPool::WorkerPoolImpl::~WorkerPoolImpl() {
+  Stop();
+}
+
+bool WorkerPool::WorkerPoolImpl::Start(size_t threadCount) {
+  if (!_threads.empty()) {
+    return false;
+  }
+
+  _stopping = false;
+  for (size_t i = 0; i < threadCount; ++i) {
+    rtc::Thread *thread = new rtc::Thread();
+
+    thread->SetName("peeracle_worker", this);
+    if (!thread->Start(this)) {
+      delete thread;
+      Stop();
+      return false;
+    }
+    _threads.push_back(thread);
+  }
+
+  return !_threads.empty();
+}
+
+void WorkerPool::WorkerPoolImpl::Stop() {
+  if (_threads.empty()) {
+    return;
+  }
+
+  Wait();
+  {
+    rtc::CritScope scope(&_lock);
+    _stopping = true;
+  }
+  _wakeup.Set();
+
+  for (size_t i = 0; i < _threads.size(); ++i) {
+    _threads[i]->Stop();
+    delete _threads[i];
+  }
+  _threads.clear();
+}
+
+void WorkerPool::WorkerPoolImpl::Post(Task *task) {
+  {
+    rtc::CritScope scope(&_lock);
+    _tasks.push_back(task);
+    ++_pending;
+    _idle.Reset();
+  }
+  _wakeup.Set();
+}
+
+void WorkerPool::WorkerPoolImpl::Wait() {
+  _idle.Wait(rtc::kForever);
+}
+
+size_t WorkerPool::WorkerPoolImpl::GetThreadCount() const {
+  return _threads.size();
+}
+
+WorkerPoolInterface::Task *WorkerPool::WorkerPoolImpl::Next() {
+  for (;;) {
+    {
+      rtc::CritScope scope(&_lock);
+
+      if (!_tasks.empty()) {
+        Task *task = _tasks.front();
+
+        _tasks.pop_front();
+        if (!_tasks.empty()) {
+          // The wakeup event is auto-reset, pass it on to another worker.
+          _wakeup.Set();
+        }
+        return task;
+      }
+
+      if (_stopping) {
+        _wakeup.Set();
+        return NULL;
+      }
+    }
+
+    _wakeup.Wait(rtc::kForever);
+  }
+}
+
+void WorkerPool::WorkerPoolImpl::Run(rtc::Thread *thread) {
+  Task *task;
+
+  while ((task = Next()) != NULL) {
+    task->run();
+
+    rtc::CritScope scope(&_lock);
+    if (--_pending == 0) {
+      _idle.Set();
+    }
+  }
+}
+
+}  // namespace peeracle
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_UTILS_WORKERPOOLIMPL_H_
+#define PEERACLE_UTILS_WORKERPOOLIMPL_H_
+
+#include <deque>
+#include <vector>
+#include "third_party/webrtc/webrtc/base/criticalsection.h"
+#include "third_party/webrtc/webrtc/base/event.h"
+#include "third_party/webrtc/webrtc/base/thread.h"
+#include "peeracle/Utils/WorkerPool.h"
+
+namespace peeracle {
+
+class WorkerPool::WorkerPoolImpl
+  : public rtc::Runnable {
+ public:
+  WorkerPoolImpl();
+  ~WorkerPoolImpl();
+
+  bool Start(size_t threadCount);
+  void Stop();
+  void Post(Task *task);
+  void Wait();
+  size_t GetThreadCount() const;
+
+  void Run(rtc::Thread *thread);
+
+ private:
+  Task *Next();
+
+  rtc::CriticalSection _lock;
+  rtc::Event _wakeup;
+  rtc::Event _idle;
+  std::deque<Task *> _tasks;
+  std::vector<rtc::Thread *> _threads;
+  size_t _pending;
+  bool _stopping;
+};
+
+}  // namespace peeracle
+
+#endif  // PEERACLE_UTILS_WORKERPOOLIMPL_H_
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PEERACLE_UTILS_WORKERPOOLINTERFACE_H_
+#define PEERACLE_UTILS_WORKERPOOLINTERFACE_H_
+
+#include <cstdlib>
+
+namespace peeracle {
+
+class WorkerPoolInterface {
+ public:
+  class Task {
+   public:
+    virtual void run() = 0;
+    virtual ~Task() {}
+  };
+
+  virtual ~WorkerPoolInterface() {}
+
+  /**
+   * Start \p threadCount worker threads.
+   * \return false if the threads could not be started.
+   */
+  virtual bool start(size_t threadCount) = 0;
+
+  /**
+   * Wait for the queued tasks to complete and join the worker threads.
+   */
+  virtual void stop() = 0;
+
+  /**
+   * Queue a \p task, it is run once by one of the worker threads. The pool
+   * does not take ownership of the task.
+   */
+  virtual void post(Task *task) = 0;
+
+  /**
+   * Block until every task posted so far has been run.
+   */
+  virtual void wait() = 0;
+
+  virtual size_t getThreadCount() const = 0;
+};
+
+}  // namespace peeracle
+
+#endif  // PEERACLE_UTILS_WORKERPOOLINTERFACE_H_
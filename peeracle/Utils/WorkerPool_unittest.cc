@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <vector>
+#include "third_party/googletest/gtest/include/gtest/gtest.h"
+#include "peeracle/Utils/WorkerPool.h"
+
+namespace peeracle {
+
+class WorkerPoolTest : public testing::Test {
+ protected:
+  class CountTask : public WorkerPoolInterface::Task {
+   public:
+    CountTask() : _runs(0) {
+    }
+
+    void run() {
+      ++_runs;
+    }
+
+    int _runs;
+  };
+
+  virtual void SetUp() {
+    _pool = new WorkerPool();
+  }
+
+  virtual void TearDown() {
+    delete _pool;
+  }
+
+  WorkerPool *_pool;
+};
+
+TEST_F(WorkerPoolTest, RunAllTasks) {
+  std::vector<CountTask> tasks(1000);
+
+  ASSERT_TRUE(_pool->start(4));
+  EXPECT_EQ(4, _pool->getThreadCount());
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    _pool->post(&tasks[i]);
+  }
+  _pool->wait();
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    EXPECT_EQ(1, tasks[i]._runs);
+  }
+}
+
+TEST_F(WorkerPoolTest, StopRunsPendingTasks) {
+  std::vector<CountTask> tasks(100);
+
+  ASSERT_TRUE(_pool->start(2));
+  EXPECT_FALSE(_pool->start(2));
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    _pool->post(&tasks[i]);
+  }
+  _pool->stop();
+  EXPECT_EQ(0, _pool->getThreadCount());
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    EXPECT_EQ(1, tasks[i]._runs);
+  }
+
+  _pool->stop();
+  ASSERT_TRUE(_pool->start(1));
+}
+
+TEST_F(WorkerPoolTest, ProcessorCount) {
+  EXPECT_GE(WorkerPool::getProcessorCount(), 1);
+}
+
+}  // namespace peeracle
@@ -22,6 +22,7 @@
 
 #include "third_party/webrtc/webrtc/base/ssladapter.h"
 #include "peeracle/peeracle.h"
+#include "peeracle/Utils/Logger.h"
 
 namespace peeracle {
 
@@ -42,6 +43,7 @@ webrtc::PeerConnectionFactoryInterface *getPeerConnectionFactory() {
 }
 
 bool init() {
+  Logger::start();
   rtc::InitializeSSL();
   rtc::ThreadManager::Instance()->WrapCurrentThread();
 
@@ -77,7 +79,10 @@ bool cleanup() {
   _signalingThread = NULL;
   _workerThread = NULL;
 
-  return rtc::CleanupSSL();
+  bool result = rtc::CleanupSSL();
+
+  Logger::stop();
+  return result;
 }
 
 }  // namespace peeracle
@@ -29,12 +29,14 @@
       'type': 'static_library',
       'standalone_static_library': 1,
       'dependencies': [
+        'Chunker/Chunker.gyp:*',
         'DataStream/DataStream.gyp:*',
         'Hash/Hash.gyp:*',
         'Media/Media.gyp:*',
         'Metadata/Metadata.gyp:*',
         'Peer/Peer.gyp:*',
         'Session/Session.gyp:*',
+        'StreamSelector/StreamSelector.gyp:*',
         'Tracker/Tracker.gyp:*',
         'Utils/Utils.gyp:*',
       ],
@@ -20,11 +20,17 @@
  * SOFTWARE.
  */
 
+#include "peeracle/StreamSelector/AdaptiveStreamSelector.h"
 #include "samples/vlc-plugin/PeeracleStream.h"
 
 PeeracleStream::PeeracleStream(demux_t *vlc,
                                peeracle::MetadataInterface *metadata) :
-  _vlc(vlc), _metadata(metadata), _demuxStream(NULL), _esOut(NULL) {
+  _vlc(vlc), _metadata(metadata), _demuxStream(NULL), _esOut(NULL),
+  _stream(0), _segment(0), _selected(false) {
+  peeracle::AdaptiveStreamSelectorInit selectorInit;
+
+  selectorInit.contentType = "video";
+  _selector = new peeracle::AdaptiveStreamSelector(metadata, selectorInit);
   vlc_mutex_init(&_lock);
 }
 
@@ -36,6 +42,8 @@ PeeracleStream::~PeeracleStream() {
   if (_esOut) {
     delete _esOut;
   }
+
+  delete _selector;
 }
 
 bool PeeracleStream::init() {
@@ -62,10 +70,11 @@ PeeracleManagerInterface::Status PeeracleStream::Demux(mtime_t deadline) {
   /*static bool sent = false;
 
   if (!sent) {
-    uint32_t length = _metadata->getStreams()[0]->getInitSegmentLength();
+    uint32_t length =
+      _metadata->getStreams()[_stream]->getInitSegmentLength();
     block_t *block = block_Alloc(length);
 
-    memcpy(block->p_buffer, _metadata->getStreams()[0]->getInitSegment(),
+    memcpy(block->p_buffer, _metadata->getStreams()[_stream]->getInitSegment(),
            length);
     block->i_buffer = length;
     stream_DemuxSend(_demuxStream, block);
@@ -86,14 +95,50 @@ int PeeracleStream::GetGroup() {
 }
 
 bool PeeracleStream::IsLive() {
-  return false;
+  return _metadata->isLive();
 }
 
 bool PeeracleStream::IsSeekable() {
-  return true;
+  return !_metadata->isLive();
 }
 
 bool PeeracleStream::SetPosition(int64_t time) {
+  uint32_t timecodeScale = _metadata->getTimecodeScale();
+  uint64_t timecode;
+  uint32_t stream;
+  uint32_t segment;
+  bool found;
+
+  if (!timecodeScale || time < 0) {
+    return false;
+  }
+
+  // VLC times are in microseconds, the timecode scale in nanoseconds.
+  timecode = static_cast<uint64_t>(time) * 1000 / timecodeScale;
+  if (timecode > 0xFFFFFFFF) {
+    timecode = 0xFFFFFFFF;
+  }
+
+  // The plugin does not download segments yet, so it has no throughput
+  // samples nor buffer level to feed the selector, which would fall back
+  // to the lowest stream on an empty buffer. The stream is chosen once
+  // from the initial throughput, later seeks only move within it.
+  stream = _stream;
+  if (!_selected) {
+    _selected = _selector->select(static_cast<uint32_t>(timecode), &stream,
+                                  &segment);
+    found = _selected;
+  } else {
+    found = _metadata->getStreams()[stream]->findSegmentByTimecode(
+      static_cast<uint32_t>(timecode), &segment);
+  }
+
+  if (!found) {
+    segment = 0;
+  }
+
+  _stream = stream;
+  _segment = segment;
   return true;
 }
 
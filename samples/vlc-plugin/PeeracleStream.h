@@ -24,6 +24,7 @@
 #define SAMPLES_VLC_PLUGIN_PEERACLESTREAM_H_
 
 #include "peeracle/Metadata/MetadataInterface.h"
+#include "peeracle/StreamSelector/StreamSelectorInterface.h"
 #include "samples/vlc-plugin/plugin.h"
 #include "samples/vlc-plugin/PeeracleStreamInterface.h"
 
@@ -45,12 +46,16 @@ class PeeracleStream :
  private:
   demux_t *_vlc;
   peeracle::MetadataInterface *_metadata;
+  peeracle::StreamSelectorInterface *_selector;
   stream_t *_demuxStream;
   es_out_t *_esOut;
   vlc_mutex_t _lock;
 
   mtime_t _pcr;
   int _group;
+  uint32_t _stream;
+  uint32_t _segment;
+  bool _selected;
 
   static es_out_id_t *esOutAdd(es_out_t *es, const es_format_t *fmt);
   static int esOutSend(es_out_t *es, es_out_id_t *id, block_t *block);
@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#elif defined(__APPLE__)
+#  include <mach/mach_time.h>
+#else
+#  include <time.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include "test/benchmark.h"
+
+namespace peeracle {
+
+int64_t Benchmark::now() {
+#if defined(_WIN32)
+  LARGE_INTEGER counter;
+  LARGE_INTEGER frequency;
+
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+  return static_cast<int64_t>(static_cast<double>(counter.QuadPart) *
+                              1e9 / static_cast<double>(frequency.QuadPart));
+#elif defined(__APPLE__)
+  static mach_timebase_info_data_t timebase;
+
+  if (!timebase.denom) {
+    mach_timebase_info(&timebase);
+  }
+  return static_cast<int64_t>(mach_absolute_time() * timebase.numer /
+                              timebase.denom);
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+double Benchmark::measure(Case *benchmarkCase, int64_t minNanos) {
+  int64_t start;
+  int64_t elapsed;
+  uint64_t runs = 0;
+
+  // Warm up the caches and the allocator once before timing.
+  benchmarkCase->run();
+
+  start = now();
+  do {
+    benchmarkCase->run();
+    ++runs;
+    elapsed = now() - start;
+  } while (elapsed < minNanos);
+
+  return static_cast<double>(elapsed) / static_cast<double>(runs);
+}
+
+static std::string format(double value, const char *const *units,
+                          int unitCount, double step) {
+  char buffer[32];
+  int unit = 0;
+
+  while (value >= step && unit < unitCount - 1) {
+    value /= step;
+    ++unit;
+  }
+
+  snprintf(buffer, sizeof(buffer), unit ? "%.1f" : "%.0f", value);
+  if (!*units[unit]) {
+    return buffer;
+  }
+  return std::string(buffer) + " " + units[unit];
+}
+
+std::string Benchmark::formatSize(double bytes) {
+  static const char *const units[] = { "B", "KB", "MB", "GB" };
+
+  return format(bytes, units, 4, 1024.0);
+}
+
+std::string Benchmark::formatRate(double bytesPerSecond) {
+  static const char *const units[] = { "B/s", "KB/s", "MB/s", "GB/s" };
+
+  return format(bytesPerSecond, units, 4, 1024.0);
+}
+
+std::string Benchmark::formatTime(double nanos) {
+  static const char *const units[] = { "ns", "us", "ms", "s" };
+
+  return format(nanos, units, 4, 1000.0);
+}
+
+std::string Benchmark::formatCount(double count) {
+  static const char *const units[] = { "", "K", "M", "G" };
+
+  return format(count, units, 4, 1000.0);
+}
+
+BenchmarkTable::BenchmarkTable(const std::string &title) : _title(title) {
+}
+
+void BenchmarkTable::addColumn(const std::string &name) {
+  _columns.push_back(name);
+}
+
+void BenchmarkTable::addRow() {
+  _rows.push_back(std::vector<std::string>());
+}
+
+void BenchmarkTable::addCell(const std::string &value) {
+  _rows.back().push_back(value);
+}
+
+void BenchmarkTable::print(std::ostream *out) const {
+  std::vector<size_t> widths;
+
+  for (size_t c = 0; c < _columns.size(); ++c) {
+    widths.push_back(_columns[c].size());
+  }
+
+  for (size_t r = 0; r < _rows.size(); ++r) {
+    for (size_t c = 0; c < _rows[r].size() && c < widths.size(); ++c) {
+      if (_rows[r][c].size() > widths[c]) {
+        widths[c] = _rows[r][c].size();
+      }
+    }
+  }
+
+  *out << _title << std::endl;
+  for (size_t c = 0; c < _columns.size(); ++c) {
+    *out << (c ? " | " : "") << std::string(widths[c] - _columns[c].size(), ' ')
+        << _columns[c];
+  }
+  *out << std::endl;
+
+  for (size_t c = 0; c < _columns.size(); ++c) {
+    *out << (c ? "-+-" : "") << std::string(widths[c], '-');
+  }
+  *out << std::endl;
+
+  for (size_t r = 0; r < _rows.size(); ++r) {
+    for (size_t c = 0; c < _rows[r].size() && c < widths.size(); ++c) {
+      *out << (c ? " | " : "") << std::string(widths[c] - _rows[r][c].size(),
+                                             ' ') << _rows[r][c];
+    }
+    *out << std::endl;
+  }
+  *out << std::endl;
+}
+
+static const uint32_t kSegment = 0x18538067;
+static const uint32_t kSeekHead = 0x114D9B74;
+static const uint32_t kSeek = 0x4DBB;
+static const uint32_t kSeekID = 0x53AB;
+static const uint32_t kSeekPosition = 0x53AC;
+static const uint32_t kInfo = 0x1549A966;
+static const uint32_t kTimecodeScale = 0x2AD7B1;
+static const uint32_t kTracks = 0x1654AE6B;
+static const uint32_t kCluster = 0x1F43B675;
+static const uint32_t kTimecode = 0xE7;
+static const uint32_t kSimpleBlock = 0xA3;
+static const uint32_t kCues = 0x1C53BB6B;
+static const uint32_t kCuePoint = 0xBB;
+static const uint32_t kCueTime = 0xB3;
+static const uint32_t kCueTrackPositions = 0xB7;
+static const uint32_t kCueTrack = 0xF7;
+static const uint32_t kCueClusterPosition = 0xF1;
+
+const uint64_t SyntheticMedia::kUnknownSize = 0xFFFFFFFFFFFFFFFFULL;
+
+SyntheticMedia::SyntheticMedia(uint32_t segmentCount,
+                               uint32_t segmentDuration,
+                               uint32_t framesPerSegment)
+  : _segmentCount(segmentCount), _segmentDuration(segmentDuration),
+    _framesPerSegment(framesPerSegment) {
+}
+
+SyntheticMedia::~SyntheticMedia() {
+}
+
+uint32_t SyntheticMedia::getFrameLength(uint32_t segment, uint32_t frame) {
+  return frame ? 64 + (segment * 31 + frame * 17) % 256 : 4096;
+}
+
+void SyntheticMedia::fillFrame(uint32_t segment, uint32_t frame,
+                               std::vector<uint8_t> *payload) {
+  std::fill(payload->begin(), payload->end(), 0x5A);
+  if (payload->size() >= 4) {
+    (*payload)[0] = 0x81;
+    (*payload)[1] = 0;
+    (*payload)[2] = 0;
+    (*payload)[3] = frame ? 0 : 0x80;
+  }
+}
+
+void SyntheticMedia::writeWebM(bool cues, bool seekHead,
+                               std::vector<uint8_t> *out) {
+  std::vector<uint8_t> segment;
+  std::vector<uint8_t> head;
+  std::vector<uint8_t> info;
+  std::vector<uint8_t> tracks(4400, 0x42);
+  std::vector<uint8_t> cuePoints;
+  std::vector<uint64_t> positions;
+
+  // The Cues position is written on 4 bytes, the SeekHead size does not
+  // depend on it.
+  if (cues && seekHead) {
+    _putSeekHead(0, &segment);
+  }
+  putUnsigned(kTimecodeScale, 1000000, 4, &info);
+  putElement(kInfo, info, &segment);
+  putElement(kTracks, tracks, &segment);
+  _writeClusters(&segment, &positions);
+
+  for (uint32_t s = 0; cues && s < _segmentCount; ++s) {
+    std::vector<uint8_t> point;
+    std::vector<uint8_t> trackPositions;
+
+    putUnsigned(kCueTrack, 1, 4, &trackPositions);
+    putUnsigned(kCueClusterPosition, positions[s], 4, &trackPositions);
+    putUnsigned(kCueTime, s * _segmentDuration, 4, &point);
+    putElement(kCueTrackPositions, trackPositions, &point);
+    putElement(kCuePoint, point, &cuePoints);
+  }
+  if (cues && seekHead) {
+    _putSeekHead(segment.size(), &head);
+    std::copy(head.begin(), head.end(), segment.begin());
+  }
+  if (cues) {
+    putElement(kCues, cuePoints, &segment);
+  }
+
+  out->clear();
+  out->push_back(0x1A);
+  out->push_back(0x45);
+  out->push_back(0xDF);
+  out->push_back(0xA3);
+  out->push_back(0x80);
+  putElement(kSegment, segment, out);
+}
+
+void SyntheticMedia::writeClusters(std::vector<uint8_t> *out) {
+  std::vector<uint64_t> positions;
+
+  _writeClusters(out, &positions);
+}
+
+void SyntheticMedia::writeMP4(bool sidx, std::vector<uint8_t> *out) {
+  std::vector<uint8_t> fragments;
+  std::vector<uint8_t> payload;
+  std::vector<uint8_t> trak;
+  std::vector<uint8_t> mdia;
+  std::vector<uint8_t> moov;
+  std::vector<uint8_t> references;
+
+  for (uint32_t s = 0; s < _segmentCount; ++s) {
+    std::vector<uint8_t> mdat;
+    size_t start = fragments.size();
+
+    _putMoof(s, &fragments);
+    for (uint32_t f = 0; f < _framesPerSegment; ++f) {
+      std::vector<uint8_t> frame(getFrameLength(s, f));
+
+      fillFrame(s, f, &frame);
+      mdat.insert(mdat.end(), frame.begin(), frame.end());
+    }
+    putBox("mdat", mdat, &fragments);
+
+    put32(static_cast<uint32_t>(fragments.size() - start), &references);
+    put32(_segmentDuration * (kTimescale / 1000), &references);
+    put32(0x90000000, &references);
+  }
+
+  out->clear();
+  payload.insert(payload.end(), "iso6", "iso6" + 4);
+  put32(0, &payload);
+  putBox("ftyp", payload, out);
+
+  payload.clear();
+  put32(0, &payload);
+  put32(0, &payload);
+  put32(1, &payload);
+  payload.resize(80);
+  putFullBox("tkhd", 0, 3, payload, &trak);
+  payload.clear();
+  put32(0, &payload);
+  put32(0, &payload);
+  put32(kTimescale, &payload);
+  put32(0, &payload);
+  payload.resize(20);
+  putFullBox("mdhd", 0, 0, payload, &mdia);
+  putBox("mdia", mdia, &trak);
+  putBox("trak", trak, &moov);
+  putBox("moov", moov, out);
+
+  if (sidx) {
+    payload.clear();
+    put32(1, &payload);
+    put32(kTimescale, &payload);
+    put32(0, &payload);
+    put32(0, &payload);
+    put32(_segmentCount & 0xFFFF, &payload);
+    payload.insert(payload.end(), references.begin(), references.end());
+    putFullBox("sidx", 0, 0, payload, out);
+  }
+
+  out->insert(out->end(), fragments.begin(), fragments.end());
+}
+
+void SyntheticMedia::putId(uint32_t id, std::vector<uint8_t> *out) {
+  int shift = id > 0xFFFFFF ? 24 : id > 0xFFFF ? 16 : id > 0xFF ? 8 : 0;
+
+  for (; shift >= 0; shift -= 8) {
+    out->push_back(static_cast<uint8_t>(id >> shift));
+  }
+}
+
+void SyntheticMedia::putSize(uint64_t size, int length,
+                             std::vector<uint8_t> *out) {
+  if (size == kUnknownSize) {
+    out->push_back(0x01);
+    out->insert(out->end(), 7, 0xFF);
+    return;
+  }
+
+  while (!length || size >= (1ULL << (7 * length)) - 1) {
+    ++length;
+  }
+
+  for (int i = length - 1; i >= 0; --i) {
+    uint8_t byte = static_cast<uint8_t>(size >> (8 * i));
+
+    if (i == length - 1) {
+      byte |= 0x80 >> (length - 1);
+    }
+    out->push_back(byte);
+  }
+}
+
+void SyntheticMedia::putElement(uint32_t id,
+                                const std::vector<uint8_t> &payload,
+                                std::vector<uint8_t> *out,
+                                bool unknownSize) {
+  putId(id, out);
+  putSize(unknownSize ? kUnknownSize : payload.size(), 0, out);
+  out->insert(out->end(), payload.begin(), payload.end());
+}
+
+void SyntheticMedia::putUnsigned(uint32_t id, uint64_t value, int length,
+                                 std::vector<uint8_t> *out) {
+  std::vector<uint8_t> payload;
+
+  for (int i = length - 1; i >= 0; --i) {
+    payload.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+  putElement(id, payload, out);
+}
+
+void SyntheticMedia::put32(uint32_t value, std::vector<uint8_t> *out) {
+  for (int i = 3; i >= 0; --i) {
+    out->push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void SyntheticMedia::put64(uint64_t value, std::vector<uint8_t> *out) {
+  put32(static_cast<uint32_t>(value >> 32), out);
+  put32(static_cast<uint32_t>(value), out);
+}
+
+void SyntheticMedia::putBox(const char *type,
+                            const std::vector<uint8_t> &payload,
+                            std::vector<uint8_t> *out) {
+  put32(static_cast<uint32_t>(payload.size() + 8), out);
+  out->insert(out->end(), type, type + 4);
+  out->insert(out->end(), payload.begin(), payload.end());
+}
+
+void SyntheticMedia::putFullBox(const char *type, uint8_t version,
+                                uint32_t flags,
+                                const std::vector<uint8_t> &payload,
+                                std::vector<uint8_t> *out) {
+  std::vector<uint8_t> full;
+
+  put32(static_cast<uint32_t>(version) << 24 | flags, &full);
+  full.insert(full.end(), payload.begin(), payload.end());
+  putBox(type, full, out);
+}
+
+void SyntheticMedia::_writeClusters(std::vector<uint8_t> *out,
+                                    std::vector<uint64_t> *positions) {
+  for (uint32_t s = 0; s < _segmentCount; ++s) {
+    std::vector<uint8_t> cluster;
+
+    positions->push_back(out->size());
+    putUnsigned(kTimecode, s * _segmentDuration, 4, &cluster);
+    for (uint32_t f = 0; f < _framesPerSegment; ++f) {
+      std::vector<uint8_t> block(getFrameLength(s, f));
+
+      fillFrame(s, f, &block);
+      putElement(kSimpleBlock, block, &cluster);
+    }
+    putElement(kCluster, cluster, out);
+  }
+}
+
+void SyntheticMedia::_putSeekHead(uint64_t cuesPosition,
+                                  std::vector<uint8_t> *out) {
+  std::vector<uint8_t> seek;
+  std::vector<uint8_t> seekHead;
+
+  putUnsigned(kSeekID, kCues, 4, &seek);
+  putUnsigned(kSeekPosition, cuesPosition, 4, &seek);
+  putElement(kSeek, seek, &seekHead);
+  putElement(kSeekHead, seekHead, out);
+}
+
+// Build a moof box of one track fragment run, whose data offset points
+// past the header of the mdat box that follows.
+void SyntheticMedia::_putMoof(uint32_t segment, std::vector<uint8_t> *out) {
+  std::vector<uint8_t> moof;
+
+  // The first pass gives the size of the moof box, and the data offset.
+  for (uint32_t dataOffset = 0; ;
+       dataOffset = static_cast<uint32_t>(moof.size() + 16)) {
+    std::vector<uint8_t> traf;
+    std::vector<uint8_t> payload;
+
+    moof.clear();
+    put32(segment + 1, &payload);
+    putFullBox("mfhd", 0, 0, payload, &moof);
+
+    payload.clear();
+    put32(1, &payload);
+    putFullBox("tfhd", 0, 0x20000, payload, &traf);
+    payload.clear();
+    put64(static_cast<uint64_t>(segment) * _segmentDuration * kTimescale /
+          1000, &payload);
+    putFullBox("tfdt", 1, 0, payload, &traf);
+    payload.clear();
+    put32(_framesPerSegment, &payload);
+    put32(dataOffset, &payload);
+    for (uint32_t f = 0; f < _framesPerSegment; ++f) {
+      put32(getFrameLength(segment, f), &payload);
+    }
+    putFullBox("trun", 0, 0x201, payload, &traf);
+    putBox("traf", traf, &moof);
+    if (dataOffset) {
+      break;
+    }
+  }
+
+  putBox("moof", moof, out);
+}
+
+}  // namespace peeracle
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2015 peeracle contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TEST_BENCHMARK_H_
+#define TEST_BENCHMARK_H_
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace peeracle {
+
+class Benchmark {
+ public:
+  class Case {
+   public:
+    virtual void run() = 0;
+    virtual ~Case() {}
+  };
+
+  /**
+   * Get a monotonic wall clock time in nanoseconds.
+   */
+  static int64_t now();
+
+  /**
+   * Run \p benchmarkCase repeatedly for at least \p minNanos nanoseconds.
+   * \return The average wall clock time of a single run in nanoseconds.
+   */
+  static double measure(Case *benchmarkCase, int64_t minNanos);
+
+  static std::string formatSize(double bytes);
+  static std::string formatRate(double bytesPerSecond);
+  static std::string formatTime(double nanos);
+  static std::string formatCount(double count);
+};
+
+class BenchmarkTable {
+ public:
+  explicit BenchmarkTable(const std::string &title);
+
+  void addColumn(const std::string &name);
+  void addRow();
+  void addCell(const std::string &value);
+  void print(std::ostream *out) const;
+
+ private:
+  std::string _title;
+  std::vector<std::string> _columns;
+  std::vector<std::vector<std::string> > _rows;
+};
+
+/**
+ * Write synthetic WebM and fragmented MP4 files of one video track for the
+ * benchmarks and the media tests. Segments last segmentDuration
+ * milliseconds and hold framesPerSegment frames, a key frame then smaller
+ * frames. Override getFrameLength() and fillFrame() to shape the frames.
+ */
+class SyntheticMedia {
+ public:
+  static const uint64_t kUnknownSize;
+  static const uint32_t kTimescale = 90000;
+
+  SyntheticMedia(uint32_t segmentCount, uint32_t segmentDuration,
+                 uint32_t framesPerSegment);
+  virtual ~SyntheticMedia();
+
+  /**
+   * Get the length of the frame \p frame of the segment \p segment.
+   */
+  virtual uint32_t getFrameLength(uint32_t segment, uint32_t frame);
+
+  /**
+   * Fill the \p payload of a frame, already sized to its length. The
+   * default writes a SimpleBlock header of the track 1, then dummy bytes.
+   */
+  virtual void fillFrame(uint32_t segment, uint32_t frame,
+                         std::vector<uint8_t> *payload);
+
+  /**
+   * Write a WebM file: an init segment of about 4.5 KB, then Clusters.
+   * With \p cues, Cues are written after the Clusters, and with
+   * \p seekHead a SeekHead at the start of the Segment points to them.
+   */
+  void writeWebM(bool cues, bool seekHead, std::vector<uint8_t> *out);
+
+  /**
+   * Append the Clusters alone to \p out, after an init segment of the
+   * caller.
+   */
+  void writeClusters(std::vector<uint8_t> *out);
+
+  /**
+   * Write a fragmented MP4 file of one moof and mdat box per segment, in a
+   * timescale of kTimescale. With \p sidx, a sidx box after the moov box
+   * indexes the fragments.
+   */
+  void writeMP4(bool sidx, std::vector<uint8_t> *out);
+
+  static void putId(uint32_t id, std::vector<uint8_t> *out);
+
+  /**
+   * Write \p size on \p length bytes, or on as few bytes as possible when
+   * \p length is 0. kUnknownSize writes the reserved unknown size.
+   */
+  static void putSize(uint64_t size, int length, std::vector<uint8_t> *out);
+  static void putElement(uint32_t id, const std::vector<uint8_t> &payload,
+                         std::vector<uint8_t> *out,
+                         bool unknownSize = false);
+  static void putUnsigned(uint32_t id, uint64_t value, int length,
+                          std::vector<uint8_t> *out);
+
+  static void put32(uint32_t value, std::vector<uint8_t> *out);
+  static void put64(uint64_t value, std::vector<uint8_t> *out);
+  static void putBox(const char *type, const std::vector<uint8_t> &payload,
+                     std::vector<uint8_t> *out);
+  static void putFullBox(const char *type, uint8_t version, uint32_t flags,
+                         const std::vector<uint8_t> &payload,
+                         std::vector<uint8_t> *out);
+
+ private:
+  void _writeClusters(std::vector<uint8_t> *out,
+                      std::vector<uint64_t> *positions);
+  void _putSeekHead(uint64_t cuesPosition, std::vector<uint8_t> *out);
+  void _putMoof(uint32_t segment, std::vector<uint8_t> *out);
+
+  uint32_t _segmentCount;
+  uint32_t _segmentDuration;
+  uint32_t _framesPerSegment;
+};
+
+}  // namespace peeracle
+
+#endif  // TEST_BENCHMARK_H_
@@ -62,5 +62,20 @@
         },
       ],
     }],
+    ['build_tests == 1 or build_benchmarks == 1', {
+      'targets': [
+        {
+          'target_name': 'peeracle_benchmark_utils',
+          'type': 'static_library',
+          'include_dirs': [
+            '<(DEPTH)',
+          ],
+          'sources': [
+            'benchmark.cc',
+            'benchmark.h',
+          ],
+        },
+      ],
+    }],
   ],
 }